@@ -36,6 +36,7 @@
 *
 *                   FTPs_OS_CFG_SERVER_TASK_PRIO
 *                   FTPs_OS_CFG_CTRL_TASK_PRIO
+*                   FTPs_OS_CFG_PREFETCH_TASK_PRIO      (if FTPs_CFG_PREFETCH_EN is DEF_ENABLED)
 *
 *            Task priorities can be defined either in this configuration file 'ftp-s_cfg.h' or in a global
 *            OS tasks priorities configuration header file which must be included in 'ftp-s_cfg.h'.
@@ -45,6 +46,7 @@
                                                                 /* See Note #1.                                         */
 #define  FTPs_OS_CFG_SERVER_TASK_PRIO                     14
 #define  FTPs_OS_CFG_CTRL_TASK_PRIO                       15
+#define  FTPs_OS_CFG_PREFETCH_TASK_PRIO                   16
 
 
 /*
@@ -56,6 +58,7 @@
 
 #define  FTPs_OS_CFG_SERVER_TASK_STK_SIZE               1024
 #define  FTPs_OS_CFG_CTRL_TASK_STK_SIZE                 2048
+#define  FTPs_OS_CFG_PREFETCH_TASK_STK_SIZE             1024
 
 
 /*
@@ -86,4 +89,349 @@
 
 #define  FTPs_CFG_FS_PATH_LEN_MAX                        256    /* Maximum length for FS path.                          */
 #define  FTPs_CFG_FS_NAME_LEN_MAX                        256    /* Maximum length for file name.                        */
+#define  FTPs_CFG_FS_CASE_SENSITIVE             DEF_DISABLED    /* File names case sensitive: DEF_DISABLED for FAT.     */
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs CONTENT CACHE
+*
+* Notes: (1) The content cache keeps recently retrieved files in RAM so that following RETR of the same file
+*            are sent without accessing the file system.  Cached files are invalidated when modified through
+*            the server (STOR, APPE, DELE, RNTO, MDTM, ...).
+*
+*        (2) The cache memory budget is FTPs_CFG_CACHE_NBR_ENTRIES * FTPs_CFG_CACHE_ENTRY_SIZE_MAX octets,
+*            allocated from the heap by FTPs_Init().  Files larger than FTPs_CFG_CACHE_ENTRY_SIZE_MAX are
+*            never cached.  When all the entries are used, the least recently used one is evicted.
+*********************************************************************************************************
+*/
+
+#define  FTPs_CFG_CACHE_EN                      DEF_DISABLED    /* Enable/disable RETR content cache (see Note #1).     */
+#define  FTPs_CFG_CACHE_NBR_ENTRIES                        4    /* Number of cached files           (see Note #2).      */
+#define  FTPs_CFG_CACHE_ENTRY_SIZE_MAX                  8192    /* Maximum size of a cached file    (see Note #2).      */
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs PINNED FILES
+*
+* Notes: (1) Files pinned by the application with FTPs_PinFile() are kept in RAM for the whole life of the
+*            server.  RETR, SIZE & MDTM of a pinned file never access the file system.  A pinned file
+*            overwritten through STOR or APPE is re-read automatically.
+*
+*        (2) The memory image of each pinned file is allocated from the heap by FTPs_PinFile().
+*********************************************************************************************************
+*/
+
+#define  FTPs_CFG_PIN_EN                        DEF_DISABLED    /* Enable/disable pinned files      (see Note #1).      */
+#define  FTPs_CFG_PIN_NBR_ENTRIES                          2    /* Maximum number of pinned files   (see Note #2).      */
+
+
+/*
+*********************************************************************************************************
+*                                     FTPs SEQUENTIAL PREFETCHER
+*
+* Notes: (1) When a client retrieves a file located in the directory it listed last (LIST/NLST), the prefetch
+*            task reads, in background, the metadata & the first FTPs_CFG_PREFETCH_BUF_SIZE octets of the
+*            next file of the directory.  The next RETR, if it is for that file, sends them without waiting
+*            for the file system.
+*
+*        (2) The prefetch task runs at FTPs_OS_CFG_PREFETCH_TASK_PRIO, which SHOULD be lower than the control
+*            task priority.
+*
+*        (3) The memory budget is 2 * FTPs_CFG_PREFETCH_BUF_SIZE octets (the file being sent & the next one),
+*            allocated from the heap by FTPs_Init().
+*********************************************************************************************************
+*/
+
+#define  FTPs_CFG_PREFETCH_EN                   DEF_DISABLED    /* Enable/disable prefetcher        (see Note #1).      */
+#define  FTPs_CFG_PREFETCH_BUF_SIZE                     4096    /* Nbr of octets prefetched per file (see Note #3).     */
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs FILE HANDLE CACHE
+*
+* Notes: (1) The file opened by the control session to validate RETR is always handed to the data transfer.
+*            When the handle cache is enabled, read-only file handles are also kept open between commands,
+*            so that a client issuing SIZE, MDTM & RETR on the same file opens it only once.
+*
+*        (2) Cached handles are closed before the file is modified through the server (STOR, APPE, DELE,
+*            RNTO, ...) & when the session ends.  Files modified by the application while a handle is cached
+*            are only seen as the file system reports them through the open handle.
+*********************************************************************************************************
+*/
+
+#define  FTPs_CFG_HANDLE_CACHE_EN               DEF_DISABLED    /* Enable/disable file handle cache (see Note #1).      */
+#define  FTPs_CFG_HANDLE_CACHE_NBR_ENTRIES                 2    /* Number of cached file handles    (see Note #2).      */
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs METADATA CACHE
+*
+* Notes: (1) The metadata cache keeps the type, size & date/time of recently looked up files & directories,
+*            so that repeated CWD, SIZE, MDTM, ... on the same paths do not read the file system.  Entries
+*            are invalidated when modified through the server (STOR, APPE, DELE, MKD, RMD, RNTO, MDTM).
+*
+*        (2) Changes made to the file system by the application are seen after at most
+*            FTPs_CFG_META_CACHE_TTL_MS milliseconds.
+*********************************************************************************************************
+*/
+
+#define  FTPs_CFG_META_CACHE_EN                 DEF_DISABLED    /* Enable/disable metadata cache    (see Note #1).      */
+#define  FTPs_CFG_META_CACHE_NBR_ENTRIES                   8    /* Number of cached paths.                              */
+#define  FTPs_CFG_META_CACHE_TTL_MS                     2000    /* Maximum age of an entry (ms)     (see Note #2).      */
+
+
+/*
+*********************************************************************************************************
+*                                      FTPs NEGATIVE LOOKUP CACHE
+*
+* Notes: (1) The negative lookup cache remembers recently looked up paths that do not exist, so that clients
+*            polling for a file not created yet get their 550 reply without accessing the file system.  The
+*            entries of a directory are discarded when an entry is created, renamed or deleted in it through
+*            the server.
+*
+*        (2) Files created by the application are seen after at most FTPs_CFG_NEG_CACHE_TTL_MS milliseconds.
+*********************************************************************************************************
+*/
+
+#define  FTPs_CFG_NEG_CACHE_EN                  DEF_DISABLED    /* Enable/disable negative cache    (see Note #1).      */
+#define  FTPs_CFG_NEG_CACHE_NBR_ENTRIES                    4    /* Number of cached missing paths.                      */
+#define  FTPs_CFG_NEG_CACHE_TTL_MS                      1000    /* Maximum age of an entry (ms)     (see Note #2).      */
+
+
+/*
+*********************************************************************************************************
+*                                     FTPs DIRECTORY LISTING CACHE
+*
+* Notes: (1) The listing cache keeps the text sent for recent LIST & NLST commands, per directory & per
+*            command, so that listing the same directory again is a memory-to-socket send.  Listings are
+*            invalidated when an entry of the directory is modified through the server.
+*
+*        (2) The cache memory budget is FTPs_CFG_LIST_CACHE_NBR_ENTRIES * FTPs_CFG_LIST_CACHE_ENTRY_SIZE_MAX
+*            octets, allocated from the heap by FTPs_Init().  Longer listings are never cached.
+*
+*        (3) Changes made to the file system by the application are seen after at most
+*            FTPs_CFG_LIST_CACHE_TTL_MS milliseconds.
+*********************************************************************************************************
+*/
+
+#define  FTPs_CFG_LIST_CACHE_EN                 DEF_DISABLED    /* Enable/disable listing cache     (see Note #1).      */
+#define  FTPs_CFG_LIST_CACHE_NBR_ENTRIES                   2    /* Number of cached listings        (see Note #2).      */
+#define  FTPs_CFG_LIST_CACHE_ENTRY_SIZE_MAX             4096    /* Maximum size of a listing        (see Note #2).      */
+#define  FTPs_CFG_LIST_CACHE_TTL_MS                     5000    /* Maximum age of a listing (ms)    (see Note #3).      */
+
+
+/*
+*********************************************************************************************************
+*                                      FTPs LISTING NAME PATTERNS
+*
+* Notes: (1) When enabled, the last component of the NLST, LIST & MLSD path may be a glob pattern ('*', '?' &
+*            '[...]', e.g. "LIST -l *.csv").  The pattern is matched while the directory is read, so
+*            only the matching entries are formatted & sent.  Names are matched with regard to case
+*            only if FTPs_CFG_FS_CASE_SENSITIVE is enabled.
+*
+*        (2) When disabled, the pattern is taken as an entry name.
+*********************************************************************************************************
+*/
+
+#define  FTPs_CFG_LIST_GLOB_EN                  DEF_ENABLED     /* Enable/disable name patterns     (see Note #1).      */
+
+
+/*
+*********************************************************************************************************
+*                                       FTPs RECURSIVE LISTINGS
+*
+* Notes: (1) When enabled, "LIST -R" & "MLSD -R" list a whole directory tree on a single data connection.
+*            The tree is walked without recursion, so the control task stack use does not depend on the
+*            depth of the tree.
+*
+*        (2) Sub-directories deeper than FTPs_CFG_LIST_RECURSIVE_DEPTH_MAX levels are not listed.  Up to
+*            FTPs_CFG_LIST_RECURSIVE_DEPTH_MAX + 1 directories are open at a time: the file system MUST be
+*            configured accordingly.
+*********************************************************************************************************
+*/
+
+#define  FTPs_CFG_LIST_RECURSIVE_EN             DEF_DISABLED    /* Enable/disable recursive listing (see Note #1).      */
+#define  FTPs_CFG_LIST_RECURSIVE_DEPTH_MAX                 4    /* Maximum depth of a listed tree   (see Note #2).      */
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs SERVER-SIDE COPY
+*
+* Notes: (1) When enabled, "SITE CPFR <from>" followed by "SITE CPTO <to>" copies a file on the device,
+*            without sending its content over the network.
+*
+*        (2) The file is copied FTPs_CFG_SITE_COPY_BUF_SIZE octets at a time.  The buffer is allocated once
+*            from the heap.  A multiple of the file system sector size gives the best throughput.
+*********************************************************************************************************
+*/
+
+#define  FTPs_CFG_SITE_COPY_EN                  DEF_ENABLED     /* Enable/disable server-side copy  (see Note #1).      */
+#define  FTPs_CFG_SITE_COPY_BUF_SIZE                    4096    /* Size of the copy buffer          (see Note #2).      */
+
+
+/*
+*********************************************************************************************************
+*                                       FTPs DIRECTORY ARCHIVES
+*
+* Notes: (1) When enabled, "RETR <dirname>.tar" retrieves the directory tree as a tar archive, on a single
+*            data connection, unless a file of that name exists.  The archive is generated while it is sent:
+*            no temporary file is written.
+*
+*        (2) Sub-directories deeper than FTPs_CFG_TAR_DEPTH_MAX levels are archived empty.  Up to
+*            FTPs_CFG_TAR_DEPTH_MAX directories are open at a time: the file system MUST be configured
+*            accordingly.
+*
+*        (3) When enabled, "STOR <dirname>.tar" extracts the received tar archive into the existing
+*            directory, while it is received.  Entries are confined to that directory: unsafe names (e.g.
+*            with a ".." component) are skipped.  Requires FTPs_CFG_TAR_EN.
+*********************************************************************************************************
+*/
+
+#define  FTPs_CFG_TAR_EN                        DEF_DISABLED    /* Enable/disable dir archives      (see Note #1).      */
+#define  FTPs_CFG_TAR_DEPTH_MAX                            4    /* Maximum depth of an archived tree (see Note #2).     */
+#define  FTPs_CFG_TAR_EXTRACT_EN                DEF_DISABLED    /* Enable/disable archive extraction (see Note #3).     */
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs DELTA TRANSFERS
+*
+* Notes: (1) When enabled, "RETR <filename>.sig" retrieves the block signature of a file (a rolling checksum
+*            & a SHA-256 digest per block) & "STOR <filename>.delta" rebuilds the file from the blocks it
+*            already has & the changed data sent by the client.  The new file is written to a temporary
+*            file, then renamed over the original.
+*
+*        (2) Smaller blocks find more unchanged data but make the signature larger.  A buffer of one block
+*            is allocated from the heap.
+*********************************************************************************************************
+*/
+
+#define  FTPs_CFG_DELTA_EN                      DEF_DISABLED    /* Enable/disable delta transfers   (see Note #1).      */
+#define  FTPs_CFG_DELTA_BLK_SIZE                        2048    /* Size of a signature block        (see Note #2).      */
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs DEDUPLICATION
+*
+* Notes: (1) When enabled, the SHA-256 digest of each file received by STOR is recorded in an index file,
+*            FTPs_CFG_DEDUP_IDX_PATH.  "SITE DEDUP <sha256> <filename>" then creates the file from an
+*            indexed file with the same content, without any data transfer; no write is done if the file
+*            already has that content.  Requires FTPs_CFG_SITE_COPY_EN.
+*
+*        (2) The index file path is a full file system path, with no default: it MUST be outside of the
+*            users' base paths.  Client paths naming the index file are refused; but with a base path
+*            like "\\", a client could still remove or rename its directory.
+*
+*        (3) Once FTPs_CFG_DEDUP_NBR_MAX files are indexed, new digests are not recorded.  Each record
+*            uses about FTPs_CFG_FS_PATH_LEN_MAX + 40 octets of the index file.
+*********************************************************************************************************
+*/
+
+#define  FTPs_CFG_DEDUP_EN                      DEF_DISABLED    /* Enable/disable deduplication     (see Note #1).      */
+#define  FTPs_CFG_DEDUP_IDX_PATH     "\\sys\\ftps-dedup.idx"    /* Index file path                  (see Note #2).      */
+#define  FTPs_CFG_DEDUP_NBR_MAX                          256    /* Maximum number of indexed files  (see Note #3).      */
+
+
+/*
+*********************************************************************************************************
+*                                       FTPs SEGMENTED UPLOADS
+*
+* Notes: (1) When enabled, "SITE SEGS <size> <filename>" declares a file uploaded in segments, possibly by
+*            several sessions.  Each segment is sent by "REST <offset>-<end>" followed by "STOR <filename>"
+*            & written at its offset in a temporary file.  Once every octet is received, the temporary file
+*            replaces the file.
+*
+*        (2) Maximum number of files uploaded in segments at the same time.
+*
+*        (3) Received segments are merged with adjacent ones.  A segment that would need more than
+*            FTPs_CFG_SEGS_RANGE_MAX separate ranges of received octets is refused.
+*
+*        (4) "SITE SEGS 0 <filename>" cancels an upload.  An upload that received neither a declaration nor
+*            a segment for FTPs_CFG_SEGS_IDLE_TIMEOUT_MS milliseconds is cancelled when a new upload needs
+*            its slot.  DELE & STOR of the whole file also cancel its upload.
+*********************************************************************************************************
+*/
+
+#define  FTPs_CFG_SEGS_EN                       DEF_DISABLED    /* Enable/disable segmented uploads (see Note #1).      */
+#define  FTPs_CFG_SEGS_NBR_MAX                             2    /* Maximum number of uploads        (see Note #2).      */
+#define  FTPs_CFG_SEGS_RANGE_MAX                          16    /* Maximum number of ranges         (see Note #3).      */
+#define  FTPs_CFG_SEGS_IDLE_TIMEOUT_MS               3600000    /* Maximum idle time (ms) of upload (see Note #4).      */
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs TAIL-FOLLOW
+*
+* Notes: (1) When enabled, "RETR <filename>.tail" sends the file up to its current end, then keeps the data
+*            connection open & sends the octets appended to the file, until the client sends a command
+*            (e.g. ABOR) or until no octet is appended for FTPs_CFG_TAIL_IDLE_TIMEOUT_MS.  The application
+*            MUST call FTPs_TailNotify() after appending to a file.
+*
+*        (2) Maximum time without appended octets, in milliseconds.
+*********************************************************************************************************
+*/
+
+#define  FTPs_CFG_TAIL_EN                       DEF_DISABLED    /* Enable/disable tail-follow RETR  (see Note #1).      */
+#define  FTPs_CFG_TAIL_IDLE_TIMEOUT_MS                 60000    /* Idle limit                       (see Note #2).      */
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs RESUME JOURNAL
+*
+* Notes: (1) When enabled, each STOR is recorded in a journal file, FTPs_CFG_RESUME_JRNL_PATH, with the number
+*            of octets written to the media & the state of their SHA-256 digest.  If the upload is
+*            interrupted, SIZE returns the number of octets written & "SITE RESUME <filename>" also returns
+*            their digest, so that the client can check its data & continue with REST & STOR.  A record is
+*            removed once the client closes the data connection.
+*
+*        (2) The journal file path is a full file system path, with no default: it MUST be outside of the
+*            users' base paths, since a forged journal makes SIZE lie.  Client paths naming the journal
+*            file are refused (see FTPs DEDUPLICATION Note #2).
+*
+*        (3) Maximum number of interrupted uploads kept in the journal file.  Each record uses about
+*            FTPs_CFG_FS_PATH_LEN_MAX + 120 octets.
+*
+*        (4) Every FTPs_CFG_RESUME_SYNC_LEN octets received, the file is closed & re-opened to write its
+*            octets to the media, then the journal record is updated.  Smaller values lose less data on
+*            power loss but slow uploads down.
+*********************************************************************************************************
+*/
+
+#define  FTPs_CFG_RESUME_EN                     DEF_DISABLED    /* Enable/disable resume journal    (see Note #1).      */
+#define  FTPs_CFG_RESUME_JRNL_PATH  "\\sys\\ftps-resume.jnl"    /* Journal file path                (see Note #2).      */
+#define  FTPs_CFG_RESUME_NBR_MAX                          16    /* Maximum number of uploads        (see Note #3).      */
+#define  FTPs_CFG_RESUME_SYNC_LEN                      65536    /* Nbr of octets between records    (see Note #4).      */
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs RATE LIMITING
+*
+* Notes: (1) When enabled, the data transfers are limited by token buckets: a global limit shared by all
+*            the transfers & a limit for the session.  The data connection is paced after each buffer
+*            sent or received until both buckets hold octets again.
+*
+*        (2) Limits in octets per second, up to 1000000000.  0 disables the limit.  The session limit is
+*            set when the session starts & MAY be changed for the user by FTPs_AuthUser() (see ftp-s.h).
+*
+*        (3) Octets that can be transferred at once after an idle period, in milliseconds of the limit.
+*
+*        (4) Period of the kernel timer that wakes a paced transfer, in milliseconds.  The elapsed time is
+*            measured at each wake-up, so that the period only sets the pacing granularity & not the
+*            rate.  The period is rounded to the kernel timer resolution.
+*********************************************************************************************************
+*/
+
+#define  FTPs_CFG_RATE_EN                       DEF_DISABLED    /* Enable/disable rate limiting     (see Note #1).      */
+#define  FTPs_CFG_RATE_GLOBAL_LIMIT                        0    /* Global  limit                    (see Note #2).      */
+#define  FTPs_CFG_RATE_SESSION_LIMIT                       0    /* Session limit                    (see Note #2).      */
+#define  FTPs_CFG_RATE_BURST_MS                          100    /* Burst                            (see Note #3).      */
+#define  FTPs_CFG_RATE_TMR_MS                              5    /* Pacing timer period              (see Note #4).      */
 
@@ -122,6 +122,19 @@
 #endif
 
 
+#if     (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+#if     (FTPs_OS_CFG_PREFETCH_TASK_PRIO < 0u)
+#error  "FTPs_OS_CFG_PREFETCH_TASK_PRIO    illegally #define'd in 'app_cfg.h'"
+#error  "                                  [MUST be  >= 0u]                  "
+#endif
+
+#if     (FTPs_OS_CFG_PREFETCH_TASK_STK_SIZE < 1u)
+#error  "FTPs_OS_CFG_PREFETCH_TASK_STK_SIZE illegally #define'd in 'app_cfg.h'"
+#error  "                                  [MUST be  > 0u]                   "
+#endif
+#endif
+
+
 /*
 *********************************************************************************************************
 *                                            LOCAL DEFINES
@@ -140,8 +153,9 @@
                                           /* 012345678901234567890 */
 #define  FTPs_OS_SERVER_TASK_NAME           "FTP (Server)"
 #define  FTPs_OS_CTRL_TASK_NAME             "FTP (Control)"
+#define  FTPs_OS_PREFETCH_TASK_NAME         "FTP (Prefetch)"
 
-#define  FTPs_OS_OBJ_NAME_SIZE_MAX                        14    /* Maximum of ALL FTPs object name sizes.               */
+#define  FTPs_OS_OBJ_NAME_SIZE_MAX                        15    /* Maximum of ALL FTPs object name sizes.               */
 
 
 /*
@@ -174,6 +188,9 @@
                                                                 /* ------------------- TASK STACKS -------------------- */
 static  OS_STK  FTPs_OS_ServerTaskStk[FTPs_OS_CFG_SERVER_TASK_STK_SIZE];
 static  OS_STK  FTPs_OS_CtrlTaskStk[FTPs_OS_CFG_CTRL_TASK_STK_SIZE];
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+static  OS_STK  FTPs_OS_PrefetchTaskStk[FTPs_OS_CFG_PREFETCH_TASK_STK_SIZE];
+#endif
 
 
 /*
@@ -188,6 +205,11 @@ static  void  FTPs_OS_ServerTask(void  *p_data);
                                                                 /* -------- FTPs CTRL TASK MANAGEMENT FUNCTION -------- */
 static  void  FTPs_OS_CtrlTask  (void  *p_data);
 
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+                                                                /* ------ FTPs PREFETCH TASK MANAGEMENT FUNCTION ------ */
+static  void  FTPs_OS_PrefetchTask(void  *p_data);
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -409,6 +431,116 @@ static  void  FTPs_OS_CtrlTask (void  *p_data)
 }
 
 
+/*
+*********************************************************************************************************
+*                                     FTPs_OS_PrefetchTaskInit()
+*
+* Description : (1) Perform FTP prefetch/OS task initialization :
+*
+*                   (a) Create FTP prefetch task
+*
+*
+* Argument(s) : p_data      Pointer to task initialization data (required by uC/OS-II).
+*
+* Return(s)   : DEF_OK,   if FTP prefetch task successfully created.
+*
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : FTPs_Init().
+*
+*               This function is an INTERNAL FTP server function & MUST NOT be called by application
+*               function(s).
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+CPU_BOOLEAN  FTPs_OS_PrefetchTaskInit (void  *p_data)
+{
+    INT8U  os_err;
+
+
+                                                                /* Create FTP prefetch task.                            */
+#if (OS_TASK_CREATE_EXT_EN > 0u)
+    #if (OS_STK_GROWTH == 1u)
+    os_err = OSTaskCreateExt((void (*)(void *)) FTPs_OS_PrefetchTask,
+                             (void          * ) p_data,
+                             (OS_STK        * )&FTPs_OS_PrefetchTaskStk[FTPs_OS_CFG_PREFETCH_TASK_STK_SIZE - 1],/* Set Top-Of-Stack.    */
+                             (INT8U           ) FTPs_OS_CFG_PREFETCH_TASK_PRIO,
+                             (INT16U          ) FTPs_OS_CFG_PREFETCH_TASK_PRIO,
+                             (OS_STK        * )&FTPs_OS_PrefetchTaskStk[0],                                     /* Set Bottom-Of-Stack. */
+                             (INT32U          ) FTPs_OS_CFG_PREFETCH_TASK_STK_SIZE,
+                             (void          * ) 0,                                                              /* No TCB extension.    */
+                             (INT16U          ) OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR);
+    #else
+    os_err = OSTaskCreateExt((void (*)(void *)) FTPs_OS_PrefetchTask,
+                             (void          * ) p_data,
+                             (OS_STK        * )&FTPs_OS_PrefetchTaskStk[0],                                     /* Set Top-Of-Stack.    */
+                             (INT8U           ) FTPs_OS_CFG_PREFETCH_TASK_PRIO,
+                             (INT16U          ) FTPs_OS_CFG_PREFETCH_TASK_PRIO,
+                             (OS_STK        * )&FTPs_OS_PrefetchTaskStk[FTPs_OS_CFG_PREFETCH_TASK_STK_SIZE - 1],/* Set Bottom-Of-Stack. */
+                             (INT32U          ) FTPs_OS_CFG_PREFETCH_TASK_STK_SIZE,
+                             (void          * ) 0,                                                              /* No TCB extension.    */
+                             (INT16U          ) OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR);
+    #endif
+#else
+    #if (OS_STK_GROWTH == 1u)
+    os_err = OSTaskCreate((void (*)(void *)) FTPs_OS_PrefetchTask,
+                          (void          * ) p_data,
+                          (OS_STK        * )&FTPs_OS_PrefetchTaskStk[FTPs_OS_CFG_PREFETCH_TASK_STK_SIZE - 1],   /* Set Bottom-Of-Stack. */
+                          (INT8U           ) FTPs_OS_CFG_PREFETCH_TASK_PRIO);
+    #else
+    os_err = OSTaskCreate((void (*)(void *)) FTPs_OS_PrefetchTask,
+                          (void          * ) p_data,
+                          (OS_STK        * )&FTPs_OS_PrefetchTaskStk[0],                                        /* Set Top-Of-Stack.    */
+                          (INT8U           ) FTPs_OS_CFG_PREFETCH_TASK_PRIO);
+    #endif
+#endif
+
+    if (os_err != OS_ERR_NONE) {
+        return (DEF_FAIL);
+    }
+
+
+
+#if (((OS_VERSION >= 288u) && (OS_TASK_NAME_EN   >  0u)) || \
+     ((OS_VERSION <  288u) && (OS_TASK_NAME_SIZE >= FTPs_OS_OBJ_NAME_SIZE_MAX)))
+    OSTaskNameSet((INT8U  ) FTPs_OS_CFG_PREFETCH_TASK_PRIO,
+                  (INT8U *) FTPs_OS_PREFETCH_TASK_NAME,
+                  (INT8U *)&os_err);
+#endif
+
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       FTPs_OS_PrefetchTask()
+*
+* Description : OS-dependent FTP prefetch task.
+*
+* Argument(s) : p_data      Pointer to task initialization data (required by uC/OS-II).
+*
+* Return(s)   : none.
+*
+* Created by  : FTPs_OS_PrefetchTaskInit().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+static  void  FTPs_OS_PrefetchTask (void  *p_data)
+{
+    FTPs_PrefetchTask(p_data);                                  /* Call FTP prefetch task.                              */
+}
+#endif
+
+
 /*
 *********************************************************************************************************
 *                                        FTPs_OS_TaskSuspend()
@@ -122,6 +122,19 @@
 #endif
 
 
+#if     (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+#if     (FTPs_OS_CFG_PREFETCH_TASK_PRIO < 0u)
+#error  "FTPs_OS_CFG_PREFETCH_TASK_PRIO    illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                  [MUST be  >= 0u]                    "
+#endif
+
+#if     (FTPs_OS_CFG_PREFETCH_TASK_STK_SIZE < 1u)
+#error  "FTPs_OS_CFG_PREFETCH_TASK_STK_SIZE illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                  [MUST be  > 0u]                     "
+#endif
+#endif
+
+
 /*
 *********************************************************************************************************
 *                                            LOCAL DEFINES
@@ -140,6 +153,7 @@
                                           /* 012345678901234567890 */
 #define  FTPs_OS_SERVER_TASK_NAME           "FTP (Server)"
 #define  FTPs_OS_CTRL_TASK_NAME             "FTP (Control)"
+#define  FTPs_OS_PREFETCH_TASK_NAME         "FTP (Prefetch)"
 
 
 /*
@@ -172,10 +186,16 @@
                                                                 /* -------------------- TASK TCBs --------------------- */
 static  OS_TCB   FTPs_OS_ServerTaskTCB;
 static  OS_TCB   FTPs_OS_CtrlTaskTCB;
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+static  OS_TCB   FTPs_OS_PrefetchTaskTCB;
+#endif
 
                                                                 /* ------------------- TASK STACKS -------------------- */
 static  CPU_STK  FTPs_OS_ServerTaskStk[FTPs_OS_CFG_SERVER_TASK_STK_SIZE];
 static  CPU_STK  FTPs_OS_CtrlTaskStk[FTPs_OS_CFG_CTRL_TASK_STK_SIZE];
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+static  CPU_STK  FTPs_OS_PrefetchTaskStk[FTPs_OS_CFG_PREFETCH_TASK_STK_SIZE];
+#endif
 
 
 /*
@@ -190,6 +210,11 @@ static  void  FTPs_OS_ServerTask(void  *p_data);
                                                                 /* -------- FTPs CTRL TASK MANAGEMENT FUNCTION -------- */
 static  void  FTPs_OS_CtrlTask  (void  *p_data);
 
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+                                                                /* ------ FTPs PREFETCH TASK MANAGEMENT FUNCTION ------ */
+static  void  FTPs_OS_PrefetchTask(void  *p_data);
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -349,6 +374,85 @@ static  void  FTPs_OS_CtrlTask (void  *p_data)
 }
 
 
+/*
+*********************************************************************************************************
+*                                     FTPs_OS_PrefetchTaskInit()
+*
+* Description : (1) Perform FTP prefetch/OS task initialization :
+*
+*                   (a) Create FTP prefetch task
+*
+*
+* Argument(s) : p_data      Pointer to task initialization data (required by uC/OS-III).
+*
+* Return(s)   : DEF_OK,   if FTP prefetch task successfully created.
+*
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : FTPs_Init().
+*
+*               This function is an INTERNAL FTP server function & MUST NOT be called by application
+*               function(s).
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+CPU_BOOLEAN  FTPs_OS_PrefetchTaskInit (void  *p_data)
+{
+    OS_ERR  os_err;
+
+
+                                                                /* Create FTP prefetch task.                            */
+    OSTaskCreate((OS_TCB     *)&FTPs_OS_PrefetchTaskTCB,
+                 (CPU_CHAR   *) FTPs_OS_PREFETCH_TASK_NAME,
+                 (OS_TASK_PTR ) FTPs_OS_PrefetchTask,
+                 (void       *) p_data,
+                 (OS_PRIO     ) FTPs_OS_CFG_PREFETCH_TASK_PRIO,
+                 (CPU_STK    *)&FTPs_OS_PrefetchTaskStk[0],
+                 (CPU_STK_SIZE)(FTPs_OS_CFG_PREFETCH_TASK_STK_SIZE / 10u),
+                 (CPU_STK_SIZE) FTPs_OS_CFG_PREFETCH_TASK_STK_SIZE,
+                 (OS_MSG_QTY  ) 0u,
+                 (OS_TICK     ) 0u,
+                 (void       *) 0,
+                 (OS_OPT      )(OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),
+                 (OS_ERR     *)&os_err);
+
+    if (os_err != OS_ERR_NONE) {
+        return (DEF_FAIL);
+    }
+
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       FTPs_OS_PrefetchTask()
+*
+* Description : OS-dependent FTP prefetch task.
+*
+* Argument(s) : p_data      Pointer to task initialization data (required by uC/OS-III).
+*
+* Return(s)   : none.
+*
+* Created by  : FTPs_OS_PrefetchTaskInit().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+static  void  FTPs_OS_PrefetchTask (void  *p_data)
+{
+    FTPs_PrefetchTask(p_data);                                  /* Call FTP prefetch task.                              */
+}
+#endif
+
+
 /*
 *********************************************************************************************************
 *                                        FTPs_OS_TaskSuspend()
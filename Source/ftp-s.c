@@ -46,6 +46,141 @@
 *********************************************************************************************************
 */
 
+#define  FTPs_PREFETCH_NBR_ENTRIES                         2u   /* File being sent & next file.                         */
+
+                                                                /* LIST line fixed part after the permissions.          */
+#define  FTPs_LIST_LINE_OWNER_STR                  "   1 user     group    "
+#define  FTPs_LIST_LINE_OWNER_LEN                         23u
+                                                                /* LIST line max len without the name: perm, owner,     */
+                                                                /* size, month, day, year, separators & new line.       */
+#define  FTPs_LIST_LINE_LEN_MAX                         (10u + FTPs_LIST_LINE_OWNER_LEN + 10u + 1u + 3u + \
+                                                          1u +  5u + 2u + 5u + 1u + 1u)
+
+#define  FTPs_GLOB_TOK_CHAR                                0u   /* Pattern token: literal char.                         */
+#define  FTPs_GLOB_TOK_ANY                                 1u   /* Pattern token: '?', any char.                        */
+#define  FTPs_GLOB_TOK_STAR                                2u   /* Pattern token: '*', any string.                      */
+#define  FTPs_GLOB_TOK_SET                                 3u   /* Pattern token: '[...]', char set.                    */
+
+#define  FTPs_GLOB_SET_NBR_MAX                             4u   /* Max nbr of '[...]' sets in a pattern.                */
+#define  FTPs_GLOB_SET_SIZE                               32u   /* Size of a set bitmap (one bit per char value).       */
+
+                                                                /* Max len of a SITE reply line.                        */
+#define  FTPs_SITE_LINE_LEN_MAX                         (FTPs_CFG_FS_PATH_LEN_MAX + 64u)
+
+#define  FTPs_TAR_EXT_STR                               ".tar"  /* Suffix of a directory archive name.                  */
+#define  FTPs_TAR_EXT_LEN                                  4u
+
+#define  FTPs_TAR_BLK_SIZE                               512u   /* Size of a ustar header or data block.                */
+#define  FTPs_TAR_NAME_LEN                               100u   /* Max len of the ustar name   field.                   */
+#define  FTPs_TAR_PREFIX_LEN                             155u   /* Max len of the ustar prefix field.                   */
+
+#define  FTPs_TAR_HDR_NAME                                 0u   /* Offsets of the ustar header fields.                  */
+#define  FTPs_TAR_HDR_MODE                               100u
+#define  FTPs_TAR_HDR_UID                                108u
+#define  FTPs_TAR_HDR_GID                                116u
+#define  FTPs_TAR_HDR_SIZE                               124u
+#define  FTPs_TAR_HDR_MTIME                              136u
+#define  FTPs_TAR_HDR_CHKSUM                             148u
+#define  FTPs_TAR_HDR_TYPE                               156u
+#define  FTPs_TAR_HDR_MAGIC                              257u
+#define  FTPs_TAR_HDR_VERSION                            263u
+#define  FTPs_TAR_HDR_UNAME                              265u
+#define  FTPs_TAR_HDR_GNAME                              297u
+#define  FTPs_TAR_HDR_PREFIX                             345u
+
+#define  FTPs_DELTA_SIG_EXT_STR                         ".sig"  /* Suffix of a file signature name.                     */
+#define  FTPs_DELTA_SIG_EXT_LEN                            4u
+#define  FTPs_DELTA_EXT_STR                           ".delta"  /* Suffix of a file delta name.                         */
+#define  FTPs_DELTA_EXT_LEN                                6u
+#define  FTPs_DELTA_TMP_EXT_STR                      ".~delta"  /* Suffix of the file being rebuilt from a delta.       */
+#define  FTPs_DELTA_TMP_EXT_LEN                            7u
+
+#define  FTPs_DELTA_SIG_MAGIC                           "FSIG"  /* Magic of a signature header.                         */
+#define  FTPs_DELTA_MAGIC                               "FDLT"  /* Magic of a delta     header.                         */
+#define  FTPs_DELTA_HDR_LEN                               12u   /* Len of a signature or delta header.                  */
+#define  FTPs_DELTA_SIG_REC_LEN                           36u   /* Len of a signature record (weak sum & SHA-256).      */
+
+#define  FTPs_DELTA_OP_END                                 0u   /* Delta operation codes.                               */
+#define  FTPs_DELTA_OP_COPY                                1u
+#define  FTPs_DELTA_OP_DATA                                2u
+
+#define  FTPs_DELTA_ERR_NONE                               0u   /* Delta rebuild errors.                                */
+#define  FTPs_DELTA_ERR_INVALID                            1u   /* Invalid or incomplete delta.                         */
+#define  FTPs_DELTA_ERR_WR                                 2u   /* File rd or wr error.                                 */
+#define  FTPs_DELTA_ERR_REPLACE                            3u   /* Rebuilt file not renamed.                            */
+
+#define  FTPs_BAK_EXT_STR                              ".~bak"  /* Suffix of a file being replaced (backup).            */
+#define  FTPs_BAK_EXT_LEN                                  5u
+
+#define  FTPs_SEGS_TMP_EXT_STR                        ".~segs"  /* Suffix of the file being uploaded in segments.       */
+#define  FTPs_SEGS_TMP_EXT_LEN                             6u
+
+#define  FTPs_SEGS_ERR_NONE                                0u   /* Segment reception errors.                            */
+#define  FTPs_SEGS_ERR_INCOMPLETE                          1u   /* Segment not completely received.                     */
+#define  FTPs_SEGS_ERR_WR                                  2u   /* Temporary file not written.                          */
+#define  FTPs_SEGS_ERR_REPLACE                             3u   /* Complete file not renamed.                           */
+
+#define  FTPs_TAIL_EXT_STR                             ".tail"  /* Suffix of a followed file name.                      */
+#define  FTPs_TAIL_EXT_LEN                                 5u
+#define  FTPs_TAIL_WAIT_MS                               500u   /* Max wait between two checks of the ctrl conn.        */
+
+#define  FTPs_TELNET_IAC                                0xFFu   /* Telnet "Interpret As Command" escape.                */
+#define  FTPs_TELNET_WILL                               0xFBu   /* First Telnet option negotiation cmd (WILL ... DONT). */
+
+#define  FTPs_ABOR_PEEK_LEN                               16u   /* Max nbr of ctrl octets peeked for ABOR.              */
+#define  FTPs_DTP_RX_SLICE_MS                            100u   /* Data conn rx timeout between two ABOR checks.        */
+
+#define  FTPs_RATE_WAIT_MAX_MS                          1000u   /* Max wait for the pacing timer.                       */
+
+#define  FTPs_SHA256_LEN                                  32u   /* Len of a SHA-256 digest.                             */
+#define  FTPs_SHA256_BLK_SIZE                             64u   /* Size of a SHA-256 input block.                       */
+
+#if (FTPs_CFG_FS_CASE_SENSITIVE == DEF_ENABLED)                 /* Compare FS names & paths as the FS does.             */
+#define  FTPs_FS_NameCmp(p_name1, p_name2)              Str_Cmp((p_name1), (p_name2))
+#define  FTPs_FS_NameCmp_N(p_name1, p_name2, len)       Str_Cmp_N((p_name1), (p_name2), (len))
+#define  FTPs_FS_ChFold(ch)                             (ch)
+#else
+#define  FTPs_FS_NameCmp(p_name1, p_name2)              Str_CmpIgnoreCase((p_name1), (p_name2))
+#define  FTPs_FS_NameCmp_N(p_name1, p_name2, len)       Str_CmpIgnoreCase_N((p_name1), (p_name2), (len))
+#define  FTPs_FS_ChFold(ch)                             ASCII_ToLower(ch)
+#endif
+
+#if ((FTPs_CFG_DELTA_EN == DEF_ENABLED) || \
+     (FTPs_CFG_SEGS_EN  == DEF_ENABLED))
+#define  FTPs_REPLACE_EN                        DEF_ENABLED     /* FTPs_FileReplace() used by delta & segments.         */
+#else
+#define  FTPs_REPLACE_EN                        DEF_DISABLED
+#endif
+
+#define  FTPs_ROTR32(val, nbr_bits)                     (((val) >> (nbr_bits)) | ((val) << (32u - (nbr_bits))))
+
+#if ((FTPs_CFG_DELTA_EN  == DEF_ENABLED) || \
+     (FTPs_CFG_DEDUP_EN  == DEF_ENABLED) || \
+     (FTPs_CFG_RESUME_EN == DEF_ENABLED))
+#define  FTPs_SHA256_EN                         DEF_ENABLED     /* SHA-256 used by delta, dedup or resume journal.      */
+#else
+#define  FTPs_SHA256_EN                         DEF_DISABLED
+#endif
+
+#if ((FTPs_CFG_DEDUP_EN  == DEF_ENABLED) || \
+     (FTPs_CFG_RESUME_EN == DEF_ENABLED))
+#define  FTPs_SRV_FILES_EN                      DEF_ENABLED     /* Server files: dedup index or resume journal.         */
+#else
+#define  FTPs_SRV_FILES_EN                      DEF_DISABLED
+#endif
+
+#define  FTPs_PATH_HASH_INIT                      2166136261u   /* FNV-1a hash of the paths (see FTPs_PathFilterAdd()). */
+#define  FTPs_PATH_HASH_PRIME                       16777619u
+
+                                                                /* Path filter of the dedup index: 16 bits per record.  */
+#define  FTPs_DEDUP_FILTER_LEN                  (FTPs_CFG_DEDUP_NBR_MAX * 2u)
+                                                                /* Path filter of the resume journal.                   */
+#define  FTPs_RESUME_FILTER_LEN                 (FTPs_CFG_RESUME_NBR_MAX * 2u)
+
+#define  FTPs_DEDUP_NONE                                   0u   /* Results of FTPs_DedupIdxFind().                      */
+#define  FTPs_DEDUP_SAME                                   1u   /* The file itself has the digest.                      */
+#define  FTPs_DEDUP_OTHER                                  2u   /* Another file has the digest.                         */
+
 
 /*
 *********************************************************************************************************
@@ -60,6 +195,288 @@
 *********************************************************************************************************
 */
 
+                                                                /* A structure of this type holds the state of a multi- */
+                                                                /* line reply streamed while a command executes.        */
+typedef  struct  FTPs_ReplyMulti {
+    CPU_INT32S           SockID;                                /* Ctrl sock ID.                                        */
+    CPU_INT32S           ReplyNbr;                              /* Reply nbr used once the first line is sent.          */
+    CPU_SIZE_T           Len;                                   /* Len of the reply text buffered but not sent.         */
+    CPU_BOOLEAN          Sent;                                  /* DEF_YES once the first line was sent.                */
+} FTPs_REPLY_MULTI;
+
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+                                                                /* A structure of this type holds the content of one    */
+                                                                /* cached file.  Entries are recycled in LRU order.     */
+typedef  struct  FTPs_CacheEntry {
+    CPU_CHAR             Path[FTPs_CFG_FS_PATH_LEN_MAX];        /* FS absolute path of the cached file.                 */
+    CPU_CHAR            *DataPtr;                               /* Ptr to file content (FTPs_CFG_CACHE_ENTRY_SIZE_MAX). */
+    CPU_SIZE_T           DataLen;                               /* Len of file content (i.e. file size).                */
+    NET_FS_DATE_TIME     DateTime;                              /* Date/time of the cached file version.                */
+    CPU_INT32U           LastUse;                               /* Value of FTPs_CacheUseCtr when last used.            */
+    CPU_BOOLEAN          Valid;                                 /* DEF_YES if entry holds a complete file.              */
+} FTPs_CACHE_ENTRY;
+#endif
+
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+                                                                /* A structure of this type holds the memory image of   */
+                                                                /* one file pinned by the application.                  */
+typedef  struct  FTPs_PinEntry {
+    CPU_CHAR             Path[FTPs_CFG_FS_PATH_LEN_MAX];        /* FS absolute path of the pinned file.                 */
+    CPU_CHAR            *DataPtr;                               /* Ptr to file content.                                 */
+    CPU_SIZE_T           DataSize;                              /* Size of the memory image.                            */
+    CPU_SIZE_T           DataLen;                               /* Len of file content (i.e. file size).                */
+    NET_FS_DATE_TIME     DateTime;                              /* Date/time of the file.                               */
+    CPU_BOOLEAN          Used;                                  /* DEF_YES if entry is assigned to a file.              */
+    CPU_BOOLEAN          Valid;                                 /* DEF_YES if memory image matches the file.            */
+} FTPs_PIN_ENTRY;
+#endif
+
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+                                                                /* A structure of this type holds the metadata & first  */
+                                                                /* octets of one file read by the prefetch task.        */
+typedef  struct  FTPs_PrefetchEntry {
+    CPU_CHAR             Path[FTPs_CFG_FS_PATH_LEN_MAX];        /* FS absolute path of the prefetched file.             */
+    CPU_CHAR            *DataPtr;                               /* Ptr to first octets (FTPs_CFG_PREFETCH_BUF_SIZE).    */
+    CPU_SIZE_T           DataLen;                               /* Nbr of octets prefetched.                            */
+    CPU_INT32U           Size;                                  /* Size of the file.                                    */
+    NET_FS_DATE_TIME     DateTime;                              /* Date/time of the file.                               */
+    CPU_BOOLEAN          Valid;                                 /* DEF_YES if entry holds a prefetched file.            */
+    CPU_BOOLEAN          InUse;                                 /* DEF_YES while entry is used by a RETR.               */
+} FTPs_PREFETCH_ENTRY;
+#endif
+
+#if (FTPs_CFG_HANDLE_CACHE_EN == DEF_ENABLED)
+                                                                /* A structure of this type holds one read-only file    */
+                                                                /* handle kept open by the session.                     */
+typedef  struct  FTPs_HandleEntry {
+    CPU_CHAR             Path[FTPs_CFG_FS_PATH_LEN_MAX];        /* FS absolute path of the open file.                   */
+    void                *FilePtr;                               /* Open file handle (NULL if entry is free).            */
+    CPU_INT32U           LastUse;                               /* Value of FTPs_HandleUseCtr when last used.           */
+} FTPs_HANDLE_ENTRY;
+#endif
+
+#if (FTPs_CFG_META_CACHE_EN == DEF_ENABLED)
+                                                                /* A structure of this type holds the metadata of one   */
+                                                                /* file or directory.  Entries are recycled LRU.        */
+typedef  struct  FTPs_MetaEntry {
+    CPU_CHAR             Path[FTPs_CFG_FS_PATH_LEN_MAX];        /* FS absolute path of the entry.                       */
+    CPU_INT16U           Attrib;                                /* Entry attributes (see NET_FS_ENTRY_ATTRIB_xxx).      */
+    CPU_INT32U           Size;                                  /* Entry size.                                          */
+    NET_FS_DATE_TIME     DateTime;                              /* Entry date/time.                                     */
+    NET_TS_MS            TS;                                    /* Time stamp of the file system lookup.                */
+    CPU_INT32U           LastUse;                               /* Value of FTPs_MetaUseCtr when last used.             */
+    CPU_BOOLEAN          Valid;                                 /* DEF_YES if entry is used.                            */
+} FTPs_META_ENTRY;
+#endif
+
+#if (FTPs_CFG_NEG_CACHE_EN == DEF_ENABLED)
+                                                                /* A structure of this type holds one path known NOT to */
+                                                                /* exist.                                               */
+typedef  struct  FTPs_NegEntry {
+    CPU_CHAR             Path[FTPs_CFG_FS_PATH_LEN_MAX];        /* FS absolute path of the missing entry.               */
+    CPU_SIZE_T           NameOffset;                            /* Offset of the entry name (i.e. parent dir len).      */
+    NET_TS_MS            TS;                                    /* Time stamp of the file system lookup.                */
+    CPU_INT32U           Seq;                                   /* Value of FTPs_NegSeqCtr when inserted.               */
+    CPU_BOOLEAN          Valid;                                 /* DEF_YES if entry is used.                            */
+} FTPs_NEG_ENTRY;
+#endif
+
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+                                                                /* A structure of this type holds the rendered listing  */
+                                                                /* of one directory.  Entries are recycled LRU.         */
+typedef  struct  FTPs_ListEntry {
+    CPU_CHAR             Path[FTPs_CFG_FS_PATH_LEN_MAX];        /* FS absolute path of the listed directory.            */
+    CPU_INT08U           Cmd;                                   /* Listing command (FTP_CMD_LIST, FTP_CMD_NLST, ...).   */
+    CPU_CHAR            *DataPtr;                               /* Ptr to listing (FTPs_CFG_LIST_CACHE_ENTRY_SIZE_MAX). */
+    CPU_SIZE_T           DataLen;                               /* Len of listing.                                      */
+    NET_TS_MS            TS;                                    /* Time stamp of the directory read.                    */
+    CPU_INT32U           LastUse;                               /* Value of FTPs_ListUseCtr when last used.             */
+    CPU_BOOLEAN          Valid;                                 /* DEF_YES if entry holds a complete listing.           */
+} FTPs_LIST_ENTRY;
+#endif
+
+#if (FTPs_CFG_LIST_GLOB_EN == DEF_ENABLED)
+                                                                /* A structure of this type holds the name pattern of   */
+                                                                /* a listing, compiled once per command.                */
+typedef  struct  FTPs_Glob {
+    CPU_INT08U           TokTbl[FTPs_CFG_FS_NAME_LEN_MAX];      /* Tokens (FTPs_GLOB_TOK_xxx).                          */
+    CPU_INT08U           ValTbl[FTPs_CFG_FS_NAME_LEN_MAX];      /* Char (lower case) or set index of each token.        */
+    CPU_SIZE_T           TokNbr;                                /* Nbr of tokens.                                       */
+    CPU_INT08U           SetTbl[FTPs_GLOB_SET_NBR_MAX][FTPs_GLOB_SET_SIZE];    /* Chars (lower case) of each set.   */
+    CPU_INT08U           SetNbr;                                /* Nbr of sets.                                         */
+    CPU_BOOLEAN          En;                                    /* DEF_YES if the current listing is filtered.          */
+} FTPs_GLOB;
+#endif
+
+#if (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+                                                                /* A structure of this type holds the state of the      */
+                                                                /* depth-first walk of a recursive listing.             */
+typedef  struct  FTPs_ListWalk {
+    CPU_CHAR             Path[FTPs_CFG_FS_PATH_LEN_MAX];        /* FS absolute path of the dir being listed.            */
+    CPU_SIZE_T           BaseLen;                               /* Len of the path of the listed (top) dir.             */
+    void                *DirTbl[FTPs_CFG_LIST_RECURSIVE_DEPTH_MAX];        /* Stack of dirs being walked.           */
+    CPU_SIZE_T           PathLenTbl[FTPs_CFG_LIST_RECURSIVE_DEPTH_MAX];    /* Path len of each stacked dir.         */
+    CPU_SIZE_T           Depth;                                 /* Nbr of stacked dirs.                                 */
+    NET_FS_ENTRY         Entry;                                 /* Entry read from the top stacked dir.                 */
+    CPU_CHAR             EntryName[FTPs_CFG_FS_NAME_LEN_MAX];   /* Name of that entry.                                  */
+    CPU_CHAR             RelName[FTPs_CFG_FS_PATH_LEN_MAX];     /* Entry name relative to the top dir (MLSD).           */
+    CPU_BOOLEAN          En;                                    /* DEF_YES if the current listing is recursive.         */
+} FTPs_LIST_WALK;
+#endif
+
+#if (FTPs_CFG_TAR_EN == DEF_ENABLED)
+                                                                /* A structure of this type holds the state of the tar  */
+                                                                /* archive of a directory tree sent by RETR or          */
+                                                                /* extracted by STOR.                                   */
+typedef  struct  FTPs_Tar {
+    CPU_CHAR             Path[FTPs_CFG_FS_PATH_LEN_MAX];        /* FS absolute path of the entry being archived.        */
+    CPU_SIZE_T           BaseLen;                               /* Len of the path of the archived dir parent.          */
+    void                *DirTbl[FTPs_CFG_TAR_DEPTH_MAX];        /* Stack of dirs being walked.                          */
+    CPU_SIZE_T           PathLenTbl[FTPs_CFG_TAR_DEPTH_MAX];    /* Path len of each stacked dir.                        */
+    CPU_SIZE_T           Depth;                                 /* Nbr of stacked dirs.                                 */
+    NET_FS_ENTRY         Entry;                                 /* Entry being archived.                                */
+    CPU_CHAR             EntryName[FTPs_CFG_FS_NAME_LEN_MAX];   /* Name of that entry.                                  */
+    CPU_INT08U           Hdr[FTPs_TAR_BLK_SIZE];                /* Header block of that entry.                          */
+    CPU_INT32S           SockID;                                /* Data connection socket id.                           */
+    CPU_CHAR            *BufPtr;                                /* Transmit buf.                                        */
+    CPU_SIZE_T           BufLen;                                /* Nbr of octets in the transmit buf.                   */
+    CPU_INT32U           Skip;                                  /* Nbr of octets still to skip (REST offset).           */
+#if (FTPs_CFG_TAR_EXTRACT_EN == DEF_ENABLED)
+    CPU_CHAR             RxName[FTPs_TAR_PREFIX_LEN + FTPs_TAR_NAME_LEN + 2u];  /* Received entry name or pax data.     */
+    CPU_SIZE_T           TopLen;                                /* Len of the path of the target dir.                   */
+    CPU_SIZE_T           HdrLen;                                /* Nbr of octets of the header received.                */
+    void                *FilePtr;                               /* File being extracted.                                */
+    CPU_INT32U           Rem;                                   /* Nbr of entry data octets still to receive.           */
+    CPU_INT32U           Pad;                                   /* Nbr of padding octets still to receive.              */
+    CPU_INT32U           NbrFile;                               /* Nbr of files extracted.                              */
+    CPU_INT32U           NbrDir;                                /* Nbr of dirs  extracted.                              */
+    CPU_INT32U           NbrSkip;                               /* Nbr of entries skipped.                              */
+    CPU_SIZE_T           PaxLen;                                /* Nbr of pax header data octets kept in 'RxName'.      */
+    CPU_BOOLEAN          PaxRx;                                 /* DEF_YES if receiving pax header data.                */
+    CPU_BOOLEAN          SkipNext;                              /* DEF_YES if the next entry MUST be skipped.           */
+    CPU_BOOLEAN          End;                                   /* DEF_YES if the end-of-archive block was received.    */
+    CPU_BOOLEAN          WrErr;                                 /* DEF_YES if a file write failed.                      */
+#endif
+    CPU_BOOLEAN          En;                                    /* DEF_YES if RETR/STOR transfers a dir archive.        */
+} FTPs_TAR;
+#endif
+
+#if (FTPs_SHA256_EN == DEF_ENABLED)
+                                                                /* A structure of this type holds the state of a        */
+                                                                /* SHA-256 computation.                                 */
+typedef  struct  FTPs_Sha256 {
+    CPU_INT32U           State[8];                              /* Intermediate hash value.                             */
+    CPU_INT32U           Len;                                   /* Nbr of octets hashed.                                */
+    CPU_INT08U           Blk[FTPs_SHA256_BLK_SIZE];             /* Input block being filled.                            */
+    CPU_SIZE_T           BlkLen;                                /* Nbr of octets in the input block.                    */
+} FTPs_SHA256;
+#endif
+
+#if (FTPs_CFG_DELTA_EN == DEF_ENABLED)
+                                                                /* A structure of this type holds the state of the      */
+                                                                /* signature sent by RETR or the delta received by STOR.*/
+typedef  struct  FTPs_Delta {
+    CPU_CHAR             Path[FTPs_CFG_FS_PATH_LEN_MAX];        /* FS absolute path of the file.                        */
+    CPU_CHAR             TmpPath[FTPs_CFG_FS_PATH_LEN_MAX];     /* FS absolute path of the file being rebuilt.          */
+    void                *SrcFilePtr;                            /* Current  file.                                       */
+    void                *DstFilePtr;                            /* Rebuilt  file.                                       */
+    CPU_INT32U           SrcSize;                               /* Size of the current file.                            */
+    CPU_INT08U           Op[FTPs_DELTA_HDR_LEN];                /* Header or operation being received.                  */
+    CPU_SIZE_T           OpLen;                                 /* Nbr of octets of the header or operation received.   */
+    CPU_SIZE_T           OpNeed;                                /* Len  of the header or operation.                     */
+    CPU_INT32U           Rem;                                   /* Nbr of DATA octets still to receive.                 */
+    CPU_INT32U           NbrCopy;                               /* Nbr of octets copied from the current file.          */
+    CPU_INT32U           NbrData;                               /* Nbr of DATA octets received.                         */
+    CPU_INT08U           Err;                                   /* Rebuild error (see FTPs_DELTA_ERR_xxx).              */
+    CPU_BOOLEAN          HdrRx;                                 /* DEF_YES once the delta header is received.           */
+    CPU_BOOLEAN          End;                                   /* DEF_YES once the END operation is received.          */
+    CPU_BOOLEAN          En;                                    /* DEF_YES if RETR/STOR transfers a signature/delta.    */
+} FTPs_DELTA;
+#endif
+
+#if (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+                                                                /* A structure of this type is a record of the dedup    */
+                                                                /* index file.                                          */
+typedef  struct  FTPs_DedupRec {
+    CPU_INT08U           Digest[FTPs_SHA256_LEN];               /* SHA-256 digest of the file content.                  */
+    CPU_INT32U           Size;                                  /* Size & ...                                           */
+    NET_FS_DATE_TIME     DateTime;                              /* ... date of the file when indexed.                   */
+    CPU_CHAR             Path[FTPs_CFG_FS_PATH_LEN_MAX];        /* FS absolute path of the file (empty if free record). */
+} FTPs_DEDUP_REC;
+
+                                                                /* A structure of this type holds the dedup state.      */
+typedef  struct  FTPs_Dedup {
+    FTPs_DEDUP_REC       Rec;                                   /* Index record being read or written.                  */
+    FTPs_SHA256          Sha;                                   /* Digest of the file being received by STOR.           */
+    CPU_INT08U           Digest[FTPs_SHA256_LEN];               /* Digest given by SITE DEDUP.                          */
+    CPU_CHAR             Path[FTPs_CFG_FS_PATH_LEN_MAX];        /* FS absolute path of the file found with that digest. */
+    CPU_INT08U           Filter[FTPs_DEDUP_FILTER_LEN];         /* Paths of the index records (see FTPs_PathFilterAdd). */
+    CPU_BOOLEAN          FilterValid;                           /* DEF_YES once Filter is built from the index file.    */
+} FTPs_DEDUP;
+#endif
+
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+                                                                /* A structure of this type is a range of received      */
+                                                                /* octets of a file uploaded in segments.               */
+typedef  struct  FTPs_SegsRange {
+    CPU_INT32U           Start;                                 /* Offset of the first octet.                           */
+    CPU_INT32U           End;                                   /* Offset following the last octet.                     */
+} FTPs_SEGS_RANGE;
+
+                                                                /* A structure of this type holds the state of a file   */
+                                                                /* uploaded in segments.                                */
+typedef  struct  FTPs_Segs {
+    CPU_CHAR             Path[FTPs_CFG_FS_PATH_LEN_MAX];        /* FS absolute path of the file.                        */
+    CPU_CHAR             TmpPath[FTPs_CFG_FS_PATH_LEN_MAX];     /* FS absolute path of the file being received.         */
+    CPU_INT32U           Size;                                  /* Size of the file.                                    */
+    CPU_INT32U           NbrRx;                                 /* Nbr of octets received.                              */
+    FTPs_SEGS_RANGE      Range[FTPs_CFG_SEGS_RANGE_MAX];        /* Ranges of received octets.                           */
+    CPU_INT08U           NbrRange;                              /* Nbr of ranges.                                       */
+    NET_TS_MS            TS;                                    /* Time of the last declaration or segment.             */
+    CPU_BOOLEAN          En;                                    /* DEF_YES if the file is being uploaded.               */
+} FTPs_SEGS;
+#endif
+
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+                                                                /* A structure of this type is a record of the resume   */
+                                                                /* journal file.                                        */
+typedef  struct  FTPs_ResumeRec {
+    CPU_CHAR             Path[FTPs_CFG_FS_PATH_LEN_MAX];        /* FS absolute path of the file (empty if free record). */
+    CPU_INT32U           Size;                                  /* Nbr of octets written to the media.                  */
+    FTPs_SHA256          Sha;                                   /* Digest state of these octets.                        */
+} FTPs_RESUME_REC;
+
+                                                                /* A structure of this type holds the journal state of  */
+                                                                /* the current STOR.                                    */
+typedef  struct  FTPs_Resume {
+    FTPs_RESUME_REC      Rec;                                   /* Record of the upload.                                */
+    CPU_CHAR             RdPath[FTPs_CFG_FS_PATH_LEN_MAX];      /* Path of the journal record being read.               */
+    CPU_INT32U           Ix;                                    /* Ix of the record in the journal file.                */
+    CPU_INT32U           SyncLen;                               /* Nbr of octets written since the record was written.  */
+    CPU_INT08U           Filter[FTPs_RESUME_FILTER_LEN];        /* Paths of the journal records.                        */
+    CPU_BOOLEAN          FilterValid;                           /* DEF_YES once Filter is built from the journal file.  */
+    CPU_BOOLEAN          En;                                    /* DEF_YES if the current STOR is journaled.            */
+} FTPs_RESUME;
+#endif
+
+#if (FTPs_CFG_TAIL_EN == DEF_ENABLED)
+                                                                /* A structure of this type holds the file followed by  */
+                                                                /* the current RETR.                                    */
+typedef  struct  FTPs_Tail {
+    CPU_CHAR             Path[FTPs_CFG_FS_PATH_LEN_MAX];        /* FS absolute path of the file.                        */
+    CPU_BOOLEAN          En;                                    /* DEF_YES if RETR follows the file.                    */
+} FTPs_TAIL;
+#endif
+
+#if (FTPs_CFG_RATE_EN == DEF_ENABLED)
+                                                                /* A structure of this type is a token bucket limiting  */
+                                                                /* the rate of the data transfers (see FTPs_RateUse()). */
+typedef  struct  FTPs_RateBucket {
+    NET_TS_MS            TS;                                    /* Time at which the octets transferred are paid.       */
+    CPU_INT32U           Rem;                                   /* Octets not yet converted to time, in octets * 1000.  */
+} FTPs_RATE_BUCKET;
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -92,6 +509,9 @@ static         NET_PORT_NBR      FTPs_PublicPort;               /* mode.
                                                                 /* secure cfg.                                          */
 static  const  FTPs_SECURE_CFG  *FTPs_SecureCfgPtr = (FTPs_SECURE_CFG *)DEF_NULL;
 
+static         FTPs_SESSION_STRUCT *FTPs_DtpSessionPtr;         /* Session of the transfer in progress, if any.         */
+static         CPU_BOOLEAN       FTPs_DtpAbort;                 /* DEF_YES once ABOR received during the transfer.      */
+
 static         CPU_CHAR          FTPs_FS_SepChar;               /* Stores the FS separator char.                        */
 
 static         CPU_CHAR         *FTPs_FullAbsPathPtr;           /* Stores the full   absolute path string.              */
@@ -102,9 +522,9 @@ static         CPU_CHAR         *FTPs_ParentAbsPathPtr;         /* Stores the pa
 
 static         CPU_CHAR         *FTPs_CurEntryPtr;              /* Stores the entry  file name.                         */
 
-static         CPU_CHAR         *FTPs_RenAbsPathPtr;            /* Stores the        absolute entry rename.             */
+static         CPU_CHAR         *FTPs_RenAbsPathPtr;            /* Stores the        absolute entry rename/copy source. */
 
-static         CPU_CHAR         *FTPs_RenRelPathPtr;            /* Stores the        relative entry rename.             */
+static         CPU_CHAR         *FTPs_RenRelPathPtr;            /* Stores the        relative entry rename/copy source. */
 
 static         CPU_CHAR         *FTPs_NetBufCtrlCmdPtr;         /* Stores the net buf used in FTPs_ProcessCtrlCmd().    */
 
@@ -114,6 +534,112 @@ static         CPU_CHAR         *FTPs_NetBufDtpCmdPtr;          /* Stores the ne
 
 static         CPU_CHAR         *FTPs_NetBufSendReplyPtr;       /* Stores the net buf used in FTPs_SendReply().         */
 
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+static         FTPs_CACHE_ENTRY  FTPs_CacheTbl[FTPs_CFG_CACHE_NBR_ENTRIES];
+
+static         CPU_INT32U        FTPs_CacheUseCtr;              /* Incremented on each cache access (LRU ordering).     */
+
+static         FTPs_CACHE_STAT   FTPs_CacheStat;                /* See Note #1 of FTPs_CacheStatGet().                  */
+#endif
+
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+static         FTPs_PIN_ENTRY    FTPs_PinTbl[FTPs_CFG_PIN_NBR_ENTRIES];
+#endif
+
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+static         FTPs_PREFETCH_ENTRY   FTPs_PrefetchTbl[FTPs_PREFETCH_NBR_ENTRIES];
+
+static         FTPs_PREFETCH_ENTRY  *FTPs_PrefetchCurPtr;       /* Entry used by the current RETR, if any.              */
+
+static         CPU_CHAR          FTPs_PrefetchDirPath[FTPs_CFG_FS_PATH_LEN_MAX];   /* Dir of last LIST/NLST.        */
+
+static         CPU_CHAR          FTPs_PrefetchReqPath[FTPs_CFG_FS_PATH_LEN_MAX];   /* Last RETR in that dir.        */
+
+static         CPU_INT32U        FTPs_PrefetchGen;              /* Incremented on each invalidation.                    */
+
+static         KAL_LOCK_HANDLE   FTPs_PrefetchLock;             /* Protects all the prefetch variables above.           */
+
+static         KAL_SEM_HANDLE    FTPs_PrefetchSem;              /* Signals a request to the prefetch task.              */
+
+static         FTPs_PREFETCH_STAT  FTPs_PrefetchStat;           /* See Note #1 of FTPs_PrefetchStatGet().               */
+#endif
+
+#if (FTPs_CFG_HANDLE_CACHE_EN == DEF_ENABLED)
+                                                                /* Handles of the session (only one session at a time). */
+static         FTPs_HANDLE_ENTRY  FTPs_HandleTbl[FTPs_CFG_HANDLE_CACHE_NBR_ENTRIES];
+
+static         CPU_INT32U        FTPs_HandleUseCtr;             /* Incremented on each handle use (LRU ordering).       */
+#endif
+
+#if (FTPs_CFG_META_CACHE_EN == DEF_ENABLED)
+static         FTPs_META_ENTRY   FTPs_MetaTbl[FTPs_CFG_META_CACHE_NBR_ENTRIES];
+
+static         CPU_INT32U        FTPs_MetaUseCtr;               /* Incremented on each cache access (LRU ordering).     */
+
+static         FTPs_META_CACHE_STAT  FTPs_MetaCacheStat;        /* See Note #1 of FTPs_MetaCacheStatGet().              */
+#endif
+
+#if (FTPs_CFG_NEG_CACHE_EN == DEF_ENABLED)
+static         FTPs_NEG_ENTRY    FTPs_NegTbl[FTPs_CFG_NEG_CACHE_NBR_ENTRIES];
+
+static         CPU_INT32U        FTPs_NegSeqCtr;                /* Incremented on each insertion (FIFO ordering).       */
+#endif
+
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+static         FTPs_LIST_ENTRY   FTPs_ListTbl[FTPs_CFG_LIST_CACHE_NBR_ENTRIES];
+
+static         CPU_INT32U        FTPs_ListUseCtr;               /* Incremented on each cache access (LRU ordering).     */
+#endif
+
+#if (FTPs_CFG_LIST_GLOB_EN == DEF_ENABLED)
+static         FTPs_GLOB         FTPs_Glob;                     /* Pattern of the current listing (one session).        */
+#endif
+
+#if (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+static         FTPs_LIST_WALK    FTPs_ListWalk;                 /* Walk of the current listing (one session).           */
+#endif
+
+#if (FTPs_CFG_TAR_EN == DEF_ENABLED)
+static         FTPs_TAR          FTPs_Tar;                      /* Archive of the current RETR/STOR (one session).      */
+#endif
+
+#if (FTPs_CFG_SITE_COPY_EN == DEF_ENABLED)
+static         CPU_INT08U       *FTPs_SiteCopyBufPtr;           /* Stores the buf used in FTPs_SiteCpTo().              */
+#endif
+
+#if (FTPs_CFG_DELTA_EN == DEF_ENABLED)
+static         FTPs_DELTA        FTPs_Delta;                    /* Signature/delta of the current RETR/STOR.            */
+static         CPU_INT08U       *FTPs_DeltaBufPtr;              /* Stores the file blk buf used by signatures & deltas. */
+#endif
+
+#if (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+static         FTPs_DEDUP        FTPs_Dedup;                    /* Dedup index record & digests (one session).          */
+#endif
+
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+                                                                /* Files uploaded in segments.                          */
+static         FTPs_SEGS         FTPs_SegsTbl[FTPs_CFG_SEGS_NBR_MAX];
+static         FTPs_SEGS        *FTPs_SegsCurPtr;               /* Upload of the current STOR segment (one session).    */
+static         CPU_INT32U        FTPs_SegsSize;                 /* File size given by SITE SEGS (one session).          */
+#endif
+
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+static         FTPs_RESUME       FTPs_Resume;                   /* Journal state of the current STOR (one session).     */
+#endif
+
+#if (FTPs_CFG_TAIL_EN == DEF_ENABLED)
+static         FTPs_TAIL         FTPs_Tail;                     /* File followed by the current RETR (one session).     */
+static         KAL_SEM_HANDLE    FTPs_TailSem;                  /* Signals octets appended to the followed file.        */
+static         KAL_LOCK_HANDLE   FTPs_TailLock;                 /* Protects FTPs_Tail from FTPs_TailNotify().           */
+#endif
+
+#if (FTPs_CFG_RATE_EN == DEF_ENABLED)
+static         FTPs_RATE_BUCKET  FTPs_RateGlobal;               /* Bucket shared by all the transfers.                  */
+static         FTPs_RATE_BUCKET  FTPs_RateSession;              /* Bucket of the current session (one session).         */
+static         KAL_TMR_HANDLE    FTPs_RateTmr;                  /* Wakes a paced transfer.                              */
+static         KAL_SEM_HANDLE    FTPs_RateSem;                  /* Signaled by FTPs_RateTmr.                            */
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -124,46 +650,50 @@ static         CPU_CHAR         *FTPs_NetBufSendReplyPtr;       /* Stores the ne
                                                                 /* codes and their corresponding string.  The context   */
                                                                 /* is the state(s) in which the command is allowed.     */
 static  const  FTPs_CMD_STRUCT  FTPs_Cmd[] = {
-                                                 /*   L        L        G        G        G   */
-                                                 /*   O        O        O        O        O   */
-                                                 /*   G        G        T        T        T   */
-                                                 /*   O        I        U        R        R   */
-                                                 /*   U        N        S        N        E   */
-                                                 /*   T                 E        F        S   */
-                                                 /*                     R        R        T   */
-    { FTP_CMD_NOOP,  (const  CPU_CHAR *)"NOOP",  { DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON  } },
-    { FTP_CMD_QUIT,  (const  CPU_CHAR *)"QUIT",  { DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON  } },
-    { FTP_CMD_REIN,  (const  CPU_CHAR *)"REIN",  { DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON  } },
-    { FTP_CMD_SYST,  (const  CPU_CHAR *)"SYST",  { DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON  } },
-    { FTP_CMD_FEAT,  (const  CPU_CHAR *)"FEAT",  { DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON  } },
-    { FTP_CMD_HELP,  (const  CPU_CHAR *)"HELP",  { DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON  } },
-    { FTP_CMD_USER,  (const  CPU_CHAR *)"USER",  { DEF_ON,  DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_PASS,  (const  CPU_CHAR *)"PASS",  { DEF_OFF, DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF } },
-    { FTP_CMD_MODE,  (const  CPU_CHAR *)"MODE",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_TYPE,  (const  CPU_CHAR *)"TYPE",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_STRU,  (const  CPU_CHAR *)"STRU",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_PASV,  (const  CPU_CHAR *)"PASV",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_PORT,  (const  CPU_CHAR *)"PORT",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_PWD,   (const  CPU_CHAR *)"PWD" ,  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_CWD,   (const  CPU_CHAR *)"CWD" ,  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_CDUP,  (const  CPU_CHAR *)"CDUP",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_MKD,   (const  CPU_CHAR *)"MKD" ,  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_RMD,   (const  CPU_CHAR *)"RMD" ,  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_NLST,  (const  CPU_CHAR *)"NLST",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_LIST,  (const  CPU_CHAR *)"LIST",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_RETR,  (const  CPU_CHAR *)"RETR",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_ON  } },
-    { FTP_CMD_STOR,  (const  CPU_CHAR *)"STOR",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_ON  } },
-    { FTP_CMD_APPE,  (const  CPU_CHAR *)"APPE",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_REST,  (const  CPU_CHAR *)"REST",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_DELE,  (const  CPU_CHAR *)"DELE",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_RNFR,  (const  CPU_CHAR *)"RNFR",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_RNTO,  (const  CPU_CHAR *)"RNTO",  { DEF_OFF, DEF_OFF, DEF_OFF, DEF_ON,  DEF_OFF } },
-    { FTP_CMD_SIZE,  (const  CPU_CHAR *)"SIZE",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_MDTM,  (const  CPU_CHAR *)"MDTM",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_PBSZ,  (const  CPU_CHAR *)"PBSZ",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
-    { FTP_CMD_PROT,  (const  CPU_CHAR *)"PROT",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
+                                                 /*   L        L        G        G        G        G   */
+                                                 /*   O        O        O        O        O        O   */
+                                                 /*   G        G        T        T        T        T   */
+                                                 /*   O        I        U        R        R        C   */
+                                                 /*   U        N        S        N        E        P   */
+                                                 /*   T                 E        F        S        F   */
+                                                 /*                     R        R        T        R   */
+    { FTP_CMD_NOOP,  (const  CPU_CHAR *)"NOOP",  { DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON  } },
+    { FTP_CMD_QUIT,  (const  CPU_CHAR *)"QUIT",  { DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON  } },
+    { FTP_CMD_REIN,  (const  CPU_CHAR *)"REIN",  { DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON  } },
+    { FTP_CMD_SYST,  (const  CPU_CHAR *)"SYST",  { DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON  } },
+    { FTP_CMD_FEAT,  (const  CPU_CHAR *)"FEAT",  { DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON  } },
+    { FTP_CMD_HELP,  (const  CPU_CHAR *)"HELP",  { DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON,  DEF_ON  } },
+    { FTP_CMD_USER,  (const  CPU_CHAR *)"USER",  { DEF_ON,  DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_PASS,  (const  CPU_CHAR *)"PASS",  { DEF_OFF, DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_MODE,  (const  CPU_CHAR *)"MODE",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_TYPE,  (const  CPU_CHAR *)"TYPE",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_STRU,  (const  CPU_CHAR *)"STRU",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_PASV,  (const  CPU_CHAR *)"PASV",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_PORT,  (const  CPU_CHAR *)"PORT",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_PWD,   (const  CPU_CHAR *)"PWD" ,  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_CWD,   (const  CPU_CHAR *)"CWD" ,  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_CDUP,  (const  CPU_CHAR *)"CDUP",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_MKD,   (const  CPU_CHAR *)"MKD" ,  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_RMD,   (const  CPU_CHAR *)"RMD" ,  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_NLST,  (const  CPU_CHAR *)"NLST",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_LIST,  (const  CPU_CHAR *)"LIST",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_RETR,  (const  CPU_CHAR *)"RETR",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_ON,  DEF_OFF } },
+    { FTP_CMD_STOR,  (const  CPU_CHAR *)"STOR",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_ON,  DEF_OFF } },
+    { FTP_CMD_APPE,  (const  CPU_CHAR *)"APPE",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_REST,  (const  CPU_CHAR *)"REST",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_DELE,  (const  CPU_CHAR *)"DELE",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_RNFR,  (const  CPU_CHAR *)"RNFR",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_RNTO,  (const  CPU_CHAR *)"RNTO",  { DEF_OFF, DEF_OFF, DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF } },
+    { FTP_CMD_SIZE,  (const  CPU_CHAR *)"SIZE",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_MDTM,  (const  CPU_CHAR *)"MDTM",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_PBSZ,  (const  CPU_CHAR *)"PBSZ",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_PROT,  (const  CPU_CHAR *)"PROT",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_MLSD,  (const  CPU_CHAR *)"MLSD",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_MLST,  (const  CPU_CHAR *)"MLST",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } },
+    { FTP_CMD_SITE,  (const  CPU_CHAR *)"SITE",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_OFF, DEF_OFF, DEF_ON  } },
+    { FTP_CMD_ABOR,  (const  CPU_CHAR *)"ABOR",  { DEF_OFF, DEF_ON,  DEF_OFF, DEF_ON,  DEF_ON,  DEF_ON  } },
                                                                 /* The following line MUST be the LAST!                 */
-    { FTP_CMD_MAX,   (const  CPU_CHAR *)"MAX" ,  { DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } }
+    { FTP_CMD_MAX,   (const  CPU_CHAR *)"MAX" ,  { DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF, DEF_OFF } }
 };
 
                                                                 /* This table is used to match the incoming reply code  */
@@ -175,13 +705,15 @@ static  const  FTPs_REPLY_STRUCT  FTPs_Reply[] = {
                                                           " REST STREAM\n"              \
                                                           " MDTM\n"                     \
                                                           " SIZE\n"                     \
+                                                          " MLST type*;size*;modify*;perm*;\n" \
                                                           "211 End"                                                         },
     { FTP_REPLY_CODE_FILESTATUS,       (const  CPU_CHAR *)"213 File status."                                                },
     { FTP_REPLY_CODE_HELPMESSAGE,      (const  CPU_CHAR *)"214-Commands recognized:\n"                        \
                                                           " NOOP  QUIT  REIN  SYST  FEAT  HELP  USER  PASS\n" \
                                                           " MODE  TYPE  STRU  PASV  PORT  PWD   CWD   CDUP\n" \
                                                           " MKD   RMD   NLST  LIST  RETR  STOR  APPE  REST\n" \
-                                                          " DELE  RNFR  RNTO  SIZE  MDTM\n"                   \
+                                                          " DELE  RNFR  RNTO  SIZE  MDTM  MLSD  MLST  SITE\n" \
+                                                          " ABOR\n"                                           \
                                                           "214 End"                                                         },
     { FTP_REPLY_CODE_SYSTEMTYPE,       (const  CPU_CHAR *)"215 UNIX Type: L8."                                              },
     { FTP_REPLY_CODE_SERVERREADY,      (const  CPU_CHAR *)"220 Service ready for new user."                                 },
@@ -206,7 +738,46 @@ static  const  FTPs_REPLY_STRUCT  FTPs_Reply[] = {
     { FTP_REPLY_CODE_NOSPACE,          (const  CPU_CHAR *)"552 Requested file action aborted. Exceeded storage allocation." },
     { FTP_REPLY_CODE_NAMEERR,          (const  CPU_CHAR *)"553 Requested action not taken. File name not allowed."          },
     { FTP_REPLY_CODE_PBSZ,             (const  CPU_CHAR *)"200 PBSZ=%s"                                                     },
-    { FTP_REPLY_CODE_PROT,             (const  CPU_CHAR *)"200 Protection level set to %s"                                  }
+    { FTP_REPLY_CODE_PROT,             (const  CPU_CHAR *)"200 Protection level set to %s"                                  },
+    { FTP_REPLY_CODE_SITEHELP,         (const  CPU_CHAR *)"214-SITE commands recognized:\n"                   \
+                                                          " HELP  RMTREE  MKDIRS"
+#if (FTPs_CFG_SITE_COPY_EN == DEF_ENABLED)
+                                                          "  CPFR  CPTO"
+#endif
+#if (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+                                                          "  DEDUP"
+#endif
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+                                                          "  SEGS"
+#endif
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+                                                          "  RESUME"
+#endif
+                                                          "\n"                                               \
+                                                          "214 End"                                                         }
+};
+
+                                                                /* This table is used to match the incoming SITE sub-   */
+                                                                /* command string to its corresponding code.            */
+static  const  FTPs_SITE_CMD_STRUCT  FTPs_SiteCmd[] = {
+    { FTP_SITE_CMD_HELP,    (const  CPU_CHAR *)"HELP"   },
+    { FTP_SITE_CMD_RMTREE,  (const  CPU_CHAR *)"RMTREE" },
+    { FTP_SITE_CMD_MKDIRS,  (const  CPU_CHAR *)"MKDIRS" },
+#if (FTPs_CFG_SITE_COPY_EN == DEF_ENABLED)
+    { FTP_SITE_CMD_CPFR,    (const  CPU_CHAR *)"CPFR"   },
+    { FTP_SITE_CMD_CPTO,    (const  CPU_CHAR *)"CPTO"   },
+#endif
+#if (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+    { FTP_SITE_CMD_DEDUP,   (const  CPU_CHAR *)"DEDUP"  },
+#endif
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+    { FTP_SITE_CMD_SEGS,    (const  CPU_CHAR *)"SEGS"   },
+#endif
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+    { FTP_SITE_CMD_RESUME,  (const  CPU_CHAR *)"RESUME" },
+#endif
+                                                                /* The following line MUST be the LAST!                 */
+    { FTP_SITE_CMD_MAX,     (const  CPU_CHAR *)"MAX"    }
 };
 
                                                                 /* Table used to display month name abbreviation in     */
@@ -226,6 +797,20 @@ static  const  CPU_CHAR *  const  FTPs_Month_Name[] = {
     (const  CPU_CHAR *)"dec",
 };
 
+#if (FTPs_SHA256_EN == DEF_ENABLED)
+                                                                /* SHA-256 round constants (see FIPS 180-4).            */
+static  const  CPU_INT32U  FTPs_Sha256_K[64] = {
+    0x428A2F98u, 0x71374491u, 0xB5C0FBCFu, 0xE9B5DBA5u, 0x3956C25Bu, 0x59F111F1u, 0x923F82A4u, 0xAB1C5ED5u,
+    0xD807AA98u, 0x12835B01u, 0x243185BEu, 0x550C7DC3u, 0x72BE5D74u, 0x80DEB1FEu, 0x9BDC06A7u, 0xC19BF174u,
+    0xE49B69C1u, 0xEFBE4786u, 0x0FC19DC6u, 0x240CA1CCu, 0x2DE92C6Fu, 0x4A7484AAu, 0x5CB0A9DCu, 0x76F988DAu,
+    0x983E5152u, 0xA831C66Du, 0xB00327C8u, 0xBF597FC7u, 0xC6E00BF3u, 0xD5A79147u, 0x06CA6351u, 0x14292967u,
+    0x27B70A85u, 0x2E1B2138u, 0x4D2C6DFCu, 0x53380D13u, 0x650A7354u, 0x766A0ABBu, 0x81C2C92Eu, 0x92722C85u,
+    0xA2BFE8A1u, 0xA81A664Bu, 0xC24B8B70u, 0xC76C51A3u, 0xD192E819u, 0xD6990624u, 0xF40E3585u, 0x106AA070u,
+    0x19A4C116u, 0x1E376C08u, 0x2748774Cu, 0x34B0BCB5u, 0x391C0CB3u, 0x4ED8AA4Au, 0x5B9CCA4Fu, 0x682E6FF3u,
+    0x748F82EEu, 0x78A5636Fu, 0x84C87814u, 0x8CC70208u, 0x90BEFFFAu, 0xA4506CEBu, 0xBEF9A3F7u, 0xC67178F2u
+};
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -255,195 +840,505 @@ static  CPU_BOOLEAN   FTPs_BuildPath     (CPU_CHAR              *full_abs_path,
                                           CPU_CHAR              *rel_path,
                                           CPU_CHAR              *new_path);
 
+static  CPU_BOOLEAN   FTPs_PathMatch     (CPU_CHAR              *entry_path,
+                                          CPU_CHAR              *path);
 
+static  void          FTPs_InvalidatePath(CPU_CHAR              *path);
 
-static  void          FTPs_StartPasvMode (FTPs_SESSION_STRUCT   *ftp_session,
-                                          NET_ERR               *p_err);
+#if (FTPs_SRV_FILES_EN == DEF_ENABLED)
+static  CPU_BOOLEAN   FTPs_PathIsRsvd    (CPU_CHAR              *path);
 
-static  void          FTPs_StopPasvMode  (FTPs_SESSION_STRUCT   *ftp_session);
+static  CPU_BOOLEAN   FTPs_PathHasRsvd   (CPU_CHAR              *path);
 
+static  void          FTPs_PathFilterAdd (CPU_INT08U            *p_filter,
+                                          CPU_SIZE_T             filter_len,
+                                          CPU_CHAR              *path);
 
+static  CPU_BOOLEAN   FTPs_PathFilterChk (CPU_INT08U            *p_filter,
+                                          CPU_SIZE_T             filter_len,
+                                          CPU_CHAR              *path);
+#endif
 
-static  NET_ERR       FTPs_SendReply     (CPU_INT32S             sock_id,
-                                          CPU_INT32S             reply_nbr,
-                                          CPU_CHAR              *reply_msg);
 
-static  CPU_BOOLEAN   FTPs_Tx            (CPU_INT32S             sock_id,
-                                          CPU_CHAR              *net_buf,
-                                          CPU_INT16U             net_buf_len,
-                                          NET_ERR               *net_err);
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+static  CPU_BOOLEAN   FTPs_CacheInit     (void);
 
+static  void          FTPs_CacheInvalidate(CPU_CHAR             *path);
 
+static  FTPs_CACHE_ENTRY  *FTPs_CacheGet      (CPU_CHAR          *path,
+                                               CPU_INT32U         size,
+                                               NET_FS_DATE_TIME  *p_date_time);
 
-static  void          FTPs_ProcessCtrlCmd(FTPs_SESSION_STRUCT   *ftp_session);
+static  FTPs_CACHE_ENTRY  *FTPs_CacheFillStart(CPU_CHAR          *path,
+                                               CPU_INT32U         size,
+                                               NET_FS_DATE_TIME  *p_date_time);
 
-static  void          FTPs_ProcessDtpCmd (FTPs_SESSION_STRUCT   *ftp_session);
+static  void               FTPs_CacheFillEnd  (FTPs_CACHE_ENTRY  *p_entry,
+                                               CPU_SIZE_T         fill_len,
+                                               CPU_BOOLEAN        fill_ok);
+#endif
 
-static  void          FTPs_DtpTask       (void                  *p_arg);
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+static  void             FTPs_PinInit      (void);
 
+static  void             FTPs_PinInvalidate(CPU_CHAR        *path);
 
-/*
-*********************************************************************************************************
-*                                     LOCAL CONFIGURATION ERRORS
-*********************************************************************************************************
-*/
+static  CPU_BOOLEAN      FTPs_PinLoad      (FTPs_PIN_ENTRY  *p_entry);
 
+static  FTPs_PIN_ENTRY  *FTPs_PinGet       (CPU_CHAR        *path);
 
-/*
-*********************************************************************************************************
-*                                              FTPs_Init()
-*
-* Description : FTP server initialization.
-*
-* Argument(s) : public_addr     for passive mode, you have to provide your public IP address (i.e. the
-*                               IP address use to reach you over the internet).  It may be your router's
-*                               public IP address.
-*               public_port     for passive mode, you have to provide the public port you have opened
-*                               and routed to this host to the FTPs_DTP_IPPORT port.
-*
-*               p_secure_cfg    Desired value for server secure mode :
-*
-*                                   Secure Configuration Pointer    Server operations will     be secured.
-*                                   DEF_NULL                        Server operations will NOT be secured.
-*
-* Return(s)   : DEF_OK,   FTPs successfully initialized.
-*
-*               DEF_FAIL, otherwise.
-*
-* Caller(s)   : Application code.
-*
-* Note(s)     : (1) Network security manager MUST be available & enabled to initialize the server in
-*                   secure mode.
-*
-*               (2) Secure mode will is NOT supported in active mode.
-*********************************************************************************************************
-*/
+static  void             FTPs_PinReload    (CPU_CHAR        *path);
+#endif
 
-CPU_BOOLEAN  FTPs_Init (       NET_IPv4_ADDR     public_addr,
-                               NET_PORT_NBR      public_port,
-                        const  FTPs_SECURE_CFG  *p_secure_cfg)
-{
-            CPU_BOOLEAN  rtn_val;
-            CPU_INT32U   path_len_max;
-    static  NET_SOCK_ID  ctrl_sock_id;
-            CPU_INT32U   max_path_name_len;
-            CPU_SIZE_T   heap_rem_size;
-            LIB_ERR      lib_err;
-    CPU_SR_ALLOC();
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+static  CPU_BOOLEAN           FTPs_PrefetchInit      (void);
 
+static  void                  FTPs_PrefetchInvalidate(CPU_CHAR             *path);
 
-#ifndef  NET_SECURE_MODULE_PRESENT                              /* See Note #1.                                         */
-    if (p_secure_cfg != (FTPs_SECURE_CFG *)0) {
-        FTPs_TRACE_DBG(("FTPs init failed. Security manager NOT available.\n"));
-        return (DEF_FAIL);
-    }
-#endif
+static  void                  FTPs_PrefetchDirSet    (CPU_CHAR             *dir_path);
 
-    FTPs_CtrlTasks  = 0;
-    FTPs_PublicAddr = public_addr;
-    FTPs_PublicPort = public_port;
+static  FTPs_PREFETCH_ENTRY  *FTPs_PrefetchGet       (CPU_CHAR             *path,
+                                                      CPU_CHAR             *parent_path);
 
+static  void                  FTPs_PrefetchRelease   (void);
 
-    path_len_max = NetFS_CfgPathGetLenMax();
+static  void                 *FTPs_PrefetchFileOpen  (FTPs_PREFETCH_ENTRY  *p_entry);
 
-    if (FTPs_CFG_FS_PATH_LEN_MAX > path_len_max) {
-        FTPs_TRACE_DBG(("FTPs init failed. FTPs_CFG_FS_PATH_LEN_MAX is larger than the File System allows.\n"));
-        return (DEF_FAIL);
-    }
+static  CPU_BOOLEAN           FTPs_PrefetchNextGet   (CPU_CHAR             *dir_path,
+                                                      CPU_CHAR             *prev_path,
+                                                      CPU_CHAR             *next_path);
 
-    FTPs_FS_SepChar = NetFS_CfgPathGetSepChar();
+static  void                  FTPs_PrefetchFill      (CPU_CHAR             *path);
+#endif
 
-    max_path_name_len = NetFS_CfgPathGetLenMax();
+static  void         *FTPs_FileOpenRd    (CPU_CHAR              *path);
 
-    heap_rem_size = Mem_HeapGetSizeRem(sizeof(CPU_CHAR),
-                                      &lib_err);
+static  void          FTPs_FileCloseRd   (void                  *p_file);
 
-    if ((heap_rem_size  > max_path_name_len) &&
-        (lib_err       == LIB_MEM_ERR_NONE)) {
-        FTPs_FullAbsPathPtr = (CPU_CHAR *)Mem_HeapAlloc(max_path_name_len + 1,
-                                                        sizeof(CPU_CHAR),
-                                                        0,
-                                                       &lib_err);
+static  void          FTPs_HandleClose   (CPU_CHAR              *path);
 
-        if (lib_err != LIB_MEM_ERR_NONE) {
-            FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
-            return (DEF_FAIL);
-        }
+static  void          FTPs_HandleCloseAll(void);
 
-    } else {
-        FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
-        return (DEF_FAIL);
-    }
+static  CPU_SIZE_T    FTPs_NbrFmt        (CPU_CHAR              *p_dst,
+                                          CPU_INT32U             nbr,
+                                          CPU_SIZE_T             width);
 
-    heap_rem_size = Mem_HeapGetSizeRem(sizeof(CPU_CHAR),
-                                      &lib_err);
+static  CPU_INT32U    FTPs_ListLineFmt   (CPU_CHAR              *p_buf,
+                                          CPU_SIZE_T             buf_len,
+                                          NET_FS_ENTRY          *p_entry);
 
-    if ((heap_rem_size  > max_path_name_len) &&
-        (lib_err       == LIB_MEM_ERR_NONE)) {
-        FTPs_FullRelPathPtr = (CPU_CHAR *)Mem_HeapAlloc(max_path_name_len + 1,
-                                                        sizeof(CPU_CHAR),
-                                                        0,
-                                                       &lib_err);
+static  CPU_INT32U    FTPs_MlsxFmt       (CPU_CHAR              *p_buf,
+                                          CPU_SIZE_T             buf_len,
+                                          NET_FS_ENTRY          *p_entry,
+                                          CPU_CHAR              *p_name,
+                                          CPU_CHAR              *p_eol);
 
-        if (lib_err != LIB_MEM_ERR_NONE) {
-            FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
-            return (DEF_FAIL);
-        }
+#if (FTPs_CFG_LIST_GLOB_EN == DEF_ENABLED)
+static  CPU_BOOLEAN   FTPs_GlobIsPattern (CPU_CHAR              *p_name);
 
-    } else {
-        FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
-        return (DEF_FAIL);
-    }
+static  CPU_BOOLEAN   FTPs_GlobCompile   (FTPs_GLOB             *p_glob,
+                                          CPU_CHAR              *p_pattern);
 
-    heap_rem_size = Mem_HeapGetSizeRem(sizeof(CPU_CHAR),
-                                      &lib_err);
+static  CPU_BOOLEAN   FTPs_GlobMatch     (FTPs_GLOB             *p_glob,
+                                          CPU_CHAR              *p_name);
+#endif
 
-    if ((heap_rem_size  > max_path_name_len) &&
-        (lib_err       == LIB_MEM_ERR_NONE)) {
-        FTPs_ParentAbsPathPtr = (CPU_CHAR *)Mem_HeapAlloc(max_path_name_len + 1,
-                                                          sizeof(CPU_CHAR),
-                                                          0,
-                                                         &lib_err);
+#if (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+static  void          FTPs_ListWalkStart (CPU_CHAR              *path);
 
-        if (lib_err != LIB_MEM_ERR_NONE) {
-            FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
-            return (DEF_FAIL);
-        }
+static  void         *FTPs_ListWalkNext  (void);
 
-    } else {
-        FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
-        return (DEF_FAIL);
-    }
+static  CPU_CHAR     *FTPs_ListWalkRelGet(void);
 
-    heap_rem_size = Mem_HeapGetSizeRem(sizeof(CPU_CHAR),
-                                      &lib_err);
+static  CPU_CHAR     *FTPs_ListWalkNameGet(CPU_CHAR             *p_name);
 
-    if ((heap_rem_size  > max_path_name_len) &&
-        (lib_err       == LIB_MEM_ERR_NONE)) {
-        FTPs_CurEntryPtr = (CPU_CHAR *)Mem_HeapAlloc(max_path_name_len + 1,
-                                                     sizeof(CPU_CHAR),
-                                                     0,
-                                                    &lib_err);
+static  void          FTPs_ListWalkEnd   (void);
+#endif
 
-        if (lib_err != LIB_MEM_ERR_NONE) {
-            FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
-            return (DEF_FAIL);
-        }
+#if (FTPs_CFG_TAR_EN == DEF_ENABLED)
+static  CPU_BOOLEAN   FTPs_TarStart      (CPU_CHAR              *path);
 
-    } else {
-        FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
+static  CPU_BOOLEAN   FTPs_TarTx         (CPU_INT32S             sock_id,
+                                          CPU_CHAR              *p_buf,
+                                          CPU_INT32U             offset,
+                                          NET_ERR               *p_err);
+
+static  CPU_BOOLEAN   FTPs_TarEntryTx    (FTPs_TAR              *p_tar,
+                                          NET_ERR               *p_err);
+
+static  CPU_BOOLEAN   FTPs_TarHdrFmt     (FTPs_TAR              *p_tar,
+                                          CPU_INT32U             size);
+
+static  void          FTPs_TarOctFmt     (CPU_INT08U            *p_field,
+                                          CPU_SIZE_T             len,
+                                          CPU_INT32U             val);
+
+static  CPU_INT32U    FTPs_TarTimeGet    (NET_FS_DATE_TIME      *p_time);
+
+static  CPU_BOOLEAN   FTPs_TarWr         (FTPs_TAR              *p_tar,
+                                          CPU_INT08U            *p_data,
+                                          CPU_INT32U             len,
+                                          NET_ERR               *p_err);
+
+static  CPU_BOOLEAN   FTPs_TarFlush      (FTPs_TAR              *p_tar,
+                                          NET_ERR               *p_err);
+#endif
+
+#if (FTPs_CFG_TAR_EXTRACT_EN == DEF_ENABLED)
+static  CPU_BOOLEAN   FTPs_TarRx         (CPU_INT32S             sock_id,
+                                          CPU_CHAR              *p_buf,
+                                          NET_ERR               *p_err);
+
+static  CPU_BOOLEAN   FTPs_TarRxData     (FTPs_TAR              *p_tar,
+                                          CPU_INT08U            *p_data,
+                                          CPU_SIZE_T             len);
+
+static  CPU_BOOLEAN   FTPs_TarHdrRx      (FTPs_TAR              *p_tar);
+
+static  CPU_SIZE_T    FTPs_TarPathGet    (FTPs_TAR              *p_tar);
+
+static  CPU_BOOLEAN   FTPs_TarDirMk      (FTPs_TAR              *p_tar,
+                                          CPU_SIZE_T             path_len);
+
+static  CPU_BOOLEAN   FTPs_TarOctParse   (CPU_INT08U            *p_field,
+                                          CPU_SIZE_T             len,
+                                          CPU_INT32U            *p_val);
+#endif
+
+#if (FTPs_CFG_DELTA_EN == DEF_ENABLED)
+static  CPU_BOOLEAN   FTPs_DeltaStart    (CPU_CHAR              *path,
+                                          CPU_CHAR              *p_ext,
+                                          CPU_SIZE_T             ext_len);
+
+static  CPU_BOOLEAN   FTPs_DeltaSigTx    (CPU_INT32S             sock_id,
+                                          CPU_CHAR              *p_buf,
+                                          NET_ERR               *p_err);
+
+static  CPU_BOOLEAN   FTPs_DeltaRx       (CPU_INT32S             sock_id,
+                                          CPU_CHAR              *p_buf,
+                                          NET_ERR               *p_err);
+
+static  CPU_BOOLEAN   FTPs_DeltaRxData   (FTPs_DELTA            *p_delta,
+                                          CPU_INT08U            *p_data,
+                                          CPU_SIZE_T             len);
+
+static  CPU_BOOLEAN   FTPs_DeltaOpExec   (FTPs_DELTA            *p_delta);
+
+static  CPU_BOOLEAN   FTPs_DeltaCopy     (FTPs_DELTA            *p_delta,
+                                          CPU_INT32U             pos,
+                                          CPU_INT32U             len);
+
+static  CPU_INT32U    FTPs_DeltaWeakGet  (CPU_INT08U            *p_data,
+                                          CPU_SIZE_T             len);
+#endif
+
+#if (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+static  void          FTPs_DedupIdxAdd   (CPU_CHAR              *path,
+                                          CPU_INT08U            *p_digest);
+
+static  CPU_INT08U    FTPs_DedupIdxFind  (CPU_CHAR              *path,
+                                          CPU_INT08U            *p_digest,
+                                          CPU_SIZE_T             base_len);
+
+static  void          FTPs_DedupInvalidate(CPU_CHAR             *path);
+
+static  CPU_BOOLEAN   FTPs_DedupDigestParse(CPU_CHAR            *p_str,
+                                          CPU_INT08U            *p_digest);
+#endif
+
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+static  FTPs_SEGS    *FTPs_SegsGet       (CPU_CHAR              *path);
+
+static  CPU_BOOLEAN   FTPs_SegsStart     (CPU_CHAR              *path,
+                                          CPU_INT32U             offset,
+                                          CPU_INT32U             len);
+
+static  CPU_INT08U    FTPs_SegsRx        (CPU_INT32S             sock_id,
+                                          CPU_CHAR              *p_buf,
+                                          CPU_INT32U             offset,
+                                          CPU_INT32U             len,
+                                          NET_ERR               *p_err);
+
+static  void          FTPs_SegsRangeAdd  (FTPs_SEGS             *p_segs,
+                                          CPU_INT32U             start,
+                                          CPU_INT32U             end);
+
+static  CPU_BOOLEAN   FTPs_SegsCommit    (FTPs_SEGS             *p_segs);
+
+static  CPU_BOOLEAN   FTPs_SegsCancel    (CPU_CHAR              *path);
+#endif
+
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+static  CPU_BOOLEAN   FTPs_ResumeGet     (CPU_CHAR              *path,
+                                          CPU_INT32U             file_size);
+
+static  void          FTPs_ResumeRecWr   (void);
+
+static  void          FTPs_ResumeInvalidate(CPU_CHAR            *path);
+
+static  FTPs_SHA256  *FTPs_ResumeStart   (FTPs_SESSION_STRUCT   *ftp_session);
+
+static  void         *FTPs_ResumeSync    (CPU_CHAR              *path,
+                                          void                  *p_file,
+                                          CPU_SIZE_T             len);
+
+static  void          FTPs_ResumeEnd     (CPU_BOOLEAN            done);
+#endif
+
+#if (FTPs_CFG_TAIL_EN == DEF_ENABLED)
+static  CPU_BOOLEAN   FTPs_TailStart     (CPU_CHAR              *path);
+
+static  void          FTPs_TailStop      (void);
+
+static  CPU_BOOLEAN   FTPs_TailTx        (FTPs_SESSION_STRUCT   *ftp_session,
+                                          void                  *p_file,
+                                          NET_ERR               *p_err);
+#endif
+
+#if (FTPs_CFG_RATE_EN == DEF_ENABLED)
+static  void          FTPs_RateReset     (void);
+
+static  void          FTPs_RateUse       (FTPs_RATE_BUCKET      *p_bucket,
+                                          CPU_INT32U             rate,
+                                          CPU_INT32U             len,
+                                          NET_TS_MS              ts_now);
+
+static  void          FTPs_RatePace      (CPU_INT32S             sock_id,
+                                          CPU_INT32U             len);
+
+static  void          FTPs_RateTmrCallback(void                 *p_arg);
+#endif
+
+#if (FTPs_SHA256_EN == DEF_ENABLED)
+static  void          FTPs_Sha256Init    (FTPs_SHA256           *p_sha);
+
+static  void          FTPs_Sha256Upd     (FTPs_SHA256           *p_sha,
+                                          CPU_INT08U            *p_data,
+                                          CPU_SIZE_T             len);
+
+static  void          FTPs_Sha256Final   (FTPs_SHA256           *p_sha,
+                                          CPU_INT08U            *p_digest);
+
+static  void          FTPs_Sha256Blk     (FTPs_SHA256           *p_sha);
+#endif
+
+static  CPU_BOOLEAN   FTPs_EntryStat     (CPU_CHAR              *path,
+                                          NET_FS_ENTRY          *p_entry);
+
+#if (FTPs_REPLACE_EN == DEF_ENABLED)
+static  CPU_BOOLEAN   FTPs_FileReplace   (CPU_CHAR              *path,
+                                          CPU_CHAR              *tmp_path);
+#endif
+
+#if (FTPs_CFG_META_CACHE_EN == DEF_ENABLED)
+static  void          FTPs_MetaInit      (void);
+
+static  void          FTPs_MetaInvalidate(CPU_CHAR              *path);
+
+static  CPU_BOOLEAN   FTPs_MetaGet       (CPU_CHAR              *path,
+                                          NET_FS_ENTRY          *p_entry);
+
+static  void          FTPs_MetaPut       (CPU_CHAR              *path,
+                                          NET_FS_ENTRY          *p_entry);
+#endif
+
+#if (FTPs_CFG_NEG_CACHE_EN == DEF_ENABLED)
+static  CPU_SIZE_T    FTPs_NegNameOffsetGet(CPU_CHAR            *path);
+
+static  void          FTPs_NegInvalidate (CPU_CHAR              *path);
+
+static  CPU_BOOLEAN   FTPs_NegGet        (CPU_CHAR              *path);
+
+static  void          FTPs_NegPut        (CPU_CHAR              *path);
+#endif
+
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+static  CPU_BOOLEAN        FTPs_ListInit      (void);
+
+static  void               FTPs_ListInvalidate(CPU_CHAR          *path);
+
+static  FTPs_LIST_ENTRY   *FTPs_ListGet       (CPU_CHAR          *path,
+                                               CPU_INT08U         cmd);
+
+static  FTPs_LIST_ENTRY   *FTPs_ListFillStart (CPU_CHAR          *path,
+                                               CPU_INT08U         cmd);
+
+static  FTPs_LIST_ENTRY   *FTPs_ListFillAdd   (FTPs_LIST_ENTRY   *p_entry,
+                                               CPU_CHAR          *p_data,
+                                               CPU_SIZE_T         len);
+
+static  void               FTPs_ListFillEnd   (FTPs_LIST_ENTRY   *p_entry,
+                                               CPU_BOOLEAN        fill_ok);
+
+static  CPU_BOOLEAN        FTPs_ListTx        (CPU_INT32S         sock_id,
+                                               FTPs_LIST_ENTRY   *p_entry,
+                                               NET_ERR           *p_err);
+#endif
+
+
+static  void          FTPs_StartPasvMode (FTPs_SESSION_STRUCT   *ftp_session,
+                                          NET_ERR               *p_err);
+
+static  void          FTPs_StopPasvMode  (FTPs_SESSION_STRUCT   *ftp_session);
+
+
+
+static  NET_ERR       FTPs_SendReply     (CPU_INT32S             sock_id,
+                                          CPU_INT32S             reply_nbr,
+                                          CPU_CHAR              *reply_msg);
+
+static  CPU_INT16S    FTPs_Rx            (CPU_INT32S             sock_id,
+                                          CPU_CHAR              *net_buf,
+                                          CPU_INT16U             net_buf_len,
+                                          NET_ERR               *net_err);
+
+static  CPU_BOOLEAN   FTPs_AbortChk      (CPU_INT32S             sock_id);
+
+static  void          FTPs_TelnetStrip   (CPU_CHAR              *p_buf);
+
+static  CPU_BOOLEAN   FTPs_Tx            (CPU_INT32S             sock_id,
+                                          CPU_CHAR              *net_buf,
+                                          CPU_INT16U             net_buf_len,
+                                          NET_ERR               *net_err);
+
+static  void          FTPs_ReplyMultiStart(FTPs_REPLY_MULTI     *p_reply,
+                                          CPU_INT32S             sock_id,
+                                          CPU_INT32S             reply_nbr,
+                                          CPU_CHAR              *p_line);
+
+static  void          FTPs_ReplyMultiAdd (FTPs_REPLY_MULTI      *p_reply,
+                                          CPU_CHAR              *p_line);
+
+static  void          FTPs_ReplyMultiEnd (FTPs_REPLY_MULTI      *p_reply,
+                                          CPU_INT32S             reply_nbr,
+                                          CPU_CHAR              *p_line);
+
+static  void          FTPs_ReplyMultiTx  (FTPs_REPLY_MULTI      *p_reply);
+
+
+
+static  void          FTPs_ProcessCtrlCmd(FTPs_SESSION_STRUCT   *ftp_session);
+
+static  CPU_INT08U    FTPs_SiteCmdGet    (CPU_CHAR              *p_name);
+
+static  void          FTPs_ProcessSiteCmd(FTPs_SESSION_STRUCT   *ftp_session,
+                                          CPU_INT08U             site_cmd);
+
+static  void          FTPs_SiteRmTree    (FTPs_SESSION_STRUCT   *ftp_session);
+
+static  void          FTPs_SiteMkDirs    (FTPs_SESSION_STRUCT   *ftp_session);
+
+static  CPU_SIZE_T    FTPs_SiteBaseLenGet(void);
+
+#if (FTPs_CFG_SITE_COPY_EN == DEF_ENABLED)
+static  void          FTPs_SiteCpFr      (FTPs_SESSION_STRUCT   *ftp_session);
+
+static  void          FTPs_SiteCpTo      (FTPs_SESSION_STRUCT   *ftp_session);
+#endif
+
+#if (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+static  void          FTPs_SiteDedup     (FTPs_SESSION_STRUCT   *ftp_session);
+#endif
+
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+static  void          FTPs_SiteSegs      (FTPs_SESSION_STRUCT   *ftp_session);
+#endif
+
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+static  void          FTPs_SiteResume    (FTPs_SESSION_STRUCT   *ftp_session);
+#endif
+
+static  void          FTPs_ProcessDtpCmd (FTPs_SESSION_STRUCT   *ftp_session);
+
+static  void          FTPs_DtpTask       (void                  *p_arg);
+
+
+/*
+*********************************************************************************************************
+*                                     LOCAL CONFIGURATION ERRORS
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                              FTPs_Init()
+*
+* Description : FTP server initialization.
+*
+* Argument(s) : public_addr     for passive mode, you have to provide your public IP address (i.e. the
+*                               IP address use to reach you over the internet).  It may be your router's
+*                               public IP address.
+*               public_port     for passive mode, you have to provide the public port you have opened
+*                               and routed to this host to the FTPs_DTP_IPPORT port.
+*
+*               p_secure_cfg    Desired value for server secure mode :
+*
+*                                   Secure Configuration Pointer    Server operations will     be secured.
+*                                   DEF_NULL                        Server operations will NOT be secured.
+*
+* Return(s)   : DEF_OK,   FTPs successfully initialized.
+*
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : Application code.
+*
+* Note(s)     : (1) Network security manager MUST be available & enabled to initialize the server in
+*                   secure mode.
+*
+*               (2) Secure mode will is NOT supported in active mode.
+*********************************************************************************************************
+*/
+
+CPU_BOOLEAN  FTPs_Init (       NET_IPv4_ADDR     public_addr,
+                               NET_PORT_NBR      public_port,
+                        const  FTPs_SECURE_CFG  *p_secure_cfg)
+{
+            CPU_BOOLEAN  rtn_val;
+            CPU_INT32U   path_len_max;
+    static  NET_SOCK_ID  ctrl_sock_id;
+            CPU_INT32U   max_path_name_len;
+            CPU_SIZE_T   heap_rem_size;
+            LIB_ERR      lib_err;
+#if ((FTPs_CFG_TAIL_EN == DEF_ENABLED) || \
+     (FTPs_CFG_RATE_EN == DEF_ENABLED))
+            KAL_ERR      kal_err;
+#endif
+    CPU_SR_ALLOC();
+
+
+#ifndef  NET_SECURE_MODULE_PRESENT                              /* See Note #1.                                         */
+    if (p_secure_cfg != (FTPs_SECURE_CFG *)0) {
+        FTPs_TRACE_DBG(("FTPs init failed. Security manager NOT available.\n"));
         return (DEF_FAIL);
     }
+#endif
+
+    FTPs_CtrlTasks  = 0;
+    FTPs_PublicAddr = public_addr;
+    FTPs_PublicPort = public_port;
+
+
+    path_len_max = NetFS_CfgPathGetLenMax();
+
+    if (FTPs_CFG_FS_PATH_LEN_MAX > path_len_max) {
+        FTPs_TRACE_DBG(("FTPs init failed. FTPs_CFG_FS_PATH_LEN_MAX is larger than the File System allows.\n"));
+        return (DEF_FAIL);
+    }
+
+    FTPs_FS_SepChar = NetFS_CfgPathGetSepChar();
+
+    max_path_name_len = NetFS_CfgPathGetLenMax();
 
     heap_rem_size = Mem_HeapGetSizeRem(sizeof(CPU_CHAR),
                                       &lib_err);
 
     if ((heap_rem_size  > max_path_name_len) &&
         (lib_err       == LIB_MEM_ERR_NONE)) {
-        FTPs_RenAbsPathPtr = (CPU_CHAR *)Mem_HeapAlloc(max_path_name_len + 1,
-                                                       sizeof(CPU_CHAR),
-                                                       0,
-                                                      &lib_err);
+        FTPs_FullAbsPathPtr = (CPU_CHAR *)Mem_HeapAlloc(max_path_name_len + 1,
+                                                        sizeof(CPU_CHAR),
+                                                        0,
+                                                       &lib_err);
 
         if (lib_err != LIB_MEM_ERR_NONE) {
             FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
@@ -460,10 +1355,10 @@ CPU_BOOLEAN  FTPs_Init (       NET_IPv4_ADDR     public_addr,
 
     if ((heap_rem_size  > max_path_name_len) &&
         (lib_err       == LIB_MEM_ERR_NONE)) {
-        FTPs_RenRelPathPtr = (CPU_CHAR *)Mem_HeapAlloc(max_path_name_len + 1,
-                                                       sizeof(CPU_CHAR),
-                                                       0,
-                                                      &lib_err);
+        FTPs_FullRelPathPtr = (CPU_CHAR *)Mem_HeapAlloc(max_path_name_len + 1,
+                                                        sizeof(CPU_CHAR),
+                                                        0,
+                                                       &lib_err);
 
         if (lib_err != LIB_MEM_ERR_NONE) {
             FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
@@ -478,12 +1373,12 @@ CPU_BOOLEAN  FTPs_Init (       NET_IPv4_ADDR     public_addr,
     heap_rem_size = Mem_HeapGetSizeRem(sizeof(CPU_CHAR),
                                       &lib_err);
 
-    if ((heap_rem_size >= FTPs_NET_BUF_LEN) &&
+    if ((heap_rem_size  > max_path_name_len) &&
         (lib_err       == LIB_MEM_ERR_NONE)) {
-        FTPs_NetBufCtrlCmdPtr = (CPU_CHAR *)Mem_HeapAlloc(FTPs_NET_BUF_LEN,
-                                                   sizeof(CPU_CHAR),
-                                                   0,
-                                                  &lib_err);
+        FTPs_ParentAbsPathPtr = (CPU_CHAR *)Mem_HeapAlloc(max_path_name_len + 1,
+                                                          sizeof(CPU_CHAR),
+                                                          0,
+                                                         &lib_err);
 
         if (lib_err != LIB_MEM_ERR_NONE) {
             FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
@@ -498,12 +1393,12 @@ CPU_BOOLEAN  FTPs_Init (       NET_IPv4_ADDR     public_addr,
     heap_rem_size = Mem_HeapGetSizeRem(sizeof(CPU_CHAR),
                                       &lib_err);
 
-    if ((heap_rem_size >= FTPs_NET_BUF_LEN) &&
+    if ((heap_rem_size  > max_path_name_len) &&
         (lib_err       == LIB_MEM_ERR_NONE)) {
-        FTPs_NetBufCtrlTaskPtr = (CPU_CHAR *)Mem_HeapAlloc(FTPs_NET_BUF_LEN,
-                                                       sizeof(CPU_CHAR),
-                                                       0,
-                                                      &lib_err);
+        FTPs_CurEntryPtr = (CPU_CHAR *)Mem_HeapAlloc(max_path_name_len + 1,
+                                                     sizeof(CPU_CHAR),
+                                                     0,
+                                                    &lib_err);
 
         if (lib_err != LIB_MEM_ERR_NONE) {
             FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
@@ -518,12 +1413,12 @@ CPU_BOOLEAN  FTPs_Init (       NET_IPv4_ADDR     public_addr,
     heap_rem_size = Mem_HeapGetSizeRem(sizeof(CPU_CHAR),
                                       &lib_err);
 
-    if ((heap_rem_size >= FTPs_NET_BUF_LEN) &&
+    if ((heap_rem_size  > max_path_name_len) &&
         (lib_err       == LIB_MEM_ERR_NONE)) {
-        FTPs_NetBufDtpCmdPtr = (CPU_CHAR *)Mem_HeapAlloc(FTPs_NET_BUF_LEN,
-                                                         sizeof(CPU_CHAR),
-                                                         0,
-                                                        &lib_err);
+        FTPs_RenAbsPathPtr = (CPU_CHAR *)Mem_HeapAlloc(max_path_name_len + 1,
+                                                       sizeof(CPU_CHAR),
+                                                       0,
+                                                      &lib_err);
 
         if (lib_err != LIB_MEM_ERR_NONE) {
             FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
@@ -538,7 +1433,87 @@ CPU_BOOLEAN  FTPs_Init (       NET_IPv4_ADDR     public_addr,
     heap_rem_size = Mem_HeapGetSizeRem(sizeof(CPU_CHAR),
                                       &lib_err);
 
-    if ((heap_rem_size >= FTPs_NET_BUF_LEN) &&
+    if ((heap_rem_size  > max_path_name_len) &&
+        (lib_err       == LIB_MEM_ERR_NONE)) {
+        FTPs_RenRelPathPtr = (CPU_CHAR *)Mem_HeapAlloc(max_path_name_len + 1,
+                                                       sizeof(CPU_CHAR),
+                                                       0,
+                                                      &lib_err);
+
+        if (lib_err != LIB_MEM_ERR_NONE) {
+            FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
+            return (DEF_FAIL);
+        }
+
+    } else {
+        FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
+        return (DEF_FAIL);
+    }
+
+    heap_rem_size = Mem_HeapGetSizeRem(sizeof(CPU_CHAR),
+                                      &lib_err);
+
+    if ((heap_rem_size >= FTPs_NET_BUF_LEN) &&
+        (lib_err       == LIB_MEM_ERR_NONE)) {
+        FTPs_NetBufCtrlCmdPtr = (CPU_CHAR *)Mem_HeapAlloc(FTPs_NET_BUF_LEN,
+                                                   sizeof(CPU_CHAR),
+                                                   0,
+                                                  &lib_err);
+
+        if (lib_err != LIB_MEM_ERR_NONE) {
+            FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
+            return (DEF_FAIL);
+        }
+
+    } else {
+        FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
+        return (DEF_FAIL);
+    }
+
+    heap_rem_size = Mem_HeapGetSizeRem(sizeof(CPU_CHAR),
+                                      &lib_err);
+
+    if ((heap_rem_size >= FTPs_NET_BUF_LEN) &&
+        (lib_err       == LIB_MEM_ERR_NONE)) {
+        FTPs_NetBufCtrlTaskPtr = (CPU_CHAR *)Mem_HeapAlloc(FTPs_NET_BUF_LEN,
+                                                       sizeof(CPU_CHAR),
+                                                       0,
+                                                      &lib_err);
+
+        if (lib_err != LIB_MEM_ERR_NONE) {
+            FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
+            return (DEF_FAIL);
+        }
+
+    } else {
+        FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
+        return (DEF_FAIL);
+    }
+
+    heap_rem_size = Mem_HeapGetSizeRem(sizeof(CPU_CHAR),
+                                      &lib_err);
+
+    if ((heap_rem_size >= FTPs_NET_BUF_LEN) &&
+        (lib_err       == LIB_MEM_ERR_NONE)) {
+        FTPs_NetBufDtpCmdPtr = (CPU_CHAR *)Mem_HeapAlloc(FTPs_NET_BUF_LEN,
+                                                         sizeof(CPU_CHAR),
+                                                         0,
+                                                        &lib_err);
+
+        if (lib_err != LIB_MEM_ERR_NONE) {
+            FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
+            return (DEF_FAIL);
+        }
+
+    } else {
+        FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient.\n"));
+        return (DEF_FAIL);
+    }
+
+    heap_rem_size = Mem_HeapGetSizeRem(sizeof(CPU_CHAR),
+                                      &lib_err);
+
+    if ((heap_rem_size >= FTPs_NET_BUF_LEN) &&
         (lib_err       == LIB_MEM_ERR_NONE)) {
         FTPs_NetBufSendReplyPtr = (CPU_CHAR *)Mem_HeapAlloc(FTPs_NET_BUF_LEN,
                                                             sizeof(CPU_CHAR),
@@ -555,6 +1530,104 @@ CPU_BOOLEAN  FTPs_Init (       NET_IPv4_ADDR     public_addr,
         return (DEF_FAIL);
     }
 
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+    rtn_val = FTPs_CacheInit();
+    if (rtn_val != DEF_OK) {
+        FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient for content cache.\n"));
+        return (DEF_FAIL);
+    }
+#endif
+
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+    FTPs_PinInit();
+#endif
+
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+    rtn_val = FTPs_PrefetchInit();
+    if (rtn_val != DEF_OK) {
+        FTPs_TRACE_DBG(("FTPs init failed. Prefetcher initialization failed.\n"));
+        return (DEF_FAIL);
+    }
+#endif
+
+#if (FTPs_CFG_META_CACHE_EN == DEF_ENABLED)
+    FTPs_MetaInit();
+#endif
+
+#if (FTPs_CFG_NEG_CACHE_EN == DEF_ENABLED)
+    FTPs_NegSeqCtr = 0u;
+    Mem_Clr(&FTPs_NegTbl[0], sizeof(FTPs_NegTbl));
+#endif
+
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+    rtn_val = FTPs_ListInit();
+    if (rtn_val != DEF_OK) {
+        FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient for listing cache.\n"));
+        return (DEF_FAIL);
+    }
+#endif
+
+#if (FTPs_CFG_SITE_COPY_EN == DEF_ENABLED)
+    FTPs_SiteCopyBufPtr = (CPU_INT08U *)Mem_HeapAlloc(FTPs_CFG_SITE_COPY_BUF_SIZE,
+                                                      sizeof(CPU_ALIGN),
+                                                      0,
+                                                     &lib_err);
+    if (lib_err != LIB_MEM_ERR_NONE) {
+        FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient for copy buffer.\n"));
+        return (DEF_FAIL);
+    }
+#endif
+
+#if (FTPs_CFG_DELTA_EN == DEF_ENABLED)
+    FTPs_DeltaBufPtr = (CPU_INT08U *)Mem_HeapAlloc(FTPs_CFG_DELTA_BLK_SIZE,
+                                                   sizeof(CPU_ALIGN),
+                                                   0,
+                                                  &lib_err);
+    if (lib_err != LIB_MEM_ERR_NONE) {
+        FTPs_TRACE_DBG(("FTPs init failed. Memory heap size insufficient for delta buffer.\n"));
+        return (DEF_FAIL);
+    }
+#endif
+
+#if (FTPs_CFG_TAIL_EN == DEF_ENABLED)
+    FTPs_Tail.En = DEF_NO;
+    FTPs_TailSem = KAL_SemCreate((const CPU_CHAR *)"FTPs Tail Sem",
+                                                    DEF_NULL,
+                                                   &kal_err);
+    if (kal_err != KAL_ERR_NONE) {
+        FTPs_TRACE_DBG(("FTPs init failed. Tail-follow semaphore not created.\n"));
+        return (DEF_FAIL);
+    }
+    FTPs_TailLock = KAL_LockCreate((const CPU_CHAR *)"FTPs Tail Lock",
+                                                      DEF_NULL,
+                                                     &kal_err);
+    if (kal_err != KAL_ERR_NONE) {
+        FTPs_TRACE_DBG(("FTPs init failed. Tail-follow lock not created.\n"));
+        return (DEF_FAIL);
+    }
+#endif
+
+#if (FTPs_CFG_RATE_EN == DEF_ENABLED)
+    FTPs_RateSem = KAL_SemCreate((const CPU_CHAR *)"FTPs Rate Sem",
+                                                    DEF_NULL,
+                                                   &kal_err);
+    if (kal_err != KAL_ERR_NONE) {
+        FTPs_TRACE_DBG(("FTPs init failed. Rate limiting semaphore not created.\n"));
+        return (DEF_FAIL);
+    }
+                                                                /* One-shot timer, started by FTPs_RatePace().          */
+    FTPs_RateTmr = KAL_TmrCreate((const CPU_CHAR *)"FTPs Rate Tmr",
+                                                   FTPs_RateTmrCallback,
+                                                   DEF_NULL,
+                                                   FTPs_CFG_RATE_TMR_MS,
+                                                   DEF_NULL,
+                                                  &kal_err);
+    if (kal_err != KAL_ERR_NONE) {
+        FTPs_TRACE_DBG(("FTPs init failed. Rate limiting timer not created.\n"));
+        return (DEF_FAIL);
+    }
+#endif
+
 
     if (p_secure_cfg != DEF_NULL) {
 #ifdef  NET_SECURE_MODULE_PRESENT                               /* See Note #1.                                         */
@@ -640,135 +1713,375 @@ void  FTPs_SetPublicAddr (NET_IPv4_ADDR   public_addr,
 
 /*
 *********************************************************************************************************
-*                                        FTPs_ServerSockInit()
+*                                         FTPs_CacheStatGet()
 *
-* Description : Initialize server socket.
+* Description : Get content cache statistics.
 *
-* Argument(s) : none.
+* Argument(s) : p_stat      Pointer to structure that will receive the statistics.
 *
-* Return(s)   : Server socket ID, if successfully initialized.
-*               NET_SOCK_ID_NONE, otherwise.
+* Return(s)   : none.
 *
-* Caller(s)   : FTPs_Init(),
-*               FTPs_ServerTask().
+* Caller(s)   : Application code.
 *
-* Note(s)     : none.
+* Note(s)     : (1) 'FTPs_CacheStat' MUST ALWAYS be accessed exclusively in critical sections.
+*
+*               (2) The hit ratio is HitCtr / (HitCtr + MissCtr).
 *********************************************************************************************************
 */
 
-static  NET_SOCK_ID  FTPs_ServerSockInit (void)
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+void  FTPs_CacheStatGet (FTPs_CACHE_STAT  *p_stat)
 {
-    NET_SOCK_ID         server_sock_id;
-    NET_SOCK_ADDR_IPv4  server_addr_ip;
-    NET_ERR             net_err;
+    CPU_SR_ALLOC();
 
 
-                                                                /* Open a socket.                                       */
-    FTPs_TRACE_INFO(("FTPs OPEN SRV socket.\n"));
-    server_sock_id = NetSock_Open(NET_SOCK_ADDR_FAMILY_IP_V4,
-                                  NET_SOCK_TYPE_STREAM,
-                                  NET_SOCK_PROTOCOL_TCP,
-                                 &net_err);
-    if (net_err != NET_SOCK_ERR_NONE) {
-        FTPs_TRACE_DBG(("FTPs NetSock_Open() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
-        NetSock_Close(server_sock_id, &net_err);
-        return (NET_SOCK_ID_NONE);
+    if (p_stat == (FTPs_CACHE_STAT *)0) {
+        return;
     }
 
-#ifdef  NET_SECURE_MODULE_PRESENT                               /* Set sock secure mode.                                */
-    if (FTPs_SecureCfgPtr != DEF_NULL) {
-       (void)NetSock_CfgSecure(server_sock_id,
-                               DEF_YES,
-                              &net_err);
-        if (net_err != NET_SOCK_ERR_NONE) {
-            FTPs_TRACE_INFO(("FTPs NetSock_Open() failed: No secure socket available.\n"));
-            NetSock_Close(server_sock_id, &net_err);
-            return (NET_SOCK_ID_NONE);
-        }
-
-       (void)NetSock_CfgSecureServerCertKeyInstall(server_sock_id,
-                                                   FTPs_SecureCfgPtr->CertPtr,
-                                                   FTPs_SecureCfgPtr->CertLen,
-                                                   FTPs_SecureCfgPtr->KeyPtr,
-                                                   FTPs_SecureCfgPtr->KeyLen,
-                                                   FTPs_SecureCfgPtr->Fmt,
-                                                   FTPs_SecureCfgPtr->CertChain,
-                                                  &net_err);
-        if (net_err != NET_SOCK_ERR_NONE) {
-            FTPs_TRACE_INFO(("FTPs NetSock_Open() failed: No secure socket available.\n"));
-            NetSock_Close(server_sock_id, &net_err);
-            return (NET_SOCK_ID_NONE);
-        }
-    }
+    CPU_CRITICAL_ENTER();
+   *p_stat = FTPs_CacheStat;
+    CPU_CRITICAL_EXIT();
+}
 #endif
 
-                                                                /* Bind a local address so the clients can send to us.  */
-    Mem_Set(&server_addr_ip, (CPU_CHAR)0, sizeof(server_addr_ip));
-    server_addr_ip.AddrFamily = NET_SOCK_ADDR_FAMILY_IP_V4;
-    server_addr_ip.Addr       = NET_UTIL_HOST_TO_NET_32(NET_IPv4_ADDR_ANY);
 
-    if (FTPs_SecureCfgPtr != DEF_NULL) {                        /* Set the port according to the secure mode cfg.       */
-        server_addr_ip.Port = NET_UTIL_HOST_TO_NET_16(FTPs_CFG_CTRL_IPPORT_SECURE);
-    } else {
-        server_addr_ip.Port = NET_UTIL_HOST_TO_NET_16(FTPs_CFG_CTRL_IPPORT);
+/*
+*********************************************************************************************************
+*                                            FTPs_PinFile()
+*
+* Description : Pin a file in RAM, so that it is served without accessing the file system.
+*
+* Argument(s) : path        FS absolute path of the file (i.e. as passed to the network FS interface).
+*
+*               size_max    Size of the memory image to allocate for the file.  It SHOULD leave room for
+*                           the future versions of the file.
+*
+* Return(s)   : DEF_OK,   file successfully pinned.
+*
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : Application code.
+*
+* Note(s)     : (1) This function MUST be called after FTPs_Init(), once for every file to pin, during the
+*                   application initialization.
+*
+*               (2) The memory image is allocated from the heap & is never freed.
+*
+*               (3) RETR, SIZE & MDTM of a pinned file are served from its memory image.  The image is re-read
+*                   when the file is overwritten through STOR or APPE.  A pinned file that does not exist yet,
+*                   or that became larger than 'size_max', is served from the file system until it fits.
+*
+*               (4) The entry is made visible to the control task only once completely initialized.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+CPU_BOOLEAN  FTPs_PinFile (CPU_CHAR    *path,
+                           CPU_SIZE_T   size_max)
+{
+    FTPs_PIN_ENTRY  *p_entry;
+    CPU_SIZE_T       path_len;
+    CPU_INT32U       i;
+    LIB_ERR          lib_err;
+    CPU_SR_ALLOC();
+
+
+    if ((path     == (CPU_CHAR *)0) ||                          /* Validate args.                                       */
+        (size_max == 0u)) {
+        return (DEF_FAIL);
     }
 
-    NetSock_Bind(                  server_sock_id,
-                 (NET_SOCK_ADDR *)&server_addr_ip,
-                                   NET_SOCK_ADDR_SIZE,
-                                  &net_err);
-    if (net_err != NET_SOCK_ERR_NONE) {
-        FTPs_TRACE_DBG(("FTPs NetSock_Bind() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
-        NetSock_Close(server_sock_id, &net_err);
-        return (NET_SOCK_ID_NONE);
+    path_len = Str_Len(path);
+    if (path_len >= FTPs_CFG_FS_PATH_LEN_MAX) {
+        return (DEF_FAIL);
     }
 
+    p_entry = (FTPs_PIN_ENTRY *)0;                              /* Find free entry.                                     */
+    for (i = 0; i < FTPs_CFG_PIN_NBR_ENTRIES; i++) {
+        if (FTPs_PinTbl[i].Used == DEF_NO) {
+            p_entry = &FTPs_PinTbl[i];
+            break;
+        }
+    }
+    if (p_entry == (FTPs_PIN_ENTRY *)0) {
+        FTPs_TRACE_DBG(("FTPs FTPs_PinFile() failed. No more pinned file entry.\n"));
+        return (DEF_FAIL);
+    }
 
-    NetSock_Listen(server_sock_id,                              /* Listen to the socket for clients.                    */
-                   FTPs_CTRL_CONN_Q_SIZE,
-                  &net_err);
-    if (net_err != NET_SOCK_ERR_NONE) {
-        FTPs_TRACE_DBG(("FTPs NetSock_Listen() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
-        NetSock_Close(server_sock_id, &net_err);
-        return (NET_SOCK_ID_NONE);
+    p_entry->DataPtr = (CPU_CHAR *)Mem_HeapAlloc(size_max,      /* See Note #2.                                         */
+                                                 sizeof(CPU_ALIGN),
+                                                 0,
+                                                &lib_err);
+    if (lib_err != LIB_MEM_ERR_NONE) {
+        FTPs_TRACE_DBG(("FTPs FTPs_PinFile() failed. Memory heap size insufficient.\n"));
+        return (DEF_FAIL);
     }
 
-    return (server_sock_id);
+    Str_Copy_N(p_entry->Path, path, FTPs_CFG_FS_PATH_LEN_MAX);
+    p_entry->DataSize = size_max;
+    p_entry->DataLen  = 0u;
+
+    (void)FTPs_PinLoad(p_entry);                                /* See Note #3.                                         */
+
+    CPU_CRITICAL_ENTER();
+    p_entry->Used = DEF_YES;                                    /* See Note #4.                                         */
+    CPU_CRITICAL_EXIT();
+
+    return (DEF_OK);
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                          FTPs_ServerTask()
+*                                        FTPs_PrefetchStatGet()
 *
-* Description : FTP server task.
+* Description : Get prefetcher statistics.
 *
-* Argument(s) : p_arg       argument passed to the task (server socket id).
+* Argument(s) : p_stat      Pointer to structure that will receive the statistics.
 *
 * Return(s)   : none.
 *
-* Caller(s)   : FTPs_OS_ServerTask().
+* Caller(s)   : Application code.
 *
-* Note(s)     : This task uses a socket already initialized.  If a connection request is received and there
-*               is currently no other active connection, the control task is started and interaction with
-*               the client begins.  If a connection request is received and there is currently an active
-*               connection, then a reply code indicating this is sent, and the client is denied access.
+* Note(s)     : (1) 'FTPs_PrefetchStat' MUST ALWAYS be accessed exclusively in critical sections.
+*
+*               (2) The hit ratio is HitCtr / (HitCtr + MissCtr).
 *********************************************************************************************************
 */
 
-void  FTPs_ServerTask (void  *p_arg)
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+void  FTPs_PrefetchStatGet (FTPs_PREFETCH_STAT  *p_stat)
 {
-    NET_SOCK_ID        *p_sock_id;
-    NET_SOCK_ID         srv_sock_id;
-    NET_SOCK_ID         ctrl_sock_id;
-    NET_SOCK_ADDR       client_addr;
-    NET_SOCK_ADDR_LEN   client_addr_len;
-    CPU_BOOLEAN         rtn_val;
-    NET_ERR             net_err;
+    CPU_SR_ALLOC();
 
 
-    p_sock_id   = (NET_SOCK_ID*)p_arg;
-    srv_sock_id = *p_sock_id;
+    if (p_stat == (FTPs_PREFETCH_STAT *)0) {
+        return;
+    }
+
+    CPU_CRITICAL_ENTER();
+   *p_stat = FTPs_PrefetchStat;
+    CPU_CRITICAL_EXIT();
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       FTPs_MetaCacheStatGet()
+*
+* Description : Get metadata cache statistics.
+*
+* Argument(s) : p_stat      Pointer to structure that will receive the statistics.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application code.
+*
+* Note(s)     : (1) 'FTPs_MetaCacheStat' MUST ALWAYS be accessed exclusively in critical sections.
+*
+*               (2) The hit ratio is HitCtr / (HitCtr + MissCtr).
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_META_CACHE_EN == DEF_ENABLED)
+void  FTPs_MetaCacheStatGet (FTPs_META_CACHE_STAT  *p_stat)
+{
+    CPU_SR_ALLOC();
+
+
+    if (p_stat == (FTPs_META_CACHE_STAT *)0) {
+        return;
+    }
+
+    CPU_CRITICAL_ENTER();
+   *p_stat = FTPs_MetaCacheStat;
+    CPU_CRITICAL_EXIT();
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_TailNotify()
+*
+* Description : Signal that octets were appended to a file, so that a RETR following it sends them.
+*
+* Argument(s) : path        FS absolute path of the file (i.e. as passed to the network FS interface).
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application code.
+*
+* Note(s)     : (1) This function MUST be called by the application task writing the file, once the appended
+*                   octets are written to the file system (e.g. after the file is flushed).
+*
+*               (2) The notification is ignored if the file is not followed.  A notification received while
+*                   the followed file is being sent is kept, so no appended octet is missed.
+*
+*               (3) The followed file is checked & signaled with FTPs_TailLock held, since the FTP task
+*                   changes it.  Paths are compared as the file system compares names.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_TAIL_EN == DEF_ENABLED)
+void  FTPs_TailNotify (CPU_CHAR  *path)
+{
+    CPU_INT16S  cmp_val;
+    KAL_ERR     kal_err;
+
+
+    if (path == (CPU_CHAR *)0) {
+        return;
+    }
+
+    KAL_LockAcquire(FTPs_TailLock, KAL_OPT_PEND_NONE, KAL_TIMEOUT_INFINITE, &kal_err);
+    if (FTPs_Tail.En == DEF_YES) {                              /* See Note #3.                                         */
+        cmp_val = FTPs_FS_NameCmp(path, FTPs_Tail.Path);
+        if (cmp_val == 0) {
+            KAL_SemPost(FTPs_TailSem, KAL_OPT_POST_NONE, &kal_err);
+        }
+    }
+    KAL_LockRelease(FTPs_TailLock, &kal_err);
+
+    (void)&kal_err;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs_ServerSockInit()
+*
+* Description : Initialize server socket.
+*
+* Argument(s) : none.
+*
+* Return(s)   : Server socket ID, if successfully initialized.
+*               NET_SOCK_ID_NONE, otherwise.
+*
+* Caller(s)   : FTPs_Init(),
+*               FTPs_ServerTask().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  NET_SOCK_ID  FTPs_ServerSockInit (void)
+{
+    NET_SOCK_ID         server_sock_id;
+    NET_SOCK_ADDR_IPv4  server_addr_ip;
+    NET_ERR             net_err;
+
+
+                                                                /* Open a socket.                                       */
+    FTPs_TRACE_INFO(("FTPs OPEN SRV socket.\n"));
+    server_sock_id = NetSock_Open(NET_SOCK_ADDR_FAMILY_IP_V4,
+                                  NET_SOCK_TYPE_STREAM,
+                                  NET_SOCK_PROTOCOL_TCP,
+                                 &net_err);
+    if (net_err != NET_SOCK_ERR_NONE) {
+        FTPs_TRACE_DBG(("FTPs NetSock_Open() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
+        NetSock_Close(server_sock_id, &net_err);
+        return (NET_SOCK_ID_NONE);
+    }
+
+#ifdef  NET_SECURE_MODULE_PRESENT                               /* Set sock secure mode.                                */
+    if (FTPs_SecureCfgPtr != DEF_NULL) {
+       (void)NetSock_CfgSecure(server_sock_id,
+                               DEF_YES,
+                              &net_err);
+        if (net_err != NET_SOCK_ERR_NONE) {
+            FTPs_TRACE_INFO(("FTPs NetSock_Open() failed: No secure socket available.\n"));
+            NetSock_Close(server_sock_id, &net_err);
+            return (NET_SOCK_ID_NONE);
+        }
+
+       (void)NetSock_CfgSecureServerCertKeyInstall(server_sock_id,
+                                                   FTPs_SecureCfgPtr->CertPtr,
+                                                   FTPs_SecureCfgPtr->CertLen,
+                                                   FTPs_SecureCfgPtr->KeyPtr,
+                                                   FTPs_SecureCfgPtr->KeyLen,
+                                                   FTPs_SecureCfgPtr->Fmt,
+                                                   FTPs_SecureCfgPtr->CertChain,
+                                                  &net_err);
+        if (net_err != NET_SOCK_ERR_NONE) {
+            FTPs_TRACE_INFO(("FTPs NetSock_Open() failed: No secure socket available.\n"));
+            NetSock_Close(server_sock_id, &net_err);
+            return (NET_SOCK_ID_NONE);
+        }
+    }
+#endif
+
+                                                                /* Bind a local address so the clients can send to us.  */
+    Mem_Set(&server_addr_ip, (CPU_CHAR)0, sizeof(server_addr_ip));
+    server_addr_ip.AddrFamily = NET_SOCK_ADDR_FAMILY_IP_V4;
+    server_addr_ip.Addr       = NET_UTIL_HOST_TO_NET_32(NET_IPv4_ADDR_ANY);
+
+    if (FTPs_SecureCfgPtr != DEF_NULL) {                        /* Set the port according to the secure mode cfg.       */
+        server_addr_ip.Port = NET_UTIL_HOST_TO_NET_16(FTPs_CFG_CTRL_IPPORT_SECURE);
+    } else {
+        server_addr_ip.Port = NET_UTIL_HOST_TO_NET_16(FTPs_CFG_CTRL_IPPORT);
+    }
+
+    NetSock_Bind(                  server_sock_id,
+                 (NET_SOCK_ADDR *)&server_addr_ip,
+                                   NET_SOCK_ADDR_SIZE,
+                                  &net_err);
+    if (net_err != NET_SOCK_ERR_NONE) {
+        FTPs_TRACE_DBG(("FTPs NetSock_Bind() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
+        NetSock_Close(server_sock_id, &net_err);
+        return (NET_SOCK_ID_NONE);
+    }
+
+
+    NetSock_Listen(server_sock_id,                              /* Listen to the socket for clients.                    */
+                   FTPs_CTRL_CONN_Q_SIZE,
+                  &net_err);
+    if (net_err != NET_SOCK_ERR_NONE) {
+        FTPs_TRACE_DBG(("FTPs NetSock_Listen() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
+        NetSock_Close(server_sock_id, &net_err);
+        return (NET_SOCK_ID_NONE);
+    }
+
+    return (server_sock_id);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_ServerTask()
+*
+* Description : FTP server task.
+*
+* Argument(s) : p_arg       argument passed to the task (server socket id).
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_OS_ServerTask().
+*
+* Note(s)     : This task uses a socket already initialized.  If a connection request is received and there
+*               is currently no other active connection, the control task is started and interaction with
+*               the client begins.  If a connection request is received and there is currently an active
+*               connection, then a reply code indicating this is sent, and the client is denied access.
+*********************************************************************************************************
+*/
+
+void  FTPs_ServerTask (void  *p_arg)
+{
+    NET_SOCK_ID        *p_sock_id;
+    NET_SOCK_ID         srv_sock_id;
+    NET_SOCK_ID         ctrl_sock_id;
+    NET_SOCK_ADDR       client_addr;
+    NET_SOCK_ADDR_LEN   client_addr_len;
+    CPU_BOOLEAN         rtn_val;
+    NET_ERR             net_err;
+
+
+    p_sock_id   = (NET_SOCK_ID*)p_arg;
+    srv_sock_id = *p_sock_id;
 
     while (DEF_TRUE) {
                                                             /* When a client make a request, accept it and create a */
@@ -903,6 +2216,14 @@ void  FTPs_CtrlTask (void  *p_arg)
     ftp_session.DtpCmd                 = FTP_CMD_NOOP;
 
     ftp_session.DtpOffset              = 0;
+    ftp_session.DtpLen                 = 0;
+    ftp_session.DtpFilePtr             = (void *)0;
+    ftp_session.DtpDirPtr              = (void *)0;
+
+#if (FTPs_CFG_RATE_EN == DEF_ENABLED)
+    ftp_session.RateLimit              = FTPs_CFG_RATE_SESSION_LIMIT;
+    FTPs_RateReset();
+#endif
 
     FTPs_SendReply(ftp_session.CtrlSockID, FTP_REPLY_SERVERREADY, (CPU_CHAR *)0);
 
@@ -963,6 +2284,7 @@ void  FTPs_CtrlTask (void  *p_arg)
         FTPs_TRACE_INFO(("FTPs RX: %s\n", FTPs_NetBufCtrlTaskPtr));
 
         p_net_buf = FTPs_NetBufCtrlTaskPtr;
+        FTPs_TelnetStrip(p_net_buf);                            /* Skip Telnet IP & Synch sent before ABOR.             */
         p_cmd     = FTPs_FindArg(&p_net_buf);
         if (*p_cmd == (CPU_CHAR)0) {
             continue;
@@ -1011,6 +2333,8 @@ void  FTPs_CtrlTask (void  *p_arg)
         }
     }
 
+    FTPs_HandleCloseAll();                                      /* Close file handles kept by the session.              */
+
     FTPs_TRACE_INFO(("FTPs CLOSE CTRL socket.\n"));
     NetSock_Close(ftp_session.CtrlSockID, &net_err);
 
@@ -1020,6 +2344,62 @@ void  FTPs_CtrlTask (void  *p_arg)
 }
 
 
+/*
+*********************************************************************************************************
+*                                         FTPs_PrefetchTask()
+*
+* Description : FTP prefetch task.
+*
+* Argument(s) : p_arg       argument passed to the task (unused).
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_OS_PrefetchTask().
+*
+* Note(s)     : (1) This task waits for the control task to signal a RETR of a file located in the last
+*                   listed directory.  It then reads, in background, the metadata & the first octets of the
+*                   next file of that directory (in directory order).
+*
+*               (2) Only the last request is served : requests signaled while a file is being prefetched are
+*                   merged.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+void  FTPs_PrefetchTask (void  *p_arg)
+{
+    static  CPU_CHAR     dir_path [FTPs_CFG_FS_PATH_LEN_MAX];
+    static  CPU_CHAR     prev_path[FTPs_CFG_FS_PATH_LEN_MAX];
+    static  CPU_CHAR     next_path[FTPs_CFG_FS_PATH_LEN_MAX];
+            CPU_BOOLEAN  found;
+            KAL_ERR      kal_err;
+
+
+    (void)&p_arg;
+
+    while (DEF_ON) {
+        KAL_SemPend(FTPs_PrefetchSem,                           /* Wait for a request (see Note #1).                    */
+                    KAL_OPT_PEND_NONE,
+                    KAL_TIMEOUT_INFINITE,
+                   &kal_err);
+        if (kal_err != KAL_ERR_NONE) {
+            continue;
+        }
+
+        KAL_LockAcquire(FTPs_PrefetchLock, KAL_OPT_PEND_NONE, KAL_TIMEOUT_INFINITE, &kal_err);
+        Str_Copy_N(dir_path,  FTPs_PrefetchDirPath, FTPs_CFG_FS_PATH_LEN_MAX);
+        Str_Copy_N(prev_path, FTPs_PrefetchReqPath, FTPs_CFG_FS_PATH_LEN_MAX);
+        KAL_LockRelease(FTPs_PrefetchLock, &kal_err);
+
+        found = FTPs_PrefetchNextGet(dir_path, prev_path, next_path);
+        if (found == DEF_YES) {
+            FTPs_PrefetchFill(next_path);
+        }
+    }
+}
+#endif
+
+
 /*
 *********************************************************************************************************
 *********************************************************************************************************
@@ -1397,310 +2777,7690 @@ static  CPU_BOOLEAN  FTPs_BuildPath (CPU_CHAR    *full_abs_path,
 
 /*
 *********************************************************************************************************
-*                                         FTPs_StartPasvMode()
+*                                           FTPs_PathMatch()
 *
-* Description : Start passive mode listening socket.
+* Description : Determine if a path is equal to, or located under, another path.
 *
-* Argument(s) : ftp_session     structure that contains FTP session states and control data.
+* Argument(s) : entry_path      FS absolute path to test.
+*               path            FS absolute path of the entry (file or directory) that was modified.
 *
-* Return(s)   : none.
+* Return(s)   : DEF_YES, if entry_path is path itself or an entry of the path directory tree.
 *
-* Caller(s)   : FTPs_Ctrl_Task().
+*               DEF_NO,  otherwise.
 *
-* Note(s)     : none.
+* Caller(s)   : FTPs_InvalidatePath(),
+*               FTPs_DedupInvalidate(),
+*               FTPs_PathHasRsvd().
+*
+* Note(s)     : (1) Since a directory may be renamed, entries located anywhere under a modified path are
+*                   considered to be modified too.
+*
+*               (2) Paths are compared as the file system compares names (see FTPs_CFG_FS_CASE_SENSITIVE),
+*                   so that a modification through a differently cased path invalidates the entry.
 *********************************************************************************************************
 */
 
-static  void  FTPs_StartPasvMode (FTPs_SESSION_STRUCT  *ftp_session,
-                                  NET_ERR              *p_err)
+static  CPU_BOOLEAN  FTPs_PathMatch (CPU_CHAR  *entry_path,
+                                     CPU_CHAR  *path)
 {
-    CPU_INT32S  pasv_sock_id;
-    NET_ERR     net_err;
+    CPU_SIZE_T  len;
+    CPU_INT16S  cmp_val;
 
 
-    if (ftp_session->DtpPasv == DEF_NO) {
-                                                                /* Open a socket.                                       */
-        FTPs_TRACE_INFO(("FTPs OPEN passive DTP socket.\n"));
-        pasv_sock_id = NetSock_Open( NET_SOCK_ADDR_FAMILY_IP_V4,
-                                     NET_SOCK_TYPE_STREAM,
-                                     NET_SOCK_PROTOCOL_TCP,
-                                     p_err);
-        if (*p_err != NET_SOCK_ERR_NONE) {
-            FTPs_TRACE_DBG(("FTPs NetSock_Open() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
-            return;
-        }
+    len     = Str_Len(path);
+    cmp_val = FTPs_FS_NameCmp_N(entry_path, path, len);         /* See Note #2.                                         */
+    if (cmp_val != 0) {
+        return (DEF_NO);
+    }
 
-#ifdef  NET_SECURE_MODULE_PRESENT                               /* Set or clear socket secure mode.                     */
-        if (FTPs_SecureCfgPtr != DEF_NULL) {
-           (void)NetSock_CfgSecure(pasv_sock_id,
-                                   DEF_YES,
-                                   p_err);
-            if (*p_err != NET_SOCK_ERR_NONE) {
-                FTPs_TRACE_DBG(("FTPs NetSock_CfgSecure() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
-                NetSock_Close(pasv_sock_id, &net_err);
-                return;
-            }
+    if ((entry_path[len] == (CPU_CHAR)0) ||                     /* Same path ...                                        */
+        (entry_path[len] == FTPs_FS_SepChar)) {                 /* ... or entry under path (see Note #1).               */
+        return (DEF_YES);
+    }
 
-           (void)NetSock_CfgSecureServerCertKeyInstall(pasv_sock_id,
-                                                       FTPs_SecureCfgPtr->CertPtr,
-                                                       FTPs_SecureCfgPtr->CertLen,
-                                                       FTPs_SecureCfgPtr->KeyPtr,
-                                                       FTPs_SecureCfgPtr->KeyLen,
-                                                       FTPs_SecureCfgPtr->Fmt,
-                                                       FTPs_SecureCfgPtr->CertChain,
-                                                       p_err);
-            if (*p_err != NET_SOCK_ERR_NONE) {
-                FTPs_TRACE_DBG(("FTPs NetSock_CfgSecureServerCertKeyInstall() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
-                NetSock_Close(pasv_sock_id, &net_err);
-                return;
-            }
-        }
-#endif
+    return (DEF_NO);
+}
 
-                                                                /* Bind a local address so the clients can send to us.  */
-        NetSock_Bind(pasv_sock_id,
-                     (NET_SOCK_ADDR *)&ftp_session->DtpSockAddr,
-                     sizeof(ftp_session->DtpSockAddr),
-                     p_err);
-        if (*p_err != NET_SOCK_ERR_NONE) {
-            NetSock_Close(pasv_sock_id, &net_err);
-            FTPs_TRACE_DBG(("FTPs NetSock_Bind() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
-            return;
-        }
 
-                                                                /* Listen to the socket for clients.                    */
-        NetSock_Listen(pasv_sock_id, FTPs_DTP_CONN_Q_SIZE, p_err);
-        if (*p_err != NET_SOCK_ERR_NONE) {
-            NetSock_Close(pasv_sock_id, &net_err);
-            FTPs_TRACE_DBG(("FTPs NetSock_Listen() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
-            return;
-        }
+/*
+*********************************************************************************************************
+*                                          FTPs_PathIsRsvd()
+*
+* Description : Determine if a path is a file of the server itself.
+*
+* Argument(s) : path        FS absolute path built from a client request.
+*
+* Return(s)   : DEF_YES, if path is the dedup index file or the resume journal file.
+*
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd(),
+*               FTPs_TarPathGet().
+*
+* Note(s)     : (1) These files SHOULD be outside of the users' base paths.  Otherwise, a client could read
+*                   or forge them : any command on these paths is refused.
+*********************************************************************************************************
+*/
 
-        ftp_session->DtpPasv       = DEF_YES;
-        ftp_session->DtpPasvSockID = pasv_sock_id;
+#if (FTPs_SRV_FILES_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_PathIsRsvd (CPU_CHAR  *path)
+{
+    CPU_INT16S  cmp_val;
 
-        *p_err = NET_ERR_NONE;
+
+#if (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+    cmp_val = FTPs_FS_NameCmp(path, (CPU_CHAR *)FTPs_CFG_DEDUP_IDX_PATH);
+    if (cmp_val == 0) {
+        return (DEF_YES);
+    }
+#endif
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+    cmp_val = FTPs_FS_NameCmp(path, (CPU_CHAR *)FTPs_CFG_RESUME_JRNL_PATH);
+    if (cmp_val == 0) {
+        return (DEF_YES);
     }
+#endif
+
+    return (DEF_NO);
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                          FTPs_StopPasvMode()
+*                                          FTPs_PathHasRsvd()
 *
-* Description : Stop passive mode listening socket.
+* Description : Determine if a directory tree holds a file of the server itself.
 *
-* Argument(s) : ftp_session     structure that contains FTP session states and control data.
+* Argument(s) : path        FS absolute path of the top directory of the tree.
 *
-* Return(s)   : none.
+* Return(s)   : DEF_YES, if the dedup index file or the resume journal file is located under path.
 *
-* Caller(s)   : FTPs_Ctrl_Task()
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : FTPs_SiteRmTree().
 *
 * Note(s)     : none.
 *********************************************************************************************************
 */
 
-static  void  FTPs_StopPasvMode (FTPs_SESSION_STRUCT  *ftp_session)
+#if (FTPs_SRV_FILES_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_PathHasRsvd (CPU_CHAR  *path)
 {
-    NET_ERR  net_err;
+    CPU_BOOLEAN  match;
 
 
-    if (ftp_session->DtpPasv == DEF_YES) {
-        FTPs_TRACE_INFO(("FTPs CLOSE passive DTP socket.\n"));
-        NetSock_Close(ftp_session->DtpPasvSockID, &net_err);
-        ftp_session->DtpPasv =  DEF_NO;
+#if (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+    match = FTPs_PathMatch((CPU_CHAR *)FTPs_CFG_DEDUP_IDX_PATH, path);
+    if (match == DEF_YES) {
+        return (DEF_YES);
+    }
+#endif
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+    match = FTPs_PathMatch((CPU_CHAR *)FTPs_CFG_RESUME_JRNL_PATH, path);
+    if (match == DEF_YES) {
+        return (DEF_YES);
     }
+#endif
+
+    return (DEF_NO);
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                           FTPs_SendReply()
+*                                         FTPs_PathFilterAdd()
 *
-* Description : Send reply message to a command.
+* Description : Add a path to a path filter.
 *
-* Argument(s) : sock_id         control socket ID.
-*               reply_nbr       reply message number.
-*               reply_msg       reply message (set to NULL to send the official message related
-*                               to reply_nbr).
+* Argument(s) : p_filter    Pointer to the filter bits.
 *
-* Return(s)   : Network error code.
+*               filter_len  Size of the filter, in octets.
 *
-* Caller(s)   : FTPs_Ctrl_Task().
+*               path        FS absolute path to add.
 *
-* Note(s)     : This function is a convenience function to build and send a reply message back to a
-*               client.  If the incoming reply_msg string is NULL, then the FTPs_Reply[] table is
-*               searched for reply code's corresponding message string.  If the reply_msg string pointer
-*               is not NULL, then it is used instead of the default reply message.
+* Return(s)   : none.
 *
-* Note(s)     : none.
+* Caller(s)   : FTPs_DedupIdxAdd(),
+*               FTPs_DedupInvalidate(),
+*               FTPs_ResumeRecWr(),
+*               FTPs_ResumeInvalidate().
+*
+* Note(s)     : (1) A path filter tells, without reading a server file, whether it may hold a record of a
+*                   path or of an entry under that path (see FTPs_PathMatch()).  The bit of the hash of
+*                   the path & the bits of the hashes of its parent paths are set.
+*
+*               (2) Bits are never cleared when a record is freed : the filter is rebuilt from the records
+*                   kept when the file is read.
+*
+*               (3) Characters are hashed as the file system compares names (see FTPs_PathMatch() Note #2).
 *********************************************************************************************************
 */
 
-static  NET_ERR  FTPs_SendReply (CPU_INT32S   sock_id,
-                                 CPU_INT32S   reply_nbr,
-                                 CPU_CHAR    *reply_msg)
+#if (FTPs_SRV_FILES_EN == DEF_ENABLED)
+static  void  FTPs_PathFilterAdd (CPU_INT08U  *p_filter,
+                                  CPU_SIZE_T   filter_len,
+                                  CPU_CHAR    *path)
 {
-    CPU_INT32S  net_buf_len;
-    NET_ERR     net_err;
+    CPU_INT32U  hash;
+    CPU_INT32U  bit;
 
 
-    if (reply_msg == (CPU_CHAR *)0) {
-        net_buf_len = Str_FmtPrint((char *)FTPs_NetBufSendReplyPtr,
-                                           FTPs_NET_BUF_LEN,
-                                   (char *)"%s\r\n",
-                                   (char *)FTPs_Reply[reply_nbr].ReplyStr);
-    } else {
-        net_buf_len = Str_FmtPrint((char *)FTPs_NetBufSendReplyPtr,
-                                           FTPs_NET_BUF_LEN,
-                                   (char *)"%s\r\n",
-                                           reply_msg);
+    hash = FTPs_PATH_HASH_INIT;
+    while (*path != (CPU_CHAR)0) {
+        if (*path == FTPs_FS_SepChar) {                         /* Parent path (see Note #1).                           */
+            bit = hash % (filter_len * DEF_OCTET_NBR_BITS);
+            DEF_BIT_SET(p_filter[bit / DEF_OCTET_NBR_BITS], DEF_BIT(bit % DEF_OCTET_NBR_BITS));
+        }
+        hash = (hash ^ (CPU_INT08U)FTPs_FS_ChFold(*path)) * FTPs_PATH_HASH_PRIME;
+        path++;
     }
+    bit = hash % (filter_len * DEF_OCTET_NBR_BITS);
+    DEF_BIT_SET(p_filter[bit / DEF_OCTET_NBR_BITS], DEF_BIT(bit % DEF_OCTET_NBR_BITS));
+}
+#endif
 
-    FTPs_TRACE_INFO(("FTPs TX: %s", FTPs_NetBufCtrlTaskPtr));
 
-    FTPs_Tx(sock_id, FTPs_NetBufSendReplyPtr, net_buf_len, &net_err);
-    if (net_err != NET_SOCK_ERR_NONE) {
-        FTPs_TRACE_DBG(("FTPs FTPs_Tx() failed: reply #%d, error #%u, line #%u.\n", reply_nbr, (unsigned int)net_err, (unsigned int)__LINE__));
+/*
+*********************************************************************************************************
+*                                         FTPs_PathFilterChk()
+*
+* Description : Determine if a path filter may hold a path or an entry under that path.
+*
+* Argument(s) : p_filter    Pointer to the filter bits.
+*
+*               filter_len  Size of the filter, in octets.
+*
+*               path        FS absolute path of the modified entry.
+*
+* Return(s)   : DEF_YES, if the path may have been added, or the path of an entry under it.
+*
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : FTPs_DedupInvalidate(),
+*               FTPs_ResumeInvalidate().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (FTPs_SRV_FILES_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_PathFilterChk (CPU_INT08U  *p_filter,
+                                         CPU_SIZE_T   filter_len,
+                                         CPU_CHAR    *path)
+{
+    CPU_INT32U   hash;
+    CPU_INT32U   bit;
+    CPU_BOOLEAN  match;
+
+
+    hash = FTPs_PATH_HASH_INIT;
+    while (*path != (CPU_CHAR)0) {
+        hash = (hash ^ (CPU_INT08U)FTPs_FS_ChFold(*path)) * FTPs_PATH_HASH_PRIME;
+        path++;
     }
-    return (net_err);
+    bit   = hash % (filter_len * DEF_OCTET_NBR_BITS);
+    match = DEF_BIT_IS_SET(p_filter[bit / DEF_OCTET_NBR_BITS], DEF_BIT(bit % DEF_OCTET_NBR_BITS));
+
+    return (match);
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                               FTPs_Tx()
+*                                        FTPs_InvalidatePath()
 *
-* Description : Transmit data to TCP socket, handling transient errors and incomplete buffer transmit.
-*
-* Argument(s) : sock_id             TCP socket ID.
-*               net_buf             buffer to send.
-*               net_buf_len         length of buffer to send.
-*               net_err             contains error message returned.
+* Description : Discard any data kept in RAM about an entry modified through the server.
 *
-* Return(s)   : DEF_OK,   data successfully transmitted.
+* Argument(s) : path        FS absolute path of the created, modified, renamed or deleted entry.
 *
-*               DEF_FAIL, otherwise.
+* Return(s)   : none.
 *
-* Caller(s)   : FTPs_SendReply(),
+* Caller(s)   : FTPs_ProcessCtrlCmd(),
 *               FTPs_ProcessDtpCmd().
 *
-* Note(s)     : none.
+* Note(s)     : (1) This function MUST be called for every path modified by the server, before a following
+*                   command can use the data kept about it.
 *********************************************************************************************************
 */
 
-static  CPU_BOOLEAN  FTPs_Tx (CPU_INT32S   sock_id,
-                              CPU_CHAR    *net_buf,
-                              CPU_INT16U   net_buf_len,
-                              NET_ERR     *net_err)
+static  void  FTPs_InvalidatePath (CPU_CHAR  *path)
 {
-    CPU_CHAR     *tx_buf;
-    CPU_INT16S    tx_buf_len;
-    CPU_INT16S    tx_len;
-    CPU_INT16S    tx_len_tot;
-    CPU_INT32U    tx_retry_cnt;
-    CPU_BOOLEAN   tx_done;
-    CPU_BOOLEAN   tx_dly;
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+    FTPs_CacheInvalidate(path);                                 /* Invalidate cached file content.                      */
+#endif
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+    FTPs_PinInvalidate(path);                                   /* Invalidate pinned file images.                       */
+#endif
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+    FTPs_PrefetchInvalidate(path);                              /* Invalidate prefetched files.                         */
+#endif
+#if (FTPs_CFG_META_CACHE_EN == DEF_ENABLED)
+    FTPs_MetaInvalidate(path);                                  /* Invalidate cached metadata.                          */
+#endif
+#if (FTPs_CFG_NEG_CACHE_EN == DEF_ENABLED)
+    FTPs_NegInvalidate(path);                                   /* Invalidate cached missing paths.                     */
+#endif
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+    FTPs_ListInvalidate(path);                                  /* Invalidate cached directory listings.                */
+#endif
+#if (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+    FTPs_DedupInvalidate(path);                                 /* Invalidate dedup index records.                      */
+#endif
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+    FTPs_ResumeInvalidate(path);                                /* Invalidate resume journal records.                   */
+#endif
 
+    (void)&path;
+}
 
-    tx_len_tot   = 0;
-    tx_retry_cnt = 0;
-    tx_done      = DEF_NO;
-    tx_dly       = DEF_NO;
 
-    while ((tx_len_tot   <  net_buf_len)               &&       /* While tx tot len < buf len ...                       */
-           (tx_retry_cnt <  FTPs_CFG_DTP_MAX_TX_RETRY) &&       /* ... & tx retry   < MAX     ...                       */
-           (tx_done      == DEF_NO)) {                          /* ... & tx NOT done;         ...                       */
+/*
+*********************************************************************************************************
+*                                           FTPs_CacheInit()
+*
+* Description : Allocate the content cache entries.
+*
+* Argument(s) : none.
+*
+* Return(s)   : DEF_OK,   cache successfully initialized.
+*
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : FTPs_Init().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
 
-        if (tx_dly == DEF_YES) {                                /* Dly tx, if req'd.                                    */
-            KAL_Dly(100u);
-        }
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_CacheInit (void)
+{
+    FTPs_CACHE_ENTRY  *p_entry;
+    CPU_INT32U         i;
+    LIB_ERR            lib_err;
 
-        tx_buf     = net_buf     + tx_len_tot;
-        tx_buf_len = net_buf_len - tx_len_tot;
-        tx_len     = NetSock_TxData(sock_id,                    /* ... tx data.                                         */
-                                    tx_buf,
-                                    tx_buf_len,
-                                    NET_SOCK_FLAG_NONE,
-                                    net_err);
-        switch (*net_err) {
-            case NET_SOCK_ERR_NONE:
-                 if (tx_len > 0) {                              /* If          tx len > 0, ...                          */
-                     tx_len_tot += tx_len;                      /* ... inc tot tx len.                                  */
-                     tx_dly      = DEF_NO;
-                 } else {                                       /* Else dly next tx.                                    */
-                     tx_dly      = DEF_YES;
-                 }
-                 tx_retry_cnt = 0;
-                 break;
 
-            case NET_SOCK_ERR_NOT_USED:
-            case NET_SOCK_ERR_INVALID_TYPE:
-            case NET_SOCK_ERR_INVALID_FAMILY:
-            case NET_SOCK_ERR_INVALID_STATE:
-                 tx_done = DEF_YES;
-                 break;
+    FTPs_CacheUseCtr = 0u;
+    Mem_Clr(&FTPs_CacheStat, sizeof(FTPs_CacheStat));
 
-            case NET_ERR_TX:                                    /* If transitory tx err, ...                            */
-            default:
-                 tx_dly = DEF_YES;                              /* ... dly next tx.                                     */
-                 tx_retry_cnt++;
-                 break;
+    for (i = 0; i < FTPs_CFG_CACHE_NBR_ENTRIES; i++) {
+        p_entry          = &FTPs_CacheTbl[i];
+        p_entry->DataPtr = (CPU_CHAR *)Mem_HeapAlloc(FTPs_CFG_CACHE_ENTRY_SIZE_MAX,
+                                                     sizeof(CPU_ALIGN),
+                                                     0,
+                                                    &lib_err);
+        if (lib_err != LIB_MEM_ERR_NONE) {
+            return (DEF_FAIL);
         }
-    }
 
-    if (*net_err != NET_SOCK_ERR_NONE) {
-        return (DEF_FAIL);
+        p_entry->Path[0] = (CPU_CHAR)0;
+        p_entry->DataLen =  0u;
+        p_entry->LastUse =  0u;
+        p_entry->Valid   =  DEF_NO;
     }
+
     return (DEF_OK);
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                         FTPs_ProcessCtrlCmd()
+*                                        FTPs_CacheInvalidate()
 *
-* Description : Core execution routines of the FTP commands.
+* Description : Invalidate the content cache entries of a modified path.
 *
-* Argument(s) : ftp_session     structure that contains FTP session states and control data.
+* Argument(s) : path        FS absolute path of the modified entry.
 *
 * Return(s)   : none.
 *
-* Caller(s)   : FTPs_Ctrl_Task().
+* Caller(s)   : FTPs_InvalidatePath().
 *
 * Note(s)     : none.
 *********************************************************************************************************
 */
 
-static  void  FTPs_ProcessCtrlCmd (FTPs_SESSION_STRUCT  *ftp_session)
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+static  void  FTPs_CacheInvalidate (CPU_CHAR  *path)
 {
-    CPU_CHAR       *p_cmd_arg;
-    CPU_CHAR       *p_file_time;
-
-    void           *p_file;
-    void           *p_dir;
-    NET_FS_ENTRY    dirent;
-    CPU_INT32U      path_name_len;
-
-    CPU_INT08U     *p_addr;
-    CPU_INT08U     *p_port;
-
-    NET_IPv4_ADDR   addr;
-    NET_PORT_NBR    port;
-
-    CPU_INT16S      cmp_val;
-    CPU_BOOLEAN     dig;
-    CPU_BOOLEAN     rtn_val;
-    CPU_INT32U      i;
-
-    NET_ERR         net_err;
-
+    FTPs_CACHE_ENTRY  *p_entry;
+    CPU_BOOLEAN        match;
+    CPU_INT32U         i;
     CPU_SR_ALLOC();
 
 
-    p_dir = (void *)0;
+    for (i = 0; i < FTPs_CFG_CACHE_NBR_ENTRIES; i++) {
+        p_entry = &FTPs_CacheTbl[i];
+        if (p_entry->Valid == DEF_YES) {
+            match = FTPs_PathMatch(p_entry->Path, path);
+            if (match == DEF_YES) {
+                p_entry->Valid = DEF_NO;
+                CPU_CRITICAL_ENTER();
+                FTPs_CacheStat.InvalidateCtr++;
+                CPU_CRITICAL_EXIT();
+            }
+        }
+    }
+}
+#endif
 
-                                                                /* Execute the command.                                 */
+
+/*
+*********************************************************************************************************
+*                                           FTPs_CacheGet()
+*
+* Description : Find a file version in the content cache.
+*
+* Argument(s) : path            FS absolute path of the file.
+*
+*               size            Current size of the file.
+*
+*               p_date_time     Pointer to the current date/time of the file.
+*
+* Return(s)   : Pointer to the cache entry, if this version of the file is cached.
+*
+*               Pointer to NULL,            otherwise.
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) Each call is accounted as a cache hit or miss.
+*
+*               (2) An entry is only shared by readers of the same file version (same size & date/time), so
+*                   that files modified outside of the server are never served stale.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+static  FTPs_CACHE_ENTRY  *FTPs_CacheGet (CPU_CHAR          *path,
+                                          CPU_INT32U         size,
+                                          NET_FS_DATE_TIME  *p_date_time)
+{
+    FTPs_CACHE_ENTRY  *p_entry;
+    CPU_INT16S         cmp_val;
+    CPU_BOOLEAN        same_ver;
+    CPU_INT32U         i;
+    CPU_SR_ALLOC();
+
+
+    for (i = 0; i < FTPs_CFG_CACHE_NBR_ENTRIES; i++) {
+        p_entry = &FTPs_CacheTbl[i];
+        if (p_entry->Valid == DEF_YES) {
+            cmp_val = FTPs_FS_NameCmp(p_entry->Path, path);
+            if (cmp_val == 0) {
+                same_ver = Mem_Cmp(&p_entry->DateTime, p_date_time, sizeof(NET_FS_DATE_TIME));
+                if ((same_ver        == DEF_YES) &&             /* See Note #2.                                         */
+                    (p_entry->DataLen == size)) {
+                    FTPs_CacheUseCtr++;
+                    p_entry->LastUse = FTPs_CacheUseCtr;
+                    CPU_CRITICAL_ENTER();
+                    FTPs_CacheStat.HitCtr++;
+                    CPU_CRITICAL_EXIT();
+                    return (p_entry);
+                }
+
+                p_entry->Valid = DEF_NO;                        /* Stale version.                                       */
+                CPU_CRITICAL_ENTER();
+                FTPs_CacheStat.InvalidateCtr++;
+                CPU_CRITICAL_EXIT();
+            }
+        }
+    }
+
+    CPU_CRITICAL_ENTER();
+    FTPs_CacheStat.MissCtr++;
+    CPU_CRITICAL_EXIT();
+
+    return ((FTPs_CACHE_ENTRY *)0);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs_CacheFillStart()
+*
+* Description : Reserve a content cache entry to be filled while a file is being sent.
+*
+* Argument(s) : path            FS absolute path of the file.
+*
+*               size            Size of the file.
+*
+*               p_date_time     Pointer to the date/time of the file.
+*
+* Return(s)   : Pointer to the reserved cache entry, if the file can be cached.
+*
+*               Pointer to NULL,                     otherwise.
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) Empty files, files larger than FTPs_CFG_CACHE_ENTRY_SIZE_MAX & files whose path does NOT
+*                   fit the entry path buffer are not cached.
+*
+*               (2) A free entry is used, if any.  Otherwise, the least recently used entry is evicted.
+*
+*               (3) The caller reads the file directly in the entry buffer (DataPtr) & sends it from there,
+*                   so that the file is read from the file system only once for the current transfer & all
+*                   the following ones.  The entry is NOT valid until FTPs_CacheFillEnd() is called.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+static  FTPs_CACHE_ENTRY  *FTPs_CacheFillStart (CPU_CHAR          *path,
+                                                CPU_INT32U         size,
+                                                NET_FS_DATE_TIME  *p_date_time)
+{
+    FTPs_CACHE_ENTRY  *p_entry;
+    FTPs_CACHE_ENTRY  *p_victim;
+    CPU_SIZE_T         path_len;
+    CPU_INT32U         i;
+    CPU_SR_ALLOC();
+
+
+    path_len = Str_Len(path);
+    if ((size     == 0u)                            ||          /* See Note #1.                                         */
+        (size     >  FTPs_CFG_CACHE_ENTRY_SIZE_MAX) ||
+        (path_len >= FTPs_CFG_FS_PATH_LEN_MAX)) {
+        return ((FTPs_CACHE_ENTRY *)0);
+    }
+
+    p_victim = &FTPs_CacheTbl[0];                               /* Find entry to use (see Note #2).                     */
+    for (i = 0; i < FTPs_CFG_CACHE_NBR_ENTRIES; i++) {
+        p_entry = &FTPs_CacheTbl[i];
+        if (p_entry->Valid == DEF_NO) {
+            p_victim = p_entry;
+            break;
+        }
+        if (p_entry->LastUse < p_victim->LastUse) {
+            p_victim = p_entry;
+        }
+    }
+
+    if (p_victim->Valid == DEF_YES) {
+        p_victim->Valid = DEF_NO;
+        CPU_CRITICAL_ENTER();
+        FTPs_CacheStat.EvictCtr++;
+        CPU_CRITICAL_EXIT();
+    }
+
+    Str_Copy_N(p_victim->Path, path, FTPs_CFG_FS_PATH_LEN_MAX);
+    p_victim->DateTime = *p_date_time;
+    p_victim->DataLen  =  size;
+
+    return (p_victim);                                          /* See Note #3.                                         */
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_CacheFillEnd()
+*
+* Description : Complete the fill of a content cache entry.
+*
+* Argument(s) : p_entry     Pointer to the entry returned by FTPs_CacheFillStart().
+*
+*               fill_len    Number of octets read in the entry buffer.
+*
+*               fill_ok     DEF_YES, if the whole file was read without error.
+*
+*                           DEF_NO,  otherwise.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) An incomplete fill (aborted transfer, read error or file modified while being read) is
+*                   discarded & the entry is released.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+static  void  FTPs_CacheFillEnd (FTPs_CACHE_ENTRY  *p_entry,
+                                 CPU_SIZE_T         fill_len,
+                                 CPU_BOOLEAN        fill_ok)
+{
+    if ((fill_ok  == DEF_YES) &&                                /* See Note #1.                                         */
+        (fill_len == p_entry->DataLen)) {
+        FTPs_CacheUseCtr++;
+        p_entry->LastUse = FTPs_CacheUseCtr;
+        p_entry->Valid   = DEF_YES;
+    } else {
+        p_entry->Valid   = DEF_NO;
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            FTPs_PinInit()
+*
+* Description : Initialize the pinned files table.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_Init().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+static  void  FTPs_PinInit (void)
+{
+    FTPs_PIN_ENTRY  *p_entry;
+    CPU_INT32U       i;
+
+
+    for (i = 0; i < FTPs_CFG_PIN_NBR_ENTRIES; i++) {
+        p_entry           = &FTPs_PinTbl[i];
+        p_entry->Path[0]  = (CPU_CHAR)0;
+        p_entry->DataPtr  = (CPU_CHAR *)0;
+        p_entry->DataSize =  0u;
+        p_entry->DataLen  =  0u;
+        p_entry->Used     =  DEF_NO;
+        p_entry->Valid    =  DEF_NO;
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs_PinInvalidate()
+*
+* Description : Invalidate the memory image of the pinned files under a modified path.
+*
+* Argument(s) : path        FS absolute path of the modified entry.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_InvalidatePath().
+*
+* Note(s)     : (1) Invalidated images are re-read by FTPs_PinGet() or FTPs_PinReload().
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+static  void  FTPs_PinInvalidate (CPU_CHAR  *path)
+{
+    FTPs_PIN_ENTRY  *p_entry;
+    CPU_BOOLEAN      match;
+    CPU_INT32U       i;
+
+
+    for (i = 0; i < FTPs_CFG_PIN_NBR_ENTRIES; i++) {
+        p_entry = &FTPs_PinTbl[i];
+        if (p_entry->Used == DEF_YES) {
+            match = FTPs_PathMatch(p_entry->Path, path);
+            if (match == DEF_YES) {
+                p_entry->Valid = DEF_NO;
+            }
+        }
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            FTPs_PinLoad()
+*
+* Description : Read a pinned file in its memory image.
+*
+* Argument(s) : p_entry     Pointer to the pinned file entry.
+*
+* Return(s)   : DEF_OK,   memory image successfully loaded.
+*
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : FTPs_PinFile(),
+*               FTPs_PinGet(),
+*               FTPs_PinReload().
+*
+* Note(s)     : (1) A file larger than the memory image is left to the file system.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_PinLoad (FTPs_PIN_ENTRY  *p_entry)
+{
+    void          *p_file;
+    CPU_INT32U     file_size;
+    CPU_SIZE_T     rd_len;
+    CPU_SIZE_T     rd_len_ttl;
+    CPU_BOOLEAN    fs_err;
+
+
+    p_entry->Valid = DEF_NO;
+
+    p_file = NetFS_FileOpen(p_entry->Path,
+                            NET_FS_FILE_MODE_OPEN,
+                            NET_FS_FILE_ACCESS_RD);
+    if (p_file == (void *)0) {
+        return (DEF_FAIL);
+    }
+
+    fs_err = NetFS_FileSizeGet(p_file, &file_size);
+    if ((fs_err    != DEF_OK) ||
+        (file_size >  p_entry->DataSize)) {                     /* See Note #1.                                         */
+        NetFS_FileClose(p_file);
+        return (DEF_FAIL);
+    }
+
+    fs_err = NetFS_FileDateTimeCreateGet(p_file, &p_entry->DateTime);
+    if (fs_err != DEF_OK) {
+        NetFS_FileClose(p_file);
+        return (DEF_FAIL);
+    }
+
+    rd_len_ttl = 0u;
+    while (rd_len_ttl < file_size) {
+        rd_len = 0u;
+        fs_err = NetFS_FileRd((void       *) p_file,
+                              (void       *)(p_entry->DataPtr + rd_len_ttl),
+                              (CPU_SIZE_T  )(file_size - rd_len_ttl),
+                              (CPU_SIZE_T *)&rd_len);
+        if ((fs_err != DEF_OK) ||
+            (rd_len == 0u)) {
+            break;
+        }
+        rd_len_ttl += rd_len;
+    }
+    NetFS_FileClose(p_file);
+
+    if (rd_len_ttl != file_size) {
+        FTPs_TRACE_DBG(("FTPs NetFS_FileRd() failed: line #%u.\n", (unsigned int)__LINE__));
+        return (DEF_FAIL);
+    }
+
+    p_entry->DataLen = file_size;
+    p_entry->Valid   = DEF_YES;
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                             FTPs_PinGet()
+*
+* Description : Find the memory image of a pinned file.
+*
+* Argument(s) : path        FS absolute path of the file.
+*
+* Return(s)   : Pointer to the pinned file entry, if the file is pinned & its image is valid.
+*
+*               Pointer to NULL,                  otherwise.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd(),
+*               FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) An image invalidated by a modification other than STOR or APPE (e.g. RNTO) is re-read
+*                   on first use.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+static  FTPs_PIN_ENTRY  *FTPs_PinGet (CPU_CHAR  *path)
+{
+    FTPs_PIN_ENTRY  *p_entry;
+    CPU_INT16S       cmp_val;
+    CPU_BOOLEAN      ok;
+    CPU_INT32U       i;
+
+
+    for (i = 0; i < FTPs_CFG_PIN_NBR_ENTRIES; i++) {
+        p_entry = &FTPs_PinTbl[i];
+        if (p_entry->Used == DEF_YES) {
+            cmp_val = FTPs_FS_NameCmp(p_entry->Path, path);
+            if (cmp_val == 0) {
+                if (p_entry->Valid == DEF_YES) {
+                    return (p_entry);
+                }
+
+                ok = FTPs_PinLoad(p_entry);                     /* See Note #1.                                         */
+                if (ok == DEF_OK) {
+                    return (p_entry);
+                }
+                return ((FTPs_PIN_ENTRY *)0);
+            }
+        }
+    }
+
+    return ((FTPs_PIN_ENTRY *)0);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_PinReload()
+*
+* Description : Re-read the memory image of a pinned file after it was overwritten.
+*
+* Argument(s) : path        FS absolute path of the overwritten file.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ProcessDtpCmd(),
+*               FTPs_SiteCpTo(),
+*               FTPs_TarRxData(),
+*               FTPs_DeltaRx().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+static  void  FTPs_PinReload (CPU_CHAR  *path)
+{
+    FTPs_PIN_ENTRY  *p_entry;
+    CPU_INT16S       cmp_val;
+    CPU_INT32U       i;
+
+
+    for (i = 0; i < FTPs_CFG_PIN_NBR_ENTRIES; i++) {
+        p_entry = &FTPs_PinTbl[i];
+        if (p_entry->Used == DEF_YES) {
+            cmp_val = FTPs_FS_NameCmp(p_entry->Path, path);
+            if (cmp_val == 0) {
+                (void)FTPs_PinLoad(p_entry);
+            }
+        }
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs_PrefetchInit()
+*
+* Description : Initialize the prefetcher & create the prefetch task.
+*
+* Argument(s) : none.
+*
+* Return(s)   : DEF_OK,   prefetcher successfully initialized.
+*
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : FTPs_Init().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_PrefetchInit (void)
+{
+    FTPs_PREFETCH_ENTRY  *p_entry;
+    CPU_BOOLEAN           rtn_val;
+    CPU_INT32U            i;
+    LIB_ERR               lib_err;
+    KAL_ERR               kal_err;
+
+
+    FTPs_PrefetchCurPtr     = (FTPs_PREFETCH_ENTRY *)0;
+    FTPs_PrefetchDirPath[0] = (CPU_CHAR)0;
+    FTPs_PrefetchReqPath[0] = (CPU_CHAR)0;
+    FTPs_PrefetchGen        =  0u;
+    Mem_Clr(&FTPs_PrefetchStat, sizeof(FTPs_PrefetchStat));
+
+    for (i = 0; i < FTPs_PREFETCH_NBR_ENTRIES; i++) {
+        p_entry          = &FTPs_PrefetchTbl[i];
+        p_entry->DataPtr = (CPU_CHAR *)Mem_HeapAlloc(FTPs_CFG_PREFETCH_BUF_SIZE,
+                                                     sizeof(CPU_ALIGN),
+                                                     0,
+                                                    &lib_err);
+        if (lib_err != LIB_MEM_ERR_NONE) {
+            return (DEF_FAIL);
+        }
+
+        p_entry->Path[0] = (CPU_CHAR)0;
+        p_entry->DataLen =  0u;
+        p_entry->Size    =  0u;
+        p_entry->Valid   =  DEF_NO;
+        p_entry->InUse   =  DEF_NO;
+    }
+
+    FTPs_PrefetchLock = KAL_LockCreate((const CPU_CHAR *)"FTPs Prefetch Lock",
+                                                          DEF_NULL,
+                                                         &kal_err);
+    if (kal_err != KAL_ERR_NONE) {
+        return (DEF_FAIL);
+    }
+
+    FTPs_PrefetchSem = KAL_SemCreate((const CPU_CHAR *)"FTPs Prefetch Sem",
+                                                        DEF_NULL,
+                                                       &kal_err);
+    if (kal_err != KAL_ERR_NONE) {
+        return (DEF_FAIL);
+    }
+
+    rtn_val = FTPs_OS_PrefetchTaskInit((void *)0);
+
+    return (rtn_val);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                      FTPs_PrefetchInvalidate()
+*
+* Description : Discard the prefetched files under a modified path.
+*
+* Argument(s) : path        FS absolute path of the modified entry.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_InvalidatePath().
+*
+* Note(s)     : (1) The generation counter lets the prefetch task detect that a file was modified while it
+*                   was being read, so that the result is discarded.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+static  void  FTPs_PrefetchInvalidate (CPU_CHAR  *path)
+{
+    FTPs_PREFETCH_ENTRY  *p_entry;
+    CPU_BOOLEAN           match;
+    CPU_INT32U            i;
+    KAL_ERR               kal_err;
+
+
+    KAL_LockAcquire(FTPs_PrefetchLock, KAL_OPT_PEND_NONE, KAL_TIMEOUT_INFINITE, &kal_err);
+    FTPs_PrefetchGen++;                                         /* See Note #1.                                         */
+    for (i = 0; i < FTPs_PREFETCH_NBR_ENTRIES; i++) {
+        p_entry = &FTPs_PrefetchTbl[i];
+        if ((p_entry->Valid == DEF_YES) &&
+            (p_entry->InUse == DEF_NO)) {
+            match = FTPs_PathMatch(p_entry->Path, path);
+            if (match == DEF_YES) {
+                p_entry->Valid = DEF_NO;
+            }
+        }
+    }
+    KAL_LockRelease(FTPs_PrefetchLock, &kal_err);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs_PrefetchDirSet()
+*
+* Description : Remember the last directory listed by the client.
+*
+* Argument(s) : dir_path    FS absolute path of the listed directory.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd().
+*
+* Note(s)     : (1) A directory whose path does NOT fit FTPs_PrefetchDirPath is forgotten, rather than
+*                   truncated, so that RETR in it are never taken as sequential.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+static  void  FTPs_PrefetchDirSet (CPU_CHAR  *dir_path)
+{
+    CPU_SIZE_T  path_len;
+    KAL_ERR     kal_err;
+
+
+    path_len = Str_Len(dir_path);
+
+    KAL_LockAcquire(FTPs_PrefetchLock, KAL_OPT_PEND_NONE, KAL_TIMEOUT_INFINITE, &kal_err);
+    if (path_len < FTPs_CFG_FS_PATH_LEN_MAX) {
+        Str_Copy_N(FTPs_PrefetchDirPath, dir_path, FTPs_CFG_FS_PATH_LEN_MAX);
+    } else {
+        FTPs_PrefetchDirPath[0] = (CPU_CHAR)0;                  /* See Note #1.                                         */
+    }
+    KAL_LockRelease(FTPs_PrefetchLock, &kal_err);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_PrefetchGet()
+*
+* Description : (1) Handle a RETR for the prefetcher :
+*
+*                   (a) Find the prefetched entry of the file, if any
+*                   (b) Signal the prefetch task to warm the next file, if the file is located in the last
+*                       listed directory
+*
+*
+* Argument(s) : path            FS absolute path of the retrieved file.
+*
+*               parent_path     FS absolute path of its parent directory.
+*
+* Return(s)   : Pointer to the prefetched entry, if the file was prefetched.
+*
+*               Pointer to NULL,                otherwise.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd().
+*
+* Note(s)     : (2) The returned entry is reserved for the current RETR until FTPs_PrefetchRelease() is
+*                   called.
+*
+*               (3) Only RETR of files located in the last listed directory are accounted as hits or misses.
+*
+*               (4) A file whose path does NOT fit FTPs_PrefetchReqPath is neither accounted nor used to
+*                   prefetch the next file.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+static  FTPs_PREFETCH_ENTRY  *FTPs_PrefetchGet (CPU_CHAR  *path,
+                                                CPU_CHAR  *parent_path)
+{
+    FTPs_PREFETCH_ENTRY  *p_entry;
+    FTPs_PREFETCH_ENTRY  *p_found;
+    CPU_SIZE_T            path_len;
+    CPU_INT16S            cmp_val;
+    CPU_BOOLEAN           seq;
+    CPU_INT32U            i;
+    KAL_ERR               kal_err;
+    CPU_SR_ALLOC();
+
+
+    FTPs_PrefetchRelease();                                     /* Release entry of previous RETR, if any.              */
+
+    KAL_LockAcquire(FTPs_PrefetchLock, KAL_OPT_PEND_NONE, KAL_TIMEOUT_INFINITE, &kal_err);
+
+    p_found = (FTPs_PREFETCH_ENTRY *)0;                         /* Find prefetched entry (see Note #1a).                */
+    for (i = 0; i < FTPs_PREFETCH_NBR_ENTRIES; i++) {
+        p_entry = &FTPs_PrefetchTbl[i];
+        if (p_entry->Valid == DEF_YES) {
+            cmp_val = FTPs_FS_NameCmp(p_entry->Path, path);
+            if (cmp_val == 0) {
+                p_entry->InUse = DEF_YES;                       /* See Note #2.                                         */
+                p_found        = p_entry;
+            }
+        }
+    }
+    FTPs_PrefetchCurPtr = p_found;
+
+    path_len = Str_Len(path);
+    cmp_val  = FTPs_FS_NameCmp(FTPs_PrefetchDirPath, parent_path);
+    seq      = ((cmp_val  == 0) &&                              /* Sequential access (see Note #1b) ...                 */
+                (path_len <  FTPs_CFG_FS_PATH_LEN_MAX)) ? DEF_YES : DEF_NO;
+    if (seq == DEF_YES) {                                       /* ... of a file path that fits (see Note #4).          */
+        Str_Copy_N(FTPs_PrefetchReqPath, path, FTPs_CFG_FS_PATH_LEN_MAX);
+    }
+
+    KAL_LockRelease(FTPs_PrefetchLock, &kal_err);
+
+    if (seq == DEF_YES) {
+        CPU_CRITICAL_ENTER();                                   /* See Note #3.                                         */
+        if (p_found != (FTPs_PREFETCH_ENTRY *)0) {
+            FTPs_PrefetchStat.HitCtr++;
+        } else {
+            FTPs_PrefetchStat.MissCtr++;
+        }
+        CPU_CRITICAL_EXIT();
+
+        KAL_SemPost(FTPs_PrefetchSem, KAL_OPT_POST_NONE, &kal_err);
+    }
+
+    return (p_found);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs_PrefetchRelease()
+*
+* Description : Release the prefetched entry reserved by the current RETR.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_PrefetchGet(),
+*               FTPs_ProcessCtrlCmd().
+*
+* Note(s)     : (1) A released entry has been sent : it is discarded so that its buffer can be reused.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+static  void  FTPs_PrefetchRelease (void)
+{
+    KAL_ERR  kal_err;
+
+
+    if (FTPs_PrefetchCurPtr == (FTPs_PREFETCH_ENTRY *)0) {
+        return;
+    }
+
+    KAL_LockAcquire(FTPs_PrefetchLock, KAL_OPT_PEND_NONE, KAL_TIMEOUT_INFINITE, &kal_err);
+    FTPs_PrefetchCurPtr->InUse = DEF_NO;
+    FTPs_PrefetchCurPtr->Valid = DEF_NO;                        /* See Note #1.                                         */
+    FTPs_PrefetchCurPtr        = (FTPs_PREFETCH_ENTRY *)0;
+    KAL_LockRelease(FTPs_PrefetchLock, &kal_err);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       FTPs_PrefetchFileOpen()
+*
+* Description : Open a prefetched file to read the octets following the prefetched ones.
+*
+* Argument(s) : p_entry     Pointer to the prefetched entry.
+*
+* Return(s)   : Pointer to the file, positioned right after the prefetched octets, if successful.
+*
+*               Pointer to NULL,                                                    otherwise.
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) The file MUST still be the version that was prefetched.  Otherwise, the octets already
+*                   sent would not match the remaining ones.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+static  void  *FTPs_PrefetchFileOpen (FTPs_PREFETCH_ENTRY  *p_entry)
+{
+    void              *p_file;
+    CPU_INT32U         file_size;
+    NET_FS_DATE_TIME   file_date_time;
+    CPU_BOOLEAN        same_ver;
+    CPU_BOOLEAN        fs_err;
+
+
+    p_file = NetFS_FileOpen(p_entry->Path,
+                            NET_FS_FILE_MODE_OPEN,
+                            NET_FS_FILE_ACCESS_RD);
+    if (p_file == (void *)0) {
+        return ((void *)0);
+    }
+
+    fs_err = NetFS_FileSizeGet(p_file, &file_size);             /* See Note #1.                                         */
+    if (fs_err == DEF_OK) {
+        fs_err = NetFS_FileDateTimeCreateGet(p_file, &file_date_time);
+    }
+    if (fs_err == DEF_OK) {
+        same_ver = Mem_Cmp(&file_date_time, &p_entry->DateTime, sizeof(NET_FS_DATE_TIME));
+        if ((same_ver  == DEF_NO) ||
+            (file_size != p_entry->Size)) {
+            fs_err = DEF_FAIL;
+        }
+    }
+    if (fs_err == DEF_OK) {
+        fs_err = NetFS_FilePosSet(p_file, p_entry->DataLen, NET_FS_SEEK_ORIGIN_START);
+    }
+
+    if (fs_err != DEF_OK) {
+        NetFS_FileClose(p_file);
+        return ((void *)0);
+    }
+
+    return (p_file);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs_PrefetchNextGet()
+*
+* Description : Find the file following another one in a directory.
+*
+* Argument(s) : dir_path    FS absolute path of the directory.
+*
+*               prev_path   FS absolute path of the current file.
+*
+*               next_path   String that will receive the FS absolute path of the next file.
+*
+* Return(s)   : DEF_YES, if a next file was found.
+*
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : FTPs_PrefetchTask().
+*
+* Note(s)     : (1) Files are taken in directory order, which is the order of LIST/NLST.  Directories are
+*                   skipped.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_PrefetchNextGet (CPU_CHAR  *dir_path,
+                                           CPU_CHAR  *prev_path,
+                                           CPU_CHAR  *next_path)
+{
+    static  CPU_CHAR       dirent_name[FTPs_CFG_FS_NAME_LEN_MAX];
+            NET_FS_ENTRY   dirent;
+            void          *p_dir;
+            CPU_CHAR      *p_prev_name;
+            CPU_SIZE_T     dir_len;
+            CPU_SIZE_T     name_len;
+            CPU_INT16S     cmp_val;
+            CPU_BOOLEAN    prev_found;
+            CPU_BOOLEAN    next_found;
+            CPU_BOOLEAN    fs_err;
+
+
+    p_prev_name = Str_Char_Last(prev_path, FTPs_FS_SepChar);
+    if (p_prev_name == (CPU_CHAR *)0) {
+        return (DEF_NO);
+    }
+    p_prev_name++;
+
+    p_dir = NetFS_DirOpen(dir_path);
+    if (p_dir == (void *)0) {
+        return (DEF_NO);
+    }
+
+    dirent.NamePtr = &dirent_name[0];
+    prev_found     =  DEF_NO;
+    next_found     =  DEF_NO;
+    fs_err         =  NetFS_DirRd(p_dir, &dirent);
+    while (fs_err == DEF_OK) {                                  /* See Note #1.                                         */
+        if (prev_found == DEF_YES) {
+            if (DEF_BIT_IS_CLR(dirent.Attrib, NET_FS_ENTRY_ATTRIB_DIR) == DEF_YES) {
+                next_found = DEF_YES;
+                break;
+            }
+        } else {
+            cmp_val = FTPs_FS_NameCmp(dirent.NamePtr, p_prev_name);
+            if (cmp_val == 0) {
+                prev_found = DEF_YES;
+            }
+        }
+        fs_err = NetFS_DirRd(p_dir, &dirent);
+    }
+    NetFS_DirClose(p_dir);
+
+    if (next_found == DEF_NO) {
+        return (DEF_NO);
+    }
+
+    dir_len  = Str_Len(dir_path);                               /* Build next file path.                                */
+    name_len = Str_Len(dirent.NamePtr);
+    if (dir_len + name_len + 2u > FTPs_CFG_FS_PATH_LEN_MAX) {
+        return (DEF_NO);
+    }
+
+    Str_Copy(next_path, dir_path);
+    if ((dir_len                 == 0u) ||
+        (next_path[dir_len - 1u] != FTPs_FS_SepChar)) {
+        next_path[dir_len]      = FTPs_FS_SepChar;
+        next_path[dir_len + 1u] = (CPU_CHAR)0;
+    }
+    Str_Cat(next_path, dirent.NamePtr);
+
+    return (DEF_YES);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs_PrefetchFill()
+*
+* Description : Read the metadata & the first octets of a file in a free prefetch entry.
+*
+* Argument(s) : path        FS absolute path of the file to prefetch.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_PrefetchTask().
+*
+* Note(s)     : (1) The entry is reserved (valid, but with an empty path) while the file is read, so that the
+*                   control task never uses it.  The file system is accessed with the lock released.
+*
+*               (2) The result is discarded if any entry was invalidated while the file was read.
+*
+*               (3) An unused prefetched file replaced by another one is accounted as discarded.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+static  void  FTPs_PrefetchFill (CPU_CHAR  *path)
+{
+    FTPs_PREFETCH_ENTRY  *p_entry;
+    FTPs_PREFETCH_ENTRY  *p_free;
+    void                 *p_file;
+    CPU_INT32U            gen;
+    CPU_INT32U            file_size;
+    CPU_SIZE_T            rd_len;
+    CPU_SIZE_T            rd_len_ttl;
+    CPU_INT16S            cmp_val;
+    CPU_BOOLEAN           discard;
+    CPU_BOOLEAN           fs_err;
+    CPU_INT32U            i;
+    KAL_ERR               kal_err;
+    CPU_SR_ALLOC();
+
+
+    KAL_LockAcquire(FTPs_PrefetchLock, KAL_OPT_PEND_NONE, KAL_TIMEOUT_INFINITE, &kal_err);
+    p_free  = (FTPs_PREFETCH_ENTRY *)0;
+    discard =  DEF_NO;
+    for (i = 0; i < FTPs_PREFETCH_NBR_ENTRIES; i++) {
+        p_entry = &FTPs_PrefetchTbl[i];
+        if (p_entry->Valid == DEF_YES) {
+            cmp_val = FTPs_FS_NameCmp(p_entry->Path, path);
+            if (cmp_val == 0) {                                 /* Already prefetched.                                  */
+                KAL_LockRelease(FTPs_PrefetchLock, &kal_err);
+                return;
+            }
+        }
+        if (p_entry->InUse == DEF_NO) {
+            if ((p_free         == (FTPs_PREFETCH_ENTRY *)0) ||
+                (p_free->Valid  == DEF_YES)) {
+                p_free = p_entry;
+            }
+        }
+    }
+    if (p_free == (FTPs_PREFETCH_ENTRY *)0) {
+        KAL_LockRelease(FTPs_PrefetchLock, &kal_err);
+        return;
+    }
+    if (p_free->Valid == DEF_YES) {
+        discard = DEF_YES;
+    }
+    p_free->Path[0] = (CPU_CHAR)0;                              /* Reserve entry (see Note #1).                         */
+    p_free->Valid   =  DEF_YES;
+    gen             =  FTPs_PrefetchGen;
+    KAL_LockRelease(FTPs_PrefetchLock, &kal_err);
+
+    if (discard == DEF_YES) {
+        CPU_CRITICAL_ENTER();                                   /* See Note #3.                                         */
+        FTPs_PrefetchStat.DiscardCtr++;
+        CPU_CRITICAL_EXIT();
+    }
+
+    rd_len_ttl = 0u;
+    p_file     = NetFS_FileOpen(path,
+                                NET_FS_FILE_MODE_OPEN,
+                                NET_FS_FILE_ACCESS_RD);
+    if (p_file != (void *)0) {
+        fs_err = NetFS_FileSizeGet(p_file, &file_size);
+        if (fs_err == DEF_OK) {
+            fs_err = NetFS_FileDateTimeCreateGet(p_file, &p_free->DateTime);
+        }
+        while ((fs_err     == DEF_OK) &&
+               (rd_len_ttl <  file_size) &&
+               (rd_len_ttl <  FTPs_CFG_PREFETCH_BUF_SIZE)) {
+            rd_len = 0u;
+            fs_err = NetFS_FileRd((void       *) p_file,
+                                  (void       *)(p_free->DataPtr + rd_len_ttl),
+                                  (CPU_SIZE_T  )(FTPs_CFG_PREFETCH_BUF_SIZE - rd_len_ttl),
+                                  (CPU_SIZE_T *)&rd_len);
+            if (rd_len == 0u) {
+                break;
+            }
+            rd_len_ttl += rd_len;
+        }
+        NetFS_FileClose(p_file);
+    } else {
+        fs_err = DEF_FAIL;
+    }
+
+    KAL_LockAcquire(FTPs_PrefetchLock, KAL_OPT_PEND_NONE, KAL_TIMEOUT_INFINITE, &kal_err);
+    if ((fs_err           == DEF_OK) &&
+        (gen              == FTPs_PrefetchGen) &&               /* See Note #2.                                         */
+        ((rd_len_ttl      == file_size) ||
+         (rd_len_ttl      == FTPs_CFG_PREFETCH_BUF_SIZE))) {
+        Str_Copy_N(p_free->Path, path, FTPs_CFG_FS_PATH_LEN_MAX);
+        p_free->DataLen = rd_len_ttl;
+        p_free->Size    = file_size;
+        CPU_CRITICAL_ENTER();
+        FTPs_PrefetchStat.PrefetchCtr++;
+        CPU_CRITICAL_EXIT();
+    } else {
+        p_free->Valid   = DEF_NO;
+    }
+    KAL_LockRelease(FTPs_PrefetchLock, &kal_err);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_FileOpenRd()
+*
+* Description : Open a file for reading, reusing a handle kept open by the session if possible.
+*
+* Argument(s) : path        FS absolute path of the file.
+*
+* Return(s)   : Pointer to the file, positioned at the beginning of the file, if successful.
+*
+*               Pointer to NULL,                                               otherwise.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd(),
+*               FTPs_ProcessDtpCmd(),
+*               FTPs_SiteCpTo(),
+*               FTPs_DeltaSigTx().
+*
+* Note(s)     : (1) When the handle cache is enabled, a newly opened handle replaces the least recently used
+*                   one, which is closed.
+*
+*               (2) A file opened by this function MUST be closed with FTPs_FileCloseRd().
+*
+*               (3) The handle of a file whose path doesn't fit a handle entry is not kept : a truncated path
+*                   could match another file.
+*********************************************************************************************************
+*/
+
+static  void  *FTPs_FileOpenRd (CPU_CHAR  *path)
+{
+#if (FTPs_CFG_HANDLE_CACHE_EN == DEF_ENABLED)
+    FTPs_HANDLE_ENTRY  *p_entry;
+    FTPs_HANDLE_ENTRY  *p_victim;
+    CPU_SIZE_T          path_len;
+    CPU_INT16S          cmp_val;
+    CPU_BOOLEAN         fs_err;
+    CPU_INT32U          i;
+#endif
+    void               *p_file;
+
+
+#if (FTPs_CFG_HANDLE_CACHE_EN == DEF_ENABLED)
+    path_len = Str_Len(path);
+    if (path_len >= FTPs_CFG_FS_PATH_LEN_MAX) {                 /* See Note #3.                                         */
+        p_file = NetFS_FileOpen(path,
+                                NET_FS_FILE_MODE_OPEN,
+                                NET_FS_FILE_ACCESS_RD);
+        return (p_file);
+    }
+
+    FTPs_HandleUseCtr++;
+
+    p_victim = &FTPs_HandleTbl[0];
+    for (i = 0; i < FTPs_CFG_HANDLE_CACHE_NBR_ENTRIES; i++) {
+        p_entry = &FTPs_HandleTbl[i];
+        if (p_entry->FilePtr != (void *)0) {
+            cmp_val = FTPs_FS_NameCmp(p_entry->Path, path);
+            if (cmp_val == 0) {                                 /* Reuse open handle, rewound.                          */
+                fs_err = NetFS_FilePosSet(p_entry->FilePtr, 0, NET_FS_SEEK_ORIGIN_START);
+                if (fs_err == DEF_OK) {
+                    p_entry->LastUse = FTPs_HandleUseCtr;
+                    return (p_entry->FilePtr);
+                }
+                NetFS_FileClose(p_entry->FilePtr);
+                p_entry->FilePtr = (void *)0;
+                p_victim         =  p_entry;
+                break;
+            }
+            if ((p_victim->FilePtr != (void *)0) &&
+                (p_entry->LastUse  <  p_victim->LastUse)) {
+                p_victim = p_entry;
+            }
+        } else {
+            p_victim = p_entry;
+        }
+    }
+#endif
+
+    p_file = NetFS_FileOpen(path,
+                            NET_FS_FILE_MODE_OPEN,
+                            NET_FS_FILE_ACCESS_RD);
+
+#if (FTPs_CFG_HANDLE_CACHE_EN == DEF_ENABLED)
+    if (p_file != (void *)0) {                                  /* Keep handle (see Note #1).                           */
+        if (p_victim->FilePtr != (void *)0) {
+            NetFS_FileClose(p_victim->FilePtr);
+        }
+        Str_Copy_N(p_victim->Path, path, FTPs_CFG_FS_PATH_LEN_MAX);
+        p_victim->FilePtr = p_file;
+        p_victim->LastUse = FTPs_HandleUseCtr;
+    }
+#endif
+
+    return (p_file);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_FileCloseRd()
+*
+* Description : Close a file opened by FTPs_FileOpenRd().
+*
+* Argument(s) : p_file      Pointer to the file.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd(),
+*               FTPs_ProcessDtpCmd(),
+*               FTPs_SiteCpTo(),
+*               FTPs_DeltaSigTx().
+*
+* Note(s)     : (1) A handle kept in the handle cache stays open; it is closed by FTPs_HandleClose() or
+*                   FTPs_HandleCloseAll().
+*********************************************************************************************************
+*/
+
+static  void  FTPs_FileCloseRd (void  *p_file)
+{
+#if (FTPs_CFG_HANDLE_CACHE_EN == DEF_ENABLED)
+    CPU_INT32U  i;
+
+
+    for (i = 0; i < FTPs_CFG_HANDLE_CACHE_NBR_ENTRIES; i++) {
+        if (FTPs_HandleTbl[i].FilePtr == p_file) {              /* See Note #1.                                         */
+            return;
+        }
+    }
+#endif
+
+    NetFS_FileClose(p_file);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_HandleClose()
+*
+* Description : Close the cached file handles of a path about to be modified.
+*
+* Argument(s) : path        FS absolute path of the entry about to be modified.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd(),
+*               FTPs_ProcessDtpCmd(),
+*               FTPs_SiteRmTree(),
+*               FTPs_SiteCpTo(),
+*               FTPs_TarHdrRx(),
+*               FTPs_DeltaRx().
+*
+* Note(s)     : (1) This function MUST be called BEFORE the entry is written, renamed or deleted, since some
+*                   file systems refuse to modify an open file.
+*********************************************************************************************************
+*/
+
+static  void  FTPs_HandleClose (CPU_CHAR  *path)
+{
+#if (FTPs_CFG_HANDLE_CACHE_EN == DEF_ENABLED)
+    FTPs_HANDLE_ENTRY  *p_entry;
+    CPU_BOOLEAN         match;
+    CPU_INT32U          i;
+
+
+    for (i = 0; i < FTPs_CFG_HANDLE_CACHE_NBR_ENTRIES; i++) {
+        p_entry = &FTPs_HandleTbl[i];
+        if (p_entry->FilePtr != (void *)0) {
+            match = FTPs_PathMatch(p_entry->Path, path);
+            if (match == DEF_YES) {
+                NetFS_FileClose(p_entry->FilePtr);
+                p_entry->FilePtr = (void *)0;
+            }
+        }
+    }
+#else
+    (void)&path;
+#endif
+}
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs_HandleCloseAll()
+*
+* Description : Close all the file handles kept by the session.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_CtrlTask().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  FTPs_HandleCloseAll (void)
+{
+#if (FTPs_CFG_HANDLE_CACHE_EN == DEF_ENABLED)
+    FTPs_HANDLE_ENTRY  *p_entry;
+    CPU_INT32U          i;
+
+
+    for (i = 0; i < FTPs_CFG_HANDLE_CACHE_NBR_ENTRIES; i++) {
+        p_entry = &FTPs_HandleTbl[i];
+        if (p_entry->FilePtr != (void *)0) {
+            NetFS_FileClose(p_entry->FilePtr);
+            p_entry->FilePtr = (void *)0;
+        }
+    }
+#endif
+}
+
+
+/*
+*********************************************************************************************************
+*                                            FTPs_NbrFmt()
+*
+* Description : Write an unsigned decimal number, right-aligned & padded with spaces.
+*
+* Argument(s) : p_dst       Buffer that will receive the number (NOT NULL-terminated).
+*
+*               nbr         Number to write.
+*
+*               width       Minimum number of characters to write.
+*
+* Return(s)   : Number of characters written (at most DEF_MAX(width, 10)).
+*
+* Caller(s)   : FTPs_ListLineFmt().
+*
+* Note(s)     : (1) Same output as Str_FmtPrint() with the "%<width>u" format.
+*********************************************************************************************************
+*/
+
+static  CPU_SIZE_T  FTPs_NbrFmt (CPU_CHAR    *p_dst,
+                                 CPU_INT32U   nbr,
+                                 CPU_SIZE_T   width)
+{
+    CPU_CHAR    dig[10];
+    CPU_SIZE_T  nbr_dig;
+    CPU_SIZE_T  len;
+
+
+    nbr_dig = 0u;                                               /* Get digits, least significant first.                 */
+    do {
+        dig[nbr_dig] = (CPU_CHAR)('0' + (nbr % 10u));
+        nbr_dig++;
+        nbr         /= 10u;
+    } while (nbr != 0u);
+
+    len = 0u;
+    while (width > nbr_dig) {                                   /* Pad ...                                              */
+        p_dst[len] = ' ';
+        len++;
+        width--;
+    }
+    while (nbr_dig > 0u) {                                      /* ... & copy digits.                                   */
+        nbr_dig--;
+        p_dst[len] = dig[nbr_dig];
+        len++;
+    }
+
+    return (len);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs_ListLineFmt()
+*
+* Description : Format the LIST line of a directory entry.
+*
+* Argument(s) : p_buf       Buffer that will receive the line.
+*
+*               buf_len     Size of the buffer.
+*
+*               p_entry     Pointer to the entry information.
+*
+* Return(s)   : Length of the line, if it was written.
+*
+*               Value greater than or equal to 'buf_len', if the line may not fit in the buffer (nothing is
+*               written).
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) The line is identical to the one formerly produced with Str_FmtPrint() & the format
+*
+*                       "%cr%c-r%c-r%c-   1 user     group    %8u %3s %2u  %4u %s\n"
+*
+*                   but is written directly, without parsing a format string for every entry.
+*
+*               (2) The space needed is checked against the longest possible line for the entry name, so that
+*                   the buffer is never overrun.  A line that would fit exactly may be reported as not fitting:
+*                   the caller then sends the buffer & formats the line again in an empty buffer.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  FTPs_ListLineFmt (CPU_CHAR      *p_buf,
+                                      CPU_SIZE_T     buf_len,
+                                      NET_FS_ENTRY  *p_entry)
+{
+    const  CPU_CHAR    *p_month;
+           CPU_SIZE_T   name_len;
+           CPU_SIZE_T   len;
+           CPU_CHAR     attr_wr;
+
+
+    name_len = Str_Len(p_entry->NamePtr);
+    if (FTPs_LIST_LINE_LEN_MAX + name_len >= buf_len) {         /* See Note #2.                                         */
+        return (FTPs_LIST_LINE_LEN_MAX + name_len);
+    }
+
+    if (DEF_BIT_IS_CLR(p_entry->Attrib, NET_FS_ENTRY_ATTRIB_WR) == DEF_YES) {
+        attr_wr = '-';
+    } else {
+        attr_wr = 'w';
+    }
+                                                                /* Permissions.                                         */
+    p_buf[0] = (DEF_BIT_IS_CLR(p_entry->Attrib, NET_FS_ENTRY_ATTRIB_DIR) == DEF_YES) ? '-' : 'd';
+    p_buf[1] = 'r';
+    p_buf[2] =  attr_wr;
+    p_buf[3] = '-';
+    p_buf[4] = 'r';
+    p_buf[5] =  attr_wr;
+    p_buf[6] = '-';
+    p_buf[7] = 'r';
+    p_buf[8] =  attr_wr;
+    p_buf[9] = '-';
+    len      =  10u;
+
+    Mem_Copy(&p_buf[len], FTPs_LIST_LINE_OWNER_STR, FTPs_LIST_LINE_OWNER_LEN);
+    len += FTPs_LIST_LINE_OWNER_LEN;
+
+    len += FTPs_NbrFmt(&p_buf[len], p_entry->Size, 8u);         /* Size.                                                */
+    p_buf[len++] = ' ';
+
+    if ((p_entry->DateTimeCreate.Month >= 1u) &&                /* Date.                                                */
+        (p_entry->DateTimeCreate.Month <= 12u)) {
+        p_month = FTPs_Month_Name[p_entry->DateTimeCreate.Month - 1u];
+    } else {
+        p_month = (const CPU_CHAR *)"???";
+    }
+    p_buf[len++] = p_month[0];
+    p_buf[len++] = p_month[1];
+    p_buf[len++] = p_month[2];
+    p_buf[len++] = ' ';
+    len += FTPs_NbrFmt(&p_buf[len], p_entry->DateTimeCreate.Day, 2u);
+    p_buf[len++] = ' ';
+    p_buf[len++] = ' ';
+    len += FTPs_NbrFmt(&p_buf[len], p_entry->DateTimeCreate.Yr,  4u);
+    p_buf[len++] = ' ';
+
+    Mem_Copy(&p_buf[len], p_entry->NamePtr, name_len);          /* Name.                                                */
+    len += name_len;
+    p_buf[len++] = '\n';
+    p_buf[len]   = (CPU_CHAR)0;
+
+    return (len);
+}
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_MlsxFmt()
+*
+* Description : Format the facts line of an entry for MLSD & MLST (see RFC 3659).
+*
+* Argument(s) : p_buf       Buffer that will receive the line.
+*
+*               buf_len     Size of the buffer.
+*
+*               p_entry     Pointer to the entry information.
+*
+*               p_name      Name of the entry.
+*
+*               p_eol       End of line string.
+*
+* Return(s)   : Length of the line, as returned by Str_FmtPrint().
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd(),
+*               FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) The facts sent are type, size (files only), modify & perm.  The modify fact is the date/time
+*                   reported by the file system, with the format of MDTM (YYYYMMDDHHMMSS).
+*
+*               (2) The perm fact depends only on the entry write attribute:
+*
+*                   (a) Files       : "r" if read-only, "rwadf" otherwise.
+*                   (b) Directories : "el" if read-only, "elcmpdf" otherwise.
+*
+*               (3) The "." & ".." entries of a MLSD listing are typed "cdir" & "pdir" (see RFC 3659,
+*                   section 7.5.1), so that clients don't take them for sub-directories.  The "." & ".."
+*                   entries of the sub-directories of a recursive MLSD are not sent.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  FTPs_MlsxFmt (CPU_CHAR      *p_buf,
+                                  CPU_SIZE_T     buf_len,
+                                  NET_FS_ENTRY  *p_entry,
+                                  CPU_CHAR      *p_name,
+                                  CPU_CHAR      *p_eol)
+{
+    CPU_CHAR    *p_perm;
+    CPU_CHAR    *p_type;
+    CPU_BOOLEAN  is_dir;
+    CPU_BOOLEAN  is_wr;
+    CPU_INT16S   cmp_dot;
+    CPU_INT16S   cmp_dot_dot;
+    CPU_INT32U   str_len;
+
+
+    is_dir = DEF_BIT_IS_SET(p_entry->Attrib, NET_FS_ENTRY_ATTRIB_DIR);
+    is_wr  = DEF_BIT_IS_SET(p_entry->Attrib, NET_FS_ENTRY_ATTRIB_WR);
+
+    if (is_dir == DEF_YES) {                                    /* See Note #2.                                         */
+        p_perm      = (is_wr == DEF_YES) ? (CPU_CHAR *)"elcmpdf" : (CPU_CHAR *)"el";
+        cmp_dot     = Str_Cmp(p_name, (CPU_CHAR *)".");         /* See Note #3.                                         */
+        cmp_dot_dot = Str_Cmp(p_name, (CPU_CHAR *)"..");
+        if (cmp_dot == 0) {
+            p_type = (CPU_CHAR *)"cdir";
+        } else if (cmp_dot_dot == 0) {
+            p_type = (CPU_CHAR *)"pdir";
+        } else {
+            p_type = (CPU_CHAR *)"dir";
+        }
+        str_len = Str_FmtPrint((char *)p_buf,
+                                       buf_len,
+                                       "type=%s;modify=%04u%02u%02u%02u%02u%02u;perm=%s; %s%s",
+                                             p_type,
+                               (unsigned int)p_entry->DateTimeCreate.Yr,
+                               (unsigned int)p_entry->DateTimeCreate.Month,
+                               (unsigned int)p_entry->DateTimeCreate.Day,
+                               (unsigned int)p_entry->DateTimeCreate.Hr,
+                               (unsigned int)p_entry->DateTimeCreate.Min,
+                               (unsigned int)p_entry->DateTimeCreate.Sec,
+                                             p_perm,
+                                             p_name,
+                                             p_eol);
+    } else {
+        p_perm = (is_wr == DEF_YES) ? (CPU_CHAR *)"rwadf" : (CPU_CHAR *)"r";
+        str_len = Str_FmtPrint((char *)p_buf,
+                                       buf_len,
+                                       "type=file;size=%u;modify=%04u%02u%02u%02u%02u%02u;perm=%s; %s%s",
+                               (unsigned int)p_entry->Size,
+                               (unsigned int)p_entry->DateTimeCreate.Yr,
+                               (unsigned int)p_entry->DateTimeCreate.Month,
+                               (unsigned int)p_entry->DateTimeCreate.Day,
+                               (unsigned int)p_entry->DateTimeCreate.Hr,
+                               (unsigned int)p_entry->DateTimeCreate.Min,
+                               (unsigned int)p_entry->DateTimeCreate.Sec,
+                                             p_perm,
+                                             p_name,
+                                             p_eol);
+    }
+
+    return (str_len);
+}
+
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs_GlobIsPattern()
+*
+* Description : Check if a name contains glob pattern characters.
+*
+* Argument(s) : p_name      Name to check.
+*
+* Return(s)   : DEF_YES, if the name contains '*', '?' or '['.
+*
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_LIST_GLOB_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_GlobIsPattern (CPU_CHAR  *p_name)
+{
+    while (*p_name != (CPU_CHAR)0) {
+        if ((*p_name == '*') ||
+            (*p_name == '?') ||
+            (*p_name == '[')) {
+            return (DEF_YES);
+        }
+        p_name++;
+    }
+
+    return (DEF_NO);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_GlobCompile()
+*
+* Description : Compile a glob pattern into a list of tokens, to be matched against the entries of a
+*               directory by FTPs_GlobMatch().
+*
+* Argument(s) : p_glob      Pointer to the structure that will receive the compiled pattern.
+*
+*               p_pattern   Pattern to compile.
+*
+* Return(s)   : DEF_OK,   if the pattern was compiled.
+*
+*               DEF_FAIL, if the pattern has more than FTPs_GLOB_SET_NBR_MAX sets.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd().
+*
+* Note(s)     : (1) The following are supported:
+*
+*                   (a) '*'         matches any string, including the empty string.
+*                   (b) '?'         matches any single character.
+*                   (c) '[...]'     matches any single character of the set.  The set may contain ranges
+*                                   ("a-z") & is negated by a leading '!' or '^'.  A ']' placed first is part
+*                                   of the set.  A '[' without a closing ']' is a literal character.
+*
+*               (2) Consecutive '*' are compiled as a single token.
+*
+*               (3) Characters are matched as the file system compares names : unless FTPs_CFG_FS_CASE_SENSITIVE
+*                   is enabled, they are stored in lower case & matched without regard to case, like the names
+*                   of FAT file systems.
+*
+*               (4) The compiled pattern is NOT enabled; the caller sets 'En'.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_LIST_GLOB_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_GlobCompile (FTPs_GLOB  *p_glob,
+                                       CPU_CHAR   *p_pattern)
+{
+    CPU_CHAR     *p_set;
+    CPU_CHAR     *p_set_end;
+    CPU_INT08U   *p_bits;
+    CPU_BOOLEAN   neg;
+    CPU_INT16U    ch_lo;
+    CPU_INT16U    ch_hi;
+    CPU_INT16U    ch;
+    CPU_SIZE_T    i;
+
+
+    p_glob->TokNbr = 0u;
+    p_glob->SetNbr = 0u;
+    p_glob->En     = DEF_NO;                                    /* See Note #4.                                         */
+
+    while (*p_pattern != (CPU_CHAR)0) {
+        if (p_glob->TokNbr >= FTPs_CFG_FS_NAME_LEN_MAX) {       /* Longer than any name: can't match.                   */
+            return (DEF_FAIL);
+        }
+
+        switch (*p_pattern) {
+            case '*':                                           /* See Note #2.                                         */
+                 if ((p_glob->TokNbr == 0u) ||
+                     (p_glob->TokTbl[p_glob->TokNbr - 1u] != FTPs_GLOB_TOK_STAR)) {
+                     p_glob->TokTbl[p_glob->TokNbr] = FTPs_GLOB_TOK_STAR;
+                     p_glob->ValTbl[p_glob->TokNbr] = 0u;
+                     p_glob->TokNbr++;
+                 }
+                 p_pattern++;
+                 break;
+
+
+            case '?':
+                 p_glob->TokTbl[p_glob->TokNbr] = FTPs_GLOB_TOK_ANY;
+                 p_glob->ValTbl[p_glob->TokNbr] = 0u;
+                 p_glob->TokNbr++;
+                 p_pattern++;
+                 break;
+
+
+            case '[':
+                 p_set = p_pattern + 1;
+                 neg   = DEF_NO;
+                 if ((*p_set == '!') ||
+                     (*p_set == '^')) {
+                     neg = DEF_YES;
+                     p_set++;
+                 }
+                 p_set_end = p_set;
+                 if (*p_set_end == ']') {                       /* Leading ']' is part of the set (see Note #1c).       */
+                     p_set_end++;
+                 }
+                 while ((*p_set_end != (CPU_CHAR)0) &&
+                        (*p_set_end != ']')) {
+                     p_set_end++;
+                 }
+
+                 if (*p_set_end == (CPU_CHAR)0) {               /* No closing ']': literal '[' (see Note #1c).          */
+                     p_glob->TokTbl[p_glob->TokNbr] = FTPs_GLOB_TOK_CHAR;
+                     p_glob->ValTbl[p_glob->TokNbr] = (CPU_INT08U)'[';
+                     p_glob->TokNbr++;
+                     p_pattern++;
+                     break;
+                 }
+
+                 if (p_glob->SetNbr >= FTPs_GLOB_SET_NBR_MAX) {
+                     return (DEF_FAIL);
+                 }
+
+                 p_bits = &p_glob->SetTbl[p_glob->SetNbr][0];
+                 Mem_Clr(p_bits, FTPs_GLOB_SET_SIZE);
+                 while (p_set < p_set_end) {
+                     ch_lo = (CPU_INT08U)*p_set;
+                     ch_hi = ch_lo;
+                     if ((p_set[1]   == '-') &&                 /* Range, unless '-' is the last char of the set.       */
+                         (p_set + 2u <  p_set_end)) {
+                         ch_hi  = (CPU_INT08U)p_set[2];
+                         p_set += 3u;
+                     } else {
+                         p_set++;
+                     }
+                     for (ch = ch_lo; ch <= ch_hi; ch++) {      /* See Note #3.                                         */
+                         ch_lo = (CPU_INT08U)FTPs_FS_ChFold((CPU_CHAR)ch);
+                         DEF_BIT_SET(p_bits[ch_lo / 8u], DEF_BIT(ch_lo % 8u));
+                     }
+                 }
+                 if (neg == DEF_YES) {
+                     for (i = 0u; i < FTPs_GLOB_SET_SIZE; i++) {
+                         p_bits[i] = (CPU_INT08U)~p_bits[i];
+                     }
+                 }
+
+                 p_glob->TokTbl[p_glob->TokNbr] = FTPs_GLOB_TOK_SET;
+                 p_glob->ValTbl[p_glob->TokNbr] = p_glob->SetNbr;
+                 p_glob->TokNbr++;
+                 p_glob->SetNbr++;
+                 p_pattern = p_set_end + 1;
+                 break;
+
+
+            default:
+                 p_glob->TokTbl[p_glob->TokNbr] = FTPs_GLOB_TOK_CHAR;
+                 p_glob->ValTbl[p_glob->TokNbr] = (CPU_INT08U)FTPs_FS_ChFold(*p_pattern);
+                 p_glob->TokNbr++;
+                 p_pattern++;
+                 break;
+        }
+    }
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_GlobMatch()
+*
+* Description : Match a name against a pattern compiled by FTPs_GlobCompile().
+*
+* Argument(s) : p_glob      Pointer to the compiled pattern.
+*
+*               p_name      Name to match.
+*
+* Return(s)   : DEF_YES, if the whole name matches the pattern.
+*
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) The name is matched without recursion.  When a token does not match, the matching resumes
+*                   after the last '*', which then consumes one more character.  Since the tokens after a '*'
+*                   never need to be retried from an earlier '*', the work is bounded by the product of the
+*                   name & pattern lengths.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_LIST_GLOB_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_GlobMatch (FTPs_GLOB  *p_glob,
+                                     CPU_CHAR   *p_name)
+{
+    CPU_CHAR     *p_star_name;
+    CPU_SIZE_T    star_tok;
+    CPU_SIZE_T    tok;
+    CPU_INT08U    ch;
+    CPU_INT08U    val;
+    CPU_BOOLEAN   match;
+
+
+    p_star_name = (CPU_CHAR *)0;
+    star_tok    =  0u;
+    tok         =  0u;
+
+    while (*p_name != (CPU_CHAR)0) {
+        if ((tok                  <  p_glob->TokNbr) &&
+            (p_glob->TokTbl[tok] == FTPs_GLOB_TOK_STAR)) {
+            tok++;                                              /* Remember position after '*' (see Note #1).           */
+            star_tok    = tok;
+            p_star_name = p_name;
+            continue;
+        }
+
+        match = DEF_NO;
+        if (tok < p_glob->TokNbr) {
+            ch  = (CPU_INT08U)FTPs_FS_ChFold(*p_name);
+            val = p_glob->ValTbl[tok];
+            switch (p_glob->TokTbl[tok]) {
+                case FTPs_GLOB_TOK_ANY:
+                     match = DEF_YES;
+                     break;
+
+                case FTPs_GLOB_TOK_SET:
+                     match = DEF_BIT_IS_SET(p_glob->SetTbl[val][ch / 8u], DEF_BIT(ch % 8u));
+                     break;
+
+                case FTPs_GLOB_TOK_CHAR:
+                default:
+                     match = (ch == val) ? DEF_YES : DEF_NO;
+                     break;
+            }
+        }
+
+        if (match == DEF_YES) {
+            tok++;
+            p_name++;
+        } else if (p_star_name != (CPU_CHAR *)0) {             /* Let the last '*' consume one more char.              */
+            p_star_name++;
+            p_name = p_star_name;
+            tok    = star_tok;
+        } else {
+            return (DEF_NO);
+        }
+    }
+
+    while ((tok                  <  p_glob->TokNbr) &&          /* Trailing '*' match the empty string.                 */
+           (p_glob->TokTbl[tok] == FTPs_GLOB_TOK_STAR)) {
+        tok++;
+    }
+
+    return ((tok == p_glob->TokNbr) ? DEF_YES : DEF_NO);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs_ListWalkStart()
+*
+* Description : Start the walk of a directory tree for a recursive listing.
+*
+* Argument(s) : path        FS absolute path of the top directory.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) The top directory is listed by the caller; FTPs_ListWalkNext() then returns, one at a time,
+*                   the sub-directories to list, in depth-first order.
+*
+*               (2) A top directory whose path does NOT fit 'Path' is listed alone, like in a non-recursive
+*                   listing, rather than walked from a truncated path.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+static  void  FTPs_ListWalkStart (CPU_CHAR  *path)
+{
+    FTPs_LIST_WALK  *p_walk;
+    CPU_SIZE_T       path_len;
+
+
+    p_walk = &FTPs_ListWalk;
+
+    path_len = Str_Len(path);
+    if (path_len >= FTPs_CFG_FS_PATH_LEN_MAX) {                 /* See Note #2.                                         */
+        p_walk->En = DEF_NO;
+        return;
+    }
+
+    Str_Copy_N(p_walk->Path, path, FTPs_CFG_FS_PATH_LEN_MAX);
+    p_walk->BaseLen       = Str_Len(p_walk->Path);
+    p_walk->Depth         = 0u;
+    p_walk->Entry.NamePtr = &p_walk->EntryName[0];
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs_ListWalkNext()
+*
+* Description : Find the next directory to list in a recursive listing.
+*
+* Argument(s) : none.
+*
+* Return(s)   : Handle of the next directory, opened for listing.
+*
+*               Pointer to NULL, if the whole tree was listed.
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) The tree is walked depth-first without recursion, so the control task stack use does not
+*                   depend on the depth of the tree.  The directory just listed is opened again & pushed on a
+*                   stack of FTPs_CFG_LIST_RECURSIVE_DEPTH_MAX directory handles; its sub-directories are read
+*                   from that handle & listed before going back to its parent.
+*
+*               (2) The sub-directories of a directory at the maximum depth are NOT listed.  At most
+*                   FTPs_CFG_LIST_RECURSIVE_DEPTH_MAX + 1 directories are open at a time.
+*
+*               (3) Hidden directories, "." & ".." are not walked.  Directories whose path would be longer
+*                   than FTPs_CFG_FS_PATH_LEN_MAX are skipped.
+*
+*               (4) On return, the path of the directory is in 'Path' (see FTPs_ListWalkRelGet()).
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+static  void  *FTPs_ListWalkNext (void)
+{
+    FTPs_LIST_WALK  *p_walk;
+    void            *p_dir;
+    CPU_SIZE_T       path_len;
+    CPU_SIZE_T       name_len;
+    CPU_SIZE_T       sep_len;
+    CPU_INT16S       cmp_dot;
+    CPU_INT16S       cmp_dot_dot;
+    CPU_BOOLEAN      fs_err;
+
+
+    p_walk = &FTPs_ListWalk;
+
+    if (p_walk->Depth < FTPs_CFG_LIST_RECURSIVE_DEPTH_MAX) {   /* Push dir just listed (see Note #1).                  */
+        p_dir = NetFS_DirOpen(p_walk->Path);
+        if (p_dir != (void *)0) {
+            p_walk->DirTbl[p_walk->Depth]     = p_dir;
+            p_walk->PathLenTbl[p_walk->Depth] = Str_Len(p_walk->Path);
+            p_walk->Depth++;
+        }
+    }
+
+    while (p_walk->Depth > 0u) {
+        p_dir    = p_walk->DirTbl[p_walk->Depth - 1u];
+        path_len = p_walk->PathLenTbl[p_walk->Depth - 1u];
+        p_walk->Path[path_len] = (CPU_CHAR)0;
+
+        fs_err = NetFS_DirRd(p_dir, &p_walk->Entry);
+        if (fs_err != DEF_OK) {                                 /* All sub-dirs listed: back to parent dir.             */
+            NetFS_DirClose(p_dir);
+            p_walk->Depth--;
+            continue;
+        }
+
+        if ((DEF_BIT_IS_CLR(p_walk->Entry.Attrib, NET_FS_ENTRY_ATTRIB_DIR)    == DEF_YES) ||
+            (DEF_BIT_IS_SET(p_walk->Entry.Attrib, NET_FS_ENTRY_ATTRIB_HIDDEN) == DEF_YES)) {
+            continue;
+        }
+        cmp_dot     = Str_Cmp(p_walk->EntryName, (CPU_CHAR *)".");
+        cmp_dot_dot = Str_Cmp(p_walk->EntryName, (CPU_CHAR *)"..");
+        if ((cmp_dot     == 0) ||                               /* See Note #3.                                         */
+            (cmp_dot_dot == 0)) {
+            continue;
+        }
+
+        name_len = Str_Len(p_walk->EntryName);
+        sep_len  = ((path_len                      > 0u) &&
+                    (p_walk->Path[path_len - 1u] == FTPs_FS_SepChar)) ? 0u : 1u;
+        if (path_len + sep_len + name_len >= FTPs_CFG_FS_PATH_LEN_MAX) {
+            continue;
+        }
+
+        if (sep_len > 0u) {
+            p_walk->Path[path_len] = FTPs_FS_SepChar;
+        }
+        Mem_Copy(&p_walk->Path[path_len + sep_len], p_walk->EntryName, name_len + 1u);
+
+        p_dir = NetFS_DirOpen(p_walk->Path);                    /* See Note #4.                                         */
+        if (p_dir != (void *)0) {
+            return (p_dir);
+        }
+    }
+
+    return ((void *)0);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs_ListWalkRelGet()
+*
+* Description : Get the path of the directory being listed, relative to the top directory.
+*
+* Argument(s) : none.
+*
+* Return(s)   : Pointer to the relative path, in FS style (empty string for the top directory).
+*
+* Caller(s)   : FTPs_ProcessDtpCmd(),
+*               FTPs_ListWalkNameGet().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+static  CPU_CHAR  *FTPs_ListWalkRelGet (void)
+{
+    CPU_CHAR  *p_rel;
+
+
+    p_rel = &FTPs_ListWalk.Path[FTPs_ListWalk.BaseLen];
+    if (*p_rel == FTPs_FS_SepChar) {
+        p_rel++;
+    }
+
+    return (p_rel);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs_ListWalkNameGet()
+*
+* Description : Get the name of an entry of the directory being listed, relative to the top directory.
+*
+* Argument(s) : p_name      Name of the entry.
+*
+* Return(s)   : Pointer to the relative name, in FTP style (e.g. "sub/dir/name").
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) A recursive MLSD has no per-directory header : each entry is sent with its relative name.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+static  CPU_CHAR  *FTPs_ListWalkNameGet (CPU_CHAR  *p_name)
+{
+    CPU_CHAR  *p_rel;
+
+
+    p_rel = FTPs_ListWalkRelGet();
+    if (*p_rel == (CPU_CHAR)0) {                                /* Entry of the top dir.                                */
+        return (p_name);
+    }
+
+    Str_FmtPrint((char *)FTPs_ListWalk.RelName,
+                         FTPs_CFG_FS_PATH_LEN_MAX,
+                         "%s/%s",
+                         p_rel,
+                         p_name);
+    FTPs_ToFTPStylePath(FTPs_ListWalk.RelName);
+
+    return (FTPs_ListWalk.RelName);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_ListWalkEnd()
+*
+* Description : End the walk of a directory tree.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd().
+*
+* Note(s)     : (1) The directories still stacked, if the listing was aborted, are closed.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+static  void  FTPs_ListWalkEnd (void)
+{
+    while (FTPs_ListWalk.Depth > 0u) {
+        FTPs_ListWalk.Depth--;
+        NetFS_DirClose(FTPs_ListWalk.DirTbl[FTPs_ListWalk.Depth]);
+    }
+    FTPs_ListWalk.En = DEF_NO;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_TarStart()
+*
+* Description : Determine if a RETR or STOR path names the archive of a directory.
+*
+* Argument(s) : path        FS absolute path of the entry to retrieve or store.
+*
+* Return(s)   : DEF_YES, if the path is a directory path followed by ".tar" (see Note #1).
+*
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd().
+*
+* Note(s)     : (1) "RETR <dirname>.tar" sends the directory tree as a tar archive (see FTPs_TarTx()) &
+*                   "STOR <dirname>.tar" extracts the received archive into the directory (see FTPs_TarRx()),
+*                   unless a file of that name exists.  The ".tar" suffix is case insensitive.
+*
+*               (2) On return, the path of the directory is in 'Path' & FTPs_Tar.En is set.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_TAR_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_TarStart (CPU_CHAR  *path)
+{
+    FTPs_TAR      *p_tar;
+    NET_FS_ENTRY   dirent;
+    CPU_CHAR      *p_sep;
+    CPU_SIZE_T     path_len;
+    CPU_INT16S     cmp_val;
+    CPU_BOOLEAN    found;
+
+
+    p_tar    = &FTPs_Tar;
+    path_len =  Str_Len(path);
+    if ((path_len <= FTPs_TAR_EXT_LEN) ||
+        (path_len >= FTPs_CFG_FS_PATH_LEN_MAX)) {               /* Dir path MUST fit p_tar->Path.                       */
+        return (DEF_NO);
+    }
+    cmp_val = Str_CmpIgnoreCase_N(&path[path_len - FTPs_TAR_EXT_LEN],
+                                  (CPU_CHAR *)FTPs_TAR_EXT_STR,
+                                  FTPs_TAR_EXT_LEN);
+    if ((cmp_val                                    != 0) ||
+        (path[path_len - FTPs_TAR_EXT_LEN - 1u] == FTPs_FS_SepChar)) {
+        return (DEF_NO);
+    }
+
+    found = FTPs_EntryStat(path, &dirent);
+    if (found == DEF_YES) {                                     /* Existing file sent as is (see Note #1).              */
+        return (DEF_NO);
+    }
+
+    Str_Copy_N(p_tar->Path, path, FTPs_CFG_FS_PATH_LEN_MAX);
+    p_tar->Path[path_len - FTPs_TAR_EXT_LEN] = (CPU_CHAR)0;
+    found = FTPs_EntryStat(p_tar->Path, &dirent);
+    if ((found == DEF_NO) ||
+        (DEF_BIT_IS_CLR(dirent.Attrib, NET_FS_ENTRY_ATTRIB_DIR) == DEF_YES)) {
+        return (DEF_NO);
+    }
+
+    p_sep          = Str_Char_Last(p_tar->Path, FTPs_FS_SepChar);
+    p_tar->BaseLen = (p_sep != (CPU_CHAR *)0) ? (CPU_SIZE_T)(p_sep - &p_tar->Path[0]) + 1u : 0u;
+    p_tar->En      =  DEF_YES;
+
+    return (DEF_YES);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            FTPs_TarTx()
+*
+* Description : Send the directory selected by FTPs_TarStart() as a tar archive on the data connection.
+*
+* Argument(s) : sock_id     Data connection socket id.
+*
+*               p_buf       Pointer to the transmit buffer (FTPs_NET_BUF_LEN octets).
+*
+*               offset      Nbr of octets of the archive to skip (REST offset).
+*
+*               p_err       Pointer to variable that will receive the return error code from this function.
+*
+* Return(s)   : DEF_OK,   archive successfully sent.
+*
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) The archive is generated on the fly, in POSIX ustar format, from the directory & file
+*                   contents : nothing is written to the file system.  Entries are named relative to the parent
+*                   of the archived directory (e.g. "logs/", "logs/boot.txt").
+*
+*               (2) The tree is walked depth-first without recursion, with a stack of FTPs_CFG_TAR_DEPTH_MAX
+*                   directory handles (see FTPs_ListWalkNext()).  The sub-directories of a directory at the
+*                   maximum depth are archived empty.
+*
+*               (3) Since the archive of an unchanged tree is always the same, a REST offset is honored by
+*                   generating the archive & skipping its first 'offset' octets.  Files entirely skipped are
+*                   not read.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_TAR_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_TarTx (CPU_INT32S   sock_id,
+                                 CPU_CHAR    *p_buf,
+                                 CPU_INT32U   offset,
+                                 NET_ERR     *p_err)
+{
+    FTPs_TAR     *p_tar;
+    void         *p_dir;
+    CPU_SIZE_T    path_len;
+    CPU_SIZE_T    name_len;
+    CPU_SIZE_T    sep_len;
+    CPU_INT16S    cmp_dot;
+    CPU_INT16S    cmp_dot_dot;
+    CPU_BOOLEAN   found;
+    CPU_BOOLEAN   fs_err;
+    CPU_BOOLEAN   rtn_val;
+
+
+    p_tar                = &FTPs_Tar;
+    p_tar->SockID        =  sock_id;
+    p_tar->BufPtr        =  p_buf;
+    p_tar->BufLen        =  0u;
+    p_tar->Skip          =  offset;
+    p_tar->Depth         =  0u;
+    p_tar->Entry.NamePtr = &p_tar->EntryName[0];
+   *p_err                =  NET_SOCK_ERR_NONE;
+
+    found = FTPs_EntryStat(p_tar->Path, &p_tar->Entry);         /* Top dir.                                             */
+    p_dir = NetFS_DirOpen(p_tar->Path);
+    if ((found == DEF_NO) ||
+        (p_dir == (void *)0)) {
+        if (p_dir != (void *)0) {
+            NetFS_DirClose(p_dir);
+        }
+        return (DEF_FAIL);
+    }
+    p_tar->DirTbl[0]     = p_dir;
+    p_tar->PathLenTbl[0] = Str_Len(p_tar->Path);
+    p_tar->Depth         = 1u;
+
+    rtn_val = FTPs_TarEntryTx(p_tar, p_err);
+
+    while ((rtn_val      == DEF_OK) &&                          /* See Note #2.                                         */
+           (p_tar->Depth >  0u)) {
+        p_dir    = p_tar->DirTbl[p_tar->Depth - 1u];
+        path_len = p_tar->PathLenTbl[p_tar->Depth - 1u];
+        p_tar->Path[path_len] = (CPU_CHAR)0;
+
+        fs_err = NetFS_DirRd(p_dir, &p_tar->Entry);
+        if (fs_err != DEF_OK) {                                 /* Whole dir archived: back to parent dir.              */
+            NetFS_DirClose(p_dir);
+            p_tar->Depth--;
+            continue;
+        }
+
+        cmp_dot     = Str_Cmp(p_tar->EntryName, (CPU_CHAR *)".");
+        cmp_dot_dot = Str_Cmp(p_tar->EntryName, (CPU_CHAR *)"..");
+        if ((cmp_dot     == 0) ||
+            (cmp_dot_dot == 0)) {
+            continue;
+        }
+
+        name_len = Str_Len(p_tar->EntryName);
+        sep_len  = (p_tar->Path[path_len - 1u] == FTPs_FS_SepChar) ? 0u : 1u;
+        if (path_len + sep_len + name_len >= FTPs_CFG_FS_PATH_LEN_MAX) {
+            FTPs_TRACE_DBG(("FTPs tar: path too long, entry skipped: line #%u.\n", (unsigned int)__LINE__));
+            continue;
+        }
+        if (sep_len > 0u) {
+            p_tar->Path[path_len] = FTPs_FS_SepChar;
+        }
+        Mem_Copy(&p_tar->Path[path_len + sep_len], p_tar->EntryName, name_len + 1u);
+
+        rtn_val = FTPs_TarEntryTx(p_tar, p_err);
+
+        if ((rtn_val      == DEF_OK) &&                         /* Sub-dir: archive its content first.                  */
+            (p_tar->Depth <  FTPs_CFG_TAR_DEPTH_MAX) &&
+            (DEF_BIT_IS_SET(p_tar->Entry.Attrib, NET_FS_ENTRY_ATTRIB_DIR) == DEF_YES)) {
+            p_dir = NetFS_DirOpen(p_tar->Path);
+            if (p_dir != (void *)0) {
+                p_tar->DirTbl[p_tar->Depth]     = p_dir;
+                p_tar->PathLenTbl[p_tar->Depth] = Str_Len(p_tar->Path);
+                p_tar->Depth++;
+            }
+        }
+    }
+
+    while (p_tar->Depth > 0u) {                                 /* Close dirs left open by an aborted transfer.         */
+        p_tar->Depth--;
+        NetFS_DirClose(p_tar->DirTbl[p_tar->Depth]);
+    }
+
+    if (rtn_val == DEF_OK) {                                    /* End of archive: two zero blocks.                     */
+        rtn_val = FTPs_TarWr(p_tar, (CPU_INT08U *)0, 2u * FTPs_TAR_BLK_SIZE, p_err);
+    }
+    if (rtn_val == DEF_OK) {
+        rtn_val = FTPs_TarFlush(p_tar, p_err);
+    }
+
+    return (rtn_val);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_TarEntryTx()
+*
+* Description : Add the entry located at 'Path' to the tar archive being sent.
+*
+* Argument(s) : p_tar       Pointer to the archive state.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function.
+*
+* Return(s)   : DEF_OK,   entry added or skipped.
+*
+*               DEF_FAIL, data connection error.
+*
+* Caller(s)   : FTPs_TarTx().
+*
+* Note(s)     : (1) Files that can't be opened & entries whose name doesn't fit a ustar header are skipped.
+*
+*               (2) The file is sent with the size read when it was opened.  If it gets shorter while being
+*                   read, the missing octets are sent as zeros so the archive stays readable.
+*
+*               (3) When the buffered octets & the whole file data lie before the REST offset, they are
+*                   dropped without reading the file (see FTPs_TarTx() Note #3).
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_TAR_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_TarEntryTx (FTPs_TAR  *p_tar,
+                                      NET_ERR   *p_err)
+{
+    void         *p_file;
+    CPU_INT32U    size;
+    CPU_INT32U    rem;
+    CPU_SIZE_T    len;
+    CPU_SIZE_T    rd_len;
+    CPU_BOOLEAN   fs_err;
+    CPU_BOOLEAN   rtn_val;
+
+
+    p_file = (void *)0;
+    size   =  0u;
+    if (DEF_BIT_IS_CLR(p_tar->Entry.Attrib, NET_FS_ENTRY_ATTRIB_DIR) == DEF_YES) {
+        p_file = NetFS_FileOpen(p_tar->Path,
+                                NET_FS_FILE_MODE_OPEN,
+                                NET_FS_FILE_ACCESS_RD);
+        if (p_file == (void *)0) {                              /* See Note #1.                                         */
+            FTPs_TRACE_DBG(("FTPs tar: file not opened, entry skipped: line #%u.\n", (unsigned int)__LINE__));
+            return (DEF_OK);
+        }
+        fs_err = NetFS_FileSizeGet(p_file, &size);
+        if (fs_err != DEF_OK) {
+            size = p_tar->Entry.Size;
+        }
+    }
+
+    rtn_val = FTPs_TarHdrFmt(p_tar, size);
+    if (rtn_val != DEF_OK) {                                    /* See Note #1.                                         */
+        FTPs_TRACE_DBG(("FTPs tar: name too long, entry skipped: line #%u.\n", (unsigned int)__LINE__));
+        if (p_file != (void *)0) {
+            NetFS_FileClose(p_file);
+        }
+        return (DEF_OK);
+    }
+
+    rtn_val = FTPs_TarWr(p_tar, p_tar->Hdr, FTPs_TAR_BLK_SIZE, p_err);
+    if (p_file == (void *)0) {
+        return (rtn_val);
+    }
+
+    rem = size;
+    if (p_tar->Skip >= p_tar->BufLen + size) {                  /* Hdr & data skipped: file not read (see Note #3).     */
+        p_tar->Skip   -= p_tar->BufLen + size;
+        p_tar->BufLen  = 0u;
+        rem            = 0u;
+    }
+    while ((rtn_val == DEF_OK) &&
+           (rem     >  0u)) {
+        if (p_tar->BufLen == FTPs_NET_BUF_LEN) {
+            rtn_val = FTPs_TarFlush(p_tar, p_err);
+            if (rtn_val != DEF_OK) {
+                break;
+            }
+        }
+        len = DEF_MIN(rem, FTPs_NET_BUF_LEN - p_tar->BufLen);
+        (void)NetFS_FileRd((void       *) p_file,
+                           (void       *)&p_tar->BufPtr[p_tar->BufLen],
+                           (CPU_SIZE_T  ) len,
+                           (CPU_SIZE_T *)&rd_len);
+        if (rd_len == 0u) {                                     /* See Note #2.                                         */
+            break;
+        }
+        p_tar->BufLen += rd_len;
+        rem           -= rd_len;
+    }
+    NetFS_FileClose(p_file);
+
+    if (rtn_val == DEF_OK) {                                    /* Pad data to a whole block.                           */
+        rem    += (FTPs_TAR_BLK_SIZE - (size % FTPs_TAR_BLK_SIZE)) % FTPs_TAR_BLK_SIZE;
+        rtn_val = FTPs_TarWr(p_tar, (CPU_INT08U *)0, rem, p_err);
+    }
+
+    return (rtn_val);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_TarHdrFmt()
+*
+* Description : Format the ustar header block of the entry located at 'Path'.
+*
+* Argument(s) : p_tar       Pointer to the archive state.
+*
+*               size        Size of the entry data, in octets.
+*
+* Return(s)   : DEF_OK,   header formatted in 'Hdr'.
+*
+*               DEF_FAIL, name too long for a ustar header.
+*
+* Caller(s)   : FTPs_TarEntryTx().
+*
+* Note(s)     : (1) A name longer than 100 characters is split, on a '/', into a prefix of up to 155 characters
+*                   & a name of up to 100 characters.  Directory names end with '/'.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_TAR_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_TarHdrFmt (FTPs_TAR    *p_tar,
+                                     CPU_INT32U   size)
+{
+    CPU_INT08U   *p_hdr;
+    CPU_CHAR     *p_name;
+    CPU_SIZE_T    name_len;
+    CPU_SIZE_T    ttl_len;
+    CPU_SIZE_T    split;
+    CPU_SIZE_T    i;
+    CPU_INT32U    chk_sum;
+    CPU_INT32U    mode;
+    CPU_BOOLEAN   is_dir;
+    CPU_CHAR      ch;
+
+
+    p_hdr    =  p_tar->Hdr;
+    p_name   = &p_tar->Path[p_tar->BaseLen];
+    name_len =  Str_Len(p_name);
+    is_dir   =  DEF_BIT_IS_SET(p_tar->Entry.Attrib, NET_FS_ENTRY_ATTRIB_DIR);
+    ttl_len  =  name_len + ((is_dir == DEF_YES) ? 1u : 0u);
+
+    split = 0u;                                                 /* See Note #1.                                         */
+    if (ttl_len > FTPs_TAR_NAME_LEN) {
+        i = ttl_len - FTPs_TAR_NAME_LEN - 1u;
+        while ((i <  name_len) &&
+               (i <= FTPs_TAR_PREFIX_LEN)) {
+            if (p_name[i] == FTPs_FS_SepChar) {
+                split = i;
+                break;
+            }
+            i++;
+        }
+        if (split == 0u) {
+            return (DEF_FAIL);
+        }
+    }
+
+    Mem_Clr(p_hdr, FTPs_TAR_BLK_SIZE);
+
+    for (i = 0u; i < name_len; i++) {                           /* Name & prefix, with '/' separators.                  */
+        ch = (p_name[i] == FTPs_FS_SepChar) ? '/' : p_name[i];
+        if (split == 0u) {
+            p_hdr[FTPs_TAR_HDR_NAME   + i]               = (CPU_INT08U)ch;
+        } else if (i < split) {
+            p_hdr[FTPs_TAR_HDR_PREFIX + i]               = (CPU_INT08U)ch;
+        } else if (i > split) {
+            p_hdr[FTPs_TAR_HDR_NAME   + i - split - 1u]  = (CPU_INT08U)ch;
+        }
+    }
+    if (is_dir == DEF_YES) {
+        p_hdr[FTPs_TAR_HDR_NAME + ((split == 0u) ? name_len : name_len - split - 1u)] = (CPU_INT08U)'/';
+    }
+
+    if (is_dir == DEF_YES) {
+        mode = 0755u;
+    } else {
+        mode = 0644u;
+    }
+    if (DEF_BIT_IS_CLR(p_tar->Entry.Attrib, NET_FS_ENTRY_ATTRIB_WR) == DEF_YES) {
+        mode &= 0555u;                                          /* Read-only entry.                                     */
+    }
+
+    FTPs_TarOctFmt(&p_hdr[FTPs_TAR_HDR_MODE],   8u, mode);
+    FTPs_TarOctFmt(&p_hdr[FTPs_TAR_HDR_UID],    8u, 0u);
+    FTPs_TarOctFmt(&p_hdr[FTPs_TAR_HDR_GID],    8u, 0u);
+    FTPs_TarOctFmt(&p_hdr[FTPs_TAR_HDR_SIZE],  12u, size);
+    FTPs_TarOctFmt(&p_hdr[FTPs_TAR_HDR_MTIME], 12u, FTPs_TarTimeGet(&p_tar->Entry.DateTimeCreate));
+    p_hdr[FTPs_TAR_HDR_TYPE] = (is_dir == DEF_YES) ? (CPU_INT08U)'5' : (CPU_INT08U)'0';
+    Mem_Copy(&p_hdr[FTPs_TAR_HDR_MAGIC],   "ustar", 6u);        /* Magic, with its NULL character.                      */
+    Mem_Copy(&p_hdr[FTPs_TAR_HDR_VERSION], "00",    2u);
+    Mem_Copy(&p_hdr[FTPs_TAR_HDR_UNAME],   "user",  4u);
+    Mem_Copy(&p_hdr[FTPs_TAR_HDR_GNAME],   "group", 5u);
+
+    Mem_Set(&p_hdr[FTPs_TAR_HDR_CHKSUM], ' ', 8u);              /* Checksum computed with its field set to spaces.      */
+    chk_sum = 0u;
+    for (i = 0u; i < FTPs_TAR_BLK_SIZE; i++) {
+        chk_sum += p_hdr[i];
+    }
+    FTPs_TarOctFmt(&p_hdr[FTPs_TAR_HDR_CHKSUM], 7u, chk_sum);
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_TarOctFmt()
+*
+* Description : Format a ustar header numeric field.
+*
+* Argument(s) : p_field     Pointer to the field.
+*
+*               len         Length of the field, including its terminating NULL character.
+*
+*               val         Value to format.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_TarHdrFmt().
+*
+* Note(s)     : (1) The value is formatted in octal, zero-padded on the left.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_TAR_EN == DEF_ENABLED)
+static  void  FTPs_TarOctFmt (CPU_INT08U  *p_field,
+                              CPU_SIZE_T   len,
+                              CPU_INT32U   val)
+{
+    CPU_SIZE_T  i;
+
+
+    p_field[len - 1u] = (CPU_INT08U)0;
+    i = len - 1u;
+    while (i > 0u) {
+        i--;
+        p_field[i] = (CPU_INT08U)('0' + (val & 7u));
+        val      >>= 3u;
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_TarTimeGet()
+*
+* Description : Convert a file system date/time to a ustar modification time.
+*
+* Argument(s) : p_time      Pointer to the date/time.
+*
+* Return(s)   : Nbr of seconds since 1970-01-01 00:00:00, if the date is valid.
+*
+*               0,                                        otherwise.
+*
+* Caller(s)   : FTPs_TarHdrFmt().
+*
+* Note(s)     : (1) The number of days is computed from a year starting in March, so that February, the only
+*                   month of variable length, is the last month of the year.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_TAR_EN == DEF_ENABLED)
+static  CPU_INT32U  FTPs_TarTimeGet (NET_FS_DATE_TIME  *p_time)
+{
+    CPU_INT32U  yr;
+    CPU_INT32U  month;
+    CPU_INT32U  days;
+
+
+    if ((p_time->Yr    <  1970u) ||
+        (p_time->Month <     1u) ||
+        (p_time->Month >    12u) ||
+        (p_time->Day   <     1u)) {
+        return (0u);
+    }
+
+    yr    = p_time->Yr;                                         /* See Note #1.                                         */
+    month = p_time->Month;
+    if (month <= 2u) {
+        yr--;
+        month += 12u;
+    }
+    days = (365u * yr) + (yr / 4u) - (yr / 100u) + (yr / 400u)
+         + (((153u * (month - 3u)) + 2u) / 5u)
+         + (p_time->Day - 1u)
+         -  719468u;                                            /* Days from 0000-03-01 to 1970-01-01.                  */
+
+    return ((days * 86400u) + (p_time->Hr * 3600u) + (p_time->Min * 60u) + p_time->Sec);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                             FTPs_TarWr()
+*
+* Description : Append octets to the tar archive being sent.
+*
+* Argument(s) : p_tar       Pointer to the archive state.
+*
+*               p_data      Pointer to the octets to append, or NULL to append zeros.
+*
+*               len         Nbr of octets to append.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function.
+*
+* Return(s)   : DEF_OK,   octets appended.
+*
+*               DEF_FAIL, data connection error.
+*
+* Caller(s)   : FTPs_TarTx(),
+*               FTPs_TarEntryTx().
+*
+* Note(s)     : (1) The transmit buffer is sent when full, so the archive goes out in full-sized segments.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_TAR_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_TarWr (FTPs_TAR    *p_tar,
+                                 CPU_INT08U  *p_data,
+                                 CPU_INT32U   len,
+                                 NET_ERR     *p_err)
+{
+    CPU_SIZE_T   chunk_len;
+    CPU_BOOLEAN  rtn_val;
+
+
+    while (len > 0u) {
+        if (p_tar->BufLen == FTPs_NET_BUF_LEN) {                /* See Note #1.                                         */
+            rtn_val = FTPs_TarFlush(p_tar, p_err);
+            if (rtn_val != DEF_OK) {
+                return (DEF_FAIL);
+            }
+        }
+        chunk_len = DEF_MIN(len, FTPs_NET_BUF_LEN - p_tar->BufLen);
+        if (p_data != (CPU_INT08U *)0) {
+            Mem_Copy(&p_tar->BufPtr[p_tar->BufLen], p_data, chunk_len);
+            p_data += chunk_len;
+        } else {
+            Mem_Clr(&p_tar->BufPtr[p_tar->BufLen], chunk_len);
+        }
+        p_tar->BufLen += chunk_len;
+        len           -= chunk_len;
+    }
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_TarFlush()
+*
+* Description : Send the transmit buffer of the tar archive being sent.
+*
+* Argument(s) : p_tar       Pointer to the archive state.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function.
+*
+* Return(s)   : DEF_OK,   buffer sent or skipped.
+*
+*               DEF_FAIL, data connection error.
+*
+* Caller(s)   : FTPs_TarTx(),
+*               FTPs_TarEntryTx(),
+*               FTPs_TarWr().
+*
+* Note(s)     : (1) Octets before the REST offset are dropped (see FTPs_TarTx() Note #3).
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_TAR_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_TarFlush (FTPs_TAR  *p_tar,
+                                    NET_ERR   *p_err)
+{
+    CPU_CHAR    *p_tx;
+    CPU_SIZE_T   tx_len;
+    CPU_SIZE_T   skip_len;
+
+
+    p_tx          = p_tar->BufPtr;
+    tx_len        = p_tar->BufLen;
+    p_tar->BufLen = 0u;
+
+    skip_len      = DEF_MIN(p_tar->Skip, tx_len);               /* See Note #1.                                         */
+    p_tar->Skip  -= skip_len;
+    p_tx         += skip_len;
+    tx_len       -= skip_len;
+    if (tx_len == 0u) {
+        return (DEF_OK);
+    }
+
+    FTPs_Tx(p_tar->SockID, p_tx, (CPU_INT16U)tx_len, p_err);
+    if (*p_err != NET_SOCK_ERR_NONE) {
+        FTPs_TRACE_DBG(("FTPs FTPs_Tx() failed: error #%u, line #%u.\n", (unsigned int)*p_err, (unsigned int)__LINE__));
+        return (DEF_FAIL);
+    }
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            FTPs_TarRx()
+*
+* Description : Extract the tar archive received on the data connection into the directory selected by
+*               FTPs_TarStart().
+*
+* Argument(s) : sock_id     Data connection socket id.
+*
+*               p_buf       Pointer to the receive buffer (FTPs_NET_BUF_LEN octets).
+*
+*               p_err       Pointer to variable that will receive the return error code from this function.
+*
+* Return(s)   : DEF_OK,   archive extracted.
+*
+*               DEF_FAIL, data connection error, invalid or truncated archive, or file write error.
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) The archive is extracted while it is received: no temporary file is written.  The numbers
+*                   of files & directories extracted & of entries skipped are left in FTPs_Tar for the reply.
+*
+*               (2) Like for STOR, a receive timeout or the close of the connection ends the transfer.  Data
+*                   following the end-of-archive blocks is received & ignored.
+*
+*               (3) A file whose data is incomplete when the transfer ends is deleted.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_TAR_EXTRACT_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_TarRx (CPU_INT32S   sock_id,
+                                 CPU_CHAR    *p_buf,
+                                 NET_ERR     *p_err)
+{
+    FTPs_TAR     *p_tar;
+    CPU_INT16S    net_len;
+    CPU_BOOLEAN   rtn_val;
+
+
+    p_tar           = &FTPs_Tar;
+    p_tar->TopLen   =  Str_Len(p_tar->Path);
+    p_tar->HdrLen   =  0u;
+    p_tar->FilePtr  = (void *)0;
+    p_tar->Rem      =  0u;
+    p_tar->Pad      =  0u;
+    p_tar->NbrFile  =  0u;
+    p_tar->NbrDir   =  0u;
+    p_tar->NbrSkip  =  0u;
+    p_tar->PaxLen   =  0u;
+    p_tar->PaxRx    =  DEF_NO;
+    p_tar->SkipNext =  DEF_NO;
+    p_tar->End      =  DEF_NO;
+    p_tar->WrErr    =  DEF_NO;
+
+    NetSock_CfgTimeoutRxQ_Set((NET_SOCK_ID  )sock_id,
+                              (CPU_INT32U   )FTPs_DTP_RX_SLICE_MS,
+                              (NET_ERR     *)p_err);
+
+    rtn_val = DEF_OK;
+    while (rtn_val == DEF_OK) {
+        net_len = FTPs_Rx(sock_id, p_buf, FTPs_NET_BUF_LEN, p_err);
+        if ((*p_err == NET_SOCK_ERR_RX_Q_CLOSED) ||             /* End of transfer (see Note #2).                       */
+            (*p_err == NET_SOCK_ERR_RX_Q_EMPTY)) {
+            *p_err = NET_SOCK_ERR_NONE;
+            break;
+        }
+        if (*p_err != NET_SOCK_ERR_NONE) {
+            FTPs_TRACE_DBG(("FTPs FTPs_Rx() failed: error #%u, line #%u.\n", (unsigned int)*p_err, (unsigned int)__LINE__));
+            rtn_val = DEF_FAIL;
+            break;
+        }
+        rtn_val = FTPs_TarRxData(p_tar, (CPU_INT08U *)p_buf, (CPU_SIZE_T)net_len);
+    }
+
+    if (p_tar->FilePtr != (void *)0) {                          /* See Note #3.                                         */
+        NetFS_FileClose(p_tar->FilePtr);
+        p_tar->FilePtr = (void *)0;
+       (void)NetFS_EntryDel(p_tar->Path, DEF_YES);
+        FTPs_InvalidatePath(p_tar->Path);
+    }
+
+    if (p_tar->End == DEF_NO) {                                 /* Archive truncated: no end-of-archive block.          */
+        rtn_val = DEF_FAIL;
+    }
+
+    return (rtn_val);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_TarRxData()
+*
+* Description : Process a chunk of the tar archive being received.
+*
+* Argument(s) : p_tar       Pointer to the archive state.
+*
+*               p_data      Pointer to the received octets.
+*
+*               len         Number of received octets.
+*
+* Return(s)   : DEF_OK,   chunk processed.
+*
+*               DEF_FAIL, invalid header or file write error.
+*
+* Caller(s)   : FTPs_TarRx().
+*
+* Note(s)     : (1) Each entry is a header block, followed by the entry data padded to a whole block.  Chunks
+*                   are not aligned on blocks: a header may be received in several chunks.
+*
+*               (2) The data of a pax extended header is kept in 'RxName' to find out if it overrides the path
+*                   of the next entry (see FTPs_TarHdrRx() Note #2).
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_TAR_EXTRACT_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_TarRxData (FTPs_TAR    *p_tar,
+                                     CPU_INT08U  *p_data,
+                                     CPU_SIZE_T   len)
+{
+    CPU_CHAR     *p_path;
+    CPU_SIZE_T    chunk_len;
+    CPU_SIZE_T    wr_len;
+    CPU_BOOLEAN   rtn_val;
+
+
+    while ((len        >  0u) &&
+           (p_tar->End == DEF_NO)) {
+        if (p_tar->Rem > 0u) {                                  /* Entry data.                                          */
+            chunk_len = DEF_MIN(len, p_tar->Rem);
+            if (p_tar->FilePtr != (void *)0) {
+                (void)NetFS_FileWr((void       *) p_tar->FilePtr,
+                                   (void       *) p_data,
+                                   (CPU_SIZE_T  ) chunk_len,
+                                   (CPU_SIZE_T *)&wr_len);
+                if (wr_len != chunk_len) {
+                    FTPs_TRACE_DBG(("FTPs NetFS_FileWr() failed: line #%u.\n", (unsigned int)__LINE__));
+                    p_tar->WrErr = DEF_YES;
+                    return (DEF_FAIL);
+                }
+            } else if (p_tar->PaxRx == DEF_YES) {               /* See Note #2.                                         */
+                wr_len = DEF_MIN(chunk_len, sizeof(p_tar->RxName) - 1u - p_tar->PaxLen);
+                Mem_Copy(&p_tar->RxName[p_tar->PaxLen], p_data, wr_len);
+                p_tar->PaxLen += wr_len;
+            }
+            p_tar->Rem -= chunk_len;
+
+        } else if (p_tar->Pad > 0u) {                           /* Entry data padding.                                  */
+            chunk_len   = DEF_MIN(len, p_tar->Pad);
+            p_tar->Pad -= chunk_len;
+
+        } else {                                                /* Header (see Note #1).                                */
+            chunk_len = DEF_MIN(len, FTPs_TAR_BLK_SIZE - p_tar->HdrLen);
+            Mem_Copy(&p_tar->Hdr[p_tar->HdrLen], p_data, chunk_len);
+            p_tar->HdrLen += chunk_len;
+            if (p_tar->HdrLen == FTPs_TAR_BLK_SIZE) {
+                p_tar->HdrLen = 0u;
+                rtn_val       = FTPs_TarHdrRx(p_tar);
+                if (rtn_val != DEF_OK) {
+                    return (DEF_FAIL);
+                }
+            }
+        }
+
+        if ((p_tar->Rem     == 0u) &&                           /* File complete.                                       */
+            (p_tar->FilePtr != (void *)0)) {
+            NetFS_FileClose(p_tar->FilePtr);
+            p_tar->FilePtr = (void *)0;
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+            FTPs_PinReload(p_tar->Path);                        /* Re-read overwritten pinned file.                     */
+#endif
+            p_tar->NbrFile++;
+        }
+
+        if ((p_tar->Rem   == 0u) &&                             /* pax header data complete (see Note #2).              */
+            (p_tar->PaxRx == DEF_YES)) {
+            p_tar->PaxRx                 =  DEF_NO;
+            p_tar->RxName[p_tar->PaxLen] = (CPU_CHAR)0;
+            p_path = Str_Str(p_tar->RxName, (CPU_CHAR *)" path=");
+            if ((p_path        != (CPU_CHAR *)0) ||
+                (p_tar->PaxLen == sizeof(p_tar->RxName) - 1u)) {
+                p_tar->SkipNext = DEF_YES;
+            }
+        }
+
+        p_data += chunk_len;
+        len    -= chunk_len;
+    }
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_TarHdrRx()
+*
+* Description : Process a received header block & create the entry it describes.
+*
+* Argument(s) : p_tar       Pointer to the archive state.
+*
+* Return(s)   : DEF_OK,   header processed.
+*
+*               DEF_FAIL, invalid header.
+*
+* Caller(s)   : FTPs_TarRxData().
+*
+* Note(s)     : (1) A block of zeros marks the end of the archive.
+*
+*               (2) Only regular files & directories are extracted.  Links, devices & FIFOs are skipped, as
+*                   well as entries whose name is unsafe (see FTPs_TarPathGet()).  The entry following a GNU
+*                   long name header, or a pax extended header holding a path, is skipped too, since its own
+*                   name is truncated.  Other pax attributes & global pax headers are ignored.
+*
+*               (3) Missing parent directories of an entry are created.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_TAR_EXTRACT_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_TarHdrRx (FTPs_TAR  *p_tar)
+{
+    CPU_INT08U   *p_hdr;
+    CPU_CHAR     *p_sep;
+    void         *p_file;
+    CPU_SIZE_T    path_len;
+    CPU_SIZE_T    i;
+    CPU_INT32U    chk_sum;
+    CPU_INT32U    chk_val;
+    CPU_INT32U    size;
+    CPU_BOOLEAN   valid;
+    CPU_BOOLEAN   rtn_val;
+    CPU_INT08U    type;
+
+
+    p_hdr   = p_tar->Hdr;
+    chk_sum = 0u;
+    for (i = 0u; i < FTPs_TAR_BLK_SIZE; i++) {
+        chk_sum += p_hdr[i];
+    }
+    if (chk_sum == 0u) {                                        /* See Note #1.                                         */
+        p_tar->End = DEF_YES;
+        return (DEF_OK);
+    }
+    for (i = 0u; i < 8u; i++) {                                 /* Checksum computed with its field set to spaces.      */
+        chk_sum -= p_hdr[FTPs_TAR_HDR_CHKSUM + i];
+        chk_sum += (CPU_INT32U)' ';
+    }
+    valid = FTPs_TarOctParse(&p_hdr[FTPs_TAR_HDR_CHKSUM], 8u, &chk_val);
+    if ((valid   == DEF_NO) ||
+        (chk_val != chk_sum)) {
+        FTPs_TRACE_DBG(("FTPs tar: invalid header checksum: line #%u.\n", (unsigned int)__LINE__));
+        return (DEF_FAIL);
+    }
+    valid = FTPs_TarOctParse(&p_hdr[FTPs_TAR_HDR_SIZE], 12u, &size);
+    if (valid == DEF_NO) {
+        FTPs_TRACE_DBG(("FTPs tar: invalid entry size: line #%u.\n", (unsigned int)__LINE__));
+        return (DEF_FAIL);
+    }
+
+    p_tar->Rem = size;                                          /* Data skipped unless a file is opened.                */
+    p_tar->Pad = (FTPs_TAR_BLK_SIZE - (size % FTPs_TAR_BLK_SIZE)) % FTPs_TAR_BLK_SIZE;
+
+    if (p_tar->SkipNext == DEF_YES) {                           /* See Note #2.                                         */
+        p_tar->SkipNext = DEF_NO;
+        p_tar->NbrSkip++;
+        return (DEF_OK);
+    }
+
+    type = p_hdr[FTPs_TAR_HDR_TYPE];
+    switch (type) {
+        case '0':                                               /* Regular file.                                        */
+        case '7':
+        case '\0':
+        case '5':                                               /* Dir.                                                 */
+             break;
+
+
+        case 'L':                                               /* GNU long name (see Note #2).                         */
+        case 'K':
+             p_tar->SkipNext = DEF_YES;
+             return (DEF_OK);
+
+
+        case 'x':                                               /* pax extended header (see Note #2).                   */
+             p_tar->PaxLen = 0u;
+             p_tar->PaxRx  = DEF_YES;
+             return (DEF_OK);
+
+
+        case 'g':
+             return (DEF_OK);
+
+
+        default:
+             p_tar->NbrSkip++;
+             return (DEF_OK);
+    }
+
+    path_len = FTPs_TarPathGet(p_tar);
+    if (path_len == 0u) {
+        FTPs_TRACE_DBG(("FTPs tar: unsafe name, entry skipped: line #%u.\n", (unsigned int)__LINE__));
+        p_tar->NbrSkip++;
+        return (DEF_OK);
+    }
+
+    if (type == '5') {
+        if (path_len == p_tar->TopLen) {                        /* Target dir itself.                                   */
+            return (DEF_OK);
+        }
+        rtn_val = FTPs_TarDirMk(p_tar, path_len);
+        if (rtn_val == DEF_OK) {
+            p_tar->NbrDir++;
+        } else {
+            p_tar->NbrSkip++;
+        }
+        return (DEF_OK);
+    }
+
+    if (path_len == p_tar->TopLen) {
+        p_tar->NbrSkip++;
+        return (DEF_OK);
+    }
+
+    FTPs_HandleClose(p_tar->Path);
+    FTPs_InvalidatePath(p_tar->Path);
+    p_file = NetFS_FileOpen(p_tar->Path,
+                            NET_FS_FILE_MODE_CREATE,
+                            NET_FS_FILE_ACCESS_WR);
+    if (p_file == (void *)0) {                                  /* See Note #3.                                         */
+        p_sep   = Str_Char_Last(&p_tar->Path[p_tar->TopLen], FTPs_FS_SepChar);
+        rtn_val = FTPs_TarDirMk(p_tar, (CPU_SIZE_T)(p_sep - &p_tar->Path[0]));
+        if (rtn_val == DEF_OK) {
+            p_file = NetFS_FileOpen(p_tar->Path,
+                                    NET_FS_FILE_MODE_CREATE,
+                                    NET_FS_FILE_ACCESS_WR);
+        }
+    }
+    if (p_file == (void *)0) {
+        FTPs_TRACE_DBG(("FTPs tar: file not created, entry skipped: line #%u.\n", (unsigned int)__LINE__));
+        p_tar->NbrSkip++;
+        return (DEF_OK);
+    }
+    p_tar->FilePtr = p_file;
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_TarPathGet()
+*
+* Description : Build the FS path of the entry described by the received header.
+*
+* Argument(s) : p_tar       Pointer to the archive state.
+*
+* Return(s)   : Length of the path built in 'Path', if the entry name is safe.
+*
+*               0,                                  otherwise.
+*
+* Caller(s)   : FTPs_TarHdrRx().
+*
+* Note(s)     : (1) The entry is always extracted below the target directory, which is itself inside the
+*                   session base path (see FTPs_BuildPath()).  Its name is checked component by component:
+*
+*                   (a) Empty & "." components are ignored, so absolute names are extracted relative to the
+*                       target directory.
+*                   (b) A ".." component, a FS separator or a control character in a component makes the
+*                       name unsafe.
+*
+*               (2) A leading component equal to the target directory name is dropped, so that an archive
+*                   retrieved by "RETR <dirname>.tar" is restored in place by "STOR <dirname>.tar".
+*
+*               (3) An entry that would overwrite a server file is unsafe (see FTPs_PathIsRsvd()).
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_TAR_EXTRACT_EN == DEF_ENABLED)
+static  CPU_SIZE_T  FTPs_TarPathGet (FTPs_TAR  *p_tar)
+{
+    CPU_INT08U   *p_hdr;
+    CPU_CHAR     *p_name;
+    CPU_CHAR     *p_comp;
+    CPU_SIZE_T    name_len;
+    CPU_SIZE_T    comp_len;
+    CPU_SIZE_T    path_len;
+    CPU_SIZE_T    top_len;
+    CPU_INT16S    cmp_val;
+    CPU_BOOLEAN   is_ustar;
+    CPU_BOOLEAN   first;
+#if (FTPs_SRV_FILES_EN == DEF_ENABLED)
+    CPU_BOOLEAN   rsvd;
+#endif
+    CPU_INT08U    ch;
+
+
+    p_hdr    = p_tar->Hdr;
+    p_name   = p_tar->RxName;
+    name_len = 0u;
+    is_ustar = Mem_Cmp(&p_hdr[FTPs_TAR_HDR_MAGIC], "ustar", 5u);
+    if ((is_ustar                   == DEF_YES) &&              /* ustar prefix, then name.                             */
+        (p_hdr[FTPs_TAR_HDR_PREFIX] != (CPU_INT08U)0)) {
+        while ((name_len < FTPs_TAR_PREFIX_LEN) &&
+               (p_hdr[FTPs_TAR_HDR_PREFIX + name_len] != (CPU_INT08U)0)) {
+            p_name[name_len] = (CPU_CHAR)p_hdr[FTPs_TAR_HDR_PREFIX + name_len];
+            name_len++;
+        }
+        p_name[name_len++] = '/';
+    }
+    comp_len = 0u;
+    while ((comp_len < FTPs_TAR_NAME_LEN) &&
+           (p_hdr[FTPs_TAR_HDR_NAME + comp_len] != (CPU_INT08U)0)) {
+        p_name[name_len++] = (CPU_CHAR)p_hdr[FTPs_TAR_HDR_NAME + comp_len];
+        comp_len++;
+    }
+    p_name[name_len] = (CPU_CHAR)0;
+
+    top_len  = p_tar->TopLen - p_tar->BaseLen;
+    path_len = p_tar->TopLen;
+    first    = DEF_YES;
+    p_comp   = p_name;
+    while (*p_comp != (CPU_CHAR)0) {
+        comp_len = 0u;                                          /* See Note #1b.                                        */
+        while ((p_comp[comp_len] != (CPU_CHAR)0) &&
+               (p_comp[comp_len] != '/')) {
+            ch = (CPU_INT08U)p_comp[comp_len];                  /* Unsigned: UTF-8 octets >= 0x80 are allowed.          */
+            if ((ch == (CPU_INT08U)FTPs_FS_SepChar) ||
+                (ch <  (CPU_INT08U)' ')) {
+                return (0u);
+            }
+            comp_len++;
+        }
+
+        if ((comp_len == 2u) &&
+            (p_comp[0] == '.') &&
+            (p_comp[1] == '.')) {
+            return (0u);
+        }
+
+        if ((comp_len  >  1u) ||                                /* See Note #1a.                                        */
+           ((comp_len  == 1u) && (p_comp[0] != '.'))) {
+            cmp_val = Str_Cmp_N(p_comp, &p_tar->Path[p_tar->BaseLen], comp_len);
+            if ((first    == DEF_YES) &&                        /* See Note #2.                                         */
+                (comp_len == top_len) &&
+                (cmp_val  == 0)) {
+                first = DEF_NO;
+
+            } else {
+                if ((comp_len                 >= FTPs_CFG_FS_NAME_LEN_MAX) ||
+                    (path_len + comp_len + 1u >= FTPs_CFG_FS_PATH_LEN_MAX)) {
+                    return (0u);
+                }
+                p_tar->Path[path_len] = FTPs_FS_SepChar;
+                Mem_Copy(&p_tar->Path[path_len + 1u], p_comp, comp_len);
+                path_len += comp_len + 1u;
+                first     = DEF_NO;
+            }
+        }
+
+        p_comp += comp_len;
+        if (*p_comp == '/') {
+            p_comp++;
+        }
+    }
+    p_tar->Path[path_len] = (CPU_CHAR)0;
+
+#if (FTPs_SRV_FILES_EN == DEF_ENABLED)
+    rsvd = FTPs_PathIsRsvd(p_tar->Path);                        /* See Note #3.                                         */
+    if (rsvd == DEF_YES) {
+        return (0u);
+    }
+#endif
+
+    return (path_len);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_TarDirMk()
+*
+* Description : Create the missing directories of the path being extracted.
+*
+* Argument(s) : p_tar       Pointer to the archive state.
+*
+*               path_len    Length of the part of 'Path' that MUST be a directory.
+*
+* Return(s)   : DEF_OK,   directories created or already existing.
+*
+*               DEF_FAIL, a directory can't be created or a file is in the way.
+*
+* Caller(s)   : FTPs_TarHdrRx().
+*
+* Note(s)     : (1) Only the components below the target directory are checked.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_TAR_EXTRACT_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_TarDirMk (FTPs_TAR    *p_tar,
+                                    CPU_SIZE_T   path_len)
+{
+    CPU_SIZE_T    i;
+    CPU_BOOLEAN   found;
+    CPU_BOOLEAN   rtn_val;
+    CPU_CHAR      ch;
+
+
+    for (i = p_tar->TopLen + 1u; i <= path_len; i++) {          /* See Note #1.                                         */
+        if ((i              <  path_len) &&
+            (p_tar->Path[i] != FTPs_FS_SepChar)) {
+            continue;
+        }
+        ch             = p_tar->Path[i];
+        p_tar->Path[i] = (CPU_CHAR)0;
+        found          = FTPs_EntryStat(p_tar->Path, &p_tar->Entry);
+        if (found == DEF_NO) {
+            rtn_val = NetFS_EntryCreate(p_tar->Path, DEF_YES);
+            FTPs_InvalidatePath(p_tar->Path);
+        } else if (DEF_BIT_IS_SET(p_tar->Entry.Attrib, NET_FS_ENTRY_ATTRIB_DIR) == DEF_YES) {
+            rtn_val = DEF_OK;
+        } else {
+            rtn_val = DEF_FAIL;
+        }
+        p_tar->Path[i] = ch;
+        if (rtn_val != DEF_OK) {
+            return (DEF_FAIL);
+        }
+    }
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_TarOctParse()
+*
+* Description : Parse a ustar header numeric field.
+*
+* Argument(s) : p_field     Pointer to the field.
+*
+*               len         Length of the field.
+*
+*               p_val       Pointer to variable that will receive the value.
+*
+* Return(s)   : DEF_YES, if the field is a valid octal number.
+*
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : FTPs_TarHdrRx().
+*
+* Note(s)     : (1) The octal digits may be preceded by spaces & followed by a space or a NULL character.
+*                   Base-256 values (sizes above 8 GB) & values that don't fit 32 bits are invalid.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_TAR_EXTRACT_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_TarOctParse (CPU_INT08U  *p_field,
+                                       CPU_SIZE_T   len,
+                                       CPU_INT32U  *p_val)
+{
+    CPU_SIZE_T  i;
+    CPU_INT32U  val;
+
+
+    i   = 0u;
+    val = 0u;
+    while ((i          <  len) &&
+           (p_field[i] == (CPU_INT08U)' ')) {
+        i++;
+    }
+    while ((i          <  len) &&
+           (p_field[i] >= (CPU_INT08U)'0') &&
+           (p_field[i] <= (CPU_INT08U)'7')) {
+        if (val > (DEF_INT_32U_MAX_VAL >> 3u)) {
+            return (DEF_NO);
+        }
+        val = (val << 3u) | (CPU_INT32U)(p_field[i] - (CPU_INT08U)'0');
+        i++;
+    }
+    if ((i          <  len) &&
+        (p_field[i] != (CPU_INT08U)0) &&
+        (p_field[i] != (CPU_INT08U)' ')) {
+        return (DEF_NO);
+    }
+
+    *p_val = val;
+
+    return (DEF_YES);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_DeltaStart()
+*
+* Description : Determine if a RETR or STOR path names the signature or the delta of a file.
+*
+* Argument(s) : path        FS absolute path of the entry to retrieve or store.
+*
+*               p_ext       Suffix naming a signature (RETR) or a delta (STOR).
+*
+*               ext_len     Length of the suffix.
+*
+* Return(s)   : DEF_YES, if the path is a file path followed by the suffix (see Note #1).
+*
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd().
+*
+* Note(s)     : (1) "RETR <filename>.sig" sends the block signature of the file (see FTPs_DeltaSigTx()) &
+*                   "STOR <filename>.delta" rebuilds the file from the received delta (see FTPs_DeltaRx()),
+*                   unless a file of that name exists.  The suffix is case insensitive.
+*
+*               (2) On return, the path & size of the file are in FTPs_Delta & FTPs_Delta.En is set.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_DELTA_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_DeltaStart (CPU_CHAR    *path,
+                                      CPU_CHAR    *p_ext,
+                                      CPU_SIZE_T   ext_len)
+{
+    FTPs_DELTA    *p_delta;
+    NET_FS_ENTRY   dirent;
+    CPU_SIZE_T     path_len;
+    CPU_INT16S     cmp_val;
+    CPU_BOOLEAN    found;
+
+
+    p_delta  = &FTPs_Delta;
+    path_len =  Str_Len(path);
+    if ((path_len <= ext_len) ||
+        (path_len >= FTPs_CFG_FS_PATH_LEN_MAX)) {               /* File path MUST fit p_delta->Path.                    */
+        return (DEF_NO);
+    }
+    cmp_val = Str_CmpIgnoreCase_N(&path[path_len - ext_len], p_ext, ext_len);
+    if ((cmp_val                        != 0) ||
+        (path[path_len - ext_len - 1u] == FTPs_FS_SepChar)) {
+        return (DEF_NO);
+    }
+
+    found = FTPs_EntryStat(path, &dirent);
+    if (found == DEF_YES) {                                     /* Existing file transferred as is (see Note #1).       */
+        return (DEF_NO);
+    }
+
+    Str_Copy_N(p_delta->Path, path, FTPs_CFG_FS_PATH_LEN_MAX);
+    p_delta->Path[path_len - ext_len] = (CPU_CHAR)0;
+    found = FTPs_EntryStat(p_delta->Path, &dirent);
+    if ((found == DEF_NO) ||
+        (DEF_BIT_IS_SET(dirent.Attrib, NET_FS_ENTRY_ATTRIB_DIR) == DEF_YES)) {
+        return (DEF_NO);
+    }
+
+    p_delta->SrcSize = dirent.Size;
+    p_delta->En      = DEF_YES;
+
+    return (DEF_YES);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_DeltaSigTx()
+*
+* Description : Send the block signature of the file selected by FTPs_DeltaStart() on the data connection.
+*
+* Argument(s) : sock_id     Data connection socket id.
+*
+*               p_buf       Pointer to the transmit buffer (FTPs_NET_BUF_LEN octets).
+*
+*               p_err       Pointer to variable that will receive the return error code from this function.
+*
+* Return(s)   : DEF_OK,   signature sent.
+*
+*               DEF_FAIL, file can't be read or data connection error.
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) The signature is a header followed by one record per block of FTPs_CFG_DELTA_BLK_SIZE
+*                   octets of the file (the last block may be shorter).  All values are big-endian.
+*
+*                   (a) Header :  "FSIG", block size (32 bits), file size (32 bits).
+*                   (b) Record :  weak checksum of the block (32 bits, see FTPs_DeltaWeakGet()), SHA-256
+*                                 digest of the block (32 octets).
+*
+*               (2) The client finds the unchanged blocks by rolling the weak checksum over its new file &
+*                   confirming each match with the SHA-256 digest, then sends a delta (see FTPs_DeltaRx()).
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_DELTA_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_DeltaSigTx (CPU_INT32S   sock_id,
+                                      CPU_CHAR    *p_buf,
+                                      NET_ERR     *p_err)
+{
+    FTPs_DELTA   *p_delta;
+    FTPs_SHA256   sha;
+    void         *p_file;
+    CPU_INT08U   *p_rec;
+    CPU_SIZE_T    buf_len;
+    CPU_SIZE_T    blk_len;
+    CPU_SIZE_T    rd_len;
+    CPU_INT32U    weak;
+
+
+   *p_err   =  NET_SOCK_ERR_NONE;
+    p_delta = &FTPs_Delta;
+    p_file  =  FTPs_FileOpenRd(p_delta->Path);
+    if (p_file == (void *)0) {
+        return (DEF_FAIL);
+    }
+
+    p_rec = (CPU_INT08U *)p_buf;                                /* See Note #1a.                                        */
+    Mem_Copy(p_rec, FTPs_DELTA_SIG_MAGIC, 4u);
+    MEM_VAL_SET_INT32U_BIG(&p_rec[4], FTPs_CFG_DELTA_BLK_SIZE);
+    MEM_VAL_SET_INT32U_BIG(&p_rec[8], p_delta->SrcSize);
+    buf_len = FTPs_DELTA_HDR_LEN;
+
+    while (DEF_TRUE) {
+        blk_len = 0u;                                           /* Rd one whole block.                                  */
+        do {
+            (void)NetFS_FileRd((void       *)p_file,
+                               (void       *)&FTPs_DeltaBufPtr[blk_len],
+                               (CPU_SIZE_T  )(FTPs_CFG_DELTA_BLK_SIZE - blk_len),
+                               (CPU_SIZE_T *)&rd_len);
+            blk_len += rd_len;
+        } while ((rd_len  >  0u) &&
+                 (blk_len <  FTPs_CFG_DELTA_BLK_SIZE));
+        if (blk_len == 0u) {
+            break;
+        }
+
+        if (buf_len + FTPs_DELTA_SIG_REC_LEN > FTPs_NET_BUF_LEN) {
+            FTPs_Tx(sock_id, p_buf, (CPU_INT16U)buf_len, p_err);
+            if (*p_err != NET_SOCK_ERR_NONE) {
+                break;
+            }
+            buf_len = 0u;
+        }
+
+        weak  = FTPs_DeltaWeakGet(FTPs_DeltaBufPtr, blk_len);   /* See Note #1b.                                        */
+        p_rec = (CPU_INT08U *)&p_buf[buf_len];
+        MEM_VAL_SET_INT32U_BIG(p_rec, weak);
+        FTPs_Sha256Init(&sha);
+        FTPs_Sha256Upd(&sha, FTPs_DeltaBufPtr, blk_len);
+        FTPs_Sha256Final(&sha, &p_rec[4]);
+        buf_len += FTPs_DELTA_SIG_REC_LEN;
+    }
+    FTPs_FileCloseRd(p_file);
+
+    if ((*p_err   == NET_SOCK_ERR_NONE) &&
+        ( buf_len >  0u)) {
+        FTPs_Tx(sock_id, p_buf, (CPU_INT16U)buf_len, p_err);
+    }
+    if (*p_err != NET_SOCK_ERR_NONE) {
+        FTPs_TRACE_DBG(("FTPs FTPs_Tx() failed: error #%u, line #%u.\n", (unsigned int)*p_err, (unsigned int)__LINE__));
+        return (DEF_FAIL);
+    }
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            FTPs_DeltaRx()
+*
+* Description : Rebuild the file selected by FTPs_DeltaStart() from the delta received on the data connection.
+*
+* Argument(s) : sock_id     Data connection socket id.
+*
+*               p_buf       Pointer to the receive buffer (FTPs_NET_BUF_LEN octets).
+*
+*               p_err       Pointer to variable that will receive the return error code from this function.
+*
+* Return(s)   : DEF_OK,   file rebuilt.
+*
+*               DEF_FAIL, otherwise; the cause is left in FTPs_Delta.Err.
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) The delta is a header followed by a sequence of operations.  All values are big-endian.
+*
+*                   (a) Header :  "FDLT", block size (32 bits), size of the file the signature was computed
+*                                 from (32 bits).  Both MUST match the current file.
+*                   (b) COPY   :  0x01, first block index (32 bits), number of blocks (32 bits); copies the
+*                                 blocks from the current file.
+*                   (c) DATA   :  0x02, length (32 bits), followed by that many literal octets.
+*                   (d) END    :  0x00; MUST be the last operation.
+*
+*               (2) The new file is written to a temporary file next to the current one, which is replaced
+*                   only once the END operation is received.  The current file is left unchanged otherwise.
+*
+*               (3) Like for STOR, a receive timeout or the close of the connection ends the transfer.
+*
+*               (4) The current file is replaced by FTPs_FileReplace(), so that it is never lost.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_DELTA_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_DeltaRx (CPU_INT32S   sock_id,
+                                   CPU_CHAR    *p_buf,
+                                   NET_ERR     *p_err)
+{
+    FTPs_DELTA   *p_delta;
+    CPU_SIZE_T    path_len;
+    CPU_INT16S    net_len;
+    CPU_BOOLEAN   rtn_val;
+
+
+   *p_err            =  NET_SOCK_ERR_NONE;
+    p_delta          = &FTPs_Delta;
+    p_delta->OpLen   =  0u;
+    p_delta->OpNeed  =  FTPs_DELTA_HDR_LEN;
+    p_delta->Rem     =  0u;
+    p_delta->NbrCopy =  0u;
+    p_delta->NbrData =  0u;
+    p_delta->HdrRx   =  DEF_NO;
+    p_delta->End     =  DEF_NO;
+    p_delta->Err     =  FTPs_DELTA_ERR_WR;
+
+    path_len = Str_Len(p_delta->Path);                          /* See Note #2.                                         */
+    if (path_len + FTPs_DELTA_TMP_EXT_LEN >= FTPs_CFG_FS_PATH_LEN_MAX) {
+        return (DEF_FAIL);
+    }
+    Str_Copy_N(p_delta->TmpPath, p_delta->Path, FTPs_CFG_FS_PATH_LEN_MAX);
+    Str_Cat(p_delta->TmpPath, FTPs_DELTA_TMP_EXT_STR);
+
+    FTPs_HandleClose(p_delta->Path);
+    p_delta->SrcFilePtr = NetFS_FileOpen(p_delta->Path,
+                                         NET_FS_FILE_MODE_OPEN,
+                                         NET_FS_FILE_ACCESS_RD);
+    if (p_delta->SrcFilePtr == (void *)0) {
+        return (DEF_FAIL);
+    }
+    FTPs_HandleClose(p_delta->TmpPath);
+    p_delta->DstFilePtr = NetFS_FileOpen(p_delta->TmpPath,
+                                         NET_FS_FILE_MODE_CREATE,
+                                         NET_FS_FILE_ACCESS_WR);
+    if (p_delta->DstFilePtr == (void *)0) {
+        NetFS_FileClose(p_delta->SrcFilePtr);
+        return (DEF_FAIL);
+    }
+
+    NetSock_CfgTimeoutRxQ_Set((NET_SOCK_ID  )sock_id,
+                              (CPU_INT32U   )FTPs_DTP_RX_SLICE_MS,
+                              (NET_ERR     *)p_err);
+
+    p_delta->Err = FTPs_DELTA_ERR_NONE;
+    rtn_val      = DEF_OK;
+    while (rtn_val == DEF_OK) {
+        net_len = FTPs_Rx(sock_id, p_buf, FTPs_NET_BUF_LEN, p_err);
+        if ((*p_err == NET_SOCK_ERR_RX_Q_CLOSED) ||             /* End of transfer (see Note #3).                       */
+            (*p_err == NET_SOCK_ERR_RX_Q_EMPTY)) {
+            *p_err = NET_SOCK_ERR_NONE;
+            break;
+        }
+        if (*p_err != NET_SOCK_ERR_NONE) {
+            FTPs_TRACE_DBG(("FTPs FTPs_Rx() failed: error #%u, line #%u.\n", (unsigned int)*p_err, (unsigned int)__LINE__));
+            rtn_val = DEF_FAIL;
+            break;
+        }
+        rtn_val = FTPs_DeltaRxData(p_delta, (CPU_INT08U *)p_buf, (CPU_SIZE_T)net_len);
+    }
+    NetFS_FileClose(p_delta->SrcFilePtr);
+    NetFS_FileClose(p_delta->DstFilePtr);
+
+    if ((rtn_val      == DEF_OK) &&                             /* Delta incomplete.                                    */
+        (p_delta->End == DEF_NO)) {
+        p_delta->Err = FTPs_DELTA_ERR_INVALID;
+        rtn_val      = DEF_FAIL;
+    }
+
+    if (rtn_val != DEF_OK) {                                    /* Current file unchanged (see Note #2).                */
+       (void)NetFS_EntryDel(p_delta->TmpPath, DEF_YES);
+        FTPs_InvalidatePath(p_delta->TmpPath);
+        return (DEF_FAIL);
+    }
+
+    rtn_val = FTPs_FileReplace(p_delta->Path,                   /* See Note #4.                                         */
+                               p_delta->TmpPath);
+    if (rtn_val != DEF_OK) {
+       (void)NetFS_EntryDel(p_delta->TmpPath, DEF_YES);
+    }
+    FTPs_InvalidatePath(p_delta->TmpPath);
+    FTPs_InvalidatePath(p_delta->Path);
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+    FTPs_PinReload(p_delta->Path);                              /* Re-read replaced pinned file.                        */
+#endif
+    if (rtn_val != DEF_OK) {
+        FTPs_TRACE_DBG(("FTPs delta: file not replaced: line #%u.\n", (unsigned int)__LINE__));
+        p_delta->Err = FTPs_DELTA_ERR_REPLACE;
+        return (DEF_FAIL);
+    }
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs_DeltaRxData()
+*
+* Description : Process a chunk of the delta being received.
+*
+* Argument(s) : p_delta     Pointer to the delta state.
+*
+*               p_data      Pointer to the received octets.
+*
+*               len         Number of received octets.
+*
+* Return(s)   : DEF_OK,   chunk processed.
+*
+*               DEF_FAIL, invalid delta or file error.
+*
+* Caller(s)   : FTPs_DeltaRx().
+*
+* Note(s)     : (1) Chunks are not aligned on operations: an operation may be received in several chunks.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_DELTA_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_DeltaRxData (FTPs_DELTA  *p_delta,
+                                       CPU_INT08U  *p_data,
+                                       CPU_SIZE_T   len)
+{
+    CPU_SIZE_T    chunk_len;
+    CPU_SIZE_T    wr_len;
+    CPU_BOOLEAN   rtn_val;
+
+
+    while ((len          >  0u) &&
+           (p_delta->End == DEF_NO)) {
+        if (p_delta->Rem > 0u) {                                /* DATA literal octets.                                 */
+            chunk_len = DEF_MIN(len, p_delta->Rem);
+            (void)NetFS_FileWr((void       *) p_delta->DstFilePtr,
+                               (void       *) p_data,
+                               (CPU_SIZE_T  ) chunk_len,
+                               (CPU_SIZE_T *)&wr_len);
+            if (wr_len != chunk_len) {
+                FTPs_TRACE_DBG(("FTPs NetFS_FileWr() failed: line #%u.\n", (unsigned int)__LINE__));
+                p_delta->Err = FTPs_DELTA_ERR_WR;
+                return (DEF_FAIL);
+            }
+            p_delta->Rem     -= chunk_len;
+            p_delta->NbrData += chunk_len;
+
+        } else {                                                /* Header or operation (see Note #1).                   */
+            chunk_len = DEF_MIN(len, p_delta->OpNeed - p_delta->OpLen);
+            Mem_Copy(&p_delta->Op[p_delta->OpLen], p_data, chunk_len);
+            p_delta->OpLen += chunk_len;
+            if (p_delta->OpLen == p_delta->OpNeed) {
+                rtn_val = FTPs_DeltaOpExec(p_delta);
+                if (rtn_val != DEF_OK) {
+                    return (DEF_FAIL);
+                }
+            }
+        }
+
+        p_data += chunk_len;
+        len    -= chunk_len;
+    }
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs_DeltaOpExec()
+*
+* Description : Execute the received delta header or operation.
+*
+* Argument(s) : p_delta     Pointer to the delta state.
+*
+* Return(s)   : DEF_OK,   header or operation processed.
+*
+*               DEF_FAIL, invalid delta or file error.
+*
+* Caller(s)   : FTPs_DeltaRxData().
+*
+* Note(s)     : (1) See FTPs_DeltaRx() Note #1 for the delta format.  The operation code is received first;
+*                   its arguments are then received as a whole before it is executed.
+*
+*               (2) A COPY MUST stay within the blocks of the current file.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_DELTA_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_DeltaOpExec (FTPs_DELTA  *p_delta)
+{
+    CPU_INT08U   *p_op;
+    CPU_INT32U    blk_size;
+    CPU_INT32U    src_size;
+    CPU_INT32U    blk_ix;
+    CPU_INT32U    blk_nbr;
+    CPU_INT32U    blk_nbr_max;
+    CPU_INT32U    pos;
+    CPU_INT32U    len;
+    CPU_BOOLEAN   valid;
+    CPU_BOOLEAN   rtn_val;
+
+
+    p_op = p_delta->Op;
+    if (p_delta->HdrRx == DEF_NO) {                             /* Header (see FTPs_DeltaRx() Note #1a).                */
+        valid    = Mem_Cmp(p_op, FTPs_DELTA_MAGIC, 4u);
+        blk_size = MEM_VAL_GET_INT32U_BIG(&p_op[4]);
+        src_size = MEM_VAL_GET_INT32U_BIG(&p_op[8]);
+        if ((valid    == DEF_NO) ||
+            (blk_size != FTPs_CFG_DELTA_BLK_SIZE) ||
+            (src_size != p_delta->SrcSize)) {
+            FTPs_TRACE_DBG(("FTPs delta: header mismatch: line #%u.\n", (unsigned int)__LINE__));
+            p_delta->Err = FTPs_DELTA_ERR_INVALID;
+            return (DEF_FAIL);
+        }
+        p_delta->HdrRx  = DEF_YES;
+        p_delta->OpLen  = 0u;
+        p_delta->OpNeed = 1u;
+        return (DEF_OK);
+    }
+
+    switch (p_op[0]) {                                          /* See Note #1.                                         */
+        case FTPs_DELTA_OP_END:
+             p_delta->End = DEF_YES;
+             break;
+
+
+        case FTPs_DELTA_OP_COPY:
+             if (p_delta->OpNeed == 1u) {
+                 p_delta->OpNeed = 9u;
+                 return (DEF_OK);
+             }
+             blk_ix      =  MEM_VAL_GET_INT32U_BIG(&p_op[1]);
+             blk_nbr     =  MEM_VAL_GET_INT32U_BIG(&p_op[5]);
+             blk_nbr_max = (p_delta->SrcSize + FTPs_CFG_DELTA_BLK_SIZE - 1u) / FTPs_CFG_DELTA_BLK_SIZE;
+             if ((blk_nbr == 0u)          ||                    /* See Note #2.                                         */
+                 (blk_ix  >= blk_nbr_max) ||
+                 (blk_nbr >  blk_nbr_max - blk_ix)) {
+                 FTPs_TRACE_DBG(("FTPs delta: COPY out of range: line #%u.\n", (unsigned int)__LINE__));
+                 p_delta->Err = FTPs_DELTA_ERR_INVALID;
+                 return (DEF_FAIL);
+             }
+             pos     = blk_ix * FTPs_CFG_DELTA_BLK_SIZE;
+             len     = DEF_MIN(blk_nbr * FTPs_CFG_DELTA_BLK_SIZE, p_delta->SrcSize - pos);
+             rtn_val = FTPs_DeltaCopy(p_delta, pos, len);
+             if (rtn_val != DEF_OK) {
+                 p_delta->Err = FTPs_DELTA_ERR_WR;
+                 return (DEF_FAIL);
+             }
+             p_delta->NbrCopy += len;
+             break;
+
+
+        case FTPs_DELTA_OP_DATA:
+             if (p_delta->OpNeed == 1u) {
+                 p_delta->OpNeed = 5u;
+                 return (DEF_OK);
+             }
+             p_delta->Rem = MEM_VAL_GET_INT32U_BIG(&p_op[1]);
+             break;
+
+
+        default:
+             FTPs_TRACE_DBG(("FTPs delta: invalid operation: line #%u.\n", (unsigned int)__LINE__));
+             p_delta->Err = FTPs_DELTA_ERR_INVALID;
+             return (DEF_FAIL);
+    }
+
+    p_delta->OpLen  = 0u;
+    p_delta->OpNeed = 1u;
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_DeltaCopy()
+*
+* Description : Copy a range of the current file to the file being rebuilt.
+*
+* Argument(s) : p_delta     Pointer to the delta state.
+*
+*               pos         Position of the range in the current file.
+*
+*               len         Length of the range.
+*
+* Return(s)   : DEF_OK,   range copied.
+*
+*               DEF_FAIL, file read or write error.
+*
+* Caller(s)   : FTPs_DeltaOpExec().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_DELTA_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_DeltaCopy (FTPs_DELTA  *p_delta,
+                                     CPU_INT32U   pos,
+                                     CPU_INT32U   len)
+{
+    CPU_SIZE_T    rd_len;
+    CPU_SIZE_T    wr_len;
+    CPU_BOOLEAN   fs_err;
+
+
+    fs_err = NetFS_FilePosSet(p_delta->SrcFilePtr, pos, NET_FS_SEEK_ORIGIN_START);
+    if (fs_err != DEF_OK) {
+        return (DEF_FAIL);
+    }
+
+    while (len > 0u) {
+        (void)NetFS_FileRd((void       *) p_delta->SrcFilePtr,
+                           (void       *) FTPs_DeltaBufPtr,
+                           (CPU_SIZE_T  ) DEF_MIN(len, FTPs_CFG_DELTA_BLK_SIZE),
+                           (CPU_SIZE_T *)&rd_len);
+        if (rd_len == 0u) {
+            FTPs_TRACE_DBG(("FTPs NetFS_FileRd() failed: line #%u.\n", (unsigned int)__LINE__));
+            return (DEF_FAIL);
+        }
+        (void)NetFS_FileWr((void       *) p_delta->DstFilePtr,
+                           (void       *) FTPs_DeltaBufPtr,
+                           (CPU_SIZE_T  ) rd_len,
+                           (CPU_SIZE_T *)&wr_len);
+        if (wr_len != rd_len) {
+            FTPs_TRACE_DBG(("FTPs NetFS_FileWr() failed: line #%u.\n", (unsigned int)__LINE__));
+            return (DEF_FAIL);
+        }
+        len -= rd_len;
+    }
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs_DeltaWeakGet()
+*
+* Description : Compute the weak (rolling) checksum of a block.
+*
+* Argument(s) : p_data      Pointer to the block.
+*
+*               len         Length of the block.
+*
+* Return(s)   : Weak checksum.
+*
+* Caller(s)   : FTPs_DeltaSigTx().
+*
+* Note(s)     : (1) The checksum is the rsync one: for octets x[0] .. x[len - 1],
+*
+*                       a = sum(x[i])                 modulo 2^16
+*                       b = sum((len - i) * x[i])     modulo 2^16
+*                       checksum = a + (b * 2^16)
+*
+*                   The client updates a & b in constant time when sliding the block by one octet.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_DELTA_EN == DEF_ENABLED)
+static  CPU_INT32U  FTPs_DeltaWeakGet (CPU_INT08U  *p_data,
+                                       CPU_SIZE_T   len)
+{
+    CPU_INT32U  a;
+    CPU_INT32U  b;
+    CPU_SIZE_T  i;
+
+
+    a = 0u;
+    b = 0u;
+    for (i = 0u; i < len; i++) {
+        a += p_data[i];
+        b += a;                                                 /* Adds (len - i) * x[i] once the loop is done.         */
+    }
+
+    return ((a & 0xFFFFu) | ((b & 0xFFFFu) << 16u));
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_DedupIdxAdd()
+*
+* Description : Record the digest of a file in the dedup index file.
+*
+* Argument(s) : path        FS absolute path of the file.
+*
+*               p_digest    Pointer to the SHA-256 digest of the file content.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) The record is written in the first free record of the index file, or appended to it.
+*                   Once the index file holds FTPs_CFG_DEDUP_NBR_MAX records, the digest is not recorded.
+*
+*               (2) The size & date of the file are recorded, to detect a file modified without the server.
+*
+*               (3) A file whose path does NOT fit a record is not recorded, so that SITE DEDUP never copies
+*                   a file named by a truncated path.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+static  void  FTPs_DedupIdxAdd (CPU_CHAR    *path,
+                                CPU_INT08U  *p_digest)
+{
+    FTPs_DEDUP_REC  *p_rec;
+    NET_FS_ENTRY     dirent;
+    void            *p_file;
+    CPU_SIZE_T       path_len;
+    CPU_SIZE_T       rd_len;
+    CPU_SIZE_T       wr_len;
+    CPU_INT32U       ix;
+    CPU_INT32U       ix_free;
+    CPU_BOOLEAN      found;
+
+
+    path_len = Str_Len(path);
+    if (path_len >= FTPs_CFG_FS_PATH_LEN_MAX) {                 /* See Note #3.                                         */
+        return;
+    }
+
+    found = FTPs_EntryStat(path, &dirent);
+    if (found == DEF_NO) {
+        return;
+    }
+
+    p_file = NetFS_FileOpen((CPU_CHAR *)FTPs_CFG_DEDUP_IDX_PATH,
+                                        NET_FS_FILE_MODE_OPEN,
+                                        NET_FS_FILE_ACCESS_RD_WR);
+    if (p_file == (void *)0) {
+        p_file = NetFS_FileOpen((CPU_CHAR *)FTPs_CFG_DEDUP_IDX_PATH,
+                                            NET_FS_FILE_MODE_CREATE,
+                                            NET_FS_FILE_ACCESS_RD_WR);
+        if (p_file == (void *)0) {
+            FTPs_TRACE_DBG(("FTPs NetFS_FileOpen() failed: line #%u.\n", (unsigned int)__LINE__));
+            return;
+        }
+    }
+
+    p_rec   = &FTPs_Dedup.Rec;
+    ix_free =  FTPs_CFG_DEDUP_NBR_MAX;
+    for (ix = 0u; ix < FTPs_CFG_DEDUP_NBR_MAX; ix++) {          /* Find a free record (see Note #1).                    */
+        (void)NetFS_FileRd((void       *) p_file,
+                           (void       *) p_rec,
+                           (CPU_SIZE_T  ) sizeof(FTPs_DEDUP_REC),
+                           (CPU_SIZE_T *)&rd_len);
+        if (rd_len != sizeof(FTPs_DEDUP_REC)) {                 /* End of index file.                                   */
+            break;
+        }
+        if (p_rec->Path[0] == (CPU_CHAR)0) {
+            ix_free = ix;
+            break;
+        }
+    }
+    if (ix_free == FTPs_CFG_DEDUP_NBR_MAX) {
+        ix_free = ix;
+    }
+    if (ix_free >= FTPs_CFG_DEDUP_NBR_MAX) {                    /* Index file full.                                     */
+        NetFS_FileClose(p_file);
+        return;
+    }
+
+    Mem_Copy(p_rec->Digest, p_digest, FTPs_SHA256_LEN);         /* See Note #2.                                         */
+    p_rec->Size     = dirent.Size;
+    p_rec->DateTime = dirent.DateTimeCreate;
+    Str_Copy_N(p_rec->Path, path, FTPs_CFG_FS_PATH_LEN_MAX);
+    FTPs_PathFilterAdd(FTPs_Dedup.Filter, FTPs_DEDUP_FILTER_LEN, path);
+
+    (void)NetFS_FilePosSet(p_file, ix_free * sizeof(FTPs_DEDUP_REC), NET_FS_SEEK_ORIGIN_START);
+    (void)NetFS_FileWr((void       *) p_file,
+                       (void       *) p_rec,
+                       (CPU_SIZE_T  ) sizeof(FTPs_DEDUP_REC),
+                       (CPU_SIZE_T *)&wr_len);
+    if (wr_len != sizeof(FTPs_DEDUP_REC)) {
+        FTPs_TRACE_DBG(("FTPs NetFS_FileWr() failed: line #%u.\n", (unsigned int)__LINE__));
+    }
+    NetFS_FileClose(p_file);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_DedupIdxFind()
+*
+* Description : Search the dedup index file for a file with a given digest.
+*
+* Argument(s) : path        FS absolute path of the file to create.
+*
+*               p_digest    Pointer to the SHA-256 digest of the content.
+*
+*               base_len    Length of the user base path at the beginning of path.
+*
+* Return(s)   : FTPs_DEDUP_SAME,  if path itself has the digest.
+*
+*               FTPs_DEDUP_OTHER, if another file has the digest; its path is copied to FTPs_Dedup.Path.
+*
+*               FTPs_DEDUP_NONE,  otherwise.
+*
+* Caller(s)   : FTPs_SiteDedup().
+*
+* Note(s)     : (1) Only files located under the user base path are searched, so a user can't learn about
+*                   the content of the files of other users.
+*
+*               (2) A file whose size or date changed since it was indexed is ignored & its record is freed.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+static  CPU_INT08U  FTPs_DedupIdxFind (CPU_CHAR    *path,
+                                       CPU_INT08U  *p_digest,
+                                       CPU_SIZE_T   base_len)
+{
+    FTPs_DEDUP_REC  *p_rec;
+    NET_FS_ENTRY     dirent;
+    void            *p_file;
+    CPU_SIZE_T       rd_len;
+    CPU_SIZE_T       wr_len;
+    CPU_INT32U       ix;
+    CPU_INT16S       cmp_val;
+    CPU_BOOLEAN      same;
+    CPU_BOOLEAN      found;
+    CPU_INT08U       result;
+
+
+    p_file = NetFS_FileOpen((CPU_CHAR *)FTPs_CFG_DEDUP_IDX_PATH,
+                                        NET_FS_FILE_MODE_OPEN,
+                                        NET_FS_FILE_ACCESS_RD_WR);
+    if (p_file == (void *)0) {                                  /* No file indexed yet.                                 */
+        return (FTPs_DEDUP_NONE);
+    }
+
+    p_rec  = &FTPs_Dedup.Rec;
+    result =  FTPs_DEDUP_NONE;
+    for (ix = 0u; ix < FTPs_CFG_DEDUP_NBR_MAX; ix++) {
+        (void)NetFS_FileRd((void       *) p_file,
+                           (void       *) p_rec,
+                           (CPU_SIZE_T  ) sizeof(FTPs_DEDUP_REC),
+                           (CPU_SIZE_T *)&rd_len);
+        if (rd_len != sizeof(FTPs_DEDUP_REC)) {
+            break;
+        }
+        if (p_rec->Path[0] == (CPU_CHAR)0) {                    /* Free record.                                         */
+            continue;
+        }
+        same = Mem_Cmp(p_rec->Digest, p_digest, FTPs_SHA256_LEN);
+        if (same == DEF_NO) {
+            continue;
+        }
+        cmp_val = FTPs_FS_NameCmp_N(p_rec->Path, path, base_len);
+        if ((cmp_val               != 0) ||                     /* See Note #1.                                         */
+            (p_rec->Path[base_len] != FTPs_FS_SepChar)) {
+            continue;
+        }
+
+        found = FTPs_EntryStat(p_rec->Path, &dirent);           /* See Note #2.                                         */
+        if (found == DEF_YES) {
+            same = Mem_Cmp(&dirent.DateTimeCreate, &p_rec->DateTime, sizeof(NET_FS_DATE_TIME));
+        }
+        if ((found       == DEF_NO)       ||
+            (same        == DEF_NO)       ||
+            (dirent.Size != p_rec->Size)  ||
+            (DEF_BIT_IS_SET(dirent.Attrib, NET_FS_ENTRY_ATTRIB_DIR) == DEF_YES)) {
+            p_rec->Path[0] = (CPU_CHAR)0;
+            (void)NetFS_FilePosSet(p_file, ix * sizeof(FTPs_DEDUP_REC), NET_FS_SEEK_ORIGIN_START);
+            (void)NetFS_FileWr((void       *) p_file,
+                               (void       *) p_rec,
+                               (CPU_SIZE_T  ) sizeof(FTPs_DEDUP_REC),
+                               (CPU_SIZE_T *)&wr_len);
+            continue;
+        }
+
+        cmp_val = FTPs_FS_NameCmp(p_rec->Path, path);
+        if (cmp_val == 0) {
+            result = FTPs_DEDUP_SAME;
+            break;
+        }
+        if (result == FTPs_DEDUP_NONE) {                        /* Keep searching for path itself.                      */
+            Str_Copy_N(FTPs_Dedup.Path, p_rec->Path, FTPs_CFG_FS_PATH_LEN_MAX);
+            result = FTPs_DEDUP_OTHER;
+        }
+    }
+
+    NetFS_FileClose(p_file);
+
+    return (result);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs_DedupInvalidate()
+*
+* Description : Free the dedup index records of a modified entry.
+*
+* Argument(s) : path        FS absolute path of the modified entry.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_InvalidatePath().
+*
+* Note(s)     : (1) A record is freed if its file is the entry or is located under it (see FTPs_PathMatch()).
+*
+*               (2) The index file is read only if the path filter may hold the entry; it is then rebuilt
+*                   from the records kept (see FTPs_PathFilterAdd()).  The filter is first built by the
+*                   first call.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+static  void  FTPs_DedupInvalidate (CPU_CHAR  *path)
+{
+    FTPs_DEDUP_REC  *p_rec;
+    void            *p_file;
+    CPU_SIZE_T       rd_len;
+    CPU_SIZE_T       wr_len;
+    CPU_INT32U       ix;
+    CPU_BOOLEAN      match;
+
+
+    if (FTPs_Dedup.FilterValid == DEF_YES) {                    /* See Note #2.                                         */
+        match = FTPs_PathFilterChk(FTPs_Dedup.Filter, FTPs_DEDUP_FILTER_LEN, path);
+        if (match == DEF_NO) {
+            return;
+        }
+    }
+    Mem_Clr(FTPs_Dedup.Filter, FTPs_DEDUP_FILTER_LEN);
+    FTPs_Dedup.FilterValid = DEF_YES;
+
+    p_file = NetFS_FileOpen((CPU_CHAR *)FTPs_CFG_DEDUP_IDX_PATH,
+                                        NET_FS_FILE_MODE_OPEN,
+                                        NET_FS_FILE_ACCESS_RD_WR);
+    if (p_file == (void *)0) {                                  /* No file indexed yet.                                 */
+        return;
+    }
+
+    p_rec = &FTPs_Dedup.Rec;
+    for (ix = 0u; ix < FTPs_CFG_DEDUP_NBR_MAX; ix++) {
+        (void)NetFS_FileRd((void       *) p_file,
+                           (void       *) p_rec,
+                           (CPU_SIZE_T  ) sizeof(FTPs_DEDUP_REC),
+                           (CPU_SIZE_T *)&rd_len);
+        if (rd_len != sizeof(FTPs_DEDUP_REC)) {
+            break;
+        }
+        if (p_rec->Path[0] == (CPU_CHAR)0) {
+            continue;
+        }
+        match = FTPs_PathMatch(p_rec->Path, path);              /* See Note #1.                                         */
+        if (match == DEF_YES) {
+            p_rec->Path[0] = (CPU_CHAR)0;
+            (void)NetFS_FilePosSet(p_file, ix * sizeof(FTPs_DEDUP_REC), NET_FS_SEEK_ORIGIN_START);
+            (void)NetFS_FileWr((void       *) p_file,
+                               (void       *) p_rec,
+                               (CPU_SIZE_T  ) sizeof(FTPs_DEDUP_REC),
+                               (CPU_SIZE_T *)&wr_len);
+        } else {
+            FTPs_PathFilterAdd(FTPs_Dedup.Filter, FTPs_DEDUP_FILTER_LEN, p_rec->Path);
+        }
+    }
+
+    NetFS_FileClose(p_file);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       FTPs_DedupDigestParse()
+*
+* Description : Convert a SHA-256 digest from its hexadecimal representation.
+*
+* Argument(s) : p_str       Pointer to the string of 64 hexadecimal digits.
+*
+*               p_digest    Pointer to the buffer that will receive the digest (FTPs_SHA256_LEN octets).
+*
+* Return(s)   : DEF_OK,   if the string is a valid digest.
+*
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_DedupDigestParse (CPU_CHAR    *p_str,
+                                            CPU_INT08U  *p_digest)
+{
+    CPU_SIZE_T  len;
+    CPU_SIZE_T  i;
+    CPU_CHAR    ch;
+    CPU_INT08U  nibble;
+
+
+    len = Str_Len(p_str);
+    if (len != FTPs_SHA256_LEN * 2u) {
+        return (DEF_FAIL);
+    }
+
+    for (i = 0u; i < len; i++) {
+        ch = ASCII_ToLower(p_str[i]);
+        if ((ch >= '0') && (ch <= '9')) {
+            nibble = (CPU_INT08U)(ch - '0');
+        } else if ((ch >= 'a') && (ch <= 'f')) {
+            nibble = (CPU_INT08U)(ch - 'a' + 10);
+        } else {
+            return (DEF_FAIL);
+        }
+        if ((i & 1u) == 0u) {
+            p_digest[i / 2u]  = (CPU_INT08U)(nibble << 4u);
+        } else {
+            p_digest[i / 2u] |=  nibble;
+        }
+    }
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            FTPs_SegsGet()
+*
+* Description : Find the segmented upload of a file.
+*
+* Argument(s) : path        FS absolute path of the file.
+*
+* Return(s)   : Pointer to the segmented upload, if any.
+*
+*               Pointer to NULL,                 otherwise.
+*
+* Caller(s)   : FTPs_SegsStart(),
+*               FTPs_SegsCancel(),
+*               FTPs_SiteSegs().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+static  FTPs_SEGS  *FTPs_SegsGet (CPU_CHAR  *path)
+{
+    FTPs_SEGS   *p_segs;
+    CPU_INT16S   cmp_val;
+    CPU_INT32U   i;
+
+
+    for (i = 0u; i < FTPs_CFG_SEGS_NBR_MAX; i++) {
+        p_segs = &FTPs_SegsTbl[i];
+        if (p_segs->En == DEF_YES) {
+            cmp_val = FTPs_FS_NameCmp(p_segs->Path, path);
+            if (cmp_val == 0) {
+                return (p_segs);
+            }
+        }
+    }
+
+    return ((FTPs_SEGS *)0);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_SegsStart()
+*
+* Description : Check a STOR after "REST <offset>-<end>" & select the segmented upload it belongs to.
+*
+* Argument(s) : path        FS absolute path of the STOR file.
+*
+*               offset      Offset of the first octet of the segment.
+*
+*               len         Number of octets of the segment.
+*
+* Return(s)   : DEF_OK,   if the segment can be received, or if the file is not uploaded in segments.
+*
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd().
+*
+* Note(s)     : (1) The segment MUST be inside the file & MUST NOT overlap octets already received.
+*
+*               (2) A segment NOT adjacent to a range already received needs a free range.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_SegsStart (CPU_CHAR    *path,
+                                     CPU_INT32U   offset,
+                                     CPU_INT32U   len)
+{
+    FTPs_SEGS        *p_segs;
+    FTPs_SEGS_RANGE  *p_range;
+    CPU_INT32U        end;
+    CPU_INT32U        i;
+    CPU_BOOLEAN       adjacent;
+
+
+    p_segs = FTPs_SegsGet(path);
+    if (p_segs == (FTPs_SEGS *)0) {                             /* Plain STOR after REST.                               */
+        return (DEF_OK);
+    }
+
+    end = offset + len;
+    if ((end < offset) ||                                       /* See Note #1.                                         */
+        (end > p_segs->Size)) {
+        return (DEF_FAIL);
+    }
+
+    adjacent = DEF_NO;
+    for (i = 0u; i < p_segs->NbrRange; i++) {
+        p_range = &p_segs->Range[i];
+        if ((offset < p_range->End) &&
+            (end    > p_range->Start)) {
+            return (DEF_FAIL);
+        }
+        if ((offset == p_range->End) ||
+            (end    == p_range->Start)) {
+            adjacent = DEF_YES;
+        }
+    }
+    if ((adjacent         == DEF_NO) &&                         /* See Note #2.                                         */
+        (p_segs->NbrRange >= FTPs_CFG_SEGS_RANGE_MAX)) {
+        return (DEF_FAIL);
+    }
+
+    FTPs_SegsCurPtr = p_segs;
+    p_segs->TS      = NetUtil_TS_Get_ms();                      /* Upload still active (see FTPs_SiteSegs() Note #4).   */
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            FTPs_SegsRx()
+*
+* Description : Receive a segment of a file uploaded in segments & write it at its offset.
+*
+* Argument(s) : sock_id     Data socket ID.
+*
+*               p_buf       Pointer to the buffer used to receive the data (FTPs_NET_BUF_LEN octets).
+*
+*               offset      Offset of the first octet of the segment.
+*
+*               len         Number of octets of the segment.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               NET_SOCK_ERR_NONE       Segment received (completely or not).
+*                               Other                   Data connection error.
+*
+* Return(s)   : FTPs_SEGS_ERR_NONE,       segment stored.
+*
+*               FTPs_SEGS_ERR_INCOMPLETE, segment not completely received: it is NOT recorded.
+*
+*               FTPs_SEGS_ERR_WR,         temporary file not written.
+*
+*               FTPs_SEGS_ERR_REPLACE,    file complete, but not replaced (see FTPs_SegsCommit()).
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) Segments may be received in any order.  When a segment starts after the end of the
+*                   temporary file, the gap is filled with zeros first, since a file system may not allow
+*                   writing beyond the end of a file.  A later segment overwrites them.
+*
+*               (2) The segment is recorded only once all its octets are written, so a failed segment can be
+*                   sent again.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+static  CPU_INT08U  FTPs_SegsRx (CPU_INT32S   sock_id,
+                                 CPU_CHAR    *p_buf,
+                                 CPU_INT32U   offset,
+                                 CPU_INT32U   len,
+                                 NET_ERR     *p_err)
+{
+    FTPs_SEGS    *p_segs;
+    void         *p_file;
+    CPU_INT32U    file_size;
+    CPU_INT32U    rem;
+    CPU_INT16S    net_len;
+    CPU_SIZE_T    wr_len;
+    CPU_SIZE_T    fs_len;
+    CPU_BOOLEAN   fs_err;
+    CPU_BOOLEAN   rtn_val;
+
+
+   *p_err  =  NET_SOCK_ERR_NONE;
+    p_segs =  FTPs_SegsCurPtr;
+
+    FTPs_HandleClose(p_segs->TmpPath);
+    p_file = NetFS_FileOpen(p_segs->TmpPath,
+                            NET_FS_FILE_MODE_OPEN,
+                            NET_FS_FILE_ACCESS_RD_WR);
+    if (p_file == (void *)0) {
+        return (FTPs_SEGS_ERR_WR);
+    }
+
+    fs_err = NetFS_FileSizeGet(p_file, &file_size);
+    if (fs_err == DEF_OK) {
+        fs_err = NetFS_FilePosSet(p_file, file_size, NET_FS_SEEK_ORIGIN_START);
+    }
+    Mem_Clr(p_buf, FTPs_NET_BUF_LEN);
+    while ((fs_err    == DEF_OK) &&                             /* See Note #1.                                         */
+           (file_size <  offset)) {
+        wr_len = DEF_MIN(offset - file_size, FTPs_NET_BUF_LEN);
+        (void)NetFS_FileWr((void       *) p_file,
+                           (void       *) p_buf,
+                           (CPU_SIZE_T  ) wr_len,
+                           (CPU_SIZE_T *)&fs_len);
+        if (fs_len != wr_len) {
+            fs_err = DEF_FAIL;
+        }
+        file_size += fs_len;
+    }
+    if (fs_err == DEF_OK) {
+        fs_err = NetFS_FilePosSet(p_file, offset, NET_FS_SEEK_ORIGIN_START);
+    }
+    if (fs_err != DEF_OK) {
+        FTPs_TRACE_DBG(("FTPs segment not positioned: line #%u.\n", (unsigned int)__LINE__));
+        NetFS_FileClose(p_file);
+        return (FTPs_SEGS_ERR_WR);
+    }
+
+    NetSock_CfgTimeoutRxQ_Set((NET_SOCK_ID  )sock_id,
+                              (CPU_INT32U   )FTPs_DTP_RX_SLICE_MS,
+                              (NET_ERR     *)p_err);
+
+    rem = len;
+    while (DEF_TRUE) {
+        net_len = FTPs_Rx(sock_id, p_buf, FTPs_NET_BUF_LEN, p_err);
+        if ((*p_err == NET_SOCK_ERR_RX_Q_CLOSED) ||             /* End of segment.                                      */
+            (*p_err == NET_SOCK_ERR_RX_Q_EMPTY)) {
+            *p_err = NET_SOCK_ERR_NONE;
+            break;
+        }
+        if (*p_err != NET_SOCK_ERR_NONE) {
+            FTPs_TRACE_DBG(("FTPs FTPs_Rx() failed: error #%u, line #%u.\n", (unsigned int)*p_err, (unsigned int)__LINE__));
+            break;
+        }
+        if ((CPU_INT32U)net_len > rem) {                        /* Segment longer than declared.                        */
+            rem = len;
+            break;
+        }
+        (void)NetFS_FileWr((void       *) p_file,
+                           (void       *) p_buf,
+                           (CPU_SIZE_T  ) net_len,
+                           (CPU_SIZE_T *)&fs_len);
+        if (fs_len != (CPU_SIZE_T)net_len) {
+            FTPs_TRACE_DBG(("FTPs NetFS_FileWr() failed: line #%u.\n", (unsigned int)__LINE__));
+            NetFS_FileClose(p_file);
+            return (FTPs_SEGS_ERR_WR);
+        }
+        rem -= fs_len;
+    }
+    NetFS_FileClose(p_file);
+    FTPs_InvalidatePath(p_segs->TmpPath);
+
+    if ((*p_err != NET_SOCK_ERR_NONE) ||                        /* See Note #2.                                         */
+        ( rem   != 0u)) {
+        return (FTPs_SEGS_ERR_INCOMPLETE);
+    }
+
+    FTPs_SegsRangeAdd(p_segs, offset, offset + len);
+    if (p_segs->NbrRx < p_segs->Size) {
+        return (FTPs_SEGS_ERR_NONE);
+    }
+
+    rtn_val = FTPs_SegsCommit(p_segs);
+    if (rtn_val != DEF_OK) {
+        return (FTPs_SEGS_ERR_REPLACE);
+    }
+
+    return (FTPs_SEGS_ERR_NONE);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs_SegsRangeAdd()
+*
+* Description : Record a range of received octets.
+*
+* Argument(s) : p_segs      Pointer to the segmented upload.
+*
+*               start       Offset of the first octet of the range.
+*
+*               end         Offset following the last octet of the range.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_SegsRx().
+*
+* Note(s)     : (1) The range was checked by FTPs_SegsStart() : it doesn't overlap a recorded range & a free
+*                   range is available if it isn't adjacent to a recorded one.  Adjacent ranges are merged.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+static  void  FTPs_SegsRangeAdd (FTPs_SEGS   *p_segs,
+                                 CPU_INT32U   start,
+                                 CPU_INT32U   end)
+{
+    FTPs_SEGS_RANGE  *p_range;
+    FTPs_SEGS_RANGE  *p_merged;
+    CPU_INT32U        i;
+
+
+    p_segs->NbrRx += end - start;
+
+    p_merged = (FTPs_SEGS_RANGE *)0;
+    for (i = 0u; i < p_segs->NbrRange; i++) {                   /* Extend range ending at start.                        */
+        p_range = &p_segs->Range[i];
+        if (p_range->End == start) {
+            p_range->End = end;
+            p_merged     = p_range;
+            break;
+        }
+    }
+
+    for (i = 0u; i < p_segs->NbrRange; i++) {                   /* Merge range starting at end.                         */
+        p_range = &p_segs->Range[i];
+        if (p_range->Start == end) {
+            if (p_merged == (FTPs_SEGS_RANGE *)0) {
+                p_range->Start = start;
+            } else {
+                p_merged->End  = p_range->End;
+                p_segs->NbrRange--;
+               *p_range        = p_segs->Range[p_segs->NbrRange];
+            }
+            return;
+        }
+    }
+
+    if (p_merged == (FTPs_SEGS_RANGE *)0) {
+        p_range        = &p_segs->Range[p_segs->NbrRange];
+        p_range->Start =  start;
+        p_range->End   =  end;
+        p_segs->NbrRange++;
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_SegsCommit()
+*
+* Description : Replace a file by its completely received temporary file & end its segmented upload.
+*
+* Argument(s) : p_segs      Pointer to the segmented upload.
+*
+* Return(s)   : DEF_OK,   file replaced.
+*
+*               DEF_FAIL, otherwise; the temporary file is kept.
+*
+* Caller(s)   : FTPs_SegsRx(),
+*               FTPs_SiteSegs().
+*
+* Note(s)     : (1) The file is replaced by FTPs_FileReplace(), so that it is never lost.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_SegsCommit (FTPs_SEGS  *p_segs)
+{
+    CPU_BOOLEAN  rtn_val;
+
+
+    FTPs_HandleClose(p_segs->Path);
+    rtn_val = FTPs_FileReplace(p_segs->Path,                    /* See Note #1.                                         */
+                               p_segs->TmpPath);
+    FTPs_InvalidatePath(p_segs->TmpPath);
+    FTPs_InvalidatePath(p_segs->Path);
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+    FTPs_PinReload(p_segs->Path);                               /* Re-read replaced pinned file.                        */
+#endif
+    if (rtn_val != DEF_OK) {
+        FTPs_TRACE_DBG(("FTPs segments: file not replaced: line #%u.\n", (unsigned int)__LINE__));
+        return (DEF_FAIL);
+    }
+
+    p_segs->En = DEF_NO;
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_SegsCancel()
+*
+* Description : End the segmented upload of a file, if any, & delete its temporary file.
+*
+* Argument(s) : path        FS absolute path of the file.
+*
+* Return(s)   : DEF_YES, if the file was uploaded in segments.
+*
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd(),
+*               FTPs_ProcessDtpCmd(),
+*               FTPs_SiteSegs().
+*
+* Note(s)     : (1) The file is deleted or written whole: the segments received so far are obsolete.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_SegsCancel (CPU_CHAR  *path)
+{
+    FTPs_SEGS  *p_segs;
+
+
+    p_segs = FTPs_SegsGet(path);
+    if (p_segs == (FTPs_SEGS *)0) {
+        return (DEF_NO);
+    }
+
+    FTPs_HandleClose(p_segs->TmpPath);
+   (void)NetFS_EntryDel(p_segs->TmpPath, DEF_YES);
+    FTPs_InvalidatePath(p_segs->TmpPath);
+    p_segs->En = DEF_NO;
+
+    return (DEF_YES);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_ResumeGet()
+*
+* Description : Read the resume journal record of a file.
+*
+* Argument(s) : path        FS absolute path of the file.
+*
+*               file_size   Current size of the file.
+*
+* Return(s)   : DEF_YES, if the file has a record; it is copied to FTPs_Resume.Rec & its index to
+*                        FTPs_Resume.Ix.
+*
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd(),
+*               FTPs_ResumeStart(),
+*               FTPs_SiteResume().
+*
+* Note(s)     : (1) A record of more octets than the file holds is stale (e.g. the file was replaced without
+*                   the server) : it is freed & ignored.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_ResumeGet (CPU_CHAR    *path,
+                                     CPU_INT32U   file_size)
+{
+    FTPs_RESUME_REC  *p_rec;
+    void             *p_file;
+    CPU_SIZE_T        rd_len;
+    CPU_SIZE_T        wr_len;
+    CPU_INT32U        ix;
+    CPU_INT16S        cmp_val;
+    CPU_BOOLEAN       found;
+
+
+    p_file = NetFS_FileOpen((CPU_CHAR *)FTPs_CFG_RESUME_JRNL_PATH,
+                                        NET_FS_FILE_MODE_OPEN,
+                                        NET_FS_FILE_ACCESS_RD_WR);
+    if (p_file == (void *)0) {                                  /* No upload journaled yet.                             */
+        return (DEF_NO);
+    }
+
+    p_rec = &FTPs_Resume.Rec;
+    found =  DEF_NO;
+    for (ix = 0u; ix < FTPs_CFG_RESUME_NBR_MAX; ix++) {
+        (void)NetFS_FileRd((void       *) p_file,
+                           (void       *) p_rec,
+                           (CPU_SIZE_T  ) sizeof(FTPs_RESUME_REC),
+                           (CPU_SIZE_T *)&rd_len);
+        if (rd_len != sizeof(FTPs_RESUME_REC)) {
+            break;
+        }
+        if (p_rec->Path[0] == (CPU_CHAR)0) {                    /* Free record.                                         */
+            continue;
+        }
+        cmp_val = FTPs_FS_NameCmp(p_rec->Path, path);
+        if (cmp_val == 0) {
+            found = DEF_YES;
+            break;
+        }
+    }
+
+    if ((found       == DEF_YES) &&                             /* See Note #1.                                         */
+        (p_rec->Size >  file_size)) {
+        p_rec->Path[0] = (CPU_CHAR)0;
+        (void)NetFS_FilePosSet(p_file, ix * sizeof(FTPs_RESUME_REC), NET_FS_SEEK_ORIGIN_START);
+        (void)NetFS_FileWr((void       *) p_file,
+                           (void       *) p_rec->Path,
+                           (CPU_SIZE_T  ) 1u,
+                           (CPU_SIZE_T *)&wr_len);
+        found = DEF_NO;
+    }
+    NetFS_FileClose(p_file);
+
+    if (found == DEF_YES) {
+        FTPs_Resume.Ix = ix;
+    }
+
+    return (found);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_ResumeRecWr()
+*
+* Description : Write the resume journal record of the current STOR.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ProcessDtpCmd(),
+*               FTPs_ResumeSync(),
+*               FTPs_ResumeEnd().
+*
+* Note(s)     : (1) The record is written at FTPs_Resume.Ix.  A new record is written in the first free record
+*                   of the journal file, or appended to it.  Once the journal file holds FTPs_CFG_RESUME_NBR_MAX
+*                   records, the upload is not journaled.
+*
+*               (2) A record with an empty path frees its record of the journal file.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+static  void  FTPs_ResumeRecWr (void)
+{
+    void        *p_file;
+    CPU_SIZE_T   rd_len;
+    CPU_SIZE_T   wr_len;
+    CPU_INT32U   ix;
+
+
+    if ((FTPs_Resume.Ix          == FTPs_CFG_RESUME_NBR_MAX) &&
+        (FTPs_Resume.Rec.Path[0] == (CPU_CHAR)0)) {             /* No record to free (see Note #2).                     */
+        return;
+    }
+
+    p_file = NetFS_FileOpen((CPU_CHAR *)FTPs_CFG_RESUME_JRNL_PATH,
+                                        NET_FS_FILE_MODE_OPEN,
+                                        NET_FS_FILE_ACCESS_RD_WR);
+    if (p_file == (void *)0) {
+        p_file = NetFS_FileOpen((CPU_CHAR *)FTPs_CFG_RESUME_JRNL_PATH,
+                                            NET_FS_FILE_MODE_CREATE,
+                                            NET_FS_FILE_ACCESS_RD_WR);
+        if (p_file == (void *)0) {
+            FTPs_TRACE_DBG(("FTPs NetFS_FileOpen() failed: line #%u.\n", (unsigned int)__LINE__));
+            return;
+        }
+    }
+
+    if (FTPs_Resume.Ix == FTPs_CFG_RESUME_NBR_MAX) {            /* Find a free record (see Note #1).                    */
+        for (ix = 0u; ix < FTPs_CFG_RESUME_NBR_MAX; ix++) {
+            (void)NetFS_FilePosSet(p_file, ix * sizeof(FTPs_RESUME_REC), NET_FS_SEEK_ORIGIN_START);
+            (void)NetFS_FileRd((void       *) p_file,
+                               (void       *) FTPs_Resume.RdPath,
+                               (CPU_SIZE_T  ) 1u,
+                               (CPU_SIZE_T *)&rd_len);
+            if ((rd_len                == 0u) ||                /* End of journal file ...                              */
+                (FTPs_Resume.RdPath[0] == (CPU_CHAR)0)) {       /* ... or free record.                                  */
+                break;
+            }
+        }
+        if (ix >= FTPs_CFG_RESUME_NBR_MAX) {                    /* Journal file full.                                   */
+            NetFS_FileClose(p_file);
+            return;
+        }
+        FTPs_Resume.Ix = ix;
+    }
+
+    if (FTPs_Resume.Rec.Path[0] != (CPU_CHAR)0) {
+        FTPs_PathFilterAdd(FTPs_Resume.Filter, FTPs_RESUME_FILTER_LEN, FTPs_Resume.Rec.Path);
+    }
+    (void)NetFS_FilePosSet(p_file, FTPs_Resume.Ix * sizeof(FTPs_RESUME_REC), NET_FS_SEEK_ORIGIN_START);
+    (void)NetFS_FileWr((void       *) p_file,
+                       (void       *)&FTPs_Resume.Rec,
+                       (CPU_SIZE_T  ) sizeof(FTPs_RESUME_REC),
+                       (CPU_SIZE_T *)&wr_len);
+    if (wr_len != sizeof(FTPs_RESUME_REC)) {
+        FTPs_TRACE_DBG(("FTPs NetFS_FileWr() failed: line #%u.\n", (unsigned int)__LINE__));
+    }
+    NetFS_FileClose(p_file);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       FTPs_ResumeInvalidate()
+*
+* Description : Free the resume journal records of a modified entry.
+*
+* Argument(s) : path        FS absolute path of the modified entry.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_InvalidatePath().
+*
+* Note(s)     : (1) A record is freed if its file is the entry or is located under it (see FTPs_PathMatch()).
+*
+*               (2) Only the paths of the records are read: FTPs_Resume.Rec may hold the record of the STOR
+*                   being started (see FTPs_ResumeStart()).
+*
+*               (3) The journal file is read only if the path filter may hold the entry; it is then rebuilt
+*                   from the records kept (see FTPs_PathFilterAdd()).  The filter is first built by the
+*                   first call.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+static  void  FTPs_ResumeInvalidate (CPU_CHAR  *path)
+{
+    void         *p_file;
+    CPU_SIZE_T    rd_len;
+    CPU_SIZE_T    wr_len;
+    CPU_INT32U    ix;
+    CPU_BOOLEAN   match;
+
+
+    if (FTPs_Resume.FilterValid == DEF_YES) {                   /* See Note #3.                                         */
+        match = FTPs_PathFilterChk(FTPs_Resume.Filter, FTPs_RESUME_FILTER_LEN, path);
+        if (match == DEF_NO) {
+            return;
+        }
+    }
+    Mem_Clr(FTPs_Resume.Filter, FTPs_RESUME_FILTER_LEN);
+    FTPs_Resume.FilterValid = DEF_YES;
+
+    p_file = NetFS_FileOpen((CPU_CHAR *)FTPs_CFG_RESUME_JRNL_PATH,
+                                        NET_FS_FILE_MODE_OPEN,
+                                        NET_FS_FILE_ACCESS_RD_WR);
+    if (p_file == (void *)0) {                                  /* No upload journaled yet.                             */
+        return;
+    }
+
+    for (ix = 0u; ix < FTPs_CFG_RESUME_NBR_MAX; ix++) {         /* See Note #2.                                         */
+        (void)NetFS_FilePosSet(p_file, ix * sizeof(FTPs_RESUME_REC), NET_FS_SEEK_ORIGIN_START);
+        (void)NetFS_FileRd((void       *) p_file,
+                           (void       *) FTPs_Resume.RdPath,
+                           (CPU_SIZE_T  ) FTPs_CFG_FS_PATH_LEN_MAX,
+                           (CPU_SIZE_T *)&rd_len);
+        if (rd_len != FTPs_CFG_FS_PATH_LEN_MAX) {
+            break;
+        }
+        if (FTPs_Resume.RdPath[0] == (CPU_CHAR)0) {
+            continue;
+        }
+        match = FTPs_PathMatch(FTPs_Resume.RdPath, path);       /* See Note #1.                                         */
+        if (match == DEF_YES) {
+            FTPs_Resume.RdPath[0] = (CPU_CHAR)0;
+            (void)NetFS_FilePosSet(p_file, ix * sizeof(FTPs_RESUME_REC), NET_FS_SEEK_ORIGIN_START);
+            (void)NetFS_FileWr((void       *) p_file,
+                               (void       *) FTPs_Resume.RdPath,
+                               (CPU_SIZE_T  ) 1u,
+                               (CPU_SIZE_T *)&wr_len);
+        } else {
+            FTPs_PathFilterAdd(FTPs_Resume.Filter, FTPs_RESUME_FILTER_LEN, FTPs_Resume.RdPath);
+        }
+    }
+
+    NetFS_FileClose(p_file);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs_ResumeStart()
+*
+* Description : Determine if the current STOR is journaled & prepare its record.
+*
+* Argument(s) : ftp_session     structure that contains FTP session states and control data.
+*
+* Return(s)   : Pointer to the digest state of the octets of the file, if the STOR is journaled.
+*
+*               Pointer to NULL,                                      otherwise.
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) A STOR without REST starts a new upload.  A STOR after REST continues the upload of the
+*                   record if the restart offset is the number of octets it holds, so that the digest covers
+*                   the whole file.  APPE & other STOR are not journaled.
+*
+*               (2) This function MUST be called before the file is invalidated, which frees its record in
+*                   the journal file.  The record is written back at the same index.
+*
+*               (3) A file whose path doesn't fit a journal record is not journaled.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+static  FTPs_SHA256  *FTPs_ResumeStart (FTPs_SESSION_STRUCT  *ftp_session)
+{
+    NET_FS_ENTRY  dirent;
+    CPU_SIZE_T    path_len;
+    CPU_BOOLEAN   found;
+
+
+    FTPs_Resume.En = DEF_NO;
+    if (ftp_session->CtrlCmd != FTP_CMD_STOR) {
+        return ((FTPs_SHA256 *)0);
+    }
+    path_len = Str_Len(ftp_session->CurEntry);
+    if (path_len >= FTPs_CFG_FS_PATH_LEN_MAX) {                 /* See Note #3.                                         */
+        return ((FTPs_SHA256 *)0);
+    }
+
+    found = FTPs_EntryStat(ftp_session->CurEntry, &dirent);
+    if (found == DEF_NO) {
+        dirent.Size = 0u;
+    }
+    found = FTPs_ResumeGet(ftp_session->CurEntry, dirent.Size);
+
+    if (ftp_session->CtrlState != FTPs_STATE_GOTREST) {         /* New upload (see Note #1).                            */
+        if (found == DEF_NO) {
+            FTPs_Resume.Ix = FTPs_CFG_RESUME_NBR_MAX;
+        }
+        Str_Copy_N(FTPs_Resume.Rec.Path, ftp_session->CurEntry, FTPs_CFG_FS_PATH_LEN_MAX);
+        FTPs_Resume.Rec.Size = 0u;
+        FTPs_Sha256Init(&FTPs_Resume.Rec.Sha);
+
+    } else if ((found                != DEF_YES) ||
+               (FTPs_Resume.Rec.Size != ftp_session->DtpOffset)) {
+        return ((FTPs_SHA256 *)0);
+    }
+
+    FTPs_Resume.SyncLen = 0u;
+    FTPs_Resume.En      = DEF_YES;
+
+    return (&FTPs_Resume.Rec.Sha);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_ResumeSync()
+*
+* Description : Count octets written by the current STOR & record them in the journal periodically.
+*
+* Argument(s) : path        FS absolute path of the file.
+*
+*               p_file      Handle of the file.
+*
+*               len         Nbr of octets written to the file (& added to the digest state).
+*
+* Return(s)   : Handle of the file (see Note #1).
+*
+*               Pointer to NULL, if the file can't be re-opened.
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) Every FTPs_CFG_RESUME_SYNC_LEN octets, the file is closed, which writes its octets to the
+*                   media, then re-opened at the same position.  The network FS interface has no other way
+*                   to flush a file.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+static  void  *FTPs_ResumeSync (CPU_CHAR    *path,
+                                void        *p_file,
+                                CPU_SIZE_T   len)
+{
+    CPU_BOOLEAN  fs_err;
+
+
+    FTPs_Resume.Rec.Size += len;
+    FTPs_Resume.SyncLen  += len;
+    if (FTPs_Resume.SyncLen < FTPs_CFG_RESUME_SYNC_LEN) {
+        return (p_file);
+    }
+
+    NetFS_FileClose(p_file);                                    /* See Note #1.                                         */
+    FTPs_Resume.SyncLen = 0u;
+    FTPs_ResumeRecWr();
+
+    p_file = NetFS_FileOpen(path,
+                            NET_FS_FILE_MODE_APPEND,
+                            NET_FS_FILE_ACCESS_RD_WR);
+    if (p_file == (void *)0) {
+        FTPs_TRACE_DBG(("FTPs NetFS_FileOpen() failed: line #%u.\n", (unsigned int)__LINE__));
+        return ((void *)0);
+    }
+    fs_err = NetFS_FilePosSet(p_file, FTPs_Resume.Rec.Size, NET_FS_SEEK_ORIGIN_START);
+    if (fs_err != DEF_OK) {
+        FTPs_TRACE_DBG(("FTPs NetFS_FilePosSet() failed: line #%u.\n", (unsigned int)__LINE__));
+        NetFS_FileClose(p_file);
+        return ((void *)0);
+    }
+
+    return (p_file);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_ResumeEnd()
+*
+* Description : End the journal record of the current STOR, once the file is closed.
+*
+* Argument(s) : done        DEF_YES, if the client closed the data connection (see Note #1).
+*
+*                           DEF_NO,  otherwise.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) A client closes the data connection at the end of the file.  A timeout or a connection
+*                   error means that the upload was interrupted: the record is updated with all the octets
+*                   written, so that the client can continue from there.  Otherwise, the record is freed.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+static  void  FTPs_ResumeEnd (CPU_BOOLEAN  done)
+{
+    if (done == DEF_YES) {                                      /* See Note #1.                                         */
+        FTPs_Resume.Rec.Path[0] = (CPU_CHAR)0;
+    }
+    FTPs_ResumeRecWr();
+
+    FTPs_Resume.En = DEF_NO;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_TailStart()
+*
+* Description : Determine if a RETR path names a followed file.
+*
+* Argument(s) : path        FS absolute path of the entry to retrieve.
+*
+* Return(s)   : DEF_YES, if the path is a file path followed by ".tail" (see Note #1).
+*
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd().
+*
+* Note(s)     : (1) "RETR <filename>.tail" sends the file, then the octets appended to it (see FTPs_TailTx()),
+*                   unless a file of that name exists.  The suffix is case insensitive.
+*
+*               (2) On return, the suffix is removed from 'path', so that the file is opened like any other
+*                   RETR, & the path of the file is in FTPs_Tail.
+*
+*               (3) A file whose path does NOT fit FTPs_Tail.Path is NOT followed; the RETR names the
+*                   ".tail" entry itself, rather than a truncated path.
+*
+*               (4) FTPs_Tail is set with FTPs_TailLock held (see FTPs_TailNotify() Note #3).
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_TAIL_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_TailStart (CPU_CHAR  *path)
+{
+    NET_FS_ENTRY  dirent;
+    CPU_SIZE_T    path_len;
+    CPU_INT16S    cmp_val;
+    CPU_BOOLEAN   found;
+    KAL_ERR       kal_err;
+
+
+    path_len = Str_Len(path);
+    if ((path_len <= FTPs_TAIL_EXT_LEN) ||                      /* See Note #3.                                         */
+        (path_len -  FTPs_TAIL_EXT_LEN >= FTPs_CFG_FS_PATH_LEN_MAX)) {
+        return (DEF_NO);
+    }
+    cmp_val = Str_CmpIgnoreCase_N(&path[path_len - FTPs_TAIL_EXT_LEN], FTPs_TAIL_EXT_STR, FTPs_TAIL_EXT_LEN);
+    if ((cmp_val                                  != 0) ||
+        (path[path_len - FTPs_TAIL_EXT_LEN - 1u] == FTPs_FS_SepChar)) {
+        return (DEF_NO);
+    }
+
+    found = FTPs_EntryStat(path, &dirent);
+    if (found == DEF_YES) {                                     /* Existing file transferred as is (see Note #1).       */
+        return (DEF_NO);
+    }
+
+    path[path_len - FTPs_TAIL_EXT_LEN] = (CPU_CHAR)0;           /* See Note #2.                                         */
+
+    KAL_LockAcquire(FTPs_TailLock, KAL_OPT_PEND_NONE, KAL_TIMEOUT_INFINITE, &kal_err);
+    Str_Copy_N(FTPs_Tail.Path, path, FTPs_CFG_FS_PATH_LEN_MAX);
+    FTPs_Tail.En = DEF_YES;                                     /* See Note #4.                                         */
+    KAL_LockRelease(FTPs_TailLock, &kal_err);
+
+    return (DEF_YES);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_TailStop()
+*
+* Description : Stop following the file selected by FTPs_TailStart(), if any.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd(),
+*               FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) FTPs_Tail is changed with FTPs_TailLock held (see FTPs_TailNotify() Note #3).
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_TAIL_EN == DEF_ENABLED)
+static  void  FTPs_TailStop (void)
+{
+    KAL_ERR  kal_err;
+
+
+    KAL_LockAcquire(FTPs_TailLock, KAL_OPT_PEND_NONE, KAL_TIMEOUT_INFINITE, &kal_err);
+    FTPs_Tail.En = DEF_NO;
+    KAL_LockRelease(FTPs_TailLock, &kal_err);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            FTPs_TailTx()
+*
+* Description : Send the file selected by FTPs_TailStart(), then the octets appended to it, on the data
+*               connection.
+*
+* Argument(s) : ftp_session     structure that contains FTP session states and control data.
+*
+*               p_file          Handle of the file, opened by the command validation.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function.
+*
+* Return(s)   : DEF_OK,   follow ended by a command or by the idle limit.
+*
+*               DEF_FAIL, file can't be read, data connection error or ABOR received.
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) The same file handle is used for the whole transfer.  After REST, the file is sent from
+*                   the restart offset.
+*
+*               (2) The position is set again before reading the octets appended to the file, since a read
+*                   at the end of the file may leave the handle in an end-of-file state.
+*
+*               (3) Appended octets are signaled by FTPs_TailNotify(): the file is only read again when
+*                   notified.  Every FTPs_TAIL_WAIT_MS without notification, the control connection is
+*                   checked & the time without appended octets is compared to FTPs_CFG_TAIL_IDLE_TIMEOUT_MS.
+*
+*               (4) The data transfer runs in the control task: the control connection is peeked, without
+*                   consuming the command.  Any received command ends the follow & is then processed as
+*                   usual.  ABOR ends it as an aborted transfer (see FTPs_AbortChk()).
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_TAIL_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_TailTx (FTPs_SESSION_STRUCT  *ftp_session,
+                                  void                 *p_file,
+                                  NET_ERR              *p_err)
+{
+    CPU_CHAR     ctrl_char;
+    CPU_INT32U   pos;
+    CPU_INT32U   idle_ms;
+    CPU_SIZE_T   rd_len;
+    CPU_INT16S   net_len;
+    CPU_BOOLEAN  fs_err;
+    CPU_BOOLEAN  aborted;
+    KAL_ERR      kal_err;
+    NET_ERR      net_err;
+
+
+   *p_err   = NET_SOCK_ERR_NONE;
+    pos     = 0u;
+    if (ftp_session->CtrlState == FTPs_STATE_GOTREST) {         /* See Note #1.                                         */
+        pos = ftp_session->DtpOffset;
+    }
+    idle_ms = 0u;
+    KAL_SemSet(FTPs_TailSem, 0u, &kal_err);                     /* Discard notifications of previous follows.           */
+
+    while (DEF_TRUE) {
+                                                                /* See Note #2.                                         */
+        fs_err = NetFS_FilePosSet(p_file, pos, NET_FS_SEEK_ORIGIN_START);
+        if (fs_err != DEF_OK) {
+            FTPs_TRACE_DBG(("FTPs NetFS_FilePosSet() failed: line #%u.\n", (unsigned int)__LINE__));
+            return (DEF_FAIL);
+        }
+
+        do {                                                    /* Send up to the current end of file.                  */
+            (void)NetFS_FileRd((void       *) p_file,
+                               (void       *) FTPs_NetBufDtpCmdPtr,
+                               (CPU_SIZE_T  ) FTPs_NET_BUF_LEN,
+                               (CPU_SIZE_T *)&rd_len);
+            if (rd_len > 0u) {
+                FTPs_Tx(ftp_session->DtpSockID, FTPs_NetBufDtpCmdPtr, rd_len, p_err);
+                if (*p_err != NET_SOCK_ERR_NONE) {
+                    FTPs_TRACE_DBG(("FTPs FTPs_Tx() failed: error #%u, line #%u.\n", (unsigned int)*p_err, (unsigned int)__LINE__));
+                    return (DEF_FAIL);
+                }
+                pos     += rd_len;
+                idle_ms  = 0u;
+            }
+        } while (rd_len == FTPs_NET_BUF_LEN);
+
+        if (idle_ms >= FTPs_CFG_TAIL_IDLE_TIMEOUT_MS) {         /* Idle limit reached.                                  */
+            break;
+        }
+                                                                /* Wait for appended octets (see Note #3).              */
+        KAL_SemPend(FTPs_TailSem, KAL_OPT_PEND_NONE, FTPs_TAIL_WAIT_MS, &kal_err);
+        if (kal_err == KAL_ERR_TIMEOUT) {
+            idle_ms += FTPs_TAIL_WAIT_MS;
+        } else if (kal_err != KAL_ERR_NONE) {
+            FTPs_TRACE_DBG(("FTPs KAL_SemPend() failed: error #%u, line #%u.\n", (unsigned int)kal_err, (unsigned int)__LINE__));
+            break;
+        }
+
+        net_len = NetSock_RxData( ftp_session->CtrlSockID,      /* Check for a cmd (see Note #4).                       */
+                                 &ctrl_char,
+                                  1u,
+                                  NET_SOCK_FLAG_RX_DATA_PEEK | NET_SOCK_FLAG_RX_NO_BLOCK,
+                                 &net_err);
+        if ((net_len >  0) ||
+           ((net_err != NET_SOCK_ERR_NONE) && (net_err != NET_SOCK_ERR_RX_Q_EMPTY))) {
+            aborted = FTPs_AbortChk(ftp_session->DtpSockID);
+            if (aborted == DEF_YES) {
+               *p_err = NET_SOCK_ERR_CONN_FAIL;
+                return (DEF_FAIL);
+            }
+            break;                                              /* Cmd received or ctrl conn closed.                    */
+        }
+    }
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_Sha256Init()
+*
+* Description : Initialize a SHA-256 computation.
+*
+* Argument(s) : p_sha       Pointer to the SHA-256 state.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_DeltaSigTx(),
+*               FTPs_ProcessDtpCmd(),
+*               FTPs_ResumeStart().
+*
+* Note(s)     : (1) See FIPS 180-4, section 6.2.
+*********************************************************************************************************
+*/
+
+#if (FTPs_SHA256_EN == DEF_ENABLED)
+static  void  FTPs_Sha256Init (FTPs_SHA256  *p_sha)
+{
+    p_sha->State[0] = 0x6A09E667u;
+    p_sha->State[1] = 0xBB67AE85u;
+    p_sha->State[2] = 0x3C6EF372u;
+    p_sha->State[3] = 0xA54FF53Au;
+    p_sha->State[4] = 0x510E527Fu;
+    p_sha->State[5] = 0x9B05688Cu;
+    p_sha->State[6] = 0x1F83D9ABu;
+    p_sha->State[7] = 0x5BE0CD19u;
+    p_sha->Len      = 0u;
+    p_sha->BlkLen   = 0u;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_Sha256Upd()
+*
+* Description : Add data to a SHA-256 computation.
+*
+* Argument(s) : p_sha       Pointer to the SHA-256 state.
+*
+*               p_data      Pointer to the data.
+*
+*               len         Length of the data.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_DeltaSigTx(),
+*               FTPs_ProcessDtpCmd().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (FTPs_SHA256_EN == DEF_ENABLED)
+static  void  FTPs_Sha256Upd (FTPs_SHA256  *p_sha,
+                              CPU_INT08U   *p_data,
+                              CPU_SIZE_T    len)
+{
+    CPU_SIZE_T  cpy_len;
+
+
+    p_sha->Len += (CPU_INT32U)len;
+    while (len > 0u) {
+        cpy_len = DEF_MIN(len, FTPs_SHA256_BLK_SIZE - p_sha->BlkLen);
+        Mem_Copy(&p_sha->Blk[p_sha->BlkLen], p_data, cpy_len);
+        p_sha->BlkLen += cpy_len;
+        p_data        += cpy_len;
+        len           -= cpy_len;
+        if (p_sha->BlkLen == FTPs_SHA256_BLK_SIZE) {
+            FTPs_Sha256Blk(p_sha);
+            p_sha->BlkLen = 0u;
+        }
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs_Sha256Final()
+*
+* Description : Terminate a SHA-256 computation.
+*
+* Argument(s) : p_sha       Pointer to the SHA-256 state.
+*
+*               p_digest    Pointer to the buffer that will receive the digest (FTPs_SHA256_LEN octets).
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_DeltaSigTx(),
+*               FTPs_ProcessDtpCmd(),
+*               FTPs_SiteResume().
+*
+* Note(s)     : (1) The data is padded with a 1 bit, zeros & its length in bits (64 bits, big-endian).
+*********************************************************************************************************
+*/
+
+#if (FTPs_SHA256_EN == DEF_ENABLED)
+static  void  FTPs_Sha256Final (FTPs_SHA256  *p_sha,
+                                CPU_INT08U   *p_digest)
+{
+    CPU_SIZE_T  i;
+
+
+    p_sha->Blk[p_sha->BlkLen++] = 0x80u;                        /* See Note #1.                                         */
+    if (p_sha->BlkLen > FTPs_SHA256_BLK_SIZE - 8u) {
+        Mem_Clr(&p_sha->Blk[p_sha->BlkLen], FTPs_SHA256_BLK_SIZE - p_sha->BlkLen);
+        FTPs_Sha256Blk(p_sha);
+        p_sha->BlkLen = 0u;
+    }
+    Mem_Clr(&p_sha->Blk[p_sha->BlkLen], FTPs_SHA256_BLK_SIZE - 8u - p_sha->BlkLen);
+    MEM_VAL_SET_INT32U_BIG(&p_sha->Blk[FTPs_SHA256_BLK_SIZE - 8u], p_sha->Len >> 29u);
+    MEM_VAL_SET_INT32U_BIG(&p_sha->Blk[FTPs_SHA256_BLK_SIZE - 4u], p_sha->Len <<  3u);
+    FTPs_Sha256Blk(p_sha);
+
+    for (i = 0u; i < 8u; i++) {
+        MEM_VAL_SET_INT32U_BIG(&p_digest[i * 4u], p_sha->State[i]);
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_Sha256Blk()
+*
+* Description : Process a 64-octet block of a SHA-256 computation.
+*
+* Argument(s) : p_sha       Pointer to the SHA-256 state, holding the block.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_Sha256Upd(),
+*               FTPs_Sha256Final().
+*
+* Note(s)     : (1) The message schedule is computed in a 16-word circular buffer.
+*********************************************************************************************************
+*/
+
+#if (FTPs_SHA256_EN == DEF_ENABLED)
+static  void  FTPs_Sha256Blk (FTPs_SHA256  *p_sha)
+{
+    CPU_INT32U  w[16];
+    CPU_INT32U  v[8];
+    CPU_INT32U  s0;
+    CPU_INT32U  s1;
+    CPU_INT32U  t1;
+    CPU_INT32U  t2;
+    CPU_SIZE_T  i;
+
+
+    for (i = 0u; i < 16u; i++) {
+        w[i] = MEM_VAL_GET_INT32U_BIG(&p_sha->Blk[i * 4u]);
+    }
+    for (i = 0u; i < 8u; i++) {
+        v[i] = p_sha->State[i];
+    }
+
+    for (i = 0u; i < 64u; i++) {
+        if (i >= 16u) {                                         /* See Note #1.                                         */
+            t1          = w[(i +  1u) & 15u];                   /* W[i - 15].                                           */
+            t2          = w[(i + 14u) & 15u];                   /* W[i -  2].                                           */
+            s0          = FTPs_ROTR32(t1,  7u) ^ FTPs_ROTR32(t1, 18u) ^ (t1 >>  3u);
+            s1          = FTPs_ROTR32(t2, 17u) ^ FTPs_ROTR32(t2, 19u) ^ (t2 >> 10u);
+            w[i & 15u] += s0 + w[(i + 9u) & 15u] + s1;
+        }
+        s1   = FTPs_ROTR32(v[4],  6u) ^ FTPs_ROTR32(v[4], 11u) ^ FTPs_ROTR32(v[4], 25u);
+        t1   = v[7] + s1 + ((v[4] & v[5]) ^ (~v[4] & v[6])) + FTPs_Sha256_K[i] + w[i & 15u];
+        s0   = FTPs_ROTR32(v[0],  2u) ^ FTPs_ROTR32(v[0], 13u) ^ FTPs_ROTR32(v[0], 22u);
+        t2   = s0 + ((v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]));
+        v[7] = v[6];
+        v[6] = v[5];
+        v[5] = v[4];
+        v[4] = v[3] + t1;
+        v[3] = v[2];
+        v[2] = v[1];
+        v[1] = v[0];
+        v[0] = t1 + t2;
+    }
+
+    for (i = 0u; i < 8u; i++) {
+        p_sha->State[i] += v[i];
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_EntryStat()
+*
+* Description : Get the attributes, size & date/time of a file or directory without opening it.
+*
+* Argument(s) : path        FS absolute path of the entry.
+*
+*               p_entry     Pointer to the structure that will receive the entry information.
+*
+* Return(s)   : DEF_YES, if the entry exists.
+*
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd().
+*
+* Note(s)     : (1) The entry is looked up in the directory listing of its parent directory.  On file systems
+*                   like FAT, reading a directory entry is much cheaper than opening the file.
+*
+*               (2) An exact name match is preferred.  Unless FTPs_CFG_FS_CASE_SENSITIVE is enabled, a name
+*                   differing only by case is accepted, as the file system would open it.
+*
+*               (3) The root directory has no parent directory : it is checked by opening it.  A path whose
+*                   parent directory does not fit FTPs_CFG_FS_PATH_LEN_MAX is reported as missing.
+*
+*               (4) The name pointer of 'p_entry' is NOT modified.
+*
+*               (5) When the metadata cache is enabled, entries found are kept in the cache & recent lookups
+*                   are answered without accessing the file system.
+*
+*               (6) When the negative lookup cache is enabled, entries NOT found are remembered & recent
+*                   lookups of the same path are answered without accessing the file system.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  FTPs_EntryStat (CPU_CHAR      *path,
+                                     NET_FS_ENTRY  *p_entry)
+{
+    static  CPU_CHAR       parent_path[FTPs_CFG_FS_PATH_LEN_MAX];
+    static  CPU_CHAR       dirent_name[FTPs_CFG_FS_NAME_LEN_MAX];
+            NET_FS_ENTRY   dirent;
+            void          *p_dir;
+            CPU_CHAR      *p_name;
+            CPU_SIZE_T     parent_len;
+            CPU_INT16S     cmp_val;
+            CPU_BOOLEAN    found;
+#if (FTPs_CFG_NEG_CACHE_EN == DEF_ENABLED)
+            CPU_BOOLEAN    missing;
+#endif
+            CPU_BOOLEAN    fs_err;
+
+
+#if (FTPs_CFG_META_CACHE_EN == DEF_ENABLED)
+    found = FTPs_MetaGet(path, p_entry);                        /* See Note #5.                                         */
+    if (found == DEF_YES) {
+        return (DEF_YES);
+    }
+#endif
+#if (FTPs_CFG_NEG_CACHE_EN == DEF_ENABLED)
+    missing = FTPs_NegGet(path);                                /* See Note #6.                                         */
+    if (missing == DEF_YES) {
+        return (DEF_NO);
+    }
+#endif
+
+    p_name = Str_Char_Last(path, FTPs_FS_SepChar);
+    if ((p_name     == (CPU_CHAR *)0) ||
+        (p_name[1u] == (CPU_CHAR  )0)) {                        /* Root dir (see Note #3).                              */
+        p_dir = NetFS_DirOpen(path);
+        if (p_dir == (void *)0) {
+            return (DEF_NO);
+        }
+        NetFS_DirClose(p_dir);
+        p_entry->Attrib = NET_FS_ENTRY_ATTRIB_DIR;
+        p_entry->Size   = 0u;
+        Mem_Clr(&p_entry->DateTimeCreate, sizeof(p_entry->DateTimeCreate));
+        return (DEF_YES);
+    }
+
+    parent_len = (CPU_SIZE_T)(p_name - path);                   /* Build parent dir path.                               */
+    if (parent_len == 0u) {
+        parent_len = 1u;                                        /* Keep sep char of root dir.                           */
+    }
+    if (parent_len >= FTPs_CFG_FS_PATH_LEN_MAX) {               /* See Note #3.                                         */
+        return (DEF_NO);
+    }
+    Str_Copy_N(parent_path, path, parent_len);
+    parent_path[parent_len] = (CPU_CHAR)0;
+    p_name++;
+
+    p_dir = NetFS_DirOpen(parent_path);
+    if (p_dir == (void *)0) {
+#if (FTPs_CFG_NEG_CACHE_EN == DEF_ENABLED)
+        FTPs_NegPut(path);
+#endif
+        return (DEF_NO);
+    }
+
+    dirent.NamePtr = &dirent_name[0];
+    found          =  DEF_NO;
+    fs_err         =  NetFS_DirRd(p_dir, &dirent);
+    while (fs_err == DEF_OK) {                                  /* See Note #2.                                         */
+        cmp_val = Str_Cmp(dirent.NamePtr, p_name);
+        if (cmp_val == 0) {
+            p_entry->Attrib         = dirent.Attrib;
+            p_entry->Size           = dirent.Size;
+            p_entry->DateTimeCreate = dirent.DateTimeCreate;
+            found                   = DEF_YES;
+            break;
+        }
+#if (FTPs_CFG_FS_CASE_SENSITIVE == DEF_DISABLED)
+        if (found == DEF_NO) {
+            cmp_val = Str_CmpIgnoreCase(dirent.NamePtr, p_name);
+            if (cmp_val == 0) {
+                p_entry->Attrib         = dirent.Attrib;
+                p_entry->Size           = dirent.Size;
+                p_entry->DateTimeCreate = dirent.DateTimeCreate;
+                found                   = DEF_YES;
+            }
+        }
+#endif
+        fs_err = NetFS_DirRd(p_dir, &dirent);
+    }
+    NetFS_DirClose(p_dir);
+
+#if (FTPs_CFG_META_CACHE_EN == DEF_ENABLED)
+    if (found == DEF_YES) {
+        FTPs_MetaPut(path, p_entry);
+    }
+#endif
+#if (FTPs_CFG_NEG_CACHE_EN == DEF_ENABLED)
+    if (found == DEF_NO) {
+        FTPs_NegPut(path);
+    }
+#endif
+
+    return (found);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_FileReplace()
+*
+* Description : Replace a file by a temporary file, without a window where neither exists.
+*
+* Argument(s) : path        FS absolute path of the file to replace (it may not exist).
+*
+*               tmp_path    FS absolute path of the new content.
+*
+* Return(s)   : DEF_OK,   file replaced.
+*
+*               DEF_FAIL, otherwise; the file is left unchanged & the temporary file is kept.
+*
+* Caller(s)   : FTPs_DeltaRx(),
+*               FTPs_SegsCommit().
+*
+* Note(s)     : (1) NetFS_EntryRename() doesn't replace an existing file.  The file is first renamed to a
+*                   backup ("<path>.~bak"), the temporary file is renamed to the file, then the backup is
+*                   deleted.  If the second rename fails, the backup is renamed back.  After a power loss
+*                   between the renames, the previous content is left in the backup.
+*
+*               (2) The caller MUST close the handles kept on the file (see FTPs_HandleClose()) & invalidate
+*                   the caches of both paths.
+*********************************************************************************************************
+*/
+
+#if (FTPs_REPLACE_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_FileReplace (CPU_CHAR  *path,
+                                       CPU_CHAR  *tmp_path)
+{
+    static  CPU_CHAR      bak_path[FTPs_CFG_FS_PATH_LEN_MAX];
+            NET_FS_ENTRY  dirent;
+            CPU_SIZE_T    path_len;
+            CPU_BOOLEAN   found;
+            CPU_BOOLEAN   rtn_val;
+
+
+    found = FTPs_EntryStat(path, &dirent);
+    if (found == DEF_NO) {                                      /* Nothing to replace.                                  */
+        rtn_val = NetFS_EntryRename(tmp_path, path);
+        return (rtn_val);
+    }
+
+    path_len = Str_Len(path);
+    if (path_len + FTPs_BAK_EXT_LEN >= FTPs_CFG_FS_PATH_LEN_MAX) {
+        return (DEF_FAIL);
+    }
+    Str_Copy_N(bak_path, path, FTPs_CFG_FS_PATH_LEN_MAX);
+    Str_Cat(bak_path, FTPs_BAK_EXT_STR);
+
+   (void)NetFS_EntryDel(bak_path, DEF_YES);                     /* Backup left by a previous power loss.                */
+    FTPs_InvalidatePath(bak_path);
+
+    rtn_val = NetFS_EntryRename(path, bak_path);                /* See Note #1.                                         */
+    if (rtn_val != DEF_OK) {
+        return (DEF_FAIL);
+    }
+    rtn_val = NetFS_EntryRename(tmp_path, path);
+    if (rtn_val != DEF_OK) {
+       (void)NetFS_EntryRename(bak_path, path);                 /* Restore the file.                                    */
+        return (DEF_FAIL);
+    }
+   (void)NetFS_EntryDel(bak_path, DEF_YES);
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_MetaInit()
+*
+* Description : Initialize the metadata cache.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_Init().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_META_CACHE_EN == DEF_ENABLED)
+static  void  FTPs_MetaInit (void)
+{
+    CPU_INT32U  i;
+
+
+    FTPs_MetaUseCtr = 0u;
+    Mem_Clr(&FTPs_MetaCacheStat, sizeof(FTPs_MetaCacheStat));
+
+    for (i = 0; i < FTPs_CFG_META_CACHE_NBR_ENTRIES; i++) {
+        FTPs_MetaTbl[i].Path[0] = (CPU_CHAR)0;
+        FTPs_MetaTbl[i].LastUse =  0u;
+        FTPs_MetaTbl[i].Valid   =  DEF_NO;
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs_MetaInvalidate()
+*
+* Description : Invalidate the metadata cache entries of a modified path.
+*
+* Argument(s) : path        FS absolute path of the modified entry.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_InvalidatePath().
+*
+* Note(s)     : (1) The entries of the path's contents are also invalidated, since a renamed or deleted
+*                   directory takes them along.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_META_CACHE_EN == DEF_ENABLED)
+static  void  FTPs_MetaInvalidate (CPU_CHAR  *path)
+{
+    FTPs_META_ENTRY  *p_entry;
+    CPU_BOOLEAN       match;
+    CPU_INT32U        i;
+    CPU_SR_ALLOC();
+
+
+    for (i = 0; i < FTPs_CFG_META_CACHE_NBR_ENTRIES; i++) {
+        p_entry = &FTPs_MetaTbl[i];
+        if (p_entry->Valid == DEF_YES) {
+            match = FTPs_PathMatch(p_entry->Path, path);        /* See Note #1.                                         */
+            if (match == DEF_YES) {
+                p_entry->Valid = DEF_NO;
+                CPU_CRITICAL_ENTER();
+                FTPs_MetaCacheStat.InvalidateCtr++;
+                CPU_CRITICAL_EXIT();
+            }
+        }
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_MetaGet()
+*
+* Description : Find the metadata of an entry in the metadata cache.
+*
+* Argument(s) : path        FS absolute path of the entry.
+*
+*               p_entry     Pointer to the structure that will receive the entry information.
+*
+* Return(s)   : DEF_YES, if recent metadata of the entry is cached.
+*
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : FTPs_EntryStat().
+*
+* Note(s)     : (1) An entry older than FTPs_CFG_META_CACHE_TTL_MS is discarded, so that changes made outside
+*                   of the server are seen.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_META_CACHE_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_MetaGet (CPU_CHAR      *path,
+                                   NET_FS_ENTRY  *p_entry)
+{
+    FTPs_META_ENTRY  *p_meta;
+    NET_TS_MS         ts_now;
+    CPU_INT16S        cmp_val;
+    CPU_INT32U        i;
+    CPU_SR_ALLOC();
+
+
+    ts_now = NetUtil_TS_Get_ms();
+
+    for (i = 0; i < FTPs_CFG_META_CACHE_NBR_ENTRIES; i++) {
+        p_meta = &FTPs_MetaTbl[i];
+        if (p_meta->Valid == DEF_YES) {
+            cmp_val = FTPs_FS_NameCmp(p_meta->Path, path);
+            if (cmp_val == 0) {
+                if ((NET_TS_MS)(ts_now - p_meta->TS) >= FTPs_CFG_META_CACHE_TTL_MS) {
+                    p_meta->Valid = DEF_NO;                     /* See Note #1.                                         */
+                    CPU_CRITICAL_ENTER();
+                    FTPs_MetaCacheStat.ExpireCtr++;
+                    FTPs_MetaCacheStat.MissCtr++;
+                    CPU_CRITICAL_EXIT();
+                    return (DEF_NO);
+                }
+
+                FTPs_MetaUseCtr++;
+                p_meta->LastUse         = FTPs_MetaUseCtr;
+                p_entry->Attrib         = p_meta->Attrib;
+                p_entry->Size           = p_meta->Size;
+                p_entry->DateTimeCreate = p_meta->DateTime;
+                CPU_CRITICAL_ENTER();
+                FTPs_MetaCacheStat.HitCtr++;
+                CPU_CRITICAL_EXIT();
+                return (DEF_YES);
+            }
+        }
+    }
+
+    CPU_CRITICAL_ENTER();
+    FTPs_MetaCacheStat.MissCtr++;
+    CPU_CRITICAL_EXIT();
+
+    return (DEF_NO);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_MetaPut()
+*
+* Description : Store the metadata of an entry in the metadata cache.
+*
+* Argument(s) : path        FS absolute path of the entry.
+*
+*               p_entry     Pointer to the entry information, as read from the file system.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_EntryStat().
+*
+* Note(s)     : (1) A free entry is used if any.  Otherwise, the least recently used entry is replaced.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_META_CACHE_EN == DEF_ENABLED)
+static  void  FTPs_MetaPut (CPU_CHAR      *path,
+                            NET_FS_ENTRY  *p_entry)
+{
+    FTPs_META_ENTRY  *p_meta;
+    FTPs_META_ENTRY  *p_victim;
+    CPU_SIZE_T        path_len;
+    CPU_INT32U        i;
+
+
+    path_len = Str_Len(path);
+    if (path_len >= FTPs_CFG_FS_PATH_LEN_MAX) {
+        return;
+    }
+
+    p_victim = &FTPs_MetaTbl[0];                                /* See Note #1.                                         */
+    for (i = 0; i < FTPs_CFG_META_CACHE_NBR_ENTRIES; i++) {
+        p_meta = &FTPs_MetaTbl[i];
+        if (p_meta->Valid == DEF_NO) {
+            p_victim = p_meta;
+            break;
+        }
+        if (p_meta->LastUse < p_victim->LastUse) {
+            p_victim = p_meta;
+        }
+    }
+
+    FTPs_MetaUseCtr++;
+    Str_Copy(p_victim->Path, path);
+    p_victim->Attrib   = p_entry->Attrib;
+    p_victim->Size     = p_entry->Size;
+    p_victim->DateTime = p_entry->DateTimeCreate;
+    p_victim->TS       = NetUtil_TS_Get_ms();
+    p_victim->LastUse  = FTPs_MetaUseCtr;
+    p_victim->Valid    = DEF_YES;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       FTPs_NegNameOffsetGet()
+*
+* Description : Get the offset of the entry name in a path.
+*
+* Argument(s) : path        FS absolute path of the entry.
+*
+* Return(s)   : Offset of the character following the last separator (0 if none).
+*
+* Caller(s)   : FTPs_NegInvalidate(),
+*               FTPs_NegPut().
+*
+* Note(s)     : (1) Two paths are in the same directory if their name offsets & the characters before are the
+*                   same.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_NEG_CACHE_EN == DEF_ENABLED)
+static  CPU_SIZE_T  FTPs_NegNameOffsetGet (CPU_CHAR  *path)
+{
+    CPU_CHAR  *p_sep;
+
+
+    p_sep = Str_Char_Last(path, FTPs_FS_SepChar);
+    if (p_sep == (CPU_CHAR *)0) {
+        return (0u);
+    }
+
+    return ((CPU_SIZE_T)(p_sep - path) + 1u);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs_NegInvalidate()
+*
+* Description : Invalidate the negative cache entries affected by a modified path.
+*
+* Argument(s) : path        FS absolute path of the created, renamed or deleted entry.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_InvalidatePath().
+*
+* Note(s)     : (1) The entries of the path itself, of its contents & of all the entries of the same
+*                   directory are invalidated.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_NEG_CACHE_EN == DEF_ENABLED)
+static  void  FTPs_NegInvalidate (CPU_CHAR  *path)
+{
+    FTPs_NEG_ENTRY  *p_entry;
+    CPU_SIZE_T       name_offset;
+    CPU_INT16S       cmp_val;
+    CPU_BOOLEAN      match;
+    CPU_INT32U       i;
+
+
+    name_offset = FTPs_NegNameOffsetGet(path);
+
+    for (i = 0; i < FTPs_CFG_NEG_CACHE_NBR_ENTRIES; i++) {
+        p_entry = &FTPs_NegTbl[i];
+        if (p_entry->Valid == DEF_YES) {
+            match = FTPs_PathMatch(p_entry->Path, path);        /* Path itself or its contents ...                      */
+            if (match == DEF_NO) {
+                if (p_entry->NameOffset == name_offset) {       /* ... or same dir (see Note #1).                       */
+                    cmp_val = FTPs_FS_NameCmp_N(p_entry->Path, path, name_offset);
+                    if (cmp_val == 0) {
+                        match = DEF_YES;
+                    }
+                }
+            }
+            if (match == DEF_YES) {
+                p_entry->Valid = DEF_NO;
+            }
+        }
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            FTPs_NegGet()
+*
+* Description : Check if a path is known NOT to exist.
+*
+* Argument(s) : path        FS absolute path of the entry.
+*
+* Return(s)   : DEF_YES, if the path was recently found missing.
+*
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : FTPs_EntryStat(),
+*               FTPs_ProcessCtrlCmd().
+*
+* Note(s)     : (1) An entry older than FTPs_CFG_NEG_CACHE_TTL_MS is discarded, so that files created outside
+*                   of the server are seen.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_NEG_CACHE_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_NegGet (CPU_CHAR  *path)
+{
+    FTPs_NEG_ENTRY  *p_entry;
+    NET_TS_MS        ts_now;
+    CPU_INT16S       cmp_val;
+    CPU_INT32U       i;
+
+
+    ts_now = NetUtil_TS_Get_ms();
+
+    for (i = 0; i < FTPs_CFG_NEG_CACHE_NBR_ENTRIES; i++) {
+        p_entry = &FTPs_NegTbl[i];
+        if (p_entry->Valid == DEF_YES) {
+            cmp_val = FTPs_FS_NameCmp(p_entry->Path, path);
+            if (cmp_val == 0) {
+                if ((NET_TS_MS)(ts_now - p_entry->TS) >= FTPs_CFG_NEG_CACHE_TTL_MS) {
+                    p_entry->Valid = DEF_NO;                    /* See Note #1.                                         */
+                    return (DEF_NO);
+                }
+                return (DEF_YES);
+            }
+        }
+    }
+
+    return (DEF_NO);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            FTPs_NegPut()
+*
+* Description : Remember that a path does NOT exist.
+*
+* Argument(s) : path        FS absolute path of the missing entry.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_EntryStat().
+*
+* Note(s)     : (1) A free entry is used if any.  Otherwise, the oldest entry is replaced.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_NEG_CACHE_EN == DEF_ENABLED)
+static  void  FTPs_NegPut (CPU_CHAR  *path)
+{
+    FTPs_NEG_ENTRY  *p_entry;
+    FTPs_NEG_ENTRY  *p_victim;
+    CPU_SIZE_T       path_len;
+    CPU_INT32U       i;
+
+
+    path_len = Str_Len(path);
+    if (path_len >= FTPs_CFG_FS_PATH_LEN_MAX) {
+        return;
+    }
+
+    p_victim = &FTPs_NegTbl[0];                                 /* See Note #1.                                         */
+    for (i = 0; i < FTPs_CFG_NEG_CACHE_NBR_ENTRIES; i++) {
+        p_entry = &FTPs_NegTbl[i];
+        if (p_entry->Valid == DEF_NO) {
+            p_victim = p_entry;
+            break;
+        }
+        if (p_entry->Seq < p_victim->Seq) {
+            p_victim = p_entry;
+        }
+    }
+
+    FTPs_NegSeqCtr++;
+    Str_Copy(p_victim->Path, path);
+    p_victim->NameOffset = FTPs_NegNameOffsetGet(path);
+    p_victim->TS         = NetUtil_TS_Get_ms();
+    p_victim->Seq        = FTPs_NegSeqCtr;
+    p_victim->Valid      = DEF_YES;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_ListInit()
+*
+* Description : Allocate the directory listing cache entries.
+*
+* Argument(s) : none.
+*
+* Return(s)   : DEF_OK,   cache successfully initialized.
+*
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : FTPs_Init().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_ListInit (void)
+{
+    FTPs_LIST_ENTRY  *p_entry;
+    CPU_INT32U        i;
+    LIB_ERR           lib_err;
+
+
+    FTPs_ListUseCtr = 0u;
+
+    for (i = 0; i < FTPs_CFG_LIST_CACHE_NBR_ENTRIES; i++) {
+        p_entry          = &FTPs_ListTbl[i];
+        p_entry->DataPtr = (CPU_CHAR *)Mem_HeapAlloc(FTPs_CFG_LIST_CACHE_ENTRY_SIZE_MAX,
+                                                     sizeof(CPU_ALIGN),
+                                                     0,
+                                                    &lib_err);
+        if (lib_err != LIB_MEM_ERR_NONE) {
+            return (DEF_FAIL);
+        }
+
+        p_entry->Path[0] = (CPU_CHAR)0;
+        p_entry->DataLen =  0u;
+        p_entry->LastUse =  0u;
+        p_entry->Valid   =  DEF_NO;
+    }
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs_ListInvalidate()
+*
+* Description : Invalidate the cached listings affected by a modified path.
+*
+* Argument(s) : path        FS absolute path of the created, modified, renamed or deleted entry.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_InvalidatePath().
+*
+* Note(s)     : (1) The listing of the parent directory of the path is invalidated, as well as the listings of
+*                   the path itself & of its sub-directories.
+*
+*               (2) A trailing separator in a cached directory path is ignored.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+static  void  FTPs_ListInvalidate (CPU_CHAR  *path)
+{
+    FTPs_LIST_ENTRY  *p_entry;
+    CPU_CHAR         *p_sep;
+    CPU_SIZE_T        parent_len;
+    CPU_SIZE_T        entry_len;
+    CPU_INT16S        cmp_val;
+    CPU_BOOLEAN       match;
+    CPU_INT32U        i;
+
+
+    p_sep = Str_Char_Last(path, FTPs_FS_SepChar);               /* Get parent dir len.                                  */
+    if (p_sep == (CPU_CHAR *)0) {
+        parent_len = 0u;
+    } else {
+        parent_len = (CPU_SIZE_T)(p_sep - path);
+        if (parent_len == 0u) {
+            parent_len = 1u;                                    /* Keep sep char of root dir.                           */
+        }
+    }
+
+    for (i = 0; i < FTPs_CFG_LIST_CACHE_NBR_ENTRIES; i++) {
+        p_entry = &FTPs_ListTbl[i];
+        if (p_entry->Valid == DEF_YES) {
+            match = FTPs_PathMatch(p_entry->Path, path);        /* Path itself or its sub-dirs ...                      */
+            if (match == DEF_NO) {
+                entry_len = Str_Len(p_entry->Path);             /* ... or parent dir (see Note #1).                     */
+                if ((entry_len                   >  1u) &&
+                    (p_entry->Path[entry_len - 1u] == FTPs_FS_SepChar)) {
+                    entry_len--;                                /* See Note #2.                                         */
+                }
+                if (entry_len == parent_len) {
+                    cmp_val = FTPs_FS_NameCmp_N(p_entry->Path, path, parent_len);
+                    if (cmp_val == 0) {
+                        match = DEF_YES;
+                    }
+                }
+            }
+            if (match == DEF_YES) {
+                p_entry->Valid = DEF_NO;
+            }
+        }
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_ListGet()
+*
+* Description : Find the listing of a directory in the listing cache.
+*
+* Argument(s) : path        FS absolute path of the directory.
+*
+*               cmd         Listing command.
+*
+* Return(s)   : Pointer to the cache entry, if a recent listing is cached.
+*
+*               Pointer to NULL,            otherwise.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd(),
+*               FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) A listing older than FTPs_CFG_LIST_CACHE_TTL_MS is discarded, so that changes made outside
+*                   of the server are seen.
+*
+*               (2) Listings filtered by a name pattern & recursive listings are neither cached nor served
+*                   from the cache.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+static  FTPs_LIST_ENTRY  *FTPs_ListGet (CPU_CHAR    *path,
+                                        CPU_INT08U   cmd)
+{
+    FTPs_LIST_ENTRY  *p_entry;
+    NET_TS_MS         ts_now;
+    CPU_INT16S        cmp_val;
+    CPU_INT32U        i;
+
+
+#if (FTPs_CFG_LIST_GLOB_EN == DEF_ENABLED)
+    if (FTPs_Glob.En == DEF_YES) {                              /* See Note #2.                                         */
+        return ((FTPs_LIST_ENTRY *)0);
+    }
+#endif
+#if (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+    if (FTPs_ListWalk.En == DEF_YES) {
+        return ((FTPs_LIST_ENTRY *)0);
+    }
+#endif
+
+    ts_now = NetUtil_TS_Get_ms();
+
+    for (i = 0; i < FTPs_CFG_LIST_CACHE_NBR_ENTRIES; i++) {
+        p_entry = &FTPs_ListTbl[i];
+        if ((p_entry->Valid == DEF_YES) &&
+            (p_entry->Cmd   == cmd)) {
+            cmp_val = FTPs_FS_NameCmp(p_entry->Path, path);
+            if (cmp_val == 0) {
+                if ((NET_TS_MS)(ts_now - p_entry->TS) >= FTPs_CFG_LIST_CACHE_TTL_MS) {
+                    p_entry->Valid = DEF_NO;                    /* See Note #1.                                         */
+                    return ((FTPs_LIST_ENTRY *)0);
+                }
+                FTPs_ListUseCtr++;
+                p_entry->LastUse = FTPs_ListUseCtr;
+                return (p_entry);
+            }
+        }
+    }
+
+    return ((FTPs_LIST_ENTRY *)0);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs_ListFillStart()
+*
+* Description : Reserve a listing cache entry to be filled while a directory listing is being sent.
+*
+* Argument(s) : path        FS absolute path of the directory.
+*
+*               cmd         Listing command.
+*
+* Return(s)   : Pointer to the reserved cache entry.
+*
+*               Pointer to NULL, if the listing must not be cached (see Note #3).
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) A free entry is used, if any.  Otherwise, the least recently used entry is evicted.
+*
+*               (2) The entry is NOT valid until FTPs_ListFillEnd() is called.
+*
+*               (3) Listings filtered by a name pattern, recursive listings & listings of a directory whose
+*                   path doesn't fit an entry are not cached.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+static  FTPs_LIST_ENTRY  *FTPs_ListFillStart (CPU_CHAR    *path,
+                                              CPU_INT08U   cmd)
+{
+    FTPs_LIST_ENTRY  *p_entry;
+    FTPs_LIST_ENTRY  *p_victim;
+    CPU_SIZE_T        path_len;
+    CPU_INT32U        i;
+
+
+    path_len = Str_Len(path);
+    if (path_len >= FTPs_CFG_FS_PATH_LEN_MAX) {                 /* See Note #3.                                         */
+        return ((FTPs_LIST_ENTRY *)0);
+    }
+#if (FTPs_CFG_LIST_GLOB_EN == DEF_ENABLED)
+    if (FTPs_Glob.En == DEF_YES) {
+        return ((FTPs_LIST_ENTRY *)0);
+    }
+#endif
+#if (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+    if (FTPs_ListWalk.En == DEF_YES) {
+        return ((FTPs_LIST_ENTRY *)0);
+    }
+#endif
+
+    p_victim = &FTPs_ListTbl[0];                                /* See Note #1.                                         */
+    for (i = 0; i < FTPs_CFG_LIST_CACHE_NBR_ENTRIES; i++) {
+        p_entry = &FTPs_ListTbl[i];
+        if (p_entry->Valid == DEF_NO) {
+            p_victim = p_entry;
+            break;
+        }
+        if (p_entry->LastUse < p_victim->LastUse) {
+            p_victim = p_entry;
+        }
+    }
+
+    Str_Copy_N(p_victim->Path, path, FTPs_CFG_FS_PATH_LEN_MAX);
+    p_victim->Cmd     = cmd;
+    p_victim->DataLen = 0u;
+    p_victim->TS      = NetUtil_TS_Get_ms();                    /* Listing is as old as the dir read.                   */
+    p_victim->Valid   = DEF_NO;
+
+    return (p_victim);                                          /* See Note #2.                                         */
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs_ListFillAdd()
+*
+* Description : Append rendered listing text to a listing cache entry being filled.
+*
+* Argument(s) : p_entry     Pointer to the entry returned by FTPs_ListFillStart().
+*
+*               p_data      Pointer to the text to append.
+*
+*               len         Length of the text.
+*
+* Return(s)   : Pointer to the entry,   if the text was appended.
+*
+*               Pointer to NULL,        if the listing is too long to be cached (the fill is abandoned).
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+static  FTPs_LIST_ENTRY  *FTPs_ListFillAdd (FTPs_LIST_ENTRY  *p_entry,
+                                            CPU_CHAR         *p_data,
+                                            CPU_SIZE_T        len)
+{
+    if (p_entry->DataLen + len > FTPs_CFG_LIST_CACHE_ENTRY_SIZE_MAX) {
+        FTPs_ListFillEnd(p_entry, DEF_NO);
+        return ((FTPs_LIST_ENTRY *)0);
+    }
+
+    Mem_Copy(p_entry->DataPtr + p_entry->DataLen, p_data, len);
+    p_entry->DataLen += len;
+
+    return (p_entry);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs_ListFillEnd()
+*
+* Description : Complete the fill of a listing cache entry.
+*
+* Argument(s) : p_entry     Pointer to the entry returned by FTPs_ListFillStart().
+*
+*               fill_ok     DEF_YES, if the whole listing was rendered & sent without error.
+*
+*                           DEF_NO,  otherwise.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ListFillAdd(),
+*               FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) An incomplete fill is discarded & the entry is released.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+static  void  FTPs_ListFillEnd (FTPs_LIST_ENTRY  *p_entry,
+                                CPU_BOOLEAN       fill_ok)
+{
+    if (fill_ok == DEF_YES) {                                   /* See Note #1.                                         */
+        FTPs_ListUseCtr++;
+        p_entry->LastUse = FTPs_ListUseCtr;
+        p_entry->Valid   = DEF_YES;
+    } else {
+        p_entry->Valid   = DEF_NO;
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            FTPs_ListTx()
+*
+* Description : Send a cached directory listing on the data connection.
+*
+* Argument(s) : sock_id     Data connection socket id.
+*
+*               p_entry     Pointer to the cache entry.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function.
+*
+* Return(s)   : DEF_OK,   listing successfully sent.
+*
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : FTPs_ProcessDtpCmd().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  FTPs_ListTx (CPU_INT32S        sock_id,
+                                  FTPs_LIST_ENTRY  *p_entry,
+                                  NET_ERR          *p_err)
+{
+    CPU_SIZE_T  pos;
+    CPU_SIZE_T  len;
+
+
+   *p_err = NET_SOCK_ERR_NONE;
+    pos   = 0u;
+    while (pos < p_entry->DataLen) {
+        len = DEF_MIN(p_entry->DataLen - pos, FTPs_NET_BUF_LEN);
+        FTPs_Tx(sock_id, p_entry->DataPtr + pos, (CPU_INT16U)len, p_err);
+        if (*p_err != NET_SOCK_ERR_NONE) {
+            FTPs_TRACE_DBG(("FTPs FTPs_Tx() failed: error #%u, line #%u.\n", (unsigned int)*p_err, (unsigned int)__LINE__));
+            return (DEF_FAIL);
+        }
+        pos += len;
+    }
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs_StartPasvMode()
+*
+* Description : Start passive mode listening socket.
+*
+* Argument(s) : ftp_session     structure that contains FTP session states and control data.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_Ctrl_Task().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  FTPs_StartPasvMode (FTPs_SESSION_STRUCT  *ftp_session,
+                                  NET_ERR              *p_err)
+{
+    CPU_INT32S  pasv_sock_id;
+    NET_ERR     net_err;
+
+
+    if (ftp_session->DtpPasv == DEF_NO) {
+                                                                /* Open a socket.                                       */
+        FTPs_TRACE_INFO(("FTPs OPEN passive DTP socket.\n"));
+        pasv_sock_id = NetSock_Open( NET_SOCK_ADDR_FAMILY_IP_V4,
+                                     NET_SOCK_TYPE_STREAM,
+                                     NET_SOCK_PROTOCOL_TCP,
+                                     p_err);
+        if (*p_err != NET_SOCK_ERR_NONE) {
+            FTPs_TRACE_DBG(("FTPs NetSock_Open() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
+            return;
+        }
+
+#ifdef  NET_SECURE_MODULE_PRESENT                               /* Set or clear socket secure mode.                     */
+        if (FTPs_SecureCfgPtr != DEF_NULL) {
+           (void)NetSock_CfgSecure(pasv_sock_id,
+                                   DEF_YES,
+                                   p_err);
+            if (*p_err != NET_SOCK_ERR_NONE) {
+                FTPs_TRACE_DBG(("FTPs NetSock_CfgSecure() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
+                NetSock_Close(pasv_sock_id, &net_err);
+                return;
+            }
+
+           (void)NetSock_CfgSecureServerCertKeyInstall(pasv_sock_id,
+                                                       FTPs_SecureCfgPtr->CertPtr,
+                                                       FTPs_SecureCfgPtr->CertLen,
+                                                       FTPs_SecureCfgPtr->KeyPtr,
+                                                       FTPs_SecureCfgPtr->KeyLen,
+                                                       FTPs_SecureCfgPtr->Fmt,
+                                                       FTPs_SecureCfgPtr->CertChain,
+                                                       p_err);
+            if (*p_err != NET_SOCK_ERR_NONE) {
+                FTPs_TRACE_DBG(("FTPs NetSock_CfgSecureServerCertKeyInstall() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
+                NetSock_Close(pasv_sock_id, &net_err);
+                return;
+            }
+        }
+#endif
+
+                                                                /* Bind a local address so the clients can send to us.  */
+        NetSock_Bind(pasv_sock_id,
+                     (NET_SOCK_ADDR *)&ftp_session->DtpSockAddr,
+                     sizeof(ftp_session->DtpSockAddr),
+                     p_err);
+        if (*p_err != NET_SOCK_ERR_NONE) {
+            NetSock_Close(pasv_sock_id, &net_err);
+            FTPs_TRACE_DBG(("FTPs NetSock_Bind() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
+            return;
+        }
+
+                                                                /* Listen to the socket for clients.                    */
+        NetSock_Listen(pasv_sock_id, FTPs_DTP_CONN_Q_SIZE, p_err);
+        if (*p_err != NET_SOCK_ERR_NONE) {
+            NetSock_Close(pasv_sock_id, &net_err);
+            FTPs_TRACE_DBG(("FTPs NetSock_Listen() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
+            return;
+        }
+
+        ftp_session->DtpPasv       = DEF_YES;
+        ftp_session->DtpPasvSockID = pasv_sock_id;
+
+        *p_err = NET_ERR_NONE;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_StopPasvMode()
+*
+* Description : Stop passive mode listening socket.
+*
+* Argument(s) : ftp_session     structure that contains FTP session states and control data.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_Ctrl_Task()
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  FTPs_StopPasvMode (FTPs_SESSION_STRUCT  *ftp_session)
+{
+    NET_ERR  net_err;
+
+
+    if (ftp_session->DtpPasv == DEF_YES) {
+        FTPs_TRACE_INFO(("FTPs CLOSE passive DTP socket.\n"));
+        NetSock_Close(ftp_session->DtpPasvSockID, &net_err);
+        ftp_session->DtpPasv =  DEF_NO;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_SendReply()
+*
+* Description : Send reply message to a command.
+*
+* Argument(s) : sock_id         control socket ID.
+*               reply_nbr       reply message number.
+*               reply_msg       reply message (set to NULL to send the official message related
+*                               to reply_nbr).
+*
+* Return(s)   : Network error code.
+*
+* Caller(s)   : FTPs_Ctrl_Task().
+*
+* Note(s)     : This function is a convenience function to build and send a reply message back to a
+*               client.  If the incoming reply_msg string is NULL, then the FTPs_Reply[] table is
+*               searched for reply code's corresponding message string.  If the reply_msg string pointer
+*               is not NULL, then it is used instead of the default reply message.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  NET_ERR  FTPs_SendReply (CPU_INT32S   sock_id,
+                                 CPU_INT32S   reply_nbr,
+                                 CPU_CHAR    *reply_msg)
+{
+    CPU_INT32S  net_buf_len;
+    NET_ERR     net_err;
+
+
+    if (reply_msg == (CPU_CHAR *)0) {
+        net_buf_len = Str_FmtPrint((char *)FTPs_NetBufSendReplyPtr,
+                                           FTPs_NET_BUF_LEN,
+                                   (char *)"%s\r\n",
+                                   (char *)FTPs_Reply[reply_nbr].ReplyStr);
+    } else {
+        net_buf_len = Str_FmtPrint((char *)FTPs_NetBufSendReplyPtr,
+                                           FTPs_NET_BUF_LEN,
+                                   (char *)"%s\r\n",
+                                           reply_msg);
+    }
+
+    FTPs_TRACE_INFO(("FTPs TX: %s", FTPs_NetBufCtrlTaskPtr));
+
+    FTPs_Tx(sock_id, FTPs_NetBufSendReplyPtr, net_buf_len, &net_err);
+    if (net_err != NET_SOCK_ERR_NONE) {
+        FTPs_TRACE_DBG(("FTPs FTPs_Tx() failed: reply #%d, error #%u, line #%u.\n", reply_nbr, (unsigned int)net_err, (unsigned int)__LINE__));
+    }
+    return (net_err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs_ReplyMultiStart()
+*
+* Description : Start a multi-line reply streamed while a command executes.
+*
+* Argument(s) : p_reply     Pointer to the reply state.
+*
+*               sock_id     Control socket ID.
+*
+*               reply_nbr   Reply number of the reply, if it is sent before the command ends (see Note #2).
+*
+*               p_line      Text of the first line.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_SiteRmTree(),
+*               FTPs_SiteMkDirs().
+*
+* Note(s)     : (1) The reply is built in the FTPs_ProcessCtrlCmd() network buffer & sent each time the buffer
+*                   is full, so that the client sees the progress of long commands without a send per line.
+*
+*               (2) RFC 959 requires the first & last lines of a multi-line reply to carry the same code.  The
+*                   code is written in the first line when the buffer is first sent : if the whole reply fits
+*                   in the buffer, the code passed to FTPs_ReplyMultiEnd() is used; otherwise, 'reply_nbr' is
+*                   used for the whole reply.
+*********************************************************************************************************
+*/
+
+static  void  FTPs_ReplyMultiStart (FTPs_REPLY_MULTI  *p_reply,
+                                    CPU_INT32S         sock_id,
+                                    CPU_INT32S         reply_nbr,
+                                    CPU_CHAR          *p_line)
+{
+    p_reply->SockID   = sock_id;
+    p_reply->ReplyNbr = reply_nbr;
+    p_reply->Sent     = DEF_NO;
+    p_reply->Len      = Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
+                                             FTPs_NET_BUF_LEN,
+                                             "000-%s\r\n",      /* Code written when sent (see Note #2).                */
+                                             p_line);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs_ReplyMultiAdd()
+*
+* Description : Add an intermediate line to a multi-line reply.
+*
+* Argument(s) : p_reply     Pointer to the reply state.
+*
+*               p_line      Text of the line.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_SiteRmTree(),
+*               FTPs_SiteMkDirs().
+*
+* Note(s)     : (1) Intermediate lines start with a space, so that a line can never be taken for the last
+*                   line of the reply.
+*********************************************************************************************************
+*/
+
+static  void  FTPs_ReplyMultiAdd (FTPs_REPLY_MULTI  *p_reply,
+                                  CPU_CHAR          *p_line)
+{
+    CPU_SIZE_T  line_len;
+
+
+    line_len = Str_Len(p_line);
+    if (p_reply->Len + line_len + 3u >= FTPs_NET_BUF_LEN) {     /* Send buffered lines.                                 */
+        FTPs_ReplyMultiTx(p_reply);
+    }
+
+    p_reply->Len += Str_FmtPrint((char *)&FTPs_NetBufCtrlCmdPtr[p_reply->Len],
+                                          FTPs_NET_BUF_LEN - p_reply->Len,
+                                          " %s\r\n",            /* See Note #1.                                         */
+                                          p_line);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs_ReplyMultiEnd()
+*
+* Description : Add the last line to a multi-line reply & send it.
+*
+* Argument(s) : p_reply     Pointer to the reply state.
+*
+*               reply_nbr   Reply number of the reply (see FTPs_ReplyMultiStart() Note #2).
+*
+*               p_line      Text of the last line.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_SiteRmTree(),
+*               FTPs_SiteMkDirs().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  FTPs_ReplyMultiEnd (FTPs_REPLY_MULTI  *p_reply,
+                                  CPU_INT32S         reply_nbr,
+                                  CPU_CHAR          *p_line)
+{
+    CPU_SIZE_T  line_len;
+
+
+    line_len = Str_Len(p_line);
+    if (p_reply->Len + line_len + 6u >= FTPs_NET_BUF_LEN) {     /* No room for last line: send buffered lines.          */
+        FTPs_ReplyMultiTx(p_reply);
+    }
+
+    if (p_reply->Sent == DEF_NO) {                              /* Whole reply in buffer: use final code.               */
+        p_reply->ReplyNbr = reply_nbr;
+    }
+
+    p_reply->Len += Str_FmtPrint((char *)&FTPs_NetBufCtrlCmdPtr[p_reply->Len],
+                                          FTPs_NET_BUF_LEN - p_reply->Len,
+                                          "%03u %s\r\n",
+                                          (unsigned int)FTPs_Reply[p_reply->ReplyNbr].ReplyCode,
+                                          p_line);
+    FTPs_ReplyMultiTx(p_reply);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs_ReplyMultiTx()
+*
+* Description : Send the buffered lines of a multi-line reply.
+*
+* Argument(s) : p_reply     Pointer to the reply state.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ReplyMultiAdd(),
+*               FTPs_ReplyMultiEnd().
+*
+* Note(s)     : (1) The reply code is written in the first line when it is sent (see FTPs_ReplyMultiStart()
+*                   Note #2).
+*********************************************************************************************************
+*/
+
+static  void  FTPs_ReplyMultiTx (FTPs_REPLY_MULTI  *p_reply)
+{
+    CPU_INT16U  code;
+    NET_ERR     net_err;
+
+
+    if (p_reply->Sent == DEF_NO) {                              /* See Note #1.                                         */
+        code = FTPs_Reply[p_reply->ReplyNbr].ReplyCode;
+        FTPs_NetBufCtrlCmdPtr[0] = (CPU_CHAR)('0' +  code / 100u);
+        FTPs_NetBufCtrlCmdPtr[1] = (CPU_CHAR)('0' + (code /  10u) % 10u);
+        FTPs_NetBufCtrlCmdPtr[2] = (CPU_CHAR)('0' +  code % 10u);
+        p_reply->Sent            =  DEF_YES;
+    }
+
+    FTPs_TRACE_INFO(("FTPs TX: %s", FTPs_NetBufCtrlCmdPtr));
+
+    FTPs_Tx(p_reply->SockID, FTPs_NetBufCtrlCmdPtr, p_reply->Len, &net_err);
+    if (net_err != NET_SOCK_ERR_NONE) {
+        FTPs_TRACE_DBG(("FTPs FTPs_Tx() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
+    }
+    p_reply->Len = 0u;
+}
+
+
+/*
+*********************************************************************************************************
+*                                               FTPs_Tx()
+*
+* Description : Transmit data to TCP socket, handling transient errors and incomplete buffer transmit.
+*
+* Argument(s) : sock_id             TCP socket ID.
+*               net_buf             buffer to send.
+*               net_buf_len         length of buffer to send.
+*               net_err             contains error message returned.
+*
+* Return(s)   : DEF_OK,   data successfully transmitted.
+*
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : FTPs_SendReply(),
+*               FTPs_ProcessDtpCmd().
+*
+* Note(s)     : (1) The transmit on the data connection stops as soon as ABOR is received on the control
+*                   connection (see FTPs_AbortChk()), even while a transitory error is retried.
+*
+*               (2) The data connection is paced to the rate limits, if any (see FTPs_RatePace()).
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  FTPs_Tx (CPU_INT32S   sock_id,
+                              CPU_CHAR    *net_buf,
+                              CPU_INT16U   net_buf_len,
+                              NET_ERR     *net_err)
+{
+    CPU_CHAR     *tx_buf;
+    CPU_INT16S    tx_buf_len;
+    CPU_INT16S    tx_len;
+    CPU_INT16S    tx_len_tot;
+    CPU_INT32U    tx_retry_cnt;
+    CPU_BOOLEAN   tx_done;
+    CPU_BOOLEAN   tx_dly;
+    CPU_BOOLEAN   aborted;
+
+
+    tx_len_tot   = 0;
+    tx_retry_cnt = 0;
+    tx_done      = DEF_NO;
+    tx_dly       = DEF_NO;
+
+    while ((tx_len_tot   <  net_buf_len)               &&       /* While tx tot len < buf len ...                       */
+           (tx_retry_cnt <  FTPs_CFG_DTP_MAX_TX_RETRY) &&       /* ... & tx retry   < MAX     ...                       */
+           (tx_done      == DEF_NO)) {                          /* ... & tx NOT done;         ...                       */
+
+        if (tx_dly == DEF_YES) {                                /* Dly tx, if req'd.                                    */
+            KAL_Dly(100u);
+        }
+
+        aborted = FTPs_AbortChk(sock_id);                       /* See Note #1.                                         */
+        if (aborted == DEF_YES) {
+           *net_err = NET_SOCK_ERR_CONN_FAIL;
+            break;
+        }
+
+        tx_buf     = net_buf     + tx_len_tot;
+        tx_buf_len = net_buf_len - tx_len_tot;
+        tx_len     = NetSock_TxData(sock_id,                    /* ... tx data.                                         */
+                                    tx_buf,
+                                    tx_buf_len,
+                                    NET_SOCK_FLAG_NONE,
+                                    net_err);
+        switch (*net_err) {
+            case NET_SOCK_ERR_NONE:
+                 if (tx_len > 0) {                              /* If          tx len > 0, ...                          */
+                     tx_len_tot += tx_len;                      /* ... inc tot tx len.                                  */
+                     tx_dly      = DEF_NO;
+                 } else {                                       /* Else dly next tx.                                    */
+                     tx_dly      = DEF_YES;
+                 }
+                 tx_retry_cnt = 0;
+                 break;
+
+            case NET_SOCK_ERR_NOT_USED:
+            case NET_SOCK_ERR_INVALID_TYPE:
+            case NET_SOCK_ERR_INVALID_FAMILY:
+            case NET_SOCK_ERR_INVALID_STATE:
+                 tx_done = DEF_YES;
+                 break;
+
+            case NET_ERR_TX:                                    /* If transitory tx err, ...                            */
+            default:
+                 tx_dly = DEF_YES;                              /* ... dly next tx.                                     */
+                 tx_retry_cnt++;
+                 break;
+        }
+    }
+
+#if (FTPs_CFG_RATE_EN == DEF_ENABLED)
+    FTPs_RatePace(sock_id, (CPU_INT32U)tx_len_tot);             /* See Note #2.                                         */
+#endif
+
+    if (*net_err != NET_SOCK_ERR_NONE) {
+        return (DEF_FAIL);
+    }
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                               FTPs_Rx()
+*
+* Description : Receive data from the TCP socket of a transfer, unless the transfer is aborted.
+*
+* Argument(s) : sock_id             TCP socket ID.
+*               net_buf             buffer to receive into.
+*               net_buf_len         length of buffer.
+*               net_err             contains error message returned.
+*
+* Return(s)   : Nbr of octets received, as returned by NetSock_RxData().
+*
+*               -1, if ABOR was received on the control connection (see FTPs_AbortChk()).
+*
+* Caller(s)   : FTPs_DeltaRx(),
+*               FTPs_ProcessDtpCmd(),
+*               FTPs_SegsRx(),
+*               FTPs_TarRx().
+*
+* Note(s)     : (1) The caller MUST set the receive timeout of the socket to FTPs_DTP_RX_SLICE_MS.  ABOR is
+*                   checked before each receive & after each receive timeout, so that the transfer stops
+*                   within one buffer or one FTPs_DTP_RX_SLICE_MS, whatever the client does with the data
+*                   connection.  The receive only times out after FTPs_CFG_DTP_MAX_RX_TIMEOUT_MS.
+*
+*                   The end of the data (closed connection or timeout) is checked against ABOR once more,
+*                   since a client MAY close the data connection before ABOR is received: an aborted
+*                   transfer is never taken for a complete one.
+*
+*               (2) The receive is paced to the rate limits, if any (see FTPs_RatePace()): the client is
+*                   slowed down by the TCP receive window.
+*********************************************************************************************************
+*/
+
+static  CPU_INT16S  FTPs_Rx (CPU_INT32S   sock_id,
+                             CPU_CHAR    *net_buf,
+                             CPU_INT16U   net_buf_len,
+                             NET_ERR     *net_err)
+{
+    CPU_INT16S   rx_len;
+    CPU_INT32U   rx_wait_ms;
+    CPU_BOOLEAN  aborted;
+
+
+    rx_wait_ms = 0u;
+    while (DEF_TRUE) {
+        aborted = FTPs_AbortChk(sock_id);                       /* See Note #1.                                         */
+        if (aborted == DEF_YES) {
+           *net_err = NET_SOCK_ERR_CONN_FAIL;
+            return (-1);
+        }
+
+        rx_len = NetSock_RxData(sock_id, net_buf, net_buf_len, NET_SOCK_FLAG_NONE, net_err);
+        if (*net_err != NET_SOCK_ERR_RX_Q_EMPTY) {
+            break;
+        }
+        rx_wait_ms += FTPs_DTP_RX_SLICE_MS;
+        if (rx_wait_ms >= FTPs_CFG_DTP_MAX_RX_TIMEOUT_MS) {
+            break;
+        }
+    }
+
+    if ((*net_err == NET_SOCK_ERR_RX_Q_CLOSED) ||               /* End of data: check ABOR again.                       */
+        (*net_err == NET_SOCK_ERR_RX_Q_EMPTY)) {
+        aborted = FTPs_AbortChk(sock_id);
+        if (aborted == DEF_YES) {
+           *net_err = NET_SOCK_ERR_CONN_FAIL;
+            return (-1);
+        }
+    }
+
+#if (FTPs_CFG_RATE_EN == DEF_ENABLED)
+    if (rx_len > 0) {                                           /* See Note #2.                                         */
+        FTPs_RatePace(sock_id, (CPU_INT32U)rx_len);
+    }
+#endif
+
+    return (rx_len);
+}
+
+
+/*
+*********************************************************************************************************
+*                                            FTPs_AbortChk()
+*
+* Description : Check if ABOR was received on the control connection during the current transfer.
+*
+* Argument(s) : sock_id     TCP socket ID used by the caller.
+*
+* Return(s)   : DEF_YES, if ABOR was received & sock_id is the data connection of the transfer.
+*
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : FTPs_Rx(),
+*               FTPs_TailTx(),
+*               FTPs_Tx().
+*
+* Note(s)     : (1) The transfer runs in the control task (see FTPs_DtpTask()), so the control connection
+*                   is not read until the transfer ends.  Its receive queue is peeked without blocking &
+*                   without consuming the octets: ABOR is then read & replied to by FTPs_CtrlTask() once
+*                   the transfer replied 426 (see RFC #959, section 4.1.3).
+*
+*               (2) The Telnet "Interrupt Process" & "Synch" signals sent before ABOR (see RFC #959,
+*                   section 4.1.3) are received in line with the command, since the TCP urgent data is
+*                   not delivered separately by the TCP/IP stack.  They are skipped (see FTPs_TelnetStrip()).
+*
+*               (3) Any other command received during the transfer is left for FTPs_CtrlTask() & hides a
+*                   following ABOR until the transfer ends.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  FTPs_AbortChk (CPU_INT32S  sock_id)
+{
+    CPU_CHAR     buf[FTPs_ABOR_PEEK_LEN + 1u];
+    CPU_CHAR    *p_buf;
+    CPU_INT16S   rx_len;
+    CPU_INT16S   cmp_val;
+    CPU_BOOLEAN  is_space;
+    NET_ERR      net_err;
+
+
+    if (FTPs_DtpSessionPtr == (FTPs_SESSION_STRUCT *)0) {       /* No transfer in progress.                             */
+        return (DEF_NO);
+    }
+    if (sock_id != FTPs_DtpSessionPtr->DtpSockID) {             /* Not the data connection (e.g. a reply).              */
+        return (DEF_NO);
+    }
+    if (FTPs_DtpAbort == DEF_YES) {
+        return (DEF_YES);
+    }
+                                                                /* See Note #1.                                         */
+    rx_len = NetSock_RxData( FTPs_DtpSessionPtr->CtrlSockID,
+                             buf,
+                             FTPs_ABOR_PEEK_LEN,
+                             NET_SOCK_FLAG_RX_DATA_PEEK | NET_SOCK_FLAG_RX_NO_BLOCK,
+                            &net_err);
+    if ((net_err != NET_SOCK_ERR_NONE) ||
+        (rx_len  <= 0)) {
+        return (DEF_NO);
+    }
+    buf[rx_len] = (CPU_CHAR)0;
+
+    FTPs_TelnetStrip(buf);                                      /* See Note #2.                                         */
+
+    p_buf = buf;
+    while (*p_buf != (CPU_CHAR)0) {
+        is_space = ASCII_IsSpace(*p_buf);
+        if (is_space == DEF_NO) {
+            break;
+        }
+        p_buf++;
+    }
+
+    cmp_val = Str_CmpIgnoreCase_N(p_buf, (CPU_CHAR *)"ABOR", 4u);
+    if (cmp_val == 0) {
+        FTPs_TRACE_INFO(("FTPs ABOR received during transfer.\n"));
+        FTPs_DtpAbort = DEF_YES;
+    }
+
+    return (FTPs_DtpAbort);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_TelnetStrip()
+*
+* Description : Remove the Telnet commands from a command line.
+*
+* Argument(s) : p_buf       Pointer to the NULL-terminated command line, modified in place.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_AbortChk(),
+*               FTPs_CtrlTask().
+*
+* Note(s)     : (1) See RFC #854.  An IAC octet is followed by a command octet & the option negotiation
+*                   commands (WILL, WONT, DO & DONT) by an option octet.  IAC IAC stands for a data octet of
+*                   value 255.  An incomplete sequence at the end of the line is removed.
+*********************************************************************************************************
+*/
+
+static  void  FTPs_TelnetStrip (CPU_CHAR  *p_buf)
+{
+    CPU_CHAR    *p_rd;
+    CPU_CHAR    *p_wr;
+    CPU_INT08U   cmd;
+
+
+    p_rd = p_buf;
+    p_wr = p_buf;
+    while (*p_rd != (CPU_CHAR)0) {
+        if ((CPU_INT08U)*p_rd != FTPs_TELNET_IAC) {
+           *p_wr++ = *p_rd++;
+            continue;
+        }
+
+        p_rd++;                                                 /* See Note #1.                                         */
+        cmd = (CPU_INT08U)*p_rd;
+        if (cmd == 0u) {
+            break;
+        }
+        p_rd++;
+        if (cmd == FTPs_TELNET_IAC) {
+           *p_wr++ = (CPU_CHAR)FTPs_TELNET_IAC;
+        } else if ((cmd >= FTPs_TELNET_WILL) &&
+                   (*p_rd != (CPU_CHAR)0)) {
+            p_rd++;                                             /* Skip option.                                         */
+        }
+    }
+   *p_wr = (CPU_CHAR)0;
+}
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_RateReset()
+*
+* Description : Give a full burst to the rate limiting buckets.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_CtrlTask().
+*
+* Note(s)     : (1) Called when a session starts, so that the time stamps are never compared across long
+*                   idle periods (see FTPs_RateUse() Note #2).
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_RATE_EN == DEF_ENABLED)
+static  void  FTPs_RateReset (void)
+{
+    NET_TS_MS  ts_now;
+
+
+    ts_now                 = NetUtil_TS_Get_ms();
+    FTPs_RateGlobal.TS     = ts_now - FTPs_CFG_RATE_BURST_MS;
+    FTPs_RateGlobal.Rem    = 0u;
+    FTPs_RateSession.TS    = ts_now - FTPs_CFG_RATE_BURST_MS;
+    FTPs_RateSession.Rem   = 0u;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            FTPs_RateUse()
+*
+* Description : Take octets transferred from a token bucket.
+*
+* Argument(s) : p_bucket    Pointer to the bucket.
+*
+*               rate        Rate limit, in octets per second (0 if none).
+*
+*               len         Nbr of octets transferred.
+*
+*               ts_now      Current time stamp.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_RatePace().
+*
+* Note(s)     : (1) The bucket holds the time at which the octets transferred are paid for at the rate
+*                   limit.  The transfer MUST wait while this time is in the future.  A bucket is never
+*                   more than FTPs_CFG_RATE_BURST_MS in the past, which limits the octets transferred at
+*                   once after an idle period.
+*
+*               (2) The time is compared with a signed difference, which stays valid while a session is
+*                   opened.
+*
+*               (3) The octets are converted to milliseconds without losing the remainder, so that the
+*                   average rate is exact whatever the timer & time stamp resolution.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_RATE_EN == DEF_ENABLED)
+static  void  FTPs_RateUse (FTPs_RATE_BUCKET  *p_bucket,
+                            CPU_INT32U         rate,
+                            CPU_INT32U         len,
+                            NET_TS_MS          ts_now)
+{
+    CPU_INT32U  nbr;
+
+
+    if (rate == 0u) {                                           /* No limit.                                            */
+        return;
+    }
+                                                                /* See Notes #1 & #2.                                   */
+    if ((CPU_INT32S)(ts_now - FTPs_CFG_RATE_BURST_MS - p_bucket->TS) > 0) {
+        p_bucket->TS  = ts_now - FTPs_CFG_RATE_BURST_MS;
+        p_bucket->Rem = 0u;
+    }
+
+    nbr           = len * 1000u + p_bucket->Rem;                /* See Note #3.                                         */
+    p_bucket->TS += nbr / rate;
+    p_bucket->Rem = nbr % rate;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_RatePace()
+*
+* Description : Pace a data transfer to the global & session rate limits.
+*
+* Argument(s) : sock_id     TCP socket ID used by the caller.
+*
+*               len         Nbr of octets just transferred.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_Rx(),
+*               FTPs_Tx().
+*
+* Note(s)     : (1) Only the data connection of the transfer in progress is paced (see FTPs_DtpTask()).
+*
+*               (2) The wait is driven by a one-shot kernel timer of FTPs_CFG_RATE_TMR_MS, rather than by
+*                   KAL_Dly() in ticks.  The time is measured after each wake-up (see FTPs_RateUse() Note #3).
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_RATE_EN == DEF_ENABLED)
+static  void  FTPs_RatePace (CPU_INT32S  sock_id,
+                             CPU_INT32U  len)
+{
+    NET_TS_MS   ts_now;
+    CPU_INT32S  wait_global;
+    CPU_INT32S  wait_session;
+    KAL_ERR     kal_err;
+
+
+    if (FTPs_DtpSessionPtr == (FTPs_SESSION_STRUCT *)0) {       /* See Note #1.                                         */
+        return;
+    }
+    if ((sock_id != FTPs_DtpSessionPtr->DtpSockID) ||
+        (len     == 0u)) {
+        return;
+    }
+
+    ts_now = NetUtil_TS_Get_ms();
+    FTPs_RateUse(&FTPs_RateGlobal,  FTPs_CFG_RATE_GLOBAL_LIMIT,      len, ts_now);
+    FTPs_RateUse(&FTPs_RateSession, FTPs_DtpSessionPtr->RateLimit, len, ts_now);
+
+    while (DEF_TRUE) {
+        wait_global  = (CPU_INT32S)(FTPs_RateGlobal.TS  - ts_now);
+        wait_session = (CPU_INT32S)(FTPs_RateSession.TS - ts_now);
+        if ((wait_global  <= 0) &&
+            (wait_session <= 0)) {
+            break;
+        }
+                                                                /* See Note #2.                                         */
+        KAL_SemSet(FTPs_RateSem, 0u, &kal_err);                 /* Discard a wake-up of a previous wait.                */
+        KAL_TmrStart(FTPs_RateTmr, &kal_err);
+        if (kal_err != KAL_ERR_NONE) {
+            FTPs_TRACE_DBG(("FTPs KAL_TmrStart() failed: error #%u, line #%u.\n", (unsigned int)kal_err, (unsigned int)__LINE__));
+            break;
+        }
+        KAL_SemPend(FTPs_RateSem, KAL_OPT_PEND_NONE, FTPs_RATE_WAIT_MAX_MS, &kal_err);
+        ts_now = NetUtil_TS_Get_ms();
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs_RateTmrCallback()
+*
+* Description : Wake the paced transfer.
+*
+* Argument(s) : p_arg       Argument of the timer (unused).
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Kernel timer, started by FTPs_RatePace().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_RATE_EN == DEF_ENABLED)
+static  void  FTPs_RateTmrCallback (void  *p_arg)
+{
+    KAL_ERR  kal_err;
+
+
+    (void)&p_arg;
+
+    KAL_SemPost(FTPs_RateSem, KAL_OPT_POST_NONE, &kal_err);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         FTPs_ProcessCtrlCmd()
+*
+* Description : Core execution routines of the FTP commands.
+*
+* Argument(s) : ftp_session     structure that contains FTP session states and control data.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_Ctrl_Task().
+*
+* Note(s)     : (1) The presence of files & directories is checked with FTPs_EntryStat(), which never opens
+*                   a file.  Only RETR, NLST & LIST open the entry, since the transfer uses the same handle.
+*
+*               (2) The arguments of NLST, LIST & MLSD are handled as follows:
+*
+*                   (a) Leading "-xxxx" options (e.g. "-la") are skipped; the path follows them, if any.  An
+*                       'R' option requests a recursive LIST or MLSD (see FTPs_ProcessDtpCmd() Note #1),
+*                       only in a token made of option letters (e.g. "-lR", but not "--Recent").
+*                   (b) When the last path component contains '*', '?' or '[', it is compiled as a name
+*                       pattern (see FTPs_GlobCompile()) & the parent path is listed.  Only the entries
+*                       matching the pattern are formatted & sent.  Wildcards in other components are not
+*                       expanded.
+*
+*               (3) SITE takes a sub-command name (see FTPs_SiteCmd[]) followed by a path.
+*
+*                   (a) SITE HELP takes no path; every other sub-command requires one & is executed by
+*                       FTPs_ProcessSiteCmd() once the path is built.
+*                   (b) SITE CPTO MUST immediately follow SITE CPFR, like RNTO follows RNFR.  Any other
+*                       SITE sub-command cancels a pending copy.
+*                   (c) SITE DEDUP takes a SHA-256 digest, as 64 hexadecimal digits, before the path.
+*                   (d) SITE SEGS takes the file size, in decimal, before the path; 0 cancels the upload.
+*
+*               (4) "RETR <dirname>.tar" retrieves a tar archive of the directory, generated while it is sent
+*                   (see FTPs_TarTx()), unless a file of that name exists.  Likewise, "STOR <dirname>.tar"
+*                   extracts the archive into the directory while it is received (see FTPs_TarRx()).  STOR
+*                   after REST always stores a file.
+*
+*               (5) "RETR <filename>.sig" retrieves the block signature of the file & "STOR <filename>.delta"
+*                   rebuilds the file from a delta computed against that signature (see FTPs_DeltaStart()),
+*                   unless a file of that name exists.  Neither is recognized after REST.
+*
+*               (6) "REST <offset>-<end>" also sets the offset of the last octet sent by the following RETR
+*                   of a file, so that a client can download disjoint parts of a file in parallel sessions.
+*                   The end offset is included & is ignored by APPE, & by STOR unless the file is uploaded in
+*                   segments (see Note #7).  An argument that isn't "<offset>" or "<offset>-<end>", in decimal,
+*                   is refused & leaves the previous restart point unchanged.
+*
+*               (7) STOR after "REST <offset>-<end>" of a file declared by SITE SEGS sends a segment of the
+*                   file (see FTPs_SegsStart()).  An invalid segment is refused like a missing file.
+*
+*               (8) "RETR <filename>.tail" sends the file, then keeps the data connection open to send the
+*                   octets appended to it (see FTPs_TailStart()).  After REST, the file is sent from the
+*                   restart offset.
+*
+*               (9) SIZE of a file whose upload was interrupted returns the number of octets written to the
+*                   media, as recorded in the resume journal (see FTPs_ResumeGet()), so that the client can
+*                   continue the upload with REST & STOR.
+*
+*              (10) A transfer aborted by ABOR has already replied 426 & closed the data connection when ABOR
+*                   is processed (see FTPs_DtpTask() Note #2).  ABOR is then replied to with 226, like ABOR
+*                   without a transfer in progress, & cancels a pending REST, RNFR or SITE CPFR.
+*
+*              (11) A path naming a file of the server itself, the dedup index or the resume journal, is
+*                   refused like a missing file (see FTPs_PathIsRsvd()).
+*
+*              (12) A prefetched file is served only if its size & date/time are still those of the file, like
+*                   a content cache entry (see FTPs_CacheGet()).  Otherwise, the file was modified without the
+*                   server since it was prefetched.
+*
+*              (13) A RETR whose file size or date/time can't be read is sent without the content cache : a
+*                   null size is never cached (see FTPs_CacheFillStart() Note #1), so neither a stale entry
+*                   nor the version of a previous RETR is used.
+*********************************************************************************************************
+*/
+
+static  void  FTPs_ProcessCtrlCmd (FTPs_SESSION_STRUCT  *ftp_session)
+{
+    CPU_CHAR       *p_cmd_arg;
+    CPU_CHAR       *p_file_time;
+    CPU_CHAR       *p_opt;
+
+    void           *p_file;
+    void           *p_dir;
+    NET_FS_ENTRY    dirent;
+    CPU_INT32U      path_name_len;
+
+    CPU_INT08U     *p_addr;
+    CPU_INT08U     *p_port;
+
+    NET_IPv4_ADDR   addr;
+    NET_PORT_NBR    port;
+
+    CPU_INT16S      cmp_val;
+    CPU_BOOLEAN     dig;
+    CPU_BOOLEAN     found;
+    CPU_BOOLEAN     rtn_val;
+    CPU_INT32U      str_len;
+    CPU_INT32U      offset;
+    CPU_INT32U      range_len;
+    CPU_INT32U      i;
+    CPU_INT08U      site_cmd;
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+    FTPs_PIN_ENTRY *p_pin;
+#endif
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+    CPU_BOOLEAN           size_ok;
+    CPU_BOOLEAN           date_ok;
+#endif
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+    FTPs_PREFETCH_ENTRY  *p_pf;
+    CPU_BOOLEAN           same_ver;
+#endif
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+    FTPs_LIST_ENTRY      *p_list;
+#endif
+#if (FTPs_CFG_LIST_GLOB_EN == DEF_ENABLED)
+    CPU_CHAR       *p_name;
+    CPU_BOOLEAN     is_glob;
+#endif
+#if (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+    CPU_CHAR       *p_opt_ch;
+    CPU_BOOLEAN     opt_r;
+#endif
+#if (FTPs_SRV_FILES_EN == DEF_ENABLED)
+    CPU_BOOLEAN     rsvd;
+#endif
+
+    NET_ERR         net_err;
+
+    CPU_SR_ALLOC();
+
+
+    p_dir    = (void *)0;
+    site_cmd =  FTP_SITE_CMD_MAX;
+
+                                                                /* Execute the command.                                 */
     switch (ftp_session->CtrlCmd) {
                                                                 /* NOOP:   No operation (keep-alive).                   */
                                                                 /* Syntax: NOOP                                         */
@@ -1708,610 +10468,1768 @@ static  void  FTPs_ProcessCtrlCmd (FTPs_SESSION_STRUCT  *ftp_session)
              FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_OKAY, (CPU_CHAR *)0);
              break;
 
-                                                                /* QUIT:   Terminate the FTP session.                   */
-                                                                /* Syntax: QUIT                                         */
-        case FTP_CMD_QUIT:
-             FTPs_StopPasvMode(ftp_session);
-             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_SERVERCLOSING, (CPU_CHAR *)0);
-             break;
+                                                                /* QUIT:   Terminate the FTP session.                   */
+                                                                /* Syntax: QUIT                                         */
+        case FTP_CMD_QUIT:
+             FTPs_StopPasvMode(ftp_session);
+             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_SERVERCLOSING, (CPU_CHAR *)0);
+             break;
+
+                                                                /* REIN:   Reinitialize the FTP session.                */
+                                                                /* Syntax: REIN                                         */
+        case FTP_CMD_REIN:
+             FTPs_StopPasvMode(ftp_session);
+             ftp_session->CtrlState = FTPs_STATE_LOGOUT;
+             ftp_session->DtpMode   = FTP_MODE_STREAM;
+             ftp_session->DtpType   = FTP_TYPE_ASCII;
+             ftp_session->DtpForm   = FTP_FORM_NONPRINT;
+             ftp_session->DtpStru   = FTP_STRU_FILE;
+             ftp_session->DtpCmd    = FTP_CMD_NOOP;
+             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_OKAY, (CPU_CHAR *)0);
+             break;
+
+                                                                /* SYST:   Get system name.                             */
+                                                                /* Syntax: SYST                                         */
+        case FTP_CMD_SYST:
+             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_SYSTEMTYPE, (CPU_CHAR *)0);
+             break;
+
+                                                                /* FEAT:   Advertise server features.                   */
+                                                                /* Syntax: FEAT                                         */
+        case FTP_CMD_FEAT:
+             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_SYSTEMSTATUS, (CPU_CHAR *)0);
+             break;
+
+                                                                /* HELP:   Advertise server help.                       */
+                                                                /* Syntax: HELP                                         */
+        case FTP_CMD_HELP:
+             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_HELPMESSAGE, (CPU_CHAR *)0);
+             break;
+
+                                                                /* USER:   Set username.                                */
+                                                                /* Syntax: USER <username>                              */
+        case FTP_CMD_USER:
+             p_cmd_arg = FTPs_FindArg(&ftp_session->CtrlCmdArgs);
+             if (*p_cmd_arg != (CPU_CHAR)0) {
+                 Str_Copy_N(ftp_session->User, p_cmd_arg, sizeof(ftp_session->User));
+                 ftp_session->CtrlState = FTPs_STATE_GOTUSER;
+                 FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NEEDPASSWORD, (CPU_CHAR *)0);
+             } else {
+                 FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMSYNTAXERR, (CPU_CHAR *)0);
+             }
+             break;
+
+                                                                /* PASS:   Enter password.                              */
+                                                                /* Syntax: PASS <password>                              */
+        case FTP_CMD_PASS:
+             p_cmd_arg = FTPs_FindArg(&ftp_session->CtrlCmdArgs);
+             if (*p_cmd_arg != (CPU_CHAR)0) {
+                 Str_Copy_N(ftp_session->Pass, p_cmd_arg, sizeof(ftp_session->Pass));
+                 rtn_val = FTPs_AuthUser(ftp_session);
+                 if (rtn_val == DEF_OK) {
+                     ftp_session->CtrlState = FTPs_STATE_LOGIN;
+                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_LOGGEDIN, (CPU_CHAR *)0);
+                 } else {
+                     ftp_session->CtrlState = FTPs_STATE_LOGOUT;
+                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOTLOGGEDIN, (CPU_CHAR *)0);
+                 }
+             } else {
+                 FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMSYNTAXERR, (CPU_CHAR *)0);
+             }
+             break;
+
+                                                                /* MODE:   Set transfer mode (stream, block, compress). */
+                                                                /* Syntax: MODE <S|B|C>                                 */
+                                                                /* NOTE:   Server supports STREAM mode only.            */
+        case FTP_CMD_MODE:
+             p_cmd_arg = FTPs_FindArg(&ftp_session->CtrlCmdArgs);
+             switch (*p_cmd_arg) {
+                 case FTP_MODE_STREAM:
+                      ftp_session->DtpMode = FTP_MODE_STREAM;
+                      FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_OKAY, (CPU_CHAR *)0);
+                      break;
+
+                 case FTP_MODE_BLOCK:
+                 case FTP_MODE_COMPRESSED:
+                      FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMNOSUPPORT, (CPU_CHAR *)0);
+                      break;
+
+                 default:
+                      FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMSYNTAXERR, (CPU_CHAR *)0);
+                      break;
+             }
+             break;
+
+                                                                /* TYPE:   Set data representation type.                */
+                                                                /* Syntax: TYPE <A|E|I|L> [<N|T|C|bytesize>]            */
+                                                                /* NOTE:   Server supports ASCII NON_PRINT or IMAGE.    */
+        case FTP_CMD_TYPE:
+             p_cmd_arg = FTPs_FindArg(&ftp_session->CtrlCmdArgs);
+             switch (*p_cmd_arg) {
+                 case FTP_TYPE_ASCII:
+                      p_cmd_arg = FTPs_FindArg(&ftp_session->CtrlCmdArgs);
+                      switch (*p_cmd_arg) {
+                          case (CPU_CHAR)0:
+                          case FTP_FORM_NONPRINT:
+                               ftp_session->DtpType = FTP_TYPE_ASCII;
+                               ftp_session->DtpForm = FTP_FORM_NONPRINT;
+                               FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_OKAY, (CPU_CHAR *)0);
+                               break;
+
+                          case FTP_FORM_TELNET:
+                          case FTP_FORM_CARGCTRL:
+                               FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMNOSUPPORT, (CPU_CHAR *)0);
+                               break;
+
+                          default:
+                               FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMSYNTAXERR, (CPU_CHAR *)0);
+                               break;
+                      }
+                      break;
+
+                 case FTP_TYPE_IMAGE:
+                      ftp_session->DtpType = FTP_TYPE_IMAGE;
+                      FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_OKAY, (CPU_CHAR *)0);
+                      break;
+
+                 case FTP_TYPE_LOCAL:
+                 case FTP_TYPE_EBCDIC:
+                      FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMNOSUPPORT, (CPU_CHAR *)0);
+                      break;
+
+                 default:
+                      FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMSYNTAXERR, (CPU_CHAR *)0);
+                      break;
+             }
+             break;
+
+                                                                /* STRU:   Set file structure (file, record, page).     */
+                                                                /* Syntax: STRU <F|R|P>                                 */
+                                                                /* NOTE:   Server supports FILE structure only.         */
+        case FTP_CMD_STRU:
+             p_cmd_arg = FTPs_FindArg(&ftp_session->CtrlCmdArgs);
+             switch (*p_cmd_arg) {
+                 case FTP_STRU_FILE:
+                      ftp_session->DtpStru = FTP_STRU_FILE;
+                      FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_OKAY, (CPU_CHAR *)0);
+                      break;
+
+                 case FTP_STRU_RECORD:
+                 case FTP_STRU_PAGE:
+                      FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMNOSUPPORT, (CPU_CHAR *)0);
+                      break;
+
+                 default:
+                      FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMSYNTAXERR, (CPU_CHAR *)0);
+                      break;
+             }
+             break;
+
+                                                                /* PASV:   Enter passive mode.                          */
+                                                                /* Syntax: PASV                                         */
+        case FTP_CMD_PASV:
+             CPU_CRITICAL_ENTER();
+             addr = FTPs_PublicAddr;
+             port = FTPs_PublicPort;
+             CPU_CRITICAL_EXIT();
+
+             ftp_session->DtpSockAddr.Addr = NET_UTIL_HOST_TO_NET_32(NET_IPv4_ADDR_ANY);
+             ftp_session->DtpSockAddr.Port = NET_UTIL_HOST_TO_NET_16(port);
+             FTPs_StartPasvMode(ftp_session, &net_err);
+             if (ftp_session->DtpPasv == DEF_YES) {
+                 addr = NET_UTIL_HOST_TO_NET_32(addr);
+                 port = NET_UTIL_HOST_TO_NET_16(port);
+
+                 p_addr = (CPU_INT08U *)&addr;
+                 p_port = (CPU_INT08U *)&port;
+                 Str_FmtPrint((char       *)FTPs_NetBufCtrlCmdPtr,
+                                            FTPs_NET_BUF_LEN,
+                              (char       *)FTPs_Reply[FTP_REPLY_ENTERPASVMODE].ReplyStr,
+                              (unsigned int)p_addr[0],
+                              (unsigned int)p_addr[1],
+                              (unsigned int)p_addr[2],
+                              (unsigned int)p_addr[3],
+                              (unsigned int)p_port[0],
+                              (unsigned int)p_port[1]);
+
+                 FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ENTERPASVMODE, FTPs_NetBufCtrlCmdPtr);
+             } else {
+                 FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CANTOPENDATA, (CPU_CHAR *)0);
+             }
+             break;
+
+                                                                /* PORT:   Set data port configuration.                 */
+                                                                /* Syntax: PORT <ip0, ip1, ip2, ip3, port0, port1>      */
+        case FTP_CMD_PORT:
+             FTPs_StopPasvMode(ftp_session);
+             if (ftp_session->DtpPasv == DEF_NO) {
+                 p_addr = (CPU_INT08U *)&ftp_session->DtpSockAddr.Addr;
+                 p_port = (CPU_INT08U *)&ftp_session->DtpSockAddr.Port;
+
+                 for (i = 0; i <= 3; i++) {
+                     dig = ASCII_IsDig(*ftp_session->CtrlCmdArgs);
+                     while ((dig == DEF_NO) && (ftp_session->CtrlCmdArgs != (CPU_CHAR *)0) && (*ftp_session->CtrlCmdArgs != 0)) {
+                         ftp_session->CtrlCmdArgs++;
+                         dig = ASCII_IsDig(*ftp_session->CtrlCmdArgs);
+                     }
+                     p_addr[i] = Str_ParseNbr_Int32U(ftp_session->CtrlCmdArgs, &ftp_session->CtrlCmdArgs, 10);
+                 }
+                 for (i = 0; i <= 1; i++) {
+                     dig = ASCII_IsDig(*ftp_session->CtrlCmdArgs);
+                     while ((dig == DEF_NO) && (ftp_session->CtrlCmdArgs != 0) && (*ftp_session->CtrlCmdArgs != 0)) {
+                         ftp_session->CtrlCmdArgs++;
+                         dig = ASCII_IsDig(*ftp_session->CtrlCmdArgs);
+                     }
+                     p_port[i] = Str_ParseNbr_Int32U(ftp_session->CtrlCmdArgs, &ftp_session->CtrlCmdArgs, 10);
+                 }
+
+                 FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_OKAY, (CPU_CHAR *)0);
+             } else {
+                 FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CANTOPENDATA, (CPU_CHAR *)0);
+             }
+             break;
+
+                                                                /* REST:   Next transfer will start at offset <offset>. */
+                                                                /* Syntax: REST <offset>[-<end>]                        */
+        case FTP_CMD_REST:
+             p_cmd_arg = FTPs_FindArg(&ftp_session->CtrlCmdArgs);
+             dig       = ASCII_IsDig(*p_cmd_arg);
+             offset    = Str_ParseNbr_Int32U(p_cmd_arg, &p_opt, 10);
+             range_len = 0u;
+             if ((dig    == DEF_YES) &&
+                 (*p_opt == '-')) {                             /* Byte range (see Note #6).                            */
+                 dig       = ASCII_IsDig(p_opt[1]);
+                 i         = Str_ParseNbr_Int32U(p_opt + 1, &p_opt, 10);
+                 range_len = i - offset + 1u;
+                 if ((i         < offset) ||
+                     (range_len == 0u)) {                       /* Whole 4 GB range.                                    */
+                     dig = DEF_NO;
+                 }
+             }
+             if ((dig    == DEF_NO) ||                          /* Restart point unchanged on error.                    */
+                 (*p_opt != (CPU_CHAR)0)) {
+                 FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMSYNTAXERR, (CPU_CHAR *)0);
+                 break;
+             }
+             ftp_session->DtpOffset = offset;
+             ftp_session->DtpLen    = range_len;
+             ftp_session->CtrlState = FTPs_STATE_GOTREST;
+             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NEEDMOREINFO, (CPU_CHAR *)0);
+             break;
+
+                                                                /* ABOR:   Abort the previous cmd & data transfer.      */
+                                                                /* Syntax: ABOR                                         */
+        case FTP_CMD_ABOR:                                      /* See Note #10.                                        */
+             ftp_session->CtrlState = FTPs_STATE_LOGIN;
+             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CLOSINGSUCCESS, (CPU_CHAR *)0);
+             break;
+
+                                                                /* PWD:    Get present working directory.               */
+                                                                /* Syntax: PWD                                          */
+
+                                                                /* CWD:    Change working directory.                    */
+                                                                /* Syntax: CWD <dirname>                                */
+
+                                                                /* CDUP:   Change to parent directory.                  */
+                                                                /* Syntax: CDUP <filename>                              */
+
+                                                                /* MKD:    Create directory.                            */
+                                                                /* Syntax: MKD <dirname>                                */
+
+                                                                /* RMD:    Delete directory.                            */
+                                                                /* Syntax: RMD <dirname>                                */
+
+                                                                /* NLST:   Get brief directory entries list.            */
+                                                                /* Syntax: NLST [-<opts>] [<pathname>]                  */
+
+                                                                /* LIST:   Get detailed directory entries list.         */
+                                                                /* Syntax: LIST [-<opts>] [<pathname>]                  */
+
+                                                                /* RETR:   Retrieve file.                               */
+                                                                /* Syntax: RETR <filename>                              */
+
+                                                                /* STOR:   Store file.                                  */
+                                                                /* Syntax: STOR <filename>                              */
+
+                                                                /* APPE:   Append file.                                 */
+                                                                /* Syntax: APPE <filename>                              */
+
+                                                                /* DELE:   Delete file.                                 */
+                                                                /* Syntax: DELE <filename>                              */
+
+                                                                /* RNFR:   Rename file from name.                       */
+                                                                /* Syntax: RNFR <filename>                              */
+
+                                                                /* RNTO:   Rename file to name.                         */
+                                                                /* Syntax: RNTO <filename>                              */
+
+                                                                /* SIZE:   Get file size.                               */
+                                                                /* Syntax: SIZE <filename>                              */
+
+                                                                /* MDTM:   Get file modification date/time.             */
+                                                                /* Syntax: MDTM <filename>                              */
+
+                                                                /* MLSD:   Get machine-readable directory entries list. */
+                                                                /* Syntax: MLSD [-<opts>] [<dirname>]                   */
+
+                                                                /* MLST:   Get machine-readable entry facts.            */
+                                                                /* Syntax: MLST [<pathname>]                            */
+
+                                                                /* SITE:   Execute site specific sub-command.           */
+                                                                /* Syntax: SITE <sub-command> [<pathname>]              */
+        case FTP_CMD_PWD:
+        case FTP_CMD_CWD:
+        case FTP_CMD_CDUP:
+        case FTP_CMD_MKD:
+        case FTP_CMD_RMD:
+        case FTP_CMD_NLST:
+        case FTP_CMD_LIST:
+        case FTP_CMD_RETR:
+        case FTP_CMD_STOR:
+        case FTP_CMD_APPE:
+        case FTP_CMD_DELE:
+        case FTP_CMD_RNFR:
+        case FTP_CMD_RNTO:
+        case FTP_CMD_SIZE:
+        case FTP_CMD_MDTM:
+        case FTP_CMD_MLSD:
+        case FTP_CMD_MLST:
+        case FTP_CMD_SITE:
+                                                                /* Parameter handling.                                  */
+#if (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+             FTPs_ListWalk.En = DEF_NO;
+#endif
+#if (FTPs_CFG_TAR_EN == DEF_ENABLED)
+             FTPs_Tar.En      = DEF_NO;
+#endif
+#if (FTPs_CFG_DELTA_EN == DEF_ENABLED)
+             FTPs_Delta.En    = DEF_NO;
+#endif
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+             FTPs_SegsCurPtr  = (FTPs_SEGS *)0;
+#endif
+#if (FTPs_CFG_TAIL_EN == DEF_ENABLED)
+             FTPs_TailStop();
+#endif
+             if (ftp_session->CtrlCmd == FTP_CMD_PWD) {
+                 p_cmd_arg = (CPU_CHAR *)".";
+             } else if (ftp_session->CtrlCmd == FTP_CMD_CDUP) {
+                 p_cmd_arg = (CPU_CHAR *)"..";
+             } else if (ftp_session->CtrlCmd == FTP_CMD_MDTM) {
+                                                                /* MDTM command may have one or two arguments           */
+                                                                /* 1. If the first argument are a file name, return     */
+                                                                /*    file date and time.                               */
+                                                                /* 2. If the first argument are a date and time and the */
+                                                                /*    second argument are a file name, modify the file  */
+                                                                /*    date and time.                                    */
+                 p_cmd_arg   = FTPs_FindFileName(&ftp_session->CtrlCmdArgs);
+                 p_file_time = FTPs_FindArg(&ftp_session->CtrlCmdArgs);
+
+                                                                /* Check if first argument is a string of 14 digits.    */
+                                                                /* The date and time string has exactly 14 digits.      */
+                 cmp_val = Str_Len(p_file_time);
+                 if (cmp_val == 14) {
+                    for (i = 0; i < 14; i++) {
+                        dig = ASCII_IsDig(p_file_time[i]);
+                        if (dig == DEF_NO) {
+                            break;
+                        }
+                    }
+                    if (i == 14) {
+                                                                /* Yes: The file name starts after.                     */
+                                                                /* No:  The file name IS the first argument.            */
+                        p_cmd_arg = FTPs_FindFileName(&ftp_session->CtrlCmdArgs);
+                    } else {
+                        p_file_time = "";
+                    }
+                 } else {
+                    p_file_time = "";
+                 }
+             } else if ((ftp_session->CtrlCmd == FTP_CMD_NLST) ||
+                        (ftp_session->CtrlCmd == FTP_CMD_LIST) ||
+                        (ftp_session->CtrlCmd == FTP_CMD_MLSD)) {
+                 p_cmd_arg = FTPs_FindFileName(&ftp_session->CtrlCmdArgs);
+                 while (*p_cmd_arg == '-') {                    /* Skip "-xxxx" options (see Note #2a).                 */
+                     p_opt     = p_cmd_arg;
+                     p_cmd_arg = FTPs_FindArg(&p_opt);
+#if (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+                     opt_r    = DEF_NO;
+                     p_opt_ch = p_cmd_arg + 1;
+                     while (ASCII_IsAlpha(*p_opt_ch) == DEF_YES) {
+                         if (*p_opt_ch == 'R') {
+                             opt_r = DEF_YES;
+                         }
+                         p_opt_ch++;
+                     }
+                     if ((opt_r                == DEF_YES)     &&
+                         (*p_opt_ch            == (CPU_CHAR)0) &&
+                         (ftp_session->CtrlCmd != FTP_CMD_NLST)) {
+                         FTPs_ListWalk.En = DEF_YES;
+                     }
+#endif
+                     p_cmd_arg = FTPs_FindFileName(&p_opt);
+                 }
+             } else if (ftp_session->CtrlCmd == FTP_CMD_SITE) {
+                 p_opt    = FTPs_FindArg(&ftp_session->CtrlCmdArgs);
+                 site_cmd = FTPs_SiteCmdGet(p_opt);
+                 if (site_cmd == FTP_SITE_CMD_MAX) {
+                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMNOSUPPORT, (CPU_CHAR *)0);
+                     break;
+                 }
+#if (FTPs_CFG_SITE_COPY_EN == DEF_ENABLED)
+                 if (((ftp_session->CtrlState == FTPs_STATE_GOTCPFR) && (site_cmd != FTP_SITE_CMD_CPTO)) ||
+                     ((ftp_session->CtrlState != FTPs_STATE_GOTCPFR) && (site_cmd == FTP_SITE_CMD_CPTO))) {
+                     ftp_session->CtrlState = FTPs_STATE_LOGIN; /* See Note #3b.                                        */
+                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CMDBADSEQUENCE, (CPU_CHAR *)0);
+                     break;
+                 }
+#endif
+                 if (site_cmd == FTP_SITE_CMD_HELP) {
+                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_SITEHELP, (CPU_CHAR *)0);
+                     break;
+                 }
+#if (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+                 if (site_cmd == FTP_SITE_CMD_DEDUP) {          /* See Note #3c.                                        */
+                     p_opt   = FTPs_FindArg(&ftp_session->CtrlCmdArgs);
+                     rtn_val = FTPs_DedupDigestParse(p_opt, FTPs_Dedup.Digest);
+                     if (rtn_val != DEF_OK) {
+                         FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMSYNTAXERR, (CPU_CHAR *)0);
+                         break;
+                     }
+                 }
+#endif
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+                 if (site_cmd == FTP_SITE_CMD_SEGS) {           /* See Note #3d.                                        */
+                     p_opt         = FTPs_FindArg(&ftp_session->CtrlCmdArgs);
+                     dig           = ASCII_IsDig(*p_opt);
+                     FTPs_SegsSize = Str_ParseNbr_Int32U(p_opt, &p_opt, 10);
+                     if ((dig    == DEF_NO) ||
+                         (*p_opt != (CPU_CHAR)0)) {
+                         FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMSYNTAXERR, (CPU_CHAR *)0);
+                         break;
+                     }
+                 }
+#endif
+                 p_cmd_arg = FTPs_FindFileName(&ftp_session->CtrlCmdArgs);
+                 if (*p_cmd_arg == (CPU_CHAR)0) {               /* See Note #3a.                                        */
+                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMSYNTAXERR, (CPU_CHAR *)0);
+                     break;
+                 }
+             } else {
+                 p_cmd_arg = FTPs_FindFileName(&ftp_session->CtrlCmdArgs);
+             }
+
+             if (*p_cmd_arg != (CPU_CHAR)0) {
+                 FTPs_ToFTPStylePath(p_cmd_arg);
+             }
+
+#if (FTPs_CFG_LIST_GLOB_EN == DEF_ENABLED)
+             FTPs_Glob.En = DEF_NO;
+             if ((ftp_session->CtrlCmd == FTP_CMD_NLST) ||      /* Split name pattern from path (see Note #2b).         */
+                 (ftp_session->CtrlCmd == FTP_CMD_LIST) ||
+                 (ftp_session->CtrlCmd == FTP_CMD_MLSD)) {
+                 p_name = Str_Char_Last(p_cmd_arg, FTPs_PATH_SEP_CHAR);
+                 if (p_name == (CPU_CHAR *)0) {
+                     p_name = p_cmd_arg;
+                 } else {
+                     p_name++;
+                 }
+                 is_glob = FTPs_GlobIsPattern(p_name);
+                 if (is_glob == DEF_YES) {
+                     rtn_val = FTPs_GlobCompile(&FTPs_Glob, p_name);
+                     if (rtn_val == DEF_OK) {                   /* Too complex pattern: kept as a (missing) path.       */
+                         FTPs_Glob.En = DEF_YES;
+                         if (p_name == p_cmd_arg) {             /* "pattern"       : list current dir.                  */
+                             p_cmd_arg = (CPU_CHAR *)".";
+                         } else if (p_name == p_cmd_arg + 1) {  /* "/pattern"      : list root dir.                     */
+                            *p_name = (CPU_CHAR)0;
+                         } else {                               /* "path/pattern"  : list path.                         */
+                             p_name[-1] = (CPU_CHAR)0;
+                         }
+                     }
+                 }
+             }
+#endif
+
+                                                                /* Skip "-xxxx" argument.                               */
+             if ((*p_cmd_arg           == '-') &&
+                 (ftp_session->CtrlCmd != FTP_CMD_SITE)) {
+                 p_cmd_arg = (CPU_CHAR *)".";
+             }
+
+             path_name_len = NetFS_CfgPathGetLenMax();
+
+             rtn_val = FTPs_BuildPath(FTPs_FullAbsPathPtr,   path_name_len,
+                                      FTPs_FullRelPathPtr,   path_name_len,
+                                      FTPs_ParentAbsPathPtr, path_name_len,
+                                      FTPs_CurEntryPtr,      path_name_len,
+                                      ftp_session->BasePath,
+                                      ftp_session->RelPath,
+                                      p_cmd_arg);
+
+             FTPs_ToFSStylePath(FTPs_FullAbsPathPtr);
+             FTPs_ToFSStylePath(FTPs_ParentAbsPathPtr);
+
+#if (FTPs_SRV_FILES_EN == DEF_ENABLED)
+             if (rtn_val == DEF_OK) {                           /* Server files are not accessed (see Note #11).        */
+                 rsvd = FTPs_PathIsRsvd(FTPs_FullAbsPathPtr);
+                 if (rsvd == DEF_YES) {
+                     rtn_val = DEF_FAIL;
+                 }
+             }
+#endif
+
+                                                                /* Verify presence of CurEntry/directory/parent         */
+                                                                /* directory.                                           */
+             if (rtn_val == DEF_OK) {
+                 switch (ftp_session->CtrlCmd) {
+                     case FTP_CMD_PWD:                          /* Dir MUST exist (see Note #1).                        */
+                     case FTP_CMD_CWD:
+                     case FTP_CMD_CDUP:
+                     case FTP_CMD_RMD:
+                          found = FTPs_EntryStat(FTPs_FullAbsPathPtr, &dirent);
+                          if ((found == DEF_YES) &&
+                              (DEF_BIT_IS_SET(dirent.Attrib, NET_FS_ENTRY_ATTRIB_DIR) == DEF_YES)) {
+                              rtn_val = DEF_OK;
+                          } else {
+                              rtn_val = DEF_FAIL;
+                          }
+                          break;
+
+
+                     case FTP_CMD_NLST:
+                     case FTP_CMD_LIST:
+                     case FTP_CMD_MLSD:
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+                          p_list = FTPs_ListGet(FTPs_FullAbsPathPtr, ftp_session->CtrlCmd);
+                          if (p_list != (FTPs_LIST_ENTRY *)0) {
+                              rtn_val = DEF_OK;                 /* Cached listing: dir not needed.                      */
+                              break;
+                          }
+#endif
+                          p_dir = NetFS_DirOpen(FTPs_FullAbsPathPtr);
+                          if (p_dir == (void *)0) {
+                              rtn_val = DEF_FAIL;
+                          } else {
+                              rtn_val                = DEF_OK;
+                              ftp_session->DtpDirPtr = p_dir;   /* Keep dir open for the transfer.                      */
+                          }
+                          break;
+
+
+                     case FTP_CMD_DELE:                         /* File MUST exist (see Note #1).                       */
+                     case FTP_CMD_RNFR:                         /* Entry MUST exist.                                    */
+                     case FTP_CMD_MLST:
+                          found = FTPs_EntryStat(FTPs_FullAbsPathPtr, &dirent);
+                          if ((found == DEF_YES) &&
+                             ((ftp_session->CtrlCmd != FTP_CMD_DELE) ||
+                              (DEF_BIT_IS_CLR(dirent.Attrib, NET_FS_ENTRY_ATTRIB_DIR) == DEF_YES))) {
+                              rtn_val = DEF_OK;
+                          } else {
+                              rtn_val = DEF_FAIL;
+                          }
+                          break;
+
+
+                     case FTP_CMD_MKD:                          /* Entry MUST NOT exist (see Note #1).                  */
+                     case FTP_CMD_APPE:
+                     case FTP_CMD_RNTO:
+                          found = FTPs_EntryStat(FTPs_FullAbsPathPtr, &dirent);
+                          if (found == DEF_YES) {
+                              rtn_val = DEF_FAIL;
+                          } else {
+                              rtn_val = DEF_OK;
+                          }
+                          break;
+
+
+                     case FTP_CMD_STOR:                         /* STOR creates or overwrites: no check needed.         */
+#if (FTPs_CFG_TAR_EXTRACT_EN == DEF_ENABLED)
+                                                                /* Dir archive to extract (see Note #4).                */
+                          if (ftp_session->CtrlState != FTPs_STATE_GOTREST) {
+                             (void)FTPs_TarStart(FTPs_FullAbsPathPtr);
+                          }
+#endif
+#if (FTPs_CFG_DELTA_EN == DEF_ENABLED)
+                                                                /* File delta to apply (see Note #5).                   */
+                          if (ftp_session->CtrlState != FTPs_STATE_GOTREST) {
+                             (void)FTPs_DeltaStart(FTPs_FullAbsPathPtr, FTPs_DELTA_EXT_STR, FTPs_DELTA_EXT_LEN);
+                          }
+#endif
+                          rtn_val = DEF_OK;
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+                                                                /* Segment of a file (see Note #7).                     */
+                          if ((ftp_session->CtrlState == FTPs_STATE_GOTREST) &&
+                              (ftp_session->DtpLen    >  0u)) {
+                              rtn_val = FTPs_SegsStart(FTPs_FullAbsPathPtr, ftp_session->DtpOffset, ftp_session->DtpLen);
+                          }
+#endif
+                          break;
+
+
+                     case FTP_CMD_SITE:                         /* Checked by the sub-command.                          */
+                          rtn_val = DEF_OK;
+                          break;
+
+
+                     case FTP_CMD_RETR:
+                     case FTP_CMD_SIZE:
+                     case FTP_CMD_MDTM:
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+                          if (ftp_session->CtrlCmd == FTP_CMD_RETR) {
+                              p_pf = FTPs_PrefetchGet(FTPs_FullAbsPathPtr, FTPs_ParentAbsPathPtr);
+                              if (p_pf != (FTPs_PREFETCH_ENTRY *)0) {
+                                  same_ver = DEF_NO;            /* Prefetched version MUST be current (see Note #12).   */
+                                  found    = FTPs_EntryStat(FTPs_FullAbsPathPtr, &dirent);
+                                  if ((found       == DEF_YES) &&
+                                      (dirent.Size == p_pf->Size)) {
+                                      same_ver = Mem_Cmp(&dirent.DateTimeCreate, &p_pf->DateTime, sizeof(NET_FS_DATE_TIME));
+                                  }
+                                  if (same_ver == DEF_NO) {     /* Stale: discarded & file opened below.                */
+                                      FTPs_PrefetchRelease();
+                                      p_pf = (FTPs_PREFETCH_ENTRY *)0;
+                                  }
+                              }
+                              if (p_pf != (FTPs_PREFETCH_ENTRY *)0) {
+                                                                /* Prefetched file: metadata already known.             */
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+                                  ftp_session->DtpEntrySize     = p_pf->Size;
+                                  ftp_session->DtpEntryDateTime = p_pf->DateTime;
+#endif
+                                  rtn_val                       = DEF_OK;
+                                  break;
+                              }
+                          }
+#endif
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+                          if ((ftp_session->CtrlCmd == FTP_CMD_RETR) ||
+                              (ftp_session->CtrlCmd == FTP_CMD_SIZE) ||
+                             ((ftp_session->CtrlCmd == FTP_CMD_MDTM) && (*p_file_time == (CPU_CHAR)0))) {
+                              p_pin = FTPs_PinGet(FTPs_FullAbsPathPtr);
+                              if (p_pin != (FTPs_PIN_ENTRY *)0) {
+                                                                /* Pinned file: no file system access.                  */
+                                  dirent.Size           = p_pin->DataLen;
+                                  dirent.DateTimeCreate = p_pin->DateTime;
+                                  rtn_val               = DEF_OK;
+                                  break;
+                              }
+                          }
+#endif
+                          if (ftp_session->CtrlCmd != FTP_CMD_RETR) {
+                              found = FTPs_EntryStat(FTPs_FullAbsPathPtr, &dirent);
+                              if ((found == DEF_YES) &&
+                                  (DEF_BIT_IS_CLR(dirent.Attrib, NET_FS_ENTRY_ATTRIB_DIR) == DEF_YES)) {
+                                  rtn_val = DEF_OK;
+                              } else {
+                                  rtn_val = DEF_FAIL;
+                              }
+                              break;
+                          }
+
+#if (FTPs_CFG_TAR_EN == DEF_ENABLED)
+                          found = FTPs_TarStart(FTPs_FullAbsPathPtr);
+                          if (found == DEF_YES) {               /* Dir archive: no file to open (see Note #4).          */
+                              rtn_val = DEF_OK;
+                              break;
+                          }
+#endif
+#if (FTPs_CFG_DELTA_EN == DEF_ENABLED)
+                          if (ftp_session->CtrlState != FTPs_STATE_GOTREST) {
+                              found = FTPs_DeltaStart(FTPs_FullAbsPathPtr, FTPs_DELTA_SIG_EXT_STR, FTPs_DELTA_SIG_EXT_LEN);
+                              if (found == DEF_YES) {           /* File signature (see Note #5).                        */
+                                  rtn_val = DEF_OK;
+                                  break;
+                              }
+                          }
+#endif
+#if (FTPs_CFG_TAIL_EN == DEF_ENABLED)
+                                                                /* Followed file: opened below (see Note #8).           */
+                         (void)FTPs_TailStart(FTPs_FullAbsPathPtr);
+#endif
+#if (FTPs_CFG_NEG_CACHE_EN == DEF_ENABLED)
+                          found = FTPs_NegGet(FTPs_FullAbsPathPtr);
+                          if (found == DEF_YES) {               /* Known missing file: no file system access.           */
+                              rtn_val = DEF_FAIL;
+                              break;
+                          }
+#endif
+                          p_file = FTPs_FileOpenRd(FTPs_FullAbsPathPtr);
+                          if (p_file != (void *)0) {
+                                                                /* Keep file open for the transfer.                     */
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+                                                                /* Keep file version for the content cache.             */
+                              size_ok = NetFS_FileSizeGet(p_file, &ftp_session->DtpEntrySize);
+                              date_ok = NetFS_FileDateTimeCreateGet(p_file, &ftp_session->DtpEntryDateTime);
+                              if ((size_ok != DEF_OK) ||        /* See Note #13.                                        */
+                                  (date_ok != DEF_OK)) {
+                                  ftp_session->DtpEntrySize = 0u;
+                              }
+#endif
+                              ftp_session->DtpFilePtr = p_file;
+                              rtn_val                 = DEF_OK;
+                          } else {
+#if (FTPs_CFG_NEG_CACHE_EN == DEF_ENABLED)
+                                                                /* Remember file if missing (not a dir).                */
+                             (void)FTPs_EntryStat(FTPs_FullAbsPathPtr, &dirent);
+#endif
+                              rtn_val                 = DEF_FAIL;
+                          }
+                          break;
+
+
+                     default:
+                          break;
+                 }
+
+                                                                /* Do action.                                           */
+                 if (rtn_val == DEF_OK) {
+                     switch (ftp_session->CtrlCmd) {
+                         case FTP_CMD_PWD:
+                              Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
+                                                   FTPs_NET_BUF_LEN,
+                                           (char *)"257 \"%s\" is current directory.",
+                                                   FTPs_FullRelPathPtr);
+                              FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PATHNAME, FTPs_NetBufCtrlCmdPtr);
+                              break;
+
+                         case FTP_CMD_CWD:
+                         case FTP_CMD_CDUP:
+                              Str_Copy_N(ftp_session->RelPath,  FTPs_FullRelPathPtr, FTPs_CFG_FS_PATH_LEN_MAX);
+                              FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ACTIONCOMPLETE, (CPU_CHAR *)0);
+                              break;
+
+                         case FTP_CMD_NLST:
+                         case FTP_CMD_LIST:
+                         case FTP_CMD_MLSD:
+                         case FTP_CMD_RETR:
+                         case FTP_CMD_STOR:
+                         case FTP_CMD_APPE:
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+                              if ((ftp_session->CtrlCmd == FTP_CMD_NLST) ||
+                                  (ftp_session->CtrlCmd == FTP_CMD_LIST) ||
+                                  (ftp_session->CtrlCmd == FTP_CMD_MLSD)) {
+                                  FTPs_PrefetchDirSet(FTPs_FullAbsPathPtr);
+                              }
+#endif
+                              FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_OKAYOPENING, (CPU_CHAR *)0);
+                              ftp_session->DtpCmd = ftp_session->CtrlCmd;
+                              Str_Copy_N(ftp_session->CurEntry, FTPs_FullAbsPathPtr, FTPs_CFG_FS_PATH_LEN_MAX);
+                              FTPs_DtpTask((void *)ftp_session);
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+                              FTPs_PrefetchRelease();
+#endif
+                              if (ftp_session->DtpFilePtr != (void *)0) {   /* Transfer not started.            */
+                                  FTPs_FileCloseRd(ftp_session->DtpFilePtr);
+                                  ftp_session->DtpFilePtr = (void *)0;
+                              }
+                              if (ftp_session->DtpDirPtr != (void *)0) {
+                                  NetFS_DirClose(ftp_session->DtpDirPtr);
+                                  ftp_session->DtpDirPtr = (void *)0;
+                              }
+#if (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+                              FTPs_ListWalkEnd();
+#endif
+                              ftp_session->DtpOffset = 0;
+                              ftp_session->CtrlState = FTPs_STATE_LOGIN;
+                              break;
+
+                         case FTP_CMD_MKD:
+                              rtn_val = NetFS_EntryCreate(FTPs_FullAbsPathPtr, DEF_YES);
+                              FTPs_InvalidatePath(FTPs_FullAbsPathPtr);
+                              if (rtn_val == DEF_OK) {
+                                  Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
+                                                       FTPs_NET_BUF_LEN,
+                                               (char *)FTPs_Reply[FTP_REPLY_PATHNAME].ReplyStr,
+                                                       FTPs_FullRelPathPtr);
+                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PATHNAME, FTPs_NetBufCtrlCmdPtr);
+                              } else {
+                                  Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
+                                                       FTPs_NET_BUF_LEN,
+                                               (char *)FTPs_Reply[FTP_REPLY_NOTFOUND].ReplyStr,
+                                                       FTPs_FullRelPathPtr);
+                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOTFOUND, FTPs_NetBufCtrlCmdPtr);
+                              }
+                              break;
+
+                         case FTP_CMD_RMD:
+                              FTPs_HandleClose(FTPs_FullAbsPathPtr);
+                              rtn_val = NetFS_EntryDel(FTPs_FullAbsPathPtr, DEF_NO);
+                              FTPs_InvalidatePath(FTPs_FullAbsPathPtr);
+                              if (rtn_val == DEF_OK) {
+                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ACTIONCOMPLETE, (CPU_CHAR *)0);
+                              } else {
+                                  Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
+                                                       FTPs_NET_BUF_LEN,
+                                               (char *)FTPs_Reply[FTP_REPLY_NOTFOUND].ReplyStr,
+                                                       FTPs_FullRelPathPtr);
+                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOTFOUND, FTPs_NetBufCtrlCmdPtr);
+                              }
+                              break;
+
+                         case FTP_CMD_DELE:
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+                                                                /* End segmented upload of file.                        */
+                             (void)FTPs_SegsCancel(FTPs_FullAbsPathPtr);
+#endif
+                              FTPs_HandleClose(FTPs_FullAbsPathPtr);
+                              rtn_val = NetFS_EntryDel(FTPs_FullAbsPathPtr, DEF_YES);
+                              FTPs_InvalidatePath(FTPs_FullAbsPathPtr);
+                              if (rtn_val == DEF_OK) {
+                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ACTIONCOMPLETE, (CPU_CHAR *)0);
+                              } else {
+                                  Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
+                                                       FTPs_NET_BUF_LEN,
+                                               (char *)FTPs_Reply[FTP_REPLY_NOTFOUND].ReplyStr,
+                                                       FTPs_FullRelPathPtr);
+                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOTFOUND, FTPs_NetBufCtrlCmdPtr);
+                              }
+                              break;
+
+                         case FTP_CMD_RNFR:
+                              Str_Copy_N(FTPs_RenAbsPathPtr, FTPs_FullAbsPathPtr, FTPs_CFG_FS_PATH_LEN_MAX);
+                              Str_Copy_N(FTPs_RenRelPathPtr, FTPs_FullRelPathPtr, FTPs_CFG_FS_PATH_LEN_MAX);
+                              ftp_session->CtrlState = FTPs_STATE_GOTRNFR;
+                              FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NEEDMOREINFO, (CPU_CHAR *)0);
+                              break;
 
-                                                                /* REIN:   Reinitialize the FTP session.                */
-                                                                /* Syntax: REIN                                         */
-        case FTP_CMD_REIN:
-             FTPs_StopPasvMode(ftp_session);
-             ftp_session->CtrlState = FTPs_STATE_LOGOUT;
-             ftp_session->DtpMode   = FTP_MODE_STREAM;
-             ftp_session->DtpType   = FTP_TYPE_ASCII;
-             ftp_session->DtpForm   = FTP_FORM_NONPRINT;
-             ftp_session->DtpStru   = FTP_STRU_FILE;
-             ftp_session->DtpCmd    = FTP_CMD_NOOP;
-             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_OKAY, (CPU_CHAR *)0);
-             break;
+                         case FTP_CMD_RNTO:
+                              FTPs_HandleClose(FTPs_RenAbsPathPtr);
+                              FTPs_HandleClose(FTPs_FullAbsPathPtr);
+                              rtn_val = NetFS_EntryRename(FTPs_RenAbsPathPtr, FTPs_FullAbsPathPtr);
+                              FTPs_InvalidatePath(FTPs_RenAbsPathPtr);
+                              FTPs_InvalidatePath(FTPs_FullAbsPathPtr);
+                              ftp_session->CtrlState = FTPs_STATE_LOGIN;
+                              if (rtn_val == DEF_OK) {
+                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ACTIONCOMPLETE, (CPU_CHAR *)0);
+                              } else {
+                                  Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
+                                                       FTPs_NET_BUF_LEN,
+                                               (char *)FTPs_Reply[FTP_REPLY_NOTFOUND].ReplyStr,
+                                                       FTPs_RenRelPathPtr);
+                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOTFOUND, FTPs_NetBufCtrlCmdPtr);
+                              }
+                              break;
 
-                                                                /* SYST:   Get system name.                             */
-                                                                /* Syntax: SYST                                         */
-        case FTP_CMD_SYST:
-             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_SYSTEMTYPE, (CPU_CHAR *)0);
-             break;
+                         case FTP_CMD_MLST:
+                              str_len = Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
+                                                             FTPs_NET_BUF_LEN,
+                                                     (char *)"250-Listing %s\n ",
+                                                             FTPs_FullRelPathPtr);
+                              str_len += FTPs_MlsxFmt(FTPs_NetBufCtrlCmdPtr + str_len,
+                                                      FTPs_NET_BUF_LEN     - str_len,
+                                                     &dirent,
+                                                      FTPs_FullRelPathPtr,
+                                                      (CPU_CHAR *)"\n250 End");
+                              if (str_len < FTPs_NET_BUF_LEN) {
+                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ACTIONCOMPLETE, FTPs_NetBufCtrlCmdPtr);
+                              } else {
+                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NAMEERR, (CPU_CHAR *)0);
+                              }
+                              break;
 
-                                                                /* FEAT:   Advertise server features.                   */
-                                                                /* Syntax: FEAT                                         */
-        case FTP_CMD_FEAT:
-             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_SYSTEMSTATUS, (CPU_CHAR *)0);
-             break;
+                         case FTP_CMD_SIZE:
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+                              found = FTPs_ResumeGet(FTPs_FullAbsPathPtr, dirent.Size);
+                              if (found == DEF_YES) {           /* Interrupted upload (see Note #9).                    */
+                                  dirent.Size = FTPs_Resume.Rec.Size;
+                              }
+#endif
+                              Str_FmtPrint((char       *)FTPs_NetBufCtrlCmdPtr,
+                                                         FTPs_NET_BUF_LEN,
+                                           (char       *)"213 %u",
+                                           (unsigned int)dirent.Size);
+                              FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_FILESTATUS, FTPs_NetBufCtrlCmdPtr);
+                              break;
 
-                                                                /* HELP:   Advertise server help.                       */
-                                                                /* Syntax: HELP                                         */
-        case FTP_CMD_HELP:
-             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_HELPMESSAGE, (CPU_CHAR *)0);
-             break;
+                         case FTP_CMD_MDTM:
+                              cmp_val = Str_Cmp(p_file_time, "");
+                              if (cmp_val == 0) {
+                                                                /* Return file date and time.                           */
+                                  Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
+                                                       FTPs_NET_BUF_LEN,
+                                               (char *)"213 %04hu%02hu%02hu%02hu%02hu%02hu",
+                                                       dirent.DateTimeCreate.Yr,
+                                                       dirent.DateTimeCreate.Month,
+                                                       dirent.DateTimeCreate.Day,
+                                                       dirent.DateTimeCreate.Hr,
+                                                       dirent.DateTimeCreate.Min,
+                                                       dirent.DateTimeCreate.Sec);
+                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_FILESTATUS, FTPs_NetBufCtrlCmdPtr);
+                              } else {
+                                                                /* Modify file date and time.                           */
+                                  Str_FmtScan((char *)p_file_time,
+                                                     "%04hu%02hu%02hu%02hu%02hu%02hu",
+                                                     (CPU_INT16U *)&dirent.DateTimeCreate.Yr,
+                                                     (CPU_INT16U *)&dirent.DateTimeCreate.Month,
+                                                     (CPU_INT16U *)&dirent.DateTimeCreate.Day,
+                                                     (CPU_INT16U *)&dirent.DateTimeCreate.Hr,
+                                                     (CPU_INT16U *)&dirent.DateTimeCreate.Min,
+                                                     (CPU_INT16U *)&dirent.DateTimeCreate.Sec);
+                                  FTPs_HandleClose(FTPs_FullAbsPathPtr);
+                                 (void)NetFS_EntryTimeSet(FTPs_FullAbsPathPtr, &dirent.DateTimeCreate);
+                                  FTPs_InvalidatePath(FTPs_FullAbsPathPtr);
+                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ACTIONCOMPLETE, (CPU_CHAR *)0);
+                              }
+                              break;
 
-                                                                /* USER:   Set username.                                */
-                                                                /* Syntax: USER <username>                              */
-        case FTP_CMD_USER:
-             p_cmd_arg = FTPs_FindArg(&ftp_session->CtrlCmdArgs);
-             if (*p_cmd_arg != (CPU_CHAR)0) {
-                 Str_Copy_N(ftp_session->User, p_cmd_arg, sizeof(ftp_session->User));
-                 ftp_session->CtrlState = FTPs_STATE_GOTUSER;
-                 FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NEEDPASSWORD, (CPU_CHAR *)0);
-             } else {
-                 FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMSYNTAXERR, (CPU_CHAR *)0);
-             }
-             break;
+                         case FTP_CMD_SITE:
+                              FTPs_ProcessSiteCmd(ftp_session, site_cmd);
+                              break;
 
-                                                                /* PASS:   Enter password.                              */
-                                                                /* Syntax: PASS <password>                              */
-        case FTP_CMD_PASS:
-             p_cmd_arg = FTPs_FindArg(&ftp_session->CtrlCmdArgs);
-             if (*p_cmd_arg != (CPU_CHAR)0) {
-                 Str_Copy_N(ftp_session->Pass, p_cmd_arg, sizeof(ftp_session->Pass));
-                 rtn_val = FTPs_AuthUser(ftp_session);
-                 if (rtn_val == DEF_OK) {
-                     ftp_session->CtrlState = FTPs_STATE_LOGIN;
-                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_LOGGEDIN, (CPU_CHAR *)0);
+                         default:
+                            break;
+                     }
                  } else {
-                     ftp_session->CtrlState = FTPs_STATE_LOGOUT;
-                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOTLOGGEDIN, (CPU_CHAR *)0);
+                     Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
+                                          FTPs_NET_BUF_LEN,
+                                  (char *)FTPs_Reply[FTP_REPLY_NOTFOUND].ReplyStr,
+                                          FTPs_FullRelPathPtr);
+                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOTFOUND, FTPs_NetBufCtrlCmdPtr);
                  }
              } else {
-                 FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMSYNTAXERR, (CPU_CHAR *)0);
+                 FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NAMEERR, (CPU_CHAR *)0);
              }
              break;
 
-                                                                /* MODE:   Set transfer mode (stream, block, compress). */
-                                                                /* Syntax: MODE <S|B|C>                                 */
-                                                                /* NOTE:   Server supports STREAM mode only.            */
-        case FTP_CMD_MODE:
-             p_cmd_arg = FTPs_FindArg(&ftp_session->CtrlCmdArgs);
-             switch (*p_cmd_arg) {
-                 case FTP_MODE_STREAM:
-                      ftp_session->DtpMode = FTP_MODE_STREAM;
-                      FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_OKAY, (CPU_CHAR *)0);
-                      break;
+       case FTP_CMD_PBSZ:
+            Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
+                                 FTPs_NET_BUF_LEN,
+                         (char *)FTPs_Reply[FTP_REPLY_PBSZ].ReplyStr,
+                                 ftp_session->CtrlCmdArgs);
+             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PBSZ, FTPs_NetBufCtrlCmdPtr);
+             break;
 
-                 case FTP_MODE_BLOCK:
-                 case FTP_MODE_COMPRESSED:
-                      FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMNOSUPPORT, (CPU_CHAR *)0);
-                      break;
 
-                 default:
-                      FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMSYNTAXERR, (CPU_CHAR *)0);
-                      break;
-             }
+       case FTP_CMD_PROT:
+             Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
+                                  FTPs_NET_BUF_LEN,
+                          (char *)FTPs_Reply[FTP_REPLY_PROT].ReplyStr,
+                                  ftp_session->CtrlCmdArgs);
+             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PROT, FTPs_NetBufCtrlCmdPtr);
              break;
 
-                                                                /* TYPE:   Set data representation type.                */
-                                                                /* Syntax: TYPE <A|E|I|L> [<N|T|C|bytesize>]            */
-                                                                /* NOTE:   Server supports ASCII NON_PRINT or IMAGE.    */
-        case FTP_CMD_TYPE:
-             p_cmd_arg = FTPs_FindArg(&ftp_session->CtrlCmdArgs);
-             switch (*p_cmd_arg) {
-                 case FTP_TYPE_ASCII:
-                      p_cmd_arg = FTPs_FindArg(&ftp_session->CtrlCmdArgs);
-                      switch (*p_cmd_arg) {
-                          case (CPU_CHAR)0:
-                          case FTP_FORM_NONPRINT:
-                               ftp_session->DtpType = FTP_TYPE_ASCII;
-                               ftp_session->DtpForm = FTP_FORM_NONPRINT;
-                               FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_OKAY, (CPU_CHAR *)0);
-                               break;
 
-                          case FTP_FORM_TELNET:
-                          case FTP_FORM_CARGCTRL:
-                               FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMNOSUPPORT, (CPU_CHAR *)0);
-                               break;
+        default:
+             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CMDNOSUPPORT, (CPU_CHAR *)0);
+             break;
+    }
+}
 
-                          default:
-                               FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMSYNTAXERR, (CPU_CHAR *)0);
-                               break;
-                      }
-                      break;
 
-                 case FTP_TYPE_IMAGE:
-                      ftp_session->DtpType = FTP_TYPE_IMAGE;
-                      FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_OKAY, (CPU_CHAR *)0);
-                      break;
+/*
+*********************************************************************************************************
+*                                          FTPs_SiteCmdGet()
+*
+* Description : Find the code of a SITE sub-command.
+*
+* Argument(s) : p_name      Sub-command name (case insensitive).
+*
+* Return(s)   : Sub-command code,  if found.
+*
+*               FTP_SITE_CMD_MAX,  otherwise.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
 
-                 case FTP_TYPE_LOCAL:
-                 case FTP_TYPE_EBCDIC:
-                      FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMNOSUPPORT, (CPU_CHAR *)0);
-                      break;
+static  CPU_INT08U  FTPs_SiteCmdGet (CPU_CHAR  *p_name)
+{
+    CPU_INT16S  cmp_val;
+    CPU_INT32U  i;
 
-                 default:
-                      FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMSYNTAXERR, (CPU_CHAR *)0);
-                      break;
-             }
-             break;
 
-                                                                /* STRU:   Set file structure (file, record, page).     */
-                                                                /* Syntax: STRU <F|R|P>                                 */
-                                                                /* NOTE:   Server supports FILE structure only.         */
-        case FTP_CMD_STRU:
-             p_cmd_arg = FTPs_FindArg(&ftp_session->CtrlCmdArgs);
-             switch (*p_cmd_arg) {
-                 case FTP_STRU_FILE:
-                      ftp_session->DtpStru = FTP_STRU_FILE;
-                      FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_OKAY, (CPU_CHAR *)0);
-                      break;
+    i = 0;
+    while (FTPs_SiteCmd[i].CmdCode != FTP_SITE_CMD_MAX) {
+        cmp_val = Str_CmpIgnoreCase((CPU_CHAR *)p_name,
+                                    (CPU_CHAR *)FTPs_SiteCmd[i].CmdStr);
+        if (cmp_val == 0) {
+            break;
+        }
+        i++;
+    }
 
-                 case FTP_STRU_RECORD:
-                 case FTP_STRU_PAGE:
-                      FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMNOSUPPORT, (CPU_CHAR *)0);
-                      break;
+    return (FTPs_SiteCmd[i].CmdCode);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        FTPs_ProcessSiteCmd()
+*
+* Description : Execute a SITE sub-command.
+*
+* Argument(s) : ftp_session     structure that contains FTP session states and control data.
+*
+*               site_cmd        Sub-command code.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ProcessCtrlCmd().
+*
+* Note(s)     : (1) The path argument was built by FTPs_ProcessCtrlCmd() : FTPs_FullAbsPathPtr &
+*                   FTPs_FullRelPathPtr hold its FS absolute path & its FTP path.
+*********************************************************************************************************
+*/
 
-                 default:
-                      FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMSYNTAXERR, (CPU_CHAR *)0);
-                      break;
-             }
+static  void  FTPs_ProcessSiteCmd (FTPs_SESSION_STRUCT  *ftp_session,
+                                   CPU_INT08U            site_cmd)
+{
+    switch (site_cmd) {
+                                                                /* RMTREE: Remove directory tree.                       */
+                                                                /* Syntax: SITE RMTREE <dirname>                        */
+        case FTP_SITE_CMD_RMTREE:
+             FTPs_SiteRmTree(ftp_session);
              break;
 
-                                                                /* PASV:   Enter passive mode.                          */
-                                                                /* Syntax: PASV                                         */
-        case FTP_CMD_PASV:
-             CPU_CRITICAL_ENTER();
-             addr = FTPs_PublicAddr;
-             port = FTPs_PublicPort;
-             CPU_CRITICAL_EXIT();
-
-             ftp_session->DtpSockAddr.Addr = NET_UTIL_HOST_TO_NET_32(NET_IPv4_ADDR_ANY);
-             ftp_session->DtpSockAddr.Port = NET_UTIL_HOST_TO_NET_16(port);
-             FTPs_StartPasvMode(ftp_session, &net_err);
-             if (ftp_session->DtpPasv == DEF_YES) {
-                 addr = NET_UTIL_HOST_TO_NET_32(addr);
-                 port = NET_UTIL_HOST_TO_NET_16(port);
+                                                                /* MKDIRS: Make directory & missing parent dirs.        */
+                                                                /* Syntax: SITE MKDIRS <dirname>                        */
+        case FTP_SITE_CMD_MKDIRS:
+             FTPs_SiteMkDirs(ftp_session);
+             break;
 
-                 p_addr = (CPU_INT08U *)&addr;
-                 p_port = (CPU_INT08U *)&port;
-                 Str_FmtPrint((char       *)FTPs_NetBufCtrlCmdPtr,
-                                            FTPs_NET_BUF_LEN,
-                              (char       *)FTPs_Reply[FTP_REPLY_ENTERPASVMODE].ReplyStr,
-                              (unsigned int)p_addr[0],
-                              (unsigned int)p_addr[1],
-                              (unsigned int)p_addr[2],
-                              (unsigned int)p_addr[3],
-                              (unsigned int)p_port[0],
-                              (unsigned int)p_port[1]);
+#if (FTPs_CFG_SITE_COPY_EN == DEF_ENABLED)
+                                                                /* CPFR: Copy file from name.                           */
+                                                                /* Syntax: SITE CPFR <filename>                         */
+        case FTP_SITE_CMD_CPFR:
+             FTPs_SiteCpFr(ftp_session);
+             break;
 
-                 FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ENTERPASVMODE, FTPs_NetBufCtrlCmdPtr);
-             } else {
-                 FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CANTOPENDATA, (CPU_CHAR *)0);
-             }
+                                                                /* CPTO: Copy file to name.                             */
+                                                                /* Syntax: SITE CPTO <filename>                         */
+        case FTP_SITE_CMD_CPTO:
+             FTPs_SiteCpTo(ftp_session);
              break;
+#endif
 
-                                                                /* PORT:   Set data port configuration.                 */
-                                                                /* Syntax: PORT <ip0, ip1, ip2, ip3, port0, port1>      */
-        case FTP_CMD_PORT:
-             FTPs_StopPasvMode(ftp_session);
-             if (ftp_session->DtpPasv == DEF_NO) {
-                 p_addr = (CPU_INT08U *)&ftp_session->DtpSockAddr.Addr;
-                 p_port = (CPU_INT08U *)&ftp_session->DtpSockAddr.Port;
+#if (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+                                                                /* DEDUP: Create file from indexed file with same data. */
+                                                                /* Syntax: SITE DEDUP <sha256> <filename>               */
+        case FTP_SITE_CMD_DEDUP:
+             FTPs_SiteDedup(ftp_session);
+             break;
+#endif
 
-                 for (i = 0; i <= 3; i++) {
-                     dig = ASCII_IsDig(*ftp_session->CtrlCmdArgs);
-                     while ((dig == DEF_NO) && (ftp_session->CtrlCmdArgs != (CPU_CHAR *)0) && (*ftp_session->CtrlCmdArgs != 0)) {
-                         ftp_session->CtrlCmdArgs++;
-                         dig = ASCII_IsDig(*ftp_session->CtrlCmdArgs);
-                     }
-                     p_addr[i] = Str_ParseNbr_Int32U(ftp_session->CtrlCmdArgs, &ftp_session->CtrlCmdArgs, 10);
-                 }
-                 for (i = 0; i <= 1; i++) {
-                     dig = ASCII_IsDig(*ftp_session->CtrlCmdArgs);
-                     while ((dig == DEF_NO) && (ftp_session->CtrlCmdArgs != 0) && (*ftp_session->CtrlCmdArgs != 0)) {
-                         ftp_session->CtrlCmdArgs++;
-                         dig = ASCII_IsDig(*ftp_session->CtrlCmdArgs);
-                     }
-                     p_port[i] = Str_ParseNbr_Int32U(ftp_session->CtrlCmdArgs, &ftp_session->CtrlCmdArgs, 10);
-                 }
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+                                                                /* SEGS: Declare file uploaded in segments.             */
+                                                                /* Syntax: SITE SEGS <size> <filename>                  */
+        case FTP_SITE_CMD_SEGS:
+             FTPs_SiteSegs(ftp_session);
+             break;
+#endif
 
-                 FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_OKAY, (CPU_CHAR *)0);
-             } else {
-                 FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CANTOPENDATA, (CPU_CHAR *)0);
-             }
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+                                                                /* RESUME: Get size & digest of interrupted upload.     */
+                                                                /* Syntax: SITE RESUME <filename>                       */
+        case FTP_SITE_CMD_RESUME:
+             FTPs_SiteResume(ftp_session);
              break;
+#endif
 
-                                                                /* REST:   Next transfer will start at offset <offset>. */
-                                                                /* Syntax: REST <offset>                                */
-        case FTP_CMD_REST:
-             p_cmd_arg = FTPs_FindArg(&ftp_session->CtrlCmdArgs);
-             if (*p_cmd_arg != (CPU_CHAR)0) {
-                 ftp_session->DtpOffset = Str_ParseNbr_Int32U(p_cmd_arg, 0, 10);
-                 ftp_session->CtrlState = FTPs_STATE_GOTREST;
-                 FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NEEDMOREINFO, (CPU_CHAR *)0);
-             }
+        default:
+             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PARMNOSUPPORT, (CPU_CHAR *)0);
              break;
+    }
+}
 
-                                                                /* PWD:    Get present working directory.               */
-                                                                /* Syntax: PWD                                          */
 
-                                                                /* CWD:    Change working directory.                    */
-                                                                /* Syntax: CWD <dirname>                                */
+/*
+*********************************************************************************************************
+*                                        FTPs_SiteBaseLenGet()
+*
+* Description : Get the length of the user base path at the beginning of FTPs_FullAbsPathPtr.
+*
+* Argument(s) : none.
+*
+* Return(s)   : Length of the base path.
+*
+* Caller(s)   : FTPs_SiteRmTree(),
+*               FTPs_SiteMkDirs(),
+*               FTPs_SiteDedup().
+*
+* Note(s)     : (1) FTPs_BuildPath() builds the absolute path as the base path followed by the FTP path, so
+*                   the FS path of an entry located at &path[base_len] is its FTP path in FS style.
+*********************************************************************************************************
+*/
 
-                                                                /* CDUP:   Change to parent directory.                  */
-                                                                /* Syntax: CDUP <filename>                              */
+static  CPU_SIZE_T  FTPs_SiteBaseLenGet (void)
+{
+    CPU_SIZE_T  abs_len;
+    CPU_SIZE_T  rel_len;
 
-                                                                /* MKD:    Create directory.                            */
-                                                                /* Syntax: MKD <dirname>                                */
 
-                                                                /* RMD:    Delete directory.                            */
-                                                                /* Syntax: RMD <dirname>                                */
+    abs_len = Str_Len(FTPs_FullAbsPathPtr);
+    rel_len = Str_Len(FTPs_FullRelPathPtr);
 
-                                                                /* NLST:   Get brief directory entries list.            */
-                                                                /* Syntax: NLST [<pathname>]                            */
+    return ((abs_len > rel_len) ? (abs_len - rel_len) : 0u);
+}
 
-                                                                /* LIST:   Get detailed directory entries list.         */
-                                                                /* Syntax: LIST [<pathname>]                            */
 
-                                                                /* RETR:   Retrieve file.                               */
-                                                                /* Syntax: RETR <filename>                              */
+/*
+*********************************************************************************************************
+*                                          FTPs_SiteRmTree()
+*
+* Description : Remove a directory & everything it contains (SITE RMTREE).
+*
+* Argument(s) : ftp_session     structure that contains FTP session states and control data.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ProcessSiteCmd().
+*
+* Note(s)     : (1) The tree is removed without recursion & with a single directory open at a time.  The
+*                   current directory is opened & its first entry is read :
+*
+*                   (a) A file      is removed.
+*                   (b) A directory becomes the current directory.
+*                   (c) If the directory is empty, it is removed & its parent becomes the current directory.
+*
+*                   Since the directory is closed before each removal, the file system never has to support
+*                   removing the entries of a directory being read.
+*
+*               (2) Each entry removed is reported on a line of a multi-line reply (see FTPs_ReplyMultiStart()).
+*                   The removal stops at the first entry that can't be removed.
+*
+*               (3) The root directory of the user can't be removed.
+*
+*               (4) A tree holding a file of the server itself, the dedup index or the resume journal, is not
+*                   removed (see FTPs_PathHasRsvd()).
+*********************************************************************************************************
+*/
 
-                                                                /* STOR:   Store file.                                  */
-                                                                /* Syntax: STOR <filename>                              */
+static  void  FTPs_SiteRmTree (FTPs_SESSION_STRUCT  *ftp_session)
+{
+    static  CPU_CHAR          path[FTPs_CFG_FS_PATH_LEN_MAX];
+    static  CPU_CHAR          name[FTPs_CFG_FS_NAME_LEN_MAX];
+    static  CPU_CHAR          line[FTPs_SITE_LINE_LEN_MAX];
+            FTPs_REPLY_MULTI  reply;
+            NET_FS_ENTRY      dirent;
+            void             *p_dir;
+            CPU_CHAR         *p_sep;
+            CPU_SIZE_T        base_len;
+            CPU_SIZE_T        top_len;
+            CPU_SIZE_T        path_len;
+            CPU_SIZE_T        name_len;
+            CPU_SIZE_T        sep_len;
+            CPU_INT32U        nbr_del;
+            CPU_INT16S        cmp_val;
+            CPU_INT16S        cmp_dot;
+            CPU_INT16S        cmp_dot_dot;
+            CPU_BOOLEAN       found;
+            CPU_BOOLEAN       fs_err;
+            CPU_BOOLEAN       rtn_val;
+            CPU_BOOLEAN       rsvd;
+
+
+    dirent.NamePtr = &name[0];
+    found          =  FTPs_EntryStat(FTPs_FullAbsPathPtr, &dirent);
+    cmp_val        =  Str_Cmp(FTPs_FullRelPathPtr, FTPs_ROOT_PATH);
+#if (FTPs_SRV_FILES_EN == DEF_ENABLED)
+    rsvd           =  FTPs_PathHasRsvd(FTPs_FullAbsPathPtr);
+#else
+    rsvd           =  DEF_NO;
+#endif
+    if ((found   == DEF_NO)  ||
+        (cmp_val == 0)       ||                                 /* See Note #3.                                         */
+        (rsvd    == DEF_YES) ||                                 /* See Note #4.                                         */
+        (DEF_BIT_IS_CLR(dirent.Attrib, NET_FS_ENTRY_ATTRIB_DIR) == DEF_YES)) {
+        Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
+                             FTPs_NET_BUF_LEN,
+                     (char *)FTPs_Reply[FTP_REPLY_NOTFOUND].ReplyStr,
+                             FTPs_FullRelPathPtr);
+        FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOTFOUND, FTPs_NetBufCtrlCmdPtr);
+        return;
+    }
 
-                                                                /* APPE:   Append file.                                 */
-                                                                /* Syntax: APPE <filename>                              */
+    FTPs_HandleClose(FTPs_FullAbsPathPtr);                      /* Release handles & cached data of the tree.           */
+    FTPs_InvalidatePath(FTPs_FullAbsPathPtr);
 
-                                                                /* DELE:   Delete file.                                 */
-                                                                /* Syntax: DELE <filename>                              */
+    Str_Copy_N(path, FTPs_FullAbsPathPtr, FTPs_CFG_FS_PATH_LEN_MAX);
+    base_len = FTPs_SiteBaseLenGet();
+    top_len  = Str_Len(path);
+    path_len = top_len;
+    nbr_del  = 0u;
+    rtn_val  = DEF_OK;
 
-                                                                /* RNFR:   Rename file from name.                       */
-                                                                /* Syntax: RNFR <filename>                              */
+    Str_FmtPrint((char *)line, FTPs_SITE_LINE_LEN_MAX, "Removing %s", FTPs_FullRelPathPtr);
+    FTPs_ReplyMultiStart(&reply, ftp_session->CtrlSockID, FTP_REPLY_ACTIONCOMPLETE, line);
 
-                                                                /* RNTO:   Rename file to name.                         */
-                                                                /* Syntax: RNTO <filename>                              */
+    while (rtn_val == DEF_OK) {                                 /* See Note #1.                                         */
+        p_dir = NetFS_DirOpen(path);
+        if (p_dir == (void *)0) {
+            rtn_val = DEF_FAIL;
+            break;
+        }
+        do {
+            fs_err = NetFS_DirRd(p_dir, &dirent);
+            if (fs_err != DEF_OK) {
+                break;
+            }
+            cmp_dot     = Str_Cmp(name, (CPU_CHAR *)".");
+            cmp_dot_dot = Str_Cmp(name, (CPU_CHAR *)"..");
+        } while ((cmp_dot     == 0) ||
+                 (cmp_dot_dot == 0));
+        NetFS_DirClose(p_dir);
+
+        if (fs_err != DEF_OK) {                                 /* Empty dir: remove it (see Note #1c).                 */
+            rtn_val = NetFS_EntryDel(path, DEF_NO);
+            if (rtn_val != DEF_OK) {
+                break;
+            }
+            nbr_del++;
+            Str_FmtPrint((char *)line, FTPs_SITE_LINE_LEN_MAX, "RMD  %s", &path[base_len]);
+            FTPs_ToFTPStylePath(line);
+            FTPs_ReplyMultiAdd(&reply, line);
 
-                                                                /* SIZE:   Get file size.                               */
-                                                                /* Syntax: SIZE <filename>                              */
+            if (path_len <= top_len) {                          /* Top dir removed: done.                               */
+                break;
+            }
+            p_sep     = Str_Char_Last(path, FTPs_FS_SepChar);
+           *p_sep     = (CPU_CHAR)0;
+            path_len  = (CPU_SIZE_T)(p_sep - &path[0]);
+            continue;
+        }
 
-                                                                /* MDTM:   Get file modification date/time.             */
-                                                                /* Syntax: MDTM <filename>                              */
-        case FTP_CMD_PWD:
-        case FTP_CMD_CWD:
-        case FTP_CMD_CDUP:
-        case FTP_CMD_MKD:
-        case FTP_CMD_RMD:
-        case FTP_CMD_NLST:
-        case FTP_CMD_LIST:
-        case FTP_CMD_RETR:
-        case FTP_CMD_STOR:
-        case FTP_CMD_APPE:
-        case FTP_CMD_DELE:
-        case FTP_CMD_RNFR:
-        case FTP_CMD_RNTO:
-        case FTP_CMD_SIZE:
-        case FTP_CMD_MDTM:
-                                                                /* Parameter handling.                                  */
-             if (ftp_session->CtrlCmd == FTP_CMD_PWD) {
-                 p_cmd_arg = (CPU_CHAR *)".";
-             } else if (ftp_session->CtrlCmd == FTP_CMD_CDUP) {
-                 p_cmd_arg = (CPU_CHAR *)"..";
-             } else if (ftp_session->CtrlCmd == FTP_CMD_MDTM) {
-                                                                /* MDTM command may have one or two arguments           */
-                                                                /* 1. If the first argument are a file name, return     */
-                                                                /*    file date and time.                               */
-                                                                /* 2. If the first argument are a date and time and the */
-                                                                /*    second argument are a file name, modify the file  */
-                                                                /*    date and time.                                    */
-                 p_cmd_arg   = FTPs_FindFileName(&ftp_session->CtrlCmdArgs);
-                 p_file_time = FTPs_FindArg(&ftp_session->CtrlCmdArgs);
+        name_len = Str_Len(name);
+        sep_len  = (path[path_len - 1u] == FTPs_FS_SepChar) ? 0u : 1u;
+        if (path_len + sep_len + name_len >= FTPs_CFG_FS_PATH_LEN_MAX) {
+            rtn_val = DEF_FAIL;                                 /* Path too long to be removed.                         */
+            break;
+        }
+        if (sep_len > 0u) {
+            path[path_len] = FTPs_FS_SepChar;
+        }
+        Mem_Copy(&path[path_len + sep_len], name, name_len + 1u);
 
-                                                                /* Check if first argument is a string of 14 digits.    */
-                                                                /* The date and time string has exactly 14 digits.      */
-                 cmp_val = Str_Len(p_file_time);
-                 if (cmp_val == 14) {
-                    for (i = 0; i < 14; i++) {
-                        dig = ASCII_IsDig(p_file_time[i]);
-                        if (dig == DEF_NO) {
-                            break;
-                        }
-                    }
-                    if (i == 14) {
-                                                                /* Yes: The file name starts after.                     */
-                                                                /* No:  The file name IS the first argument.            */
-                        p_cmd_arg = FTPs_FindFileName(&ftp_session->CtrlCmdArgs);
-                    } else {
-                        p_file_time = "";
-                    }
-                 } else {
-                    p_file_time = "";
-                 }
-             } else {
-                 p_cmd_arg = FTPs_FindFileName(&ftp_session->CtrlCmdArgs);
-             }
+        if (DEF_BIT_IS_SET(dirent.Attrib, NET_FS_ENTRY_ATTRIB_DIR) == DEF_YES) {
+            path_len += sep_len + name_len;                     /* Sub-dir: remove its content first (see Note #1b).    */
+            continue;
+        }
 
-             if (*p_cmd_arg != (CPU_CHAR)0) {
-                 FTPs_ToFTPStylePath(p_cmd_arg);
-             }
+        rtn_val = NetFS_EntryDel(path, DEF_YES);                /* File: remove it (see Note #1a).                      */
+        if (rtn_val != DEF_OK) {
+            break;
+        }
+        nbr_del++;
+        Str_FmtPrint((char *)line, FTPs_SITE_LINE_LEN_MAX, "DELE %s", &path[base_len]);
+        FTPs_ToFTPStylePath(line);
+        FTPs_ReplyMultiAdd(&reply, line);
+        path[path_len] = (CPU_CHAR)0;
+    }
+
+    FTPs_InvalidatePath(FTPs_FullAbsPathPtr);
+
+    if (rtn_val == DEF_OK) {
+        Str_FmtPrint((char *)line, FTPs_SITE_LINE_LEN_MAX, "%u entries removed.", (unsigned int)nbr_del);
+        FTPs_ReplyMultiEnd(&reply, FTP_REPLY_ACTIONCOMPLETE, line);
+    } else {
+        Str_FmtPrint((char *)line,
+                             FTPs_SITE_LINE_LEN_MAX,
+                             "%s not removed; %u entries removed.",
+                            &path[base_len],
+                             (unsigned int)nbr_del);
+        FTPs_ToFTPStylePath(line);
+        FTPs_ReplyMultiEnd(&reply, FTP_REPLY_NOTFOUND, line);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_SiteMkDirs()
+*
+* Description : Make a directory & any missing parent directory (SITE MKDIRS, like "mkdir -p").
+*
+* Argument(s) : ftp_session     structure that contains FTP session states and control data.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ProcessSiteCmd().
+*
+* Note(s)     : (1) Each component of the path, below the user base path, is looked up & created if it does
+*                   not exist.  Each directory created is reported on a line of a multi-line reply (see
+*                   FTPs_ReplyMultiStart()).
+*
+*               (2) The command fails if a component is a file or can't be created.  Directories created
+*                   before the failure are kept.
+*********************************************************************************************************
+*/
+
+static  void  FTPs_SiteMkDirs (FTPs_SESSION_STRUCT  *ftp_session)
+{
+    static  CPU_CHAR          path[FTPs_CFG_FS_PATH_LEN_MAX];
+    static  CPU_CHAR          line[FTPs_SITE_LINE_LEN_MAX];
+            FTPs_REPLY_MULTI  reply;
+            NET_FS_ENTRY      dirent;
+            CPU_SIZE_T        base_len;
+            CPU_SIZE_T        path_len;
+            CPU_SIZE_T        i;
+            CPU_INT32U        nbr_created;
+            CPU_CHAR          ch;
+            CPU_BOOLEAN       found;
+            CPU_BOOLEAN       rtn_val;
+
+
+    Str_Copy_N(path, FTPs_FullAbsPathPtr, FTPs_CFG_FS_PATH_LEN_MAX);
+    base_len    = FTPs_SiteBaseLenGet();
+    path_len    = Str_Len(path);
+    nbr_created = 0u;
+    rtn_val     = DEF_OK;
+
+    Str_FmtPrint((char *)line, FTPs_SITE_LINE_LEN_MAX, "Creating %s", FTPs_FullRelPathPtr);
+    FTPs_ReplyMultiStart(&reply, ftp_session->CtrlSockID, FTP_REPLY_ACTIONCOMPLETE, line);
+
+    for (i = base_len + 1u; i <= path_len; i++) {               /* See Note #1.                                         */
+        if ((path[i]      != FTPs_FS_SepChar) &&
+            (path[i]      != (CPU_CHAR)0)) {
+            continue;
+        }
+        if (path[i - 1u] == FTPs_FS_SepChar) {                  /* Empty component.                                     */
+            continue;
+        }
+
+        ch      = path[i];
+        path[i] = (CPU_CHAR)0;
+        found   = FTPs_EntryStat(path, &dirent);
+        if (found == DEF_YES) {
+            if (DEF_BIT_IS_CLR(dirent.Attrib, NET_FS_ENTRY_ATTRIB_DIR) == DEF_YES) {
+                rtn_val = DEF_FAIL;                             /* See Note #2.                                         */
+                break;
+            }
+        } else {
+            rtn_val = NetFS_EntryCreate(path, DEF_YES);
+            FTPs_InvalidatePath(path);
+            if (rtn_val != DEF_OK) {
+                break;
+            }
+            nbr_created++;
+            Str_FmtPrint((char *)line, FTPs_SITE_LINE_LEN_MAX, "MKD  %s", &path[base_len]);
+            FTPs_ToFTPStylePath(line);
+            FTPs_ReplyMultiAdd(&reply, line);
+        }
+        path[i] = ch;
+    }
+
+    if (rtn_val == DEF_OK) {
+        Str_FmtPrint((char *)line, FTPs_SITE_LINE_LEN_MAX, "%u directories created.", (unsigned int)nbr_created);
+        FTPs_ReplyMultiEnd(&reply, FTP_REPLY_ACTIONCOMPLETE, line);
+    } else {
+        Str_FmtPrint((char *)line,
+                             FTPs_SITE_LINE_LEN_MAX,
+                             "%s not created; %u directories created.",
+                            &path[base_len],
+                             (unsigned int)nbr_created);
+        FTPs_ToFTPStylePath(line);
+        FTPs_ReplyMultiEnd(&reply, FTP_REPLY_NOTFOUND, line);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                           FTPs_SiteCpFr()
+*
+* Description : Select the source file of a server-side copy (SITE CPFR).
+*
+* Argument(s) : ftp_session     structure that contains FTP session states and control data.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ProcessSiteCmd().
+*
+* Note(s)     : (1) The source path is kept in the rename buffers, since a session is never waiting for both
+*                   RNTO & SITE CPTO.  A path that doesn't fit is refused rather than truncated, which
+*                   could select another file.
+*********************************************************************************************************
+*/
 
-                                                                /* Skip "-xxxx" argument.                               */
-             if (*p_cmd_arg == '-') {
-                 p_cmd_arg = (CPU_CHAR *)".";
-             }
+#if (FTPs_CFG_SITE_COPY_EN == DEF_ENABLED)
+static  void  FTPs_SiteCpFr (FTPs_SESSION_STRUCT  *ftp_session)
+{
+    NET_FS_ENTRY  dirent;
+    CPU_SIZE_T    path_len;
+    CPU_BOOLEAN   found;
 
-             path_name_len = NetFS_CfgPathGetLenMax();
 
-             rtn_val = FTPs_BuildPath(FTPs_FullAbsPathPtr,   path_name_len,
-                                      FTPs_FullRelPathPtr,   path_name_len,
-                                      FTPs_ParentAbsPathPtr, path_name_len,
-                                      FTPs_CurEntryPtr,      path_name_len,
-                                      ftp_session->BasePath,
-                                      ftp_session->RelPath,
-                                      p_cmd_arg);
+    path_len = Str_Len(FTPs_FullAbsPathPtr);
+    if (path_len >= FTPs_CFG_FS_PATH_LEN_MAX) {                 /* See Note #1.                                         */
+        FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NAMEERR, (CPU_CHAR *)0);
+        return;
+    }
 
-             FTPs_ToFSStylePath(FTPs_FullAbsPathPtr);
-             FTPs_ToFSStylePath(FTPs_ParentAbsPathPtr);
+    found = FTPs_EntryStat(FTPs_FullAbsPathPtr, &dirent);
+    if ((found == DEF_NO) ||                                    /* Source MUST be a file.                               */
+        (DEF_BIT_IS_SET(dirent.Attrib, NET_FS_ENTRY_ATTRIB_DIR) == DEF_YES)) {
+        Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
+                             FTPs_NET_BUF_LEN,
+                     (char *)FTPs_Reply[FTP_REPLY_NOTFOUND].ReplyStr,
+                             FTPs_FullRelPathPtr);
+        FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOTFOUND, FTPs_NetBufCtrlCmdPtr);
+        return;
+    }
 
-                                                                /* Verify presence of CurEntry/directory/parent         */
-                                                                /* directory.                                           */
-             if (rtn_val == DEF_OK) {
-                 switch (ftp_session->CtrlCmd) {
-                     case FTP_CMD_PWD:
-                     case FTP_CMD_CWD:
-                     case FTP_CMD_CDUP:
-                     case FTP_CMD_RMD:
-                     case FTP_CMD_NLST:
-                     case FTP_CMD_LIST:
-                          p_dir = NetFS_DirOpen(FTPs_FullAbsPathPtr);
-                          if (p_dir == (void *)0) {
-                              rtn_val = DEF_FAIL;
-                          } else {
-                              rtn_val = DEF_OK;
-                          }
-                          NetFS_DirClose(p_dir);
-                          break;
+    Str_Copy_N(FTPs_RenAbsPathPtr, FTPs_FullAbsPathPtr, FTPs_CFG_FS_PATH_LEN_MAX);
+    Str_Copy_N(FTPs_RenRelPathPtr, FTPs_FullRelPathPtr, FTPs_CFG_FS_PATH_LEN_MAX);
+    ftp_session->CtrlState = FTPs_STATE_GOTCPFR;
+    FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NEEDMOREINFO, (CPU_CHAR *)0);
+}
+#endif
 
 
-                     case FTP_CMD_DELE:
-                          p_dir = NetFS_DirOpen(FTPs_ParentAbsPathPtr);
-                          if (p_dir == (void *)0) {
-                              rtn_val = DEF_FAIL;
-                          }
-                          NetFS_DirClose(p_dir);
-                          break;
+/*
+*********************************************************************************************************
+*                                           FTPs_SiteCpTo()
+*
+* Description : Copy the file selected by SITE CPFR to a new name (SITE CPTO).
+*
+* Argument(s) : ftp_session     structure that contains FTP session states and control data.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ProcessSiteCmd(),
+*               FTPs_SiteDedup().
+*
+* Note(s)     : (1) The file is copied on the device, FTPs_CFG_SITE_COPY_BUF_SIZE octets at a time, so the
+*                   data never crosses the network.  An existing destination file is overwritten.
+*
+*               (2) The destination can't be a directory, nor the source file itself.  The paths are compared
+*                   as the file system compares names (see FTPs_CFG_FS_CASE_SENSITIVE): opening the source
+*                   file itself as the destination would truncate it.
+*
+*               (3) A destination file partially written is deleted.
+*********************************************************************************************************
+*/
 
+#if (FTPs_CFG_SITE_COPY_EN == DEF_ENABLED)
+static  void  FTPs_SiteCpTo (FTPs_SESSION_STRUCT  *ftp_session)
+{
+    NET_FS_ENTRY   dirent;
+    void          *p_file_src;
+    void          *p_file_dest;
+    CPU_SIZE_T     rd_len;
+    CPU_SIZE_T     wr_len;
+    CPU_INT16S     cmp_val;
+    CPU_BOOLEAN    found;
+    CPU_BOOLEAN    rd_err;
+    CPU_BOOLEAN    wr_err;
+
+
+    ftp_session->CtrlState = FTPs_STATE_LOGIN;
+
+    found   = FTPs_EntryStat(FTPs_FullAbsPathPtr, &dirent);
+    cmp_val = FTPs_FS_NameCmp(FTPs_FullAbsPathPtr, FTPs_RenAbsPathPtr);
+    if (((found == DEF_YES) &&                                  /* See Note #2.                                         */
+         (DEF_BIT_IS_SET(dirent.Attrib, NET_FS_ENTRY_ATTRIB_DIR) == DEF_YES)) ||
+         (cmp_val == 0)) {
+        FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NAMEERR, (CPU_CHAR *)0);
+        return;
+    }
 
-                     case FTP_CMD_MKD:
-                     case FTP_CMD_RETR:
-                     case FTP_CMD_STOR:
-                     case FTP_CMD_APPE:
-                     case FTP_CMD_RNFR:
-                     case FTP_CMD_RNTO:
-                     case FTP_CMD_SIZE:
-                     case FTP_CMD_MDTM:
-                          p_file = NetFS_FileOpen(FTPs_FullAbsPathPtr,
-                                                  NET_FS_FILE_MODE_OPEN,
-                                                  NET_FS_FILE_ACCESS_RD);
-                          if (p_file != (void *)0) {
-                              switch (ftp_session->CtrlCmd) {
-                                  case FTP_CMD_MKD:
-                                  case FTP_CMD_APPE:
-                                  case FTP_CMD_RNTO:
-                                       rtn_val = DEF_FAIL;
-                                       break;
-
-                                  case FTP_CMD_SIZE:
-                                       NetFS_FileSizeGet(p_file, &dirent.Size);
-                                       break;
-
-                                  case FTP_CMD_MDTM:
-                                       NetFS_FileDateTimeCreateGet(p_file, &dirent.DateTimeCreate);
-                                       break;
-
-                                  default:
-                                       rtn_val = DEF_OK;
-                                       break;
-                              }
-                              NetFS_FileClose(p_file);
+    p_file_src = FTPs_FileOpenRd(FTPs_RenAbsPathPtr);
+    if (p_file_src == (void *)0) {
+        Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
+                             FTPs_NET_BUF_LEN,
+                     (char *)FTPs_Reply[FTP_REPLY_NOTFOUND].ReplyStr,
+                             FTPs_RenRelPathPtr);
+        FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOTFOUND, FTPs_NetBufCtrlCmdPtr);
+        return;
+    }
 
-                          } else {
-                              switch (ftp_session->CtrlCmd) {
-                                  case FTP_CMD_MKD:
-                                  case FTP_CMD_STOR:
-                                  case FTP_CMD_APPE:
-                                  case FTP_CMD_RNTO:
-                                       rtn_val = DEF_OK;
-                                       break;
-
-                                  default:
-                                       rtn_val = DEF_FAIL;
-                                       break;
-                              }
-                          }
-                          break;
+    FTPs_HandleClose(FTPs_FullAbsPathPtr);
+    FTPs_InvalidatePath(FTPs_FullAbsPathPtr);
+    p_file_dest = NetFS_FileOpen(FTPs_FullAbsPathPtr,
+                                 NET_FS_FILE_MODE_CREATE,
+                                 NET_FS_FILE_ACCESS_WR);
+    if (p_file_dest == (void *)0) {
+        FTPs_FileCloseRd(p_file_src);
+        Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
+                             FTPs_NET_BUF_LEN,
+                     (char *)FTPs_Reply[FTP_REPLY_NOTFOUND].ReplyStr,
+                             FTPs_FullRelPathPtr);
+        FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOTFOUND, FTPs_NetBufCtrlCmdPtr);
+        return;
+    }
 
+    wr_err = DEF_OK;
+    do {                                                        /* See Note #1.                                         */
+        rd_err = NetFS_FileRd((void       *) p_file_src,
+                              (void       *) FTPs_SiteCopyBufPtr,
+                              (CPU_SIZE_T  ) FTPs_CFG_SITE_COPY_BUF_SIZE,
+                              (CPU_SIZE_T *)&rd_len);
+        if (rd_len == 0u) {
+            break;
+        }
+        (void)NetFS_FileWr((void       *) p_file_dest,
+                           (void       *) FTPs_SiteCopyBufPtr,
+                           (CPU_SIZE_T  ) rd_len,
+                           (CPU_SIZE_T *)&wr_len);
+        if (wr_len != rd_len) {
+            FTPs_TRACE_DBG(("FTPs NetFS_FileWr() failed: line #%u.\n", (unsigned int)__LINE__));
+            wr_err = DEF_FAIL;
+            break;
+        }
+    } while (rd_len == FTPs_CFG_SITE_COPY_BUF_SIZE);            /* Short file read: end of file.                        */
 
-                     default:
-                          break;
-                 }
+    NetFS_FileClose(p_file_dest);
+    FTPs_FileCloseRd(p_file_src);
 
-                                                                /* Do action.                                           */
-                 if (rtn_val == DEF_OK) {
-                     switch (ftp_session->CtrlCmd) {
-                         case FTP_CMD_PWD:
-                              Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
-                                                   FTPs_NET_BUF_LEN,
-                                           (char *)"257 \"%s\" is current directory.",
-                                                   FTPs_FullRelPathPtr);
-                              FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PATHNAME, FTPs_NetBufCtrlCmdPtr);
-                              break;
+    if ((rd_err == DEF_OK) &&
+        (wr_err == DEF_OK)) {
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+        FTPs_PinReload(FTPs_FullAbsPathPtr);                    /* Re-read overwritten pinned file.                     */
+#endif
+        FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ACTIONCOMPLETE, (CPU_CHAR *)0);
+        return;
+    }
 
-                         case FTP_CMD_CWD:
-                         case FTP_CMD_CDUP:
-                              Str_Copy_N(ftp_session->RelPath,  FTPs_FullRelPathPtr, FTPs_CFG_FS_PATH_LEN_MAX);
-                              FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ACTIONCOMPLETE, (CPU_CHAR *)0);
-                              break;
+    (void)NetFS_EntryDel(FTPs_FullAbsPathPtr, DEF_YES);         /* See Note #3.                                         */
+    FTPs_InvalidatePath(FTPs_FullAbsPathPtr);
+    if (wr_err != DEF_OK) {
+        FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOSPACE, (CPU_CHAR *)0);
+    } else {
+        FTPs_TRACE_DBG(("FTPs NetFS_FileRd() failed: line #%u.\n", (unsigned int)__LINE__));
+        FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ACTIONABORTED, (CPU_CHAR *)0);
+    }
+}
+#endif
 
-                         case FTP_CMD_NLST:
-                         case FTP_CMD_LIST:
-                         case FTP_CMD_RETR:
-                         case FTP_CMD_STOR:
-                         case FTP_CMD_APPE:
-                              FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_OKAYOPENING, (CPU_CHAR *)0);
-                              ftp_session->DtpCmd = ftp_session->CtrlCmd;
-                              Str_Copy_N(ftp_session->CurEntry, FTPs_FullAbsPathPtr, FTPs_CFG_FS_PATH_LEN_MAX);
-                              FTPs_DtpTask((void *)ftp_session);
-                              ftp_session->DtpOffset = 0;
-                              ftp_session->CtrlState = FTPs_STATE_LOGIN;
-                              break;
+/*
+*********************************************************************************************************
+*                                          FTPs_SiteDedup()
+*
+* Description : Create a file from an indexed file with the same content (SITE DEDUP).
+*
+* Argument(s) : ftp_session     structure that contains FTP session states and control data.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ProcessSiteCmd().
+*
+* Note(s)     : (1) The digest was parsed into FTPs_Dedup.Digest by FTPs_ProcessCtrlCmd().
+*
+*               (2) If the file already has the digest, nothing is written.  If another file of the user has
+*                   it, that file is copied on the device (see FTPs_SiteCpTo()).  Otherwise, the client MUST
+*                   upload the file.
+*
+*               (3) The file system has no hard links: a duplicate is a copy of the file.
+*********************************************************************************************************
+*/
 
-                         case FTP_CMD_MKD:
-                              rtn_val = NetFS_EntryCreate(FTPs_FullAbsPathPtr, DEF_YES);
-                              if (rtn_val == DEF_OK) {
-                                  Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
-                                                       FTPs_NET_BUF_LEN,
-                                               (char *)FTPs_Reply[FTP_REPLY_PATHNAME].ReplyStr,
-                                                       FTPs_FullRelPathPtr);
-                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PATHNAME, FTPs_NetBufCtrlCmdPtr);
-                              } else {
-                                  Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
-                                                       FTPs_NET_BUF_LEN,
-                                               (char *)FTPs_Reply[FTP_REPLY_NOTFOUND].ReplyStr,
-                                                       FTPs_FullRelPathPtr);
-                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOTFOUND, FTPs_NetBufCtrlCmdPtr);
-                              }
-                              break;
+#if (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+static  void  FTPs_SiteDedup (FTPs_SESSION_STRUCT  *ftp_session)
+{
+    CPU_SIZE_T  base_len;
+    CPU_INT08U  result;
 
-                         case FTP_CMD_RMD:
-                              rtn_val = NetFS_EntryDel(FTPs_FullAbsPathPtr, DEF_NO);
-                              if (rtn_val == DEF_OK) {
-                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ACTIONCOMPLETE, (CPU_CHAR *)0);
-                              } else {
-                                  Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
-                                                       FTPs_NET_BUF_LEN,
-                                               (char *)FTPs_Reply[FTP_REPLY_NOTFOUND].ReplyStr,
-                                                       FTPs_FullRelPathPtr);
-                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOTFOUND, FTPs_NetBufCtrlCmdPtr);
-                              }
-                              break;
 
-                         case FTP_CMD_DELE:
-                              rtn_val = NetFS_EntryDel(FTPs_FullAbsPathPtr, DEF_YES);
-                              if (rtn_val == DEF_OK) {
-                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ACTIONCOMPLETE, (CPU_CHAR *)0);
-                              } else {
-                                  Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
-                                                       FTPs_NET_BUF_LEN,
-                                               (char *)FTPs_Reply[FTP_REPLY_NOTFOUND].ReplyStr,
-                                                       FTPs_FullRelPathPtr);
-                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOTFOUND, FTPs_NetBufCtrlCmdPtr);
-                              }
-                              break;
+    base_len = FTPs_SiteBaseLenGet();
+    result   = FTPs_DedupIdxFind(FTPs_FullAbsPathPtr, FTPs_Dedup.Digest, base_len);
+    switch (result) {
+        case FTPs_DEDUP_SAME:                                   /* See Note #2.                                         */
+             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ACTIONCOMPLETE, (CPU_CHAR *)"250 File already present: no transfer needed.");
+             break;
 
-                         case FTP_CMD_RNFR:
-                              Str_Copy_N(FTPs_RenAbsPathPtr, FTPs_FullAbsPathPtr, FTPs_CFG_FS_PATH_LEN_MAX);
-                              Str_Copy_N(FTPs_RenRelPathPtr, FTPs_FullRelPathPtr, FTPs_CFG_FS_PATH_LEN_MAX);
-                              ftp_session->CtrlState = FTPs_STATE_GOTRNFR;
-                              FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NEEDMOREINFO, (CPU_CHAR *)0);
-                              break;
+        case FTPs_DEDUP_OTHER:                                  /* See Note #3.                                         */
+             Str_Copy_N(FTPs_RenAbsPathPtr,  FTPs_Dedup.Path,           FTPs_CFG_FS_PATH_LEN_MAX);
+             Str_Copy_N(FTPs_RenRelPathPtr, &FTPs_Dedup.Path[base_len], FTPs_CFG_FS_PATH_LEN_MAX);
+             FTPs_ToFTPStylePath(FTPs_RenRelPathPtr);
+             FTPs_SiteCpTo(ftp_session);
+             break;
 
-                         case FTP_CMD_RNTO:
-                              rtn_val = NetFS_EntryRename(FTPs_RenAbsPathPtr, FTPs_FullAbsPathPtr);
-                              ftp_session->CtrlState = FTPs_STATE_LOGIN;
-                              if (rtn_val == DEF_OK) {
-                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ACTIONCOMPLETE, (CPU_CHAR *)0);
-                              } else {
-                                  Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
-                                                       FTPs_NET_BUF_LEN,
-                                               (char *)FTPs_Reply[FTP_REPLY_NOTFOUND].ReplyStr,
-                                                       FTPs_RenRelPathPtr);
-                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOTFOUND, FTPs_NetBufCtrlCmdPtr);
-                              }
-                              break;
+        case FTPs_DEDUP_NONE:
+        default:
+             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOTFOUND, (CPU_CHAR *)"550 No file with this digest: upload needed.");
+             break;
+    }
+}
+#endif
 
-                         case FTP_CMD_SIZE:
-                              Str_FmtPrint((char       *)FTPs_NetBufCtrlCmdPtr,
-                                                         FTPs_NET_BUF_LEN,
-                                           (char       *)"213 %u",
-                                           (unsigned int)dirent.Size);
-                              FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_FILESTATUS, FTPs_NetBufCtrlCmdPtr);
-                              break;
 
-                         case FTP_CMD_MDTM:
-                              cmp_val = Str_Cmp(p_file_time, "");
-                              if (cmp_val == 0) {
-                                                                /* Return file date and time.                           */
-                                  Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
-                                                       FTPs_NET_BUF_LEN,
-                                               (char *)"213 %04hu%02hu%02hu%02hu%02hu%02hu",
-                                                       dirent.DateTimeCreate.Yr,
-                                                       dirent.DateTimeCreate.Month,
-                                                       dirent.DateTimeCreate.Day,
-                                                       dirent.DateTimeCreate.Hr,
-                                                       dirent.DateTimeCreate.Min,
-                                                       dirent.DateTimeCreate.Sec);
-                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_FILESTATUS, FTPs_NetBufCtrlCmdPtr);
-                              } else {
-                                                                /* Modify file date and time.                           */
-                                  Str_FmtScan((char *)p_file_time,
-                                                     "%04hu%02hu%02hu%02hu%02hu%02hu",
-                                                     (CPU_INT16U *)&dirent.DateTimeCreate.Yr,
-                                                     (CPU_INT16U *)&dirent.DateTimeCreate.Month,
-                                                     (CPU_INT16U *)&dirent.DateTimeCreate.Day,
-                                                     (CPU_INT16U *)&dirent.DateTimeCreate.Hr,
-                                                     (CPU_INT16U *)&dirent.DateTimeCreate.Min,
-                                                     (CPU_INT16U *)&dirent.DateTimeCreate.Sec);
-                                 (void)NetFS_EntryTimeSet(FTPs_FullAbsPathPtr, &dirent.DateTimeCreate);
-                                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ACTIONCOMPLETE, (CPU_CHAR *)0);
-                              }
-                              break;
+/*
+*********************************************************************************************************
+*                                           FTPs_SiteSegs()
+*
+* Description : Declare a file uploaded in segments, or get the progress of its upload (SITE SEGS).
+*
+* Argument(s) : ftp_session     structure that contains FTP session states and control data.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ProcessSiteCmd().
+*
+* Note(s)     : (1) The size was parsed into FTPs_SegsSize by FTPs_ProcessCtrlCmd().
+*
+*               (2) Every session sending segments of the file declares it with the same size : the first
+*                   declaration starts the upload & the others join it.  A different size restarts it.
+*
+*               (3) The file is replaced once all its octets are received; a failed replacement is retried.
+*
+*               (4) "SITE SEGS 0 <filename>" cancels the upload & deletes its temporary file.  An upload
+*                   without a declaration or a segment for FTPs_CFG_SEGS_IDLE_TIMEOUT_MS is abandoned : it is
+*                   cancelled when its slot is needed by a new upload.
+*********************************************************************************************************
+*/
 
-                         default:
-                            break;
-                     }
-                 } else {
-                     Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
-                                          FTPs_NET_BUF_LEN,
-                                  (char *)FTPs_Reply[FTP_REPLY_NOTFOUND].ReplyStr,
-                                          FTPs_FullRelPathPtr);
-                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOTFOUND, FTPs_NetBufCtrlCmdPtr);
-                 }
-             } else {
-                 FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NAMEERR, (CPU_CHAR *)0);
-             }
-             break;
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+static  void  FTPs_SiteSegs (FTPs_SESSION_STRUCT  *ftp_session)
+{
+    FTPs_SEGS     *p_segs;
+    NET_FS_ENTRY   dirent;
+    void          *p_file;
+    NET_TS_MS      ts_now;
+    CPU_SIZE_T     path_len;
+    CPU_INT32U     i;
+    CPU_BOOLEAN    found;
+    CPU_BOOLEAN    rtn_val;
 
-       case FTP_CMD_PBSZ:
+
+    if (FTPs_SegsSize == 0u) {                                  /* Cancel upload (see Note #4).                         */
+        found = FTPs_SegsCancel(FTPs_FullAbsPathPtr);
+        if (found == DEF_YES) {
+            FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ACTIONCOMPLETE, (CPU_CHAR *)0);
+        } else {
             Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
                                  FTPs_NET_BUF_LEN,
-                         (char *)FTPs_Reply[FTP_REPLY_PBSZ].ReplyStr,
-                                 ftp_session->CtrlCmdArgs);
-             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PBSZ, FTPs_NetBufCtrlCmdPtr);
-             break;
+                         (char *)FTPs_Reply[FTP_REPLY_NOTFOUND].ReplyStr,
+                                 FTPs_FullRelPathPtr);
+            FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOTFOUND, FTPs_NetBufCtrlCmdPtr);
+        }
+        return;
+    }
 
+    p_segs = FTPs_SegsGet(FTPs_FullAbsPathPtr);
+    if ((p_segs       == (FTPs_SEGS *)0) ||                     /* See Note #2.                                         */
+        (p_segs->Size != FTPs_SegsSize)) {
+        found    = FTPs_EntryStat(FTPs_FullAbsPathPtr, &dirent);
+        path_len = Str_Len(FTPs_FullAbsPathPtr);
+        if (((found == DEF_YES) &&
+             (DEF_BIT_IS_SET(dirent.Attrib, NET_FS_ENTRY_ATTRIB_DIR) == DEF_YES)) ||
+             (path_len + FTPs_SEGS_TMP_EXT_LEN >= FTPs_CFG_FS_PATH_LEN_MAX)) {
+            FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NAMEERR, (CPU_CHAR *)0);
+            return;
+        }
 
-       case FTP_CMD_PROT:
-             Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
-                                  FTPs_NET_BUF_LEN,
-                          (char *)FTPs_Reply[FTP_REPLY_PROT].ReplyStr,
-                                  ftp_session->CtrlCmdArgs);
-             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_PROT, FTPs_NetBufCtrlCmdPtr);
-             break;
+        for (i = 0u; (p_segs == (FTPs_SEGS *)0) && (i < FTPs_CFG_SEGS_NBR_MAX); i++) {
+            if (FTPs_SegsTbl[i].En == DEF_NO) {
+                p_segs = &FTPs_SegsTbl[i];
+            }
+        }
+        ts_now = NetUtil_TS_Get_ms();
+        for (i = 0u; (p_segs == (FTPs_SEGS *)0) && (i < FTPs_CFG_SEGS_NBR_MAX); i++) {
+            if ((NET_TS_MS)(ts_now - FTPs_SegsTbl[i].TS) >= FTPs_CFG_SEGS_IDLE_TIMEOUT_MS) {
+               (void)FTPs_SegsCancel(FTPs_SegsTbl[i].Path);     /* Reuse abandoned upload's slot (see Note #4).         */
+                p_segs = &FTPs_SegsTbl[i];
+            }
+        }
+        if (p_segs == (FTPs_SEGS *)0) {
+            FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOSPACE, (CPU_CHAR *)"552 Too many segmented uploads.");
+            return;
+        }
 
+        Str_Copy_N(p_segs->Path,    FTPs_FullAbsPathPtr, FTPs_CFG_FS_PATH_LEN_MAX);
+        Str_Copy_N(p_segs->TmpPath, FTPs_FullAbsPathPtr, FTPs_CFG_FS_PATH_LEN_MAX);
+        Str_Cat(p_segs->TmpPath, FTPs_SEGS_TMP_EXT_STR);
+        p_segs->Size     = FTPs_SegsSize;
+        p_segs->NbrRx    = 0u;
+        p_segs->NbrRange = 0u;
+        p_segs->TS       = NetUtil_TS_Get_ms();
+        p_segs->En       = DEF_NO;
+
+        FTPs_HandleClose(p_segs->TmpPath);
+        p_file = NetFS_FileOpen(p_segs->TmpPath,                /* Create empty temporary file.                         */
+                                NET_FS_FILE_MODE_CREATE,
+                                NET_FS_FILE_ACCESS_WR);
+        FTPs_InvalidatePath(p_segs->TmpPath);
+        if (p_file == (void *)0) {
+            FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NAMEERR, (CPU_CHAR *)0);
+            return;
+        }
+        NetFS_FileClose(p_file);
+        p_segs->En = DEF_YES;
+    }
 
-        default:
-             FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CMDNOSUPPORT, (CPU_CHAR *)0);
-             break;
+    if (p_segs->NbrRx == p_segs->Size) {                        /* See Note #3.                                         */
+        rtn_val = FTPs_SegsCommit(p_segs);
+        if (rtn_val != DEF_OK) {
+            FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NAMEERR, (CPU_CHAR *)0);
+            return;
+        }
+        FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ACTIONCOMPLETE, (CPU_CHAR *)0);
+        return;
+    }
+
+    Str_FmtPrint((char       *)FTPs_NetBufCtrlCmdPtr,
+                               FTPs_NET_BUF_LEN,
+                 (char       *)"200 Segmented upload of %s: %u of %u octets received.",
+                 (char       *)FTPs_FullRelPathPtr,
+                 (unsigned int)p_segs->NbrRx,
+                 (unsigned int)p_segs->Size);
+    FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_OKAY, FTPs_NetBufCtrlCmdPtr);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          FTPs_SiteResume()
+*
+* Description : Get the size & the digest of an interrupted upload (SITE RESUME).
+*
+* Argument(s) : ftp_session     structure that contains FTP session states and control data.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : FTPs_ProcessSiteCmd().
+*
+* Note(s)     : (1) The reply is "213 <size> <sha256>", where <size> is the number of octets of the file
+*                   written to the media & <sha256> the SHA-256 digest of these octets, in hexadecimal.  The
+*                   client compares the digest to the one of its own data, then continues the upload with
+*                   "REST <size>" & STOR.
+*********************************************************************************************************
+*/
+
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+static  void  FTPs_SiteResume (FTPs_SESSION_STRUCT  *ftp_session)
+{
+    NET_FS_ENTRY   dirent;
+    FTPs_SHA256    sha;
+    CPU_INT08U     digest[FTPs_SHA256_LEN];
+    CPU_CHAR       digest_str[FTPs_SHA256_LEN * 2u + 1u];
+    CPU_SIZE_T     i;
+    CPU_BOOLEAN    found;
+
+
+    found = FTPs_EntryStat(FTPs_FullAbsPathPtr, &dirent);
+    if ((found == DEF_YES) &&
+        (DEF_BIT_IS_CLR(dirent.Attrib, NET_FS_ENTRY_ATTRIB_DIR) == DEF_YES)) {
+        found = FTPs_ResumeGet(FTPs_FullAbsPathPtr, dirent.Size);
+    } else {
+        found = DEF_NO;
+    }
+    if (found == DEF_NO) {
+        Str_FmtPrint((char *)FTPs_NetBufCtrlCmdPtr,
+                             FTPs_NET_BUF_LEN,
+                     (char *)"550 No interrupted upload of %s.",
+                             FTPs_FullRelPathPtr);
+        FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_NOTFOUND, FTPs_NetBufCtrlCmdPtr);
+        return;
+    }
+
+    sha = FTPs_Resume.Rec.Sha;                                  /* Digest of the octets written so far.                 */
+    FTPs_Sha256Final(&sha, digest);
+    for (i = 0u; i < FTPs_SHA256_LEN; i++) {
+        Str_FmtPrint((char *)&digest_str[i * 2u], 3u, "%02x", (unsigned int)digest[i]);
     }
+
+    Str_FmtPrint((char       *)FTPs_NetBufCtrlCmdPtr,           /* See Note #1.                                         */
+                               FTPs_NET_BUF_LEN,
+                 (char       *)"213 %u %s",
+                 (unsigned int)FTPs_Resume.Rec.Size,
+                               digest_str);
+    FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_FILESTATUS, FTPs_NetBufCtrlCmdPtr);
 }
+#endif
 
 
 /*
@@ -2326,7 +12244,39 @@ static  void  FTPs_ProcessCtrlCmd (FTPs_SESSION_STRUCT  *ftp_session)
 *
 * Caller(s)   : FTPs_DtpTask().
 *
-* Note(s)     : none.
+* Note(s)     : (1) A recursive LIST (e.g. "LIST -lR") sends the top directory, then each sub-directory, in
+*                   depth-first order, preceded by a "<relative path>:" header line, like "ls -R".  A recursive
+*                   MLSD sends the entries of the sub-directories with their relative name (e.g. "sub/name").
+*                   See FTPs_ListWalkNext() for the walk limits.
+*
+*               (2) RETR of a directory archive (see FTPs_TarStart()) sends the archive generated by FTPs_TarTx()
+*                   instead of a file.
+*
+*               (3) STOR of a directory archive extracts it with FTPs_TarRx() instead of writing a file, then
+*                   sends a single reply summarizing the extraction.
+*
+*               (4) RETR of a file signature sends the signature generated by FTPs_DeltaSigTx() & STOR of a
+*                   file delta rebuilds the file with FTPs_DeltaRx() (see FTPs_DeltaStart()).
+*
+*               (5) RETR after "REST <offset>-<end>" stops once ftp_session->DtpLen octets are sent (see
+*                   FTPs_ProcessCtrlCmd() Note #6).
+*
+*               (6) The data received by a STOR without REST, or by a STOR continuing a journaled upload (see
+*                   Note #9), is hashed while it is written.  Once the file is completely received, its digest
+*                   is recorded in the dedup index (see FTPs_SiteDedup()).
+*
+*               (7) STOR of a segment writes it at its offset in the temporary file of the segmented upload
+*                   (see FTPs_SegsRx()).
+*
+*               (8) RETR of a followed file sends the file, then the octets appended to it, with the handle
+*                   opened by the command validation (see FTPs_TailTx()).  The file is never served from RAM.
+*
+*               (9) A STOR without REST, or after REST at the end of an interrupted upload, is recorded in the
+*                   resume journal (see FTPs_ResumeStart()).  The record, written when the transfer starts,
+*                   every FTPs_CFG_RESUME_SYNC_LEN octets (see FTPs_ResumeSync()) & when it ends (see
+*                   FTPs_ResumeEnd()), holds the number of octets written to the media & their digest state.
+*                   If the file can't be opened or positioned, the record of a continued upload is restored
+*                   & the record of a new upload is freed.
 *********************************************************************************************************
 */
 
@@ -2342,24 +12292,114 @@ static  void  FTPs_ProcessDtpCmd (FTPs_SESSION_STRUCT  *ftp_session)
     void          *p_dir;
     NET_FS_ENTRY   dirent;
     CPU_CHAR       dirent_name[FTPs_CFG_FS_NAME_LEN_MAX];
-    CPU_CHAR       attr_dir;
-    CPU_CHAR       attr_ro;
+    CPU_CHAR      *p_buf;
+    CPU_CHAR      *p_mem;
+    CPU_SIZE_T     mem_len;
+    CPU_SIZE_T     mem_pos;
+    CPU_SIZE_T     rd_len;
+    CPU_INT32U     tx_rem;
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+    FTPs_CACHE_ENTRY  *p_cache;
+    FTPs_CACHE_ENTRY  *p_fill;
+    CPU_SIZE_T         fill_len;
+#endif
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+    FTPs_PIN_ENTRY    *p_pin;
+#endif
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+    FTPs_PREFETCH_ENTRY  *p_pf;
+#endif
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+    FTPs_LIST_ENTRY      *p_list;
+#endif
+#if (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+    CPU_INT16S            cmp_dot;
+    CPU_INT16S            cmp_dot_dot;
+#endif
+#if (FTPs_CFG_TAR_EXTRACT_EN == DEF_ENABLED)
+    CPU_CHAR             *p_reply;
+#endif
+#if ((FTPs_CFG_TAR_EXTRACT_EN == DEF_ENABLED) || \
+     (FTPs_CFG_DELTA_EN       == DEF_ENABLED) || \
+     (FTPs_CFG_SEGS_EN        == DEF_ENABLED))
+    CPU_INT32S            reply_nbr;
+#endif
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+    CPU_INT08U            seg_err;
+#endif
+#if ((FTPs_CFG_DEDUP_EN  == DEF_ENABLED) || \
+     (FTPs_CFG_RESUME_EN == DEF_ENABLED))
+    FTPs_SHA256          *p_sha;
+#endif
+#if (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+    CPU_INT08U            digest[FTPs_SHA256_LEN];
+#endif
     NET_ERR        net_err;
     CPU_BOOLEAN    fs_err;
+    CPU_BOOLEAN    match;
+    CPU_CHAR      *p_name;
 
 
     str_len_ttl    =         0;
     p_file         = (void *)0;
+    p_mem          = (CPU_CHAR *)0;
+    mem_len        =         0u;
+    mem_pos        =         0u;
     p_dir          = (void *)0;
     net_err        =         NET_SOCK_ERR_NONE;
     dirent.NamePtr =        &dirent_name[0];
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+    p_fill         = (FTPs_CACHE_ENTRY *)0;
+    fill_len       =         0u;
+#endif
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+    p_pf           = (FTPs_PREFETCH_ENTRY *)0;
+#endif
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+    p_list         = (FTPs_LIST_ENTRY *)0;
+
+    if ((ftp_session->DtpCmd == FTP_CMD_NLST) ||               /* Send cached listing, if any.                         */
+        (ftp_session->DtpCmd == FTP_CMD_LIST) ||
+        (ftp_session->DtpCmd == FTP_CMD_MLSD)) {
+        p_list = FTPs_ListGet(ftp_session->CurEntry, ftp_session->DtpCmd);
+        if (p_list != (FTPs_LIST_ENTRY *)0) {
+            if (ftp_session->DtpDirPtr != (void *)0) {
+                NetFS_DirClose(ftp_session->DtpDirPtr);
+                ftp_session->DtpDirPtr = (void *)0;
+            }
+            fs_err = FTPs_ListTx(ftp_session->DtpSockID, p_list, &net_err);
+            if (fs_err == DEF_OK) {
+                FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CLOSINGSUCCESS, (CPU_CHAR *)0);
+            } else {
+                FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CLOSEDCONNABORT, (CPU_CHAR *)0);
+            }
+            return;
+        }
+    }
+#endif
 
     switch (ftp_session->DtpCmd) {
         case FTP_CMD_NLST:
-             p_dir = NetFS_DirOpen(ftp_session->CurEntry);
+             p_dir                  = ftp_session->DtpDirPtr;   /* Use dir opened by cmd validation, if any.            */
+             ftp_session->DtpDirPtr = (void *)0;
+             if (p_dir == (void *)0) {
+                 p_dir = NetFS_DirOpen(ftp_session->CurEntry);
+             }
              if (p_dir != (void *)0) {
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+                 p_list = FTPs_ListFillStart(ftp_session->CurEntry, ftp_session->DtpCmd);
+#endif
                  fs_err = NetFS_DirRd(p_dir, &dirent);
                  while (fs_err == DEF_OK) {
+#if (FTPs_CFG_LIST_GLOB_EN == DEF_ENABLED)
+                     if (FTPs_Glob.En == DEF_YES) {             /* Skip entries not matching the name pattern.          */
+                         match = FTPs_GlobMatch(&FTPs_Glob, dirent.NamePtr);
+                         if (match == DEF_NO) {
+                             fs_err = NetFS_DirRd(p_dir, &dirent);
+                             continue;
+                         }
+                     }
+#endif
                      prn_buf     = FTPs_NetBufDtpCmdPtr + str_len_ttl;
                      prn_buf_len = FTPs_NET_BUF_LEN - str_len_ttl;
                      str_len = Str_FmtPrint((char *)prn_buf,
@@ -2378,6 +12418,11 @@ static  void  FTPs_ProcessDtpCmd (FTPs_SESSION_STRUCT  *ftp_session)
                          continue;
                      }
 
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+                     if (p_list != (FTPs_LIST_ENTRY *)0) {      /* Keep line for following listings.                    */
+                         p_list = FTPs_ListFillAdd(p_list, prn_buf, str_len);
+                     }
+#endif
                      str_len_ttl += str_len;
                      fs_err = NetFS_DirRd(p_dir, &dirent);
                  }
@@ -2400,34 +12445,61 @@ static  void  FTPs_ProcessDtpCmd (FTPs_SESSION_STRUCT  *ftp_session)
              break;
 
         case FTP_CMD_LIST:
-             p_dir = NetFS_DirOpen(ftp_session->CurEntry);
+        case FTP_CMD_MLSD:
+             p_dir                  = ftp_session->DtpDirPtr;   /* Use dir opened by cmd validation, if any.            */
+             ftp_session->DtpDirPtr = (void *)0;
+             if (p_dir == (void *)0) {
+                 p_dir = NetFS_DirOpen(ftp_session->CurEntry);
+             }
              if (p_dir != (void *)0) {
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+                 p_list = FTPs_ListFillStart(ftp_session->CurEntry, ftp_session->DtpCmd);
+#endif
+#if (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+                 if (FTPs_ListWalk.En == DEF_YES) {
+                     FTPs_ListWalkStart(ftp_session->CurEntry);
+                 }
+#endif
                  fs_err = NetFS_DirRd(p_dir, &dirent);
                  while (fs_err == DEF_OK) {
-                     if (DEF_BIT_IS_CLR(dirent.Attrib, NET_FS_ENTRY_ATTRIB_HIDDEN) == DEF_YES) {
-                         if (DEF_BIT_IS_CLR(dirent.Attrib, NET_FS_ENTRY_ATTRIB_DIR) == DEF_YES) {
-                             attr_dir = '-';
-                         } else {
-                             attr_dir = 'd';
-                         }
-                         if (DEF_BIT_IS_CLR(dirent.Attrib, NET_FS_ENTRY_ATTRIB_WR) == DEF_YES) {
-                             attr_ro  = '-';
-                         } else {
-                             attr_ro  = 'w';
+                     match = DEF_BIT_IS_CLR(dirent.Attrib, NET_FS_ENTRY_ATTRIB_HIDDEN);
+#if (FTPs_CFG_LIST_GLOB_EN == DEF_ENABLED)
+                     if ((match        == DEF_YES) &&           /* Skip entries not matching the name pattern.          */
+                         (FTPs_Glob.En == DEF_YES)) {
+                         match = FTPs_GlobMatch(&FTPs_Glob, dirent.NamePtr);
+                     }
+#endif
+#if (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+                                                                /* See FTPs_MlsxFmt() Note #3.                          */
+                     if ((match               == DEF_YES)       &&
+                         (ftp_session->DtpCmd == FTP_CMD_MLSD) &&
+                         (FTPs_ListWalk.En    == DEF_YES)       &&
+                         (FTPs_ListWalk.Depth >  0u)) {
+                         cmp_dot     = Str_Cmp(dirent.NamePtr, (CPU_CHAR *)".");
+                         cmp_dot_dot = Str_Cmp(dirent.NamePtr, (CPU_CHAR *)"..");
+                         if ((cmp_dot == 0) || (cmp_dot_dot == 0)) {
+                             match = DEF_NO;
                          }
-
+                     }
+#endif
+                     if (match == DEF_YES) {
                          prn_buf     = FTPs_NetBufDtpCmdPtr + str_len_ttl;
                          prn_buf_len = FTPs_NET_BUF_LEN     - str_len_ttl;
-                         str_len     = Str_FmtPrint((char       *)prn_buf,
-                                                                  prn_buf_len,
-                                                                 "%cr%c-r%c-r%c-   1 user     group    %8u %3s %2u  %4u %s\n",
-                                                                  attr_dir,
-                                                                  attr_ro, attr_ro, attr_ro,
-                                                                  dirent.Size,
-                                                                  FTPs_Month_Name[dirent.DateTimeCreate.Month - 1],
-                                                    (unsigned int)dirent.DateTimeCreate.Day,
-                                                    (unsigned int)dirent.DateTimeCreate.Yr,
-                                                                  dirent.NamePtr);
+                         if (ftp_session->DtpCmd == FTP_CMD_MLSD) {
+                             p_name = dirent.NamePtr;
+#if (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+                             if (FTPs_ListWalk.En == DEF_YES) {
+                                 p_name = FTPs_ListWalkNameGet(dirent.NamePtr);
+                             }
+#endif
+                             str_len = FTPs_MlsxFmt(prn_buf,
+                                                    prn_buf_len,
+                                                   &dirent,
+                                                    p_name,
+                                                    (CPU_CHAR *)"\r\n");
+                         } else {
+                             str_len = FTPs_ListLineFmt(prn_buf, prn_buf_len, &dirent);
+                         }
 
                          if (str_len_ttl + str_len >= FTPs_NET_BUF_LEN) {
                              FTPs_Tx(ftp_session->DtpSockID, FTPs_NetBufDtpCmdPtr, str_len_ttl, &net_err);
@@ -2441,9 +12513,44 @@ static  void  FTPs_ProcessDtpCmd (FTPs_SESSION_STRUCT  *ftp_session)
                              continue;
                          }
 
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+                         if (p_list != (FTPs_LIST_ENTRY *)0) {  /* Keep line for following listings.                    */
+                             p_list = FTPs_ListFillAdd(p_list, prn_buf, str_len);
+                         }
+#endif
                          str_len_ttl += str_len;
                      }
                      fs_err = NetFS_DirRd(p_dir, &dirent);
+#if (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+                     if ((fs_err           != DEF_OK) &&        /* End of dir: list next dir of tree (see Note #1).     */
+                         (FTPs_ListWalk.En == DEF_YES)) {
+                         NetFS_DirClose(p_dir);
+                         p_dir = FTPs_ListWalkNext();
+                         if (p_dir == (void *)0) {
+                             break;
+                         }
+
+                         if (ftp_session->DtpCmd == FTP_CMD_LIST) {
+                             if (str_len_ttl + FTPs_CFG_FS_PATH_LEN_MAX + 3u >= FTPs_NET_BUF_LEN) {
+                                 FTPs_Tx(ftp_session->DtpSockID, FTPs_NetBufDtpCmdPtr, str_len_ttl, &net_err);
+                                 str_len_ttl = 0;
+                                 if (net_err != NET_SOCK_ERR_NONE) {
+                                     FTPs_TRACE_DBG(("FTPs FTPs_Tx() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
+                                     break;
+                                 }
+                             }
+                             prn_buf     = FTPs_NetBufDtpCmdPtr + str_len_ttl;
+                             prn_buf_len = FTPs_NET_BUF_LEN     - str_len_ttl;
+                             str_len     = Str_FmtPrint((char *)prn_buf,
+                                                                prn_buf_len,
+                                                                "\n%s:\n",
+                                                                FTPs_ListWalkRelGet());
+                             FTPs_ToFTPStylePath(prn_buf);
+                             str_len_ttl += str_len;
+                         }
+                         fs_err = NetFS_DirRd(p_dir, &dirent);
+                     }
+#endif
                  }
 
                  if (str_len_ttl > 0) {
@@ -2453,7 +12560,9 @@ static  void  FTPs_ProcessDtpCmd (FTPs_SESSION_STRUCT  *ftp_session)
                          break;
                      }
                  }
-                 NetFS_DirClose(p_dir);
+                 if (p_dir != (void *)0) {                      /* Closed at the end of a recursive listing.            */
+                     NetFS_DirClose(p_dir);
+                 }
              }
 
              if (net_err == NET_SOCK_ERR_NONE) {
@@ -2464,10 +12573,107 @@ static  void  FTPs_ProcessDtpCmd (FTPs_SESSION_STRUCT  *ftp_session)
              break;
 
         case FTP_CMD_RETR:
-             p_file = NetFS_FileOpen(ftp_session->CurEntry,
-                                     NET_FS_FILE_MODE_OPEN,
-                                     NET_FS_FILE_ACCESS_RD);
-             if (p_file == (void *)0) {
+#if (FTPs_CFG_TAR_EN == DEF_ENABLED)
+             if (FTPs_Tar.En == DEF_YES) {                      /* Send dir archive (see Note #2).                      */
+                 fs_err = FTPs_TarTx(ftp_session->DtpSockID,
+                                     FTPs_NetBufDtpCmdPtr,
+                                    (ftp_session->CtrlState == FTPs_STATE_GOTREST) ? ftp_session->DtpOffset : 0u,
+                                    &net_err);
+                 if (fs_err == DEF_OK) {
+                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CLOSINGSUCCESS, (CPU_CHAR *)0);
+                 } else {
+                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CLOSEDCONNABORT, (CPU_CHAR *)0);
+                 }
+                 break;
+             }
+#endif
+#if (FTPs_CFG_DELTA_EN == DEF_ENABLED)
+             if (FTPs_Delta.En == DEF_YES) {                    /* Send file signature (see Note #4).                   */
+                 fs_err = FTPs_DeltaSigTx(ftp_session->DtpSockID, FTPs_NetBufDtpCmdPtr, &net_err);
+                 if (fs_err == DEF_OK) {
+                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CLOSINGSUCCESS, (CPU_CHAR *)0);
+                 } else if (net_err != NET_SOCK_ERR_NONE) {
+                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CLOSEDCONNABORT, (CPU_CHAR *)0);
+                 } else {
+                     Str_FmtPrint((char *)FTPs_NetBufDtpCmdPtr,
+                                          FTPs_NET_BUF_LEN,
+                                  (char *)"551 Cannot read %s.",
+                                          FTPs_Delta.Path);
+                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ACTIONABORTED, FTPs_NetBufDtpCmdPtr);
+                 }
+                 break;
+             }
+#endif
+             p_file                  = ftp_session->DtpFilePtr; /* Use file opened by cmd validation, if any.           */
+             ftp_session->DtpFilePtr = (void *)0;
+#if (FTPs_CFG_TAIL_EN == DEF_ENABLED)
+             if ((FTPs_Tail.En == DEF_YES) &&                   /* Follow file (see Note #8).                           */
+                 (p_file       != (void *)0)) {
+                 fs_err = FTPs_TailTx(ftp_session, p_file, &net_err);
+                 FTPs_FileCloseRd(p_file);
+                 if (fs_err == DEF_OK) {
+                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CLOSINGSUCCESS, (CPU_CHAR *)0);
+                 } else if (net_err != NET_SOCK_ERR_NONE) {
+                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CLOSEDCONNABORT, (CPU_CHAR *)0);
+                 } else {
+                     Str_FmtPrint((char *)FTPs_NetBufDtpCmdPtr,
+                                          FTPs_NET_BUF_LEN,
+                                  (char *)"551 Cannot read %s.",
+                                          FTPs_Tail.Path);
+                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_ACTIONABORTED, FTPs_NetBufDtpCmdPtr);
+                 }
+                 FTPs_TailStop();
+                 break;
+             }
+#endif
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+             p_pin = FTPs_PinGet(ftp_session->CurEntry);        /* Serve pinned file from its memory image.             */
+             if (p_pin != (FTPs_PIN_ENTRY *)0) {
+                 p_mem   = p_pin->DataPtr;
+                 mem_len = p_pin->DataLen;
+             }
+#endif
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+             if (p_mem == (CPU_CHAR *)0) {                      /* Serve this file version from RAM, if cached.         */
+                 p_cache = FTPs_CacheGet( ftp_session->CurEntry,
+                                          ftp_session->DtpEntrySize,
+                                         &ftp_session->DtpEntryDateTime);
+                 if (p_cache != (FTPs_CACHE_ENTRY *)0) {
+                     p_mem   = p_cache->DataPtr;
+                     mem_len = p_cache->DataLen;
+                 }
+             }
+#endif
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+             if ((p_mem                  == (CPU_CHAR *)0) &&   /* Send octets prefetched in background, if any.        */
+                 (FTPs_PrefetchCurPtr    != (FTPs_PREFETCH_ENTRY *)0) &&
+                 (ftp_session->CtrlState != FTPs_STATE_GOTREST)) {
+                 p_pf    = FTPs_PrefetchCurPtr;
+                 p_mem   = p_pf->DataPtr;
+                 mem_len = p_pf->DataLen;
+             }
+#endif
+             if (p_mem != (CPU_CHAR *)0) {                      /* Sent from RAM: file not needed.                      */
+                 if (p_file != (void *)0) {
+                     FTPs_FileCloseRd(p_file);
+                     p_file = (void *)0;
+                 }
+             } else {
+                 if (p_file == (void *)0) {
+                     p_file = FTPs_FileOpenRd(ftp_session->CurEntry);
+                 }
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+                                                                /* Fill cache while sending the whole file.             */
+                 if ((p_file                 != (void *)0) &&
+                     (ftp_session->CtrlState != FTPs_STATE_GOTREST)) {
+                     p_fill = FTPs_CacheFillStart( ftp_session->CurEntry,
+                                                   ftp_session->DtpEntrySize,
+                                                  &ftp_session->DtpEntryDateTime);
+                 }
+#endif
+             }
+             if ((p_file == (void     *)0) &&
+                 (p_mem  == (CPU_CHAR *)0)) {
                  Str_FmtPrint((char *)FTPs_NetBufDtpCmdPtr,
                                       FTPs_NET_BUF_LEN,
                               (char *)"551 Cannot open %s: access denied.",
@@ -2477,9 +12683,20 @@ static  void  FTPs_ProcessDtpCmd (FTPs_SESSION_STRUCT  *ftp_session)
              }
 
              if (ftp_session->CtrlState == FTPs_STATE_GOTREST) {
-                 fs_err = NetFS_FilePosSet(p_file, ftp_session->DtpOffset, NET_FS_SEEK_ORIGIN_START);
+                 if (p_mem != (CPU_CHAR *)0) {
+                     if (ftp_session->DtpOffset <= mem_len) {
+                         mem_pos = ftp_session->DtpOffset;
+                         fs_err  = DEF_OK;
+                     } else {
+                         fs_err  = DEF_FAIL;
+                     }
+                 } else {
+                     fs_err = NetFS_FilePosSet(p_file, ftp_session->DtpOffset, NET_FS_SEEK_ORIGIN_START);
+                 }
                  if (fs_err != DEF_OK) {
-                     NetFS_FileClose(p_file);
+                     if (p_file != (void *)0) {
+                         FTPs_FileCloseRd(p_file);
+                     }
                      Str_FmtPrint((char       *)FTPs_NetBufDtpCmdPtr,
                                                 FTPs_NET_BUF_LEN,
                                   (char       *)"551 Cannot seek file %s to offset %u.",
@@ -2490,11 +12707,54 @@ static  void  FTPs_ProcessDtpCmd (FTPs_SESSION_STRUCT  *ftp_session)
                  }
              }
 
+             tx_rem = DEF_INT_32U_MAX_VAL;
+             if ((ftp_session->CtrlState == FTPs_STATE_GOTREST) &&
+                 (ftp_session->DtpLen    >  0u)) {              /* Send byte range only (see Note #5).                  */
+                 tx_rem = ftp_session->DtpLen;
+             }
+
              while (DEF_TRUE) {
-                 fs_err = NetFS_FileRd((void       *) p_file,
-                                         (void       *) FTPs_NetBufDtpCmdPtr,
-                                         (CPU_SIZE_T  ) FTPs_NET_BUF_LEN,
-                                         (CPU_SIZE_T *)&fs_len);
+                 rd_len = DEF_MIN(tx_rem, FTPs_NET_BUF_LEN);
+                 if (mem_pos < mem_len) {                       /* Send from RAM ...                                    */
+                     p_buf    = p_mem + mem_pos;
+                     fs_len   = DEF_MIN(mem_len - mem_pos, rd_len);
+                     mem_pos += fs_len;
+                     fs_err   = DEF_OK;
+                 } else {                                       /* ... or from the file system.                         */
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+                     if ((p_pf          != (FTPs_PREFETCH_ENTRY *)0) &&
+                         (p_pf->DataLen <   p_pf->Size)) {      /* Open rest of prefetched file.                        */
+                         p_file = FTPs_PrefetchFileOpen(p_pf);
+                         p_pf   = (FTPs_PREFETCH_ENTRY *)0;
+                         if (p_file == (void *)0) {
+                             FTPs_TRACE_DBG(("FTPs FTPs_PrefetchFileOpen() failed: line #%u.\n", (unsigned int)__LINE__));
+                             fs_err = DEF_FAIL;
+                             break;
+                         }
+                     }
+#endif
+                     if (p_file == (void *)0) {                 /* Whole file sent from RAM.                            */
+                         fs_err = DEF_OK;
+                         break;
+                     }
+                     p_buf    = FTPs_NetBufDtpCmdPtr;
+                     fs_err   = NetFS_FileRd((void       *) p_file,
+                                             (void       *) p_buf,
+                                             (CPU_SIZE_T  ) rd_len,
+                                             (CPU_SIZE_T *)&fs_len);
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+                     if (p_fill != (FTPs_CACHE_ENTRY *)0) {     /* Keep chunk for following readers.                    */
+                         if ((fs_err             == DEF_OK) &&
+                             (fill_len + fs_len  <= p_fill->DataLen)) {
+                             Mem_Copy(p_fill->DataPtr + fill_len, p_buf, fs_len);
+                             fill_len += fs_len;
+                         } else {                               /* File changed while being read: drop fill.            */
+                             FTPs_CacheFillEnd(p_fill, fill_len, DEF_NO);
+                             p_fill = (FTPs_CACHE_ENTRY *)0;
+                         }
+                     }
+#endif
+                 }
                  if (fs_len == 0) {
                      if (fs_err == DEF_FAIL) {
                          FTPs_TRACE_DBG(("FTPs NetFS_FileRd() failed: line #%u.\n", (unsigned int)__LINE__));
@@ -2502,16 +12762,30 @@ static  void  FTPs_ProcessDtpCmd (FTPs_SESSION_STRUCT  *ftp_session)
                      break;
                  }
 
-                 FTPs_Tx(ftp_session->DtpSockID, FTPs_NetBufDtpCmdPtr, fs_len, &net_err);
+                 FTPs_Tx(ftp_session->DtpSockID, p_buf, fs_len, &net_err);
                  if (net_err != NET_SOCK_ERR_NONE) {
                      FTPs_TRACE_DBG(("FTPs FTPs_Tx() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
                      break;
                  }
-                 if (fs_len != FTPs_NET_BUF_LEN) {
+                 tx_rem -= fs_len;
+                 if (tx_rem == 0u) {                            /* End of byte range.                                   */
+                     break;
+                 }
+                 if ((p_buf  == FTPs_NetBufDtpCmdPtr) &&        /* Short file read: end of file.                        */
+                     (fs_len != rd_len)) {
                      break;
                  }
              }
-             NetFS_FileClose(p_file);
+             if (p_file != (void *)0) {
+                 FTPs_FileCloseRd(p_file);
+             }
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+             if (p_fill != (FTPs_CACHE_ENTRY *)0) {             /* Publish entry only if whole file was sent.           */
+                 FTPs_CacheFillEnd(p_fill,
+                                   fill_len,
+                                  ((net_err == NET_SOCK_ERR_NONE) && (fs_err == DEF_OK)));
+             }
+#endif
 
              if ((net_err == NET_SOCK_ERR_NONE) && (fs_err == DEF_OK)) {
                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CLOSINGSUCCESS, (CPU_CHAR *)0);
@@ -2522,6 +12796,133 @@ static  void  FTPs_ProcessDtpCmd (FTPs_SESSION_STRUCT  *ftp_session)
 
         case FTP_CMD_STOR:
         case FTP_CMD_APPE:
+#if (FTPs_CFG_TAR_EXTRACT_EN == DEF_ENABLED)
+             if (FTPs_Tar.En == DEF_YES) {                      /* Extract dir archive (see Note #3).                   */
+                 fs_err = FTPs_TarRx(ftp_session->DtpSockID, FTPs_NetBufDtpCmdPtr, &net_err);
+                 if (net_err != NET_SOCK_ERR_NONE) {
+                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CLOSEDCONNABORT, (CPU_CHAR *)0);
+                     break;
+                 }
+                 if (fs_err == DEF_OK) {
+                     p_reply   = (CPU_CHAR *)"226 Archive extracted";
+                     reply_nbr =  FTP_REPLY_CLOSINGSUCCESS;
+                 } else if (FTPs_Tar.WrErr == DEF_YES) {
+                     p_reply   = (CPU_CHAR *)"552 Write error";
+                     reply_nbr =  FTP_REPLY_NOSPACE;
+                 } else {
+                     p_reply   = (CPU_CHAR *)"551 Invalid archive";
+                     reply_nbr =  FTP_REPLY_ACTIONABORTED;
+                 }
+                 Str_FmtPrint((char       *)FTPs_NetBufDtpCmdPtr,
+                                            FTPs_NET_BUF_LEN,
+                              (char       *)"%s: %u files & %u directories extracted, %u entries skipped.",
+                              (char       *)p_reply,
+                              (unsigned int)FTPs_Tar.NbrFile,
+                              (unsigned int)FTPs_Tar.NbrDir,
+                              (unsigned int)FTPs_Tar.NbrSkip);
+                 FTPs_SendReply(ftp_session->CtrlSockID, reply_nbr, FTPs_NetBufDtpCmdPtr);
+                 break;
+             }
+#endif
+#if (FTPs_CFG_DELTA_EN == DEF_ENABLED)
+             if (FTPs_Delta.En == DEF_YES) {                    /* Rebuild file from delta (see Note #4).               */
+                 fs_err = FTPs_DeltaRx(ftp_session->DtpSockID, FTPs_NetBufDtpCmdPtr, &net_err);
+                 if (net_err != NET_SOCK_ERR_NONE) {
+                     FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CLOSEDCONNABORT, (CPU_CHAR *)0);
+                     break;
+                 }
+                 switch (FTPs_Delta.Err) {
+                     case FTPs_DELTA_ERR_NONE:
+                          Str_FmtPrint((char       *)FTPs_NetBufDtpCmdPtr,
+                                                     FTPs_NET_BUF_LEN,
+                                       (char       *)"226 Delta applied: %u octets copied, %u octets received.",
+                                       (unsigned int)FTPs_Delta.NbrCopy,
+                                       (unsigned int)FTPs_Delta.NbrData);
+                          reply_nbr = FTP_REPLY_CLOSINGSUCCESS;
+                          break;
+
+                     case FTPs_DELTA_ERR_INVALID:
+                          Str_FmtPrint((char *)FTPs_NetBufDtpCmdPtr,
+                                               FTPs_NET_BUF_LEN,
+                                       (char *)"551 Invalid delta: %s unchanged.",
+                                               FTPs_Delta.Path);
+                          reply_nbr = FTP_REPLY_ACTIONABORTED;
+                          break;
+
+                     case FTPs_DELTA_ERR_REPLACE:
+                          Str_FmtPrint((char *)FTPs_NetBufDtpCmdPtr,
+                                               FTPs_NET_BUF_LEN,
+                                       (char *)"553 Cannot replace %s: new file left in %s.",
+                                               FTPs_Delta.Path,
+                                               FTPs_Delta.TmpPath);
+                          reply_nbr = FTP_REPLY_NAMEERR;
+                          break;
+
+                     case FTPs_DELTA_ERR_WR:
+                     default:
+                          Str_FmtPrint((char *)FTPs_NetBufDtpCmdPtr,
+                                               FTPs_NET_BUF_LEN,
+                                       (char *)"552 Cannot write %s: file unchanged.",
+                                               FTPs_Delta.Path);
+                          reply_nbr = FTP_REPLY_NOSPACE;
+                          break;
+                 }
+                 FTPs_SendReply(ftp_session->CtrlSockID, reply_nbr, FTPs_NetBufDtpCmdPtr);
+                 break;
+             }
+#endif
+#if (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+             if (FTPs_SegsCurPtr != (FTPs_SEGS *)0) {           /* Write file segment (see Note #7).                    */
+                 seg_err = FTPs_SegsRx(ftp_session->DtpSockID,
+                                       FTPs_NetBufDtpCmdPtr,
+                                       ftp_session->DtpOffset,
+                                       ftp_session->DtpLen,
+                                      &net_err);
+                 switch (seg_err) {
+                     case FTPs_SEGS_ERR_NONE:
+                          if (FTPs_SegsCurPtr->En == DEF_YES) {
+                              Str_FmtPrint((char       *)FTPs_NetBufDtpCmdPtr,
+                                                         FTPs_NET_BUF_LEN,
+                                           (char       *)"226 Segment stored: %u of %u octets received.",
+                                           (unsigned int)FTPs_SegsCurPtr->NbrRx,
+                                           (unsigned int)FTPs_SegsCurPtr->Size);
+                          } else {
+                              Str_Copy_N(FTPs_NetBufDtpCmdPtr, "226 Segment stored: file complete.", FTPs_NET_BUF_LEN);
+                          }
+                          reply_nbr = FTP_REPLY_CLOSINGSUCCESS;
+                          break;
+
+                     case FTPs_SEGS_ERR_INCOMPLETE:
+                          Str_Copy_N(FTPs_NetBufDtpCmdPtr, "426 Segment incomplete: not recorded.", FTPs_NET_BUF_LEN);
+                          reply_nbr = FTP_REPLY_CLOSEDCONNABORT;
+                          break;
+
+                     case FTPs_SEGS_ERR_REPLACE:
+                          Str_Copy_N(FTPs_NetBufDtpCmdPtr, "553 Segment stored: file complete, but not replaced.", FTPs_NET_BUF_LEN);
+                          reply_nbr = FTP_REPLY_NAMEERR;
+                          break;
+
+                     case FTPs_SEGS_ERR_WR:
+                     default:
+                          Str_Copy_N(FTPs_NetBufDtpCmdPtr, "552 Cannot write segment.", FTPs_NET_BUF_LEN);
+                          reply_nbr = FTP_REPLY_NOSPACE;
+                          break;
+                 }
+                 FTPs_SendReply(ftp_session->CtrlSockID, reply_nbr, FTPs_NetBufDtpCmdPtr);
+                 break;
+             }
+            (void)FTPs_SegsCancel(ftp_session->CurEntry);       /* Whole file written: end segmented upload.            */
+#endif
+#if ((FTPs_CFG_DEDUP_EN  == DEF_ENABLED) || \
+     (FTPs_CFG_RESUME_EN == DEF_ENABLED))
+             p_sha = (FTPs_SHA256 *)0;
+#endif
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+             p_sha = FTPs_ResumeStart(ftp_session);             /* Journal upload (see Note #9).                        */
+#endif
+             FTPs_HandleClose(ftp_session->CurEntry);
+             FTPs_InvalidatePath(ftp_session->CurEntry);
+
              if ((ftp_session->CtrlCmd   == FTP_CMD_STOR) &&
                  (ftp_session->CtrlState != FTPs_STATE_GOTREST)) {
                  p_file = NetFS_FileOpen(ftp_session->CurEntry,
@@ -2534,6 +12935,11 @@ static  void  FTPs_ProcessDtpCmd (FTPs_SESSION_STRUCT  *ftp_session)
              }
 
              if (p_file == (void *)0) {
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+                 if (FTPs_Resume.En == DEF_YES) {               /* File unchanged (see Note #9).                        */
+                     FTPs_ResumeEnd((ftp_session->CtrlState == FTPs_STATE_GOTREST) ? DEF_NO : DEF_YES);
+                 }
+#endif
                  Str_FmtPrint((char *)FTPs_NetBufDtpCmdPtr,
                                       FTPs_NET_BUF_LEN,
                               (char *)"551 Cannot open %s: access denied.",
@@ -2546,6 +12952,11 @@ static  void  FTPs_ProcessDtpCmd (FTPs_SESSION_STRUCT  *ftp_session)
                  fs_err = NetFS_FilePosSet(p_file, ftp_session->DtpOffset, NET_FS_SEEK_ORIGIN_START);
                  if (fs_err != DEF_OK) {
                      NetFS_FileClose(p_file);
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+                     if (FTPs_Resume.En == DEF_YES) {           /* File unchanged: restore record (see Note #9).        */
+                         FTPs_ResumeEnd(DEF_NO);
+                     }
+#endif
                      Str_FmtPrint((char       *)FTPs_NetBufDtpCmdPtr,
                                                 FTPs_NET_BUF_LEN,
                                   (char       *)"551 Cannot seek file %s to offset %u.",
@@ -2556,16 +12967,30 @@ static  void  FTPs_ProcessDtpCmd (FTPs_SESSION_STRUCT  *ftp_session)
                  }
              }
 
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+             if (FTPs_Resume.En == DEF_YES) {                   /* Record upload start.                                 */
+                 FTPs_ResumeRecWr();
+             }
+#endif
+#if (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+             if ((p_sha                  == (FTPs_SHA256 *)0) &&
+                 (ftp_session->CtrlCmd   == FTP_CMD_STOR)     &&
+                 (ftp_session->CtrlState != FTPs_STATE_GOTREST)) {
+                 p_sha = &FTPs_Dedup.Sha;                       /* See Note #6.                                         */
+                 FTPs_Sha256Init(p_sha);
+             }
+#endif
+
              NetSock_CfgTimeoutRxQ_Set((NET_SOCK_ID  ) ftp_session->DtpSockID,
-                                       (CPU_INT32U   ) FTPs_CFG_DTP_MAX_RX_TIMEOUT_MS,
+                                       (CPU_INT32U   ) FTPs_DTP_RX_SLICE_MS,
                                        (NET_ERR     *)&net_err);
 
              while (DEF_TRUE) {
-                 net_len = NetSock_RxData(ftp_session->DtpSockID, FTPs_NetBufDtpCmdPtr, FTPs_NET_BUF_LEN, NET_SOCK_FLAG_NONE, &net_err);
+                 net_len = FTPs_Rx(ftp_session->DtpSockID, FTPs_NetBufDtpCmdPtr, FTPs_NET_BUF_LEN, &net_err);
                  if ((net_err != NET_SOCK_ERR_NONE) &&
                      (net_err != NET_SOCK_ERR_RX_Q_CLOSED) &&
                      (net_err != NET_SOCK_ERR_RX_Q_EMPTY)) {
-                     FTPs_TRACE_DBG(("FTPs NetSock_RxData() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
+                     FTPs_TRACE_DBG(("FTPs FTPs_Rx() failed: error #%u, line #%u.\n", (unsigned int)net_err, (unsigned int)__LINE__));
                      break;
                  }
 
@@ -2583,13 +13008,46 @@ static  void  FTPs_ProcessDtpCmd (FTPs_SESSION_STRUCT  *ftp_session)
                      FTPs_TRACE_DBG(("FTPs NetFS_FileWr() failed: line #%u.\n", (unsigned int)__LINE__));
                      break;
                  }
+#if ((FTPs_CFG_DEDUP_EN  == DEF_ENABLED) || \
+     (FTPs_CFG_RESUME_EN == DEF_ENABLED))
+                 if (p_sha != (FTPs_SHA256 *)0) {
+                     FTPs_Sha256Upd(p_sha, (CPU_INT08U *)FTPs_NetBufDtpCmdPtr, fs_len);
+                 }
+#endif
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+                 if (FTPs_Resume.En == DEF_YES) {               /* Record octets written (see Note #9).                 */
+                     p_file = FTPs_ResumeSync(ftp_session->CurEntry, p_file, fs_len);
+                     if (p_file == (void *)0) {
+                         fs_err = DEF_FAIL;
+                         break;
+                     }
+                 }
+#endif
+             }
+             if (p_file != (void *)0) {
+                 NetFS_FileClose(p_file);
              }
-             NetFS_FileClose(p_file);
+#if (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+             if (FTPs_Resume.En == DEF_YES) {
+                 FTPs_ResumeEnd(((net_err       == NET_SOCK_ERR_RX_Q_CLOSED) &&
+                                 (FTPs_DtpAbort == DEF_NO)) ? DEF_YES : DEF_NO);
+             }
+#endif
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+             FTPs_PinReload(ftp_session->CurEntry);             /* Re-read overwritten pinned file.                     */
+#endif
 
-             if (((net_err == NET_SOCK_ERR_NONE)        ||
-                  (net_err == NET_SOCK_ERR_RX_Q_CLOSED) ||
-                  (net_err == NET_SOCK_ERR_RX_Q_EMPTY)) &&
-                  (fs_err  == DEF_OK)) {
+             if (((net_err       == NET_SOCK_ERR_NONE)        ||
+                  (net_err       == NET_SOCK_ERR_RX_Q_CLOSED) ||
+                  (net_err       == NET_SOCK_ERR_RX_Q_EMPTY)) &&
+                  (fs_err        == DEF_OK)                   &&
+                  (FTPs_DtpAbort == DEF_NO)) {                  /* Aborted transfer is never complete.                  */
+#if (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+                 if (p_sha != (FTPs_SHA256 *)0) {
+                     FTPs_Sha256Final(p_sha, digest);
+                     FTPs_DedupIdxAdd(ftp_session->CurEntry, digest);
+                 }
+#endif
                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CLOSINGSUCCESS, (CPU_CHAR *)0);
              } else {
                  FTPs_SendReply(ftp_session->CtrlSockID, FTP_REPLY_CLOSEDCONNABORT, (CPU_CHAR *)0);
@@ -2599,6 +13057,12 @@ static  void  FTPs_ProcessDtpCmd (FTPs_SESSION_STRUCT  *ftp_session)
         default:
              break;
     }
+
+#if (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+    if (p_list != (FTPs_LIST_ENTRY *)0) {                       /* Publish listing only if completely sent.             */
+        FTPs_ListFillEnd(p_list, (net_err == NET_SOCK_ERR_NONE));
+    }
+#endif
 }
 
 
@@ -2614,9 +13078,14 @@ static  void  FTPs_ProcessDtpCmd (FTPs_SESSION_STRUCT  *ftp_session)
 *
 * Caller(s)   : FTPs_ProcessCtrlCmd().
 *
-* Note(s)     : This task implements the "DTP" (Data Transfer Process) as described in RFC 959.  The
-*               means by which the connection is established with the client depends on whether or not
-*               the DTP is to be passive or not.
+* Note(s)     : (1) This task implements the "DTP" (Data Transfer Process) as described in RFC 959.  The
+*                   means by which the connection is established with the client depends on whether or not
+*                   the DTP is to be passive or not.
+*
+*               (2) ABOR received during the transfer stops it within one buffer (see FTPs_AbortChk()).  The
+*                   transfer replies 426 & the data connection is closed, then ABOR is replied to with 226.
+*
+*               (3) The data connection is paced to the rate limits, if any (see FTPs_RatePace()).
 *********************************************************************************************************
 */
 
@@ -2717,9 +13186,12 @@ void  FTPs_DtpTask (void  *p_arg)
 
     if (net_err == NET_SOCK_ERR_NONE) {
         ftp_session->DtpSockID = dtp_sock_id;
+        FTPs_DtpSessionPtr     = ftp_session;                   /* See Notes #2 & #3.                                   */
+        FTPs_DtpAbort          = DEF_NO;
         FTPs_TRACE_INFO(("FTPs START transfer.\n"));
         FTPs_ProcessDtpCmd(ftp_session);
         FTPs_TRACE_INFO(("FTPs STOP transfer.\n"));
+        FTPs_DtpSessionPtr     = (FTPs_SESSION_STRUCT *)0;
     }
 
     FTPs_TRACE_INFO(("FTPs CLOSE DTP socket.\n"));
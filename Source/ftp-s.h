@@ -105,6 +105,200 @@
 #endif
 
 
+/*
+*********************************************************************************************************
+*                                        DEFAULT CONFIGURATION
+*
+* Note(s) : (1) Optional features MAY be left undefined in 'ftp-s_cfg.h'.  They are then disabled so that
+*               configuration files written for previous versions of FTPs remain valid.
+*********************************************************************************************************
+*/
+
+#ifndef  FTPs_CFG_FS_CASE_SENSITIVE                             /* See Note #1.                                         */
+#define  FTPs_CFG_FS_CASE_SENSITIVE                     DEF_DISABLED
+#endif
+
+#ifndef  FTPs_CFG_CACHE_EN
+#define  FTPs_CFG_CACHE_EN                              DEF_DISABLED
+#endif
+
+#ifndef  FTPs_CFG_CACHE_NBR_ENTRIES
+#define  FTPs_CFG_CACHE_NBR_ENTRIES                        4
+#endif
+
+#ifndef  FTPs_CFG_CACHE_ENTRY_SIZE_MAX
+#define  FTPs_CFG_CACHE_ENTRY_SIZE_MAX                  8192
+#endif
+
+#ifndef  FTPs_CFG_PIN_EN
+#define  FTPs_CFG_PIN_EN                                DEF_DISABLED
+#endif
+
+#ifndef  FTPs_CFG_PIN_NBR_ENTRIES
+#define  FTPs_CFG_PIN_NBR_ENTRIES                          2
+#endif
+
+#ifndef  FTPs_CFG_PREFETCH_EN
+#define  FTPs_CFG_PREFETCH_EN                           DEF_DISABLED
+#endif
+
+#ifndef  FTPs_CFG_PREFETCH_BUF_SIZE
+#define  FTPs_CFG_PREFETCH_BUF_SIZE                     4096
+#endif
+
+#ifndef  FTPs_CFG_HANDLE_CACHE_EN
+#define  FTPs_CFG_HANDLE_CACHE_EN                       DEF_DISABLED
+#endif
+
+#ifndef  FTPs_CFG_HANDLE_CACHE_NBR_ENTRIES
+#define  FTPs_CFG_HANDLE_CACHE_NBR_ENTRIES                 2
+#endif
+
+#ifndef  FTPs_CFG_META_CACHE_EN
+#define  FTPs_CFG_META_CACHE_EN                         DEF_DISABLED
+#endif
+
+#ifndef  FTPs_CFG_META_CACHE_NBR_ENTRIES
+#define  FTPs_CFG_META_CACHE_NBR_ENTRIES                   8
+#endif
+
+#ifndef  FTPs_CFG_META_CACHE_TTL_MS
+#define  FTPs_CFG_META_CACHE_TTL_MS                     2000
+#endif
+
+#ifndef  FTPs_CFG_NEG_CACHE_EN
+#define  FTPs_CFG_NEG_CACHE_EN                          DEF_DISABLED
+#endif
+
+#ifndef  FTPs_CFG_NEG_CACHE_NBR_ENTRIES
+#define  FTPs_CFG_NEG_CACHE_NBR_ENTRIES                    4
+#endif
+
+#ifndef  FTPs_CFG_NEG_CACHE_TTL_MS
+#define  FTPs_CFG_NEG_CACHE_TTL_MS                      1000
+#endif
+
+#ifndef  FTPs_CFG_LIST_CACHE_EN
+#define  FTPs_CFG_LIST_CACHE_EN                         DEF_DISABLED
+#endif
+
+#ifndef  FTPs_CFG_LIST_CACHE_NBR_ENTRIES
+#define  FTPs_CFG_LIST_CACHE_NBR_ENTRIES                   2
+#endif
+
+#ifndef  FTPs_CFG_LIST_CACHE_ENTRY_SIZE_MAX
+#define  FTPs_CFG_LIST_CACHE_ENTRY_SIZE_MAX             4096
+#endif
+
+#ifndef  FTPs_CFG_LIST_CACHE_TTL_MS
+#define  FTPs_CFG_LIST_CACHE_TTL_MS                     5000
+#endif
+
+#ifndef  FTPs_CFG_LIST_GLOB_EN
+#define  FTPs_CFG_LIST_GLOB_EN                          DEF_DISABLED
+#endif
+
+#ifndef  FTPs_CFG_LIST_RECURSIVE_EN
+#define  FTPs_CFG_LIST_RECURSIVE_EN                     DEF_DISABLED
+#endif
+
+#ifndef  FTPs_CFG_LIST_RECURSIVE_DEPTH_MAX
+#define  FTPs_CFG_LIST_RECURSIVE_DEPTH_MAX                 4
+#endif
+
+#ifndef  FTPs_CFG_SITE_COPY_EN
+#define  FTPs_CFG_SITE_COPY_EN                          DEF_DISABLED
+#endif
+
+#ifndef  FTPs_CFG_SITE_COPY_BUF_SIZE
+#define  FTPs_CFG_SITE_COPY_BUF_SIZE                    4096
+#endif
+
+#ifndef  FTPs_CFG_TAR_EN
+#define  FTPs_CFG_TAR_EN                                DEF_DISABLED
+#endif
+
+#ifndef  FTPs_CFG_TAR_DEPTH_MAX
+#define  FTPs_CFG_TAR_DEPTH_MAX                            4
+#endif
+
+#ifndef  FTPs_CFG_TAR_EXTRACT_EN
+#define  FTPs_CFG_TAR_EXTRACT_EN                        DEF_DISABLED
+#endif
+
+#ifndef  FTPs_CFG_DELTA_EN
+#define  FTPs_CFG_DELTA_EN                              DEF_DISABLED
+#endif
+
+#ifndef  FTPs_CFG_DELTA_BLK_SIZE
+#define  FTPs_CFG_DELTA_BLK_SIZE                        2048
+#endif
+
+#ifndef  FTPs_CFG_DEDUP_EN
+#define  FTPs_CFG_DEDUP_EN                              DEF_DISABLED
+#endif
+
+#ifndef  FTPs_CFG_DEDUP_NBR_MAX
+#define  FTPs_CFG_DEDUP_NBR_MAX                          256
+#endif
+
+#ifndef  FTPs_CFG_SEGS_EN
+#define  FTPs_CFG_SEGS_EN                               DEF_DISABLED
+#endif
+
+#ifndef  FTPs_CFG_SEGS_NBR_MAX
+#define  FTPs_CFG_SEGS_NBR_MAX                             2
+#endif
+
+#ifndef  FTPs_CFG_SEGS_RANGE_MAX
+#define  FTPs_CFG_SEGS_RANGE_MAX                          16
+#endif
+
+#ifndef  FTPs_CFG_SEGS_IDLE_TIMEOUT_MS
+#define  FTPs_CFG_SEGS_IDLE_TIMEOUT_MS               3600000
+#endif
+
+#ifndef  FTPs_CFG_TAIL_EN
+#define  FTPs_CFG_TAIL_EN                               DEF_DISABLED
+#endif
+
+#ifndef  FTPs_CFG_TAIL_IDLE_TIMEOUT_MS
+#define  FTPs_CFG_TAIL_IDLE_TIMEOUT_MS                 60000
+#endif
+
+#ifndef  FTPs_CFG_RESUME_EN
+#define  FTPs_CFG_RESUME_EN                             DEF_DISABLED
+#endif
+
+#ifndef  FTPs_CFG_RESUME_NBR_MAX
+#define  FTPs_CFG_RESUME_NBR_MAX                          16
+#endif
+
+#ifndef  FTPs_CFG_RESUME_SYNC_LEN
+#define  FTPs_CFG_RESUME_SYNC_LEN                      65536
+#endif
+
+#ifndef  FTPs_CFG_RATE_EN
+#define  FTPs_CFG_RATE_EN                               DEF_DISABLED
+#endif
+
+#ifndef  FTPs_CFG_RATE_GLOBAL_LIMIT
+#define  FTPs_CFG_RATE_GLOBAL_LIMIT                        0
+#endif
+
+#ifndef  FTPs_CFG_RATE_SESSION_LIMIT
+#define  FTPs_CFG_RATE_SESSION_LIMIT                       0
+#endif
+
+#ifndef  FTPs_CFG_RATE_BURST_MS
+#define  FTPs_CFG_RATE_BURST_MS                          100
+#endif
+
+#ifndef  FTPs_CFG_RATE_TMR_MS
+#define  FTPs_CFG_RATE_TMR_MS                              5
+#endif
+
+
 /*
 *********************************************************************************************************
 *                                                  FTP
@@ -140,7 +334,8 @@
 #define  FTPs_STATE_GOTUSER                                2
 #define  FTPs_STATE_GOTRNFR                                3
 #define  FTPs_STATE_GOTREST                                4
-#define  FTPs_STATE_MAX                                    5    /* This line MUST be the LAST!                          */
+#define  FTPs_STATE_GOTCPFR                                5
+#define  FTPs_STATE_MAX                                    6    /* This line MUST be the LAST!                          */
 
 
 /*
@@ -180,7 +375,28 @@
 #define  FTP_CMD_MDTM                                     28
 #define  FTP_CMD_PBSZ                                     29
 #define  FTP_CMD_PROT                                     30
-#define  FTP_CMD_MAX                                      31    /* This line MUST be the LAST!                          */
+#define  FTP_CMD_MLSD                                     31
+#define  FTP_CMD_MLST                                     32
+#define  FTP_CMD_SITE                                     33
+#define  FTP_CMD_ABOR                                     34
+#define  FTP_CMD_MAX                                      35    /* This line MUST be the LAST!                          */
+
+
+/*
+*********************************************************************************************************
+*                                           FTP SITE COMMANDS
+*********************************************************************************************************
+*/
+
+#define  FTP_SITE_CMD_HELP                                 0
+#define  FTP_SITE_CMD_RMTREE                               1
+#define  FTP_SITE_CMD_MKDIRS                               2
+#define  FTP_SITE_CMD_CPFR                                 3
+#define  FTP_SITE_CMD_CPTO                                 4
+#define  FTP_SITE_CMD_DEDUP                                5
+#define  FTP_SITE_CMD_SEGS                                 6
+#define  FTP_SITE_CMD_RESUME                               7
+#define  FTP_SITE_CMD_MAX                                  8    /* This line MUST be the LAST!                          */
 
 
 /*
@@ -218,7 +434,8 @@
 #define  FTP_REPLY_NAMEERR                                26
 #define  FTP_REPLY_PBSZ                                   27
 #define  FTP_REPLY_PROT                                   28
-#define  FTP_REPLY_MAX                                    29    /* This line MUST be the LAST!                          */
+#define  FTP_REPLY_SITEHELP                               29
+#define  FTP_REPLY_MAX                                    30    /* This line MUST be the LAST!                          */
 
 #define  FTP_REPLY_CODE_OKAYOPENING                      150
 #define  FTP_REPLY_CODE_OKAY                             200
@@ -249,6 +466,7 @@
 #define  FTP_REPLY_CODE_NAMEERR                          553
 #define FTP_REPLY_CODE_PBSZ                              554
 #define FTP_REPLY_CODE_PROT                              555
+#define  FTP_REPLY_CODE_SITEHELP                         214
 
 
 /*
@@ -315,6 +533,13 @@ typedef struct  FTPs_CmdStruct {
            CPU_BOOLEAN   CmdCntxt[FTPs_STATE_MAX];
 } FTPs_CMD_STRUCT;
 
+                                                                /* This structure is used to build a table of SITE      */
+                                                                /* sub-command codes and their corresponding strings.   */
+typedef struct  FTPs_SiteCmdStruct {
+           CPU_INT08U    CmdCode;
+    const  CPU_CHAR     *CmdStr;
+} FTPs_SITE_CMD_STRUCT;
+
                                                                 /* This structure is used to build a table of reply     */
                                                                 /* codes and their corresponding messages.              */
 typedef struct  FTPs_ReplyStruct {
@@ -342,9 +567,19 @@ typedef  struct  FTPs_SessionStruct {
     CPU_INT08U           DtpStru;
     CPU_INT08U           DtpCmd;
     CPU_INT32U           DtpOffset;
+    CPU_INT32U           DtpLen;                                /* Nbr of octets to send after REST (0 if up to EOF).   */
+    void                *DtpFilePtr;                            /* File opened by cmd validation, for the transfer.     */
+    void                *DtpDirPtr;                             /* Dir  opened by cmd validation, for the transfer.     */
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+    CPU_INT32U           DtpEntrySize;
+    NET_FS_DATE_TIME     DtpEntryDateTime;
+#endif
 
     CPU_CHAR             User[FTPs_CFG_USER_LEN_MAX];
     CPU_CHAR             Pass[FTPs_CFG_PASS_LEN_MAX];
+#if (FTPs_CFG_RATE_EN == DEF_ENABLED)
+    CPU_INT32U           RateLimit;                             /* Session rate limit, in octets/s (0 if none).         */
+#endif
 
     CPU_CHAR             BasePath[FTPs_CFG_FS_PATH_LEN_MAX];
     CPU_CHAR             RelPath [FTPs_CFG_FS_PATH_LEN_MAX];
@@ -361,6 +596,30 @@ typedef  struct  FTPs_SecureCfg {
     CPU_BOOLEAN                    CertChain;
 } FTPs_SECURE_CFG;
 
+                                                                /* Content cache statistics (see FTPs_CacheStatGet()).  */
+typedef  struct  FTPs_CacheStat {
+    CPU_INT32U           HitCtr;                                /* Nbr of RETR served from the cache.                   */
+    CPU_INT32U           MissCtr;                               /* Nbr of RETR served from the file system.             */
+    CPU_INT32U           EvictCtr;                              /* Nbr of entries evicted to load another file.         */
+    CPU_INT32U           InvalidateCtr;                         /* Nbr of entries invalidated by a modification.        */
+} FTPs_CACHE_STAT;
+
+                                                                /* Prefetcher statistics (see FTPs_PrefetchStatGet()).  */
+typedef  struct  FTPs_PrefetchStat {
+    CPU_INT32U           HitCtr;                                /* Nbr of sequential RETR found prefetched.             */
+    CPU_INT32U           MissCtr;                               /* Nbr of sequential RETR NOT found prefetched.         */
+    CPU_INT32U           PrefetchCtr;                           /* Nbr of files prefetched.                             */
+    CPU_INT32U           DiscardCtr;                            /* Nbr of prefetched files discarded unused.            */
+} FTPs_PREFETCH_STAT;
+
+                                                                /* Metadata cache stats (see FTPs_MetaCacheStatGet()).  */
+typedef  struct  FTPs_MetaCacheStat {
+    CPU_INT32U           HitCtr;                                /* Nbr of lookups served from the cache.                */
+    CPU_INT32U           MissCtr;                               /* Nbr of lookups served from the file system.          */
+    CPU_INT32U           ExpireCtr;                             /* Nbr of entries discarded because of their age.       */
+    CPU_INT32U           InvalidateCtr;                         /* Nbr of entries invalidated by a modification.        */
+} FTPs_META_CACHE_STAT;
+
 
 /*
 *********************************************************************************************************
@@ -383,6 +642,35 @@ void         FTPs_ServerTask   (       void             *p_arg);
                                                                 /* Control task: control session with the client.       */
 void         FTPs_CtrlTask     (       void             *p_arg);
 
+#if (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+                                                                /* Get content cache statistics.                        */
+void         FTPs_CacheStatGet (       FTPs_CACHE_STAT  *p_stat);
+#endif
+
+#if (FTPs_CFG_PIN_EN == DEF_ENABLED)
+                                                                /* Pin a file in RAM.                                   */
+CPU_BOOLEAN  FTPs_PinFile      (       CPU_CHAR         *path,
+                                       CPU_SIZE_T        size_max);
+#endif
+
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+                                                                /* Prefetch task: warms the next file of a directory.   */
+void         FTPs_PrefetchTask (       void             *p_arg);
+
+                                                                /* Get prefetcher statistics.                           */
+void         FTPs_PrefetchStatGet(     FTPs_PREFETCH_STAT  *p_stat);
+#endif
+
+#if (FTPs_CFG_META_CACHE_EN == DEF_ENABLED)
+                                                                /* Get metadata cache statistics.                       */
+void         FTPs_MetaCacheStatGet(    FTPs_META_CACHE_STAT  *p_stat);
+#endif
+
+#if (FTPs_CFG_TAIL_EN == DEF_ENABLED)
+                                                                /* Signal octets appended to a file.                    */
+void         FTPs_TailNotify(          CPU_CHAR              *path);
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -428,6 +716,10 @@ void         FTPs_CtrlTask     (       void             *p_arg);
 *               BasePath and RelPath MAY use name lengths according to the underlying filesystem.
 *               Paths separators WILL be converted to the underlying filesystem separator by FTPs.
 *
+*               If rate limiting is enabled (see FTPs_CFG_RATE_EN), the application MAY set the RateLimit
+*               field to the limit of the user, in octets per second (0 for none, at most 1000000000).  It
+*               is initialized to FTPs_CFG_RATE_SESSION_LIMIT.
+*
 *********************************************************************************************************
 */
 
@@ -445,6 +737,10 @@ CPU_BOOLEAN  FTPs_OS_ServerTaskInit(void  *p_arg);              /* Create server
 
 CPU_BOOLEAN  FTPs_OS_CtrlTaskInit  (void  *p_arg);              /* Create ctrl   task.                                  */
 
+#if (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+CPU_BOOLEAN  FTPs_OS_PrefetchTaskInit(void  *p_arg);            /* Create prefetch task.                                */
+#endif
+
 void         FTPs_OS_TaskSuspend   (void);                      /* Suspend   cur task.                                  */
 
 void         FTPs_OS_TaskDel       (void);                      /* Terminate cur task.                                  */
@@ -585,6 +881,348 @@ void         FTPs_OS_TaskDel       (void);                      /* Terminate cur
 #error  "                                     named 'ftp-s_cfg.h'                 "
 #endif
 
+                                                                /* File names case sensitivity.                         */
+#if     ((FTPs_CFG_FS_CASE_SENSITIVE != DEF_ENABLED ) && \
+         (FTPs_CFG_FS_CASE_SENSITIVE != DEF_DISABLED))
+#error  "FTPs_CFG_FS_CASE_SENSITIVE           illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_ENABLED ]             "
+#error  "                                     [     ||  DEF_DISABLED]             "
+#endif
+
+                                                                /* RETR content cache.                                  */
+#if     ((FTPs_CFG_CACHE_EN != DEF_ENABLED ) && \
+         (FTPs_CFG_CACHE_EN != DEF_DISABLED))
+#error  "FTPs_CFG_CACHE_EN                    illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_ENABLED ]             "
+#error  "                                     [     ||  DEF_DISABLED]             "
+
+#elif   (FTPs_CFG_CACHE_EN == DEF_ENABLED)
+#if     (FTPs_CFG_CACHE_NBR_ENTRIES < 1)
+#error  "FTPs_CFG_CACHE_NBR_ENTRIES           illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1]                     "
+#endif
+
+#if     (FTPs_CFG_CACHE_ENTRY_SIZE_MAX < FTPs_NET_BUF_LEN)
+#error  "FTPs_CFG_CACHE_ENTRY_SIZE_MAX        illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= FTPs_NET_BUF_LEN]      "
+#endif
+#endif
+
+                                                                /* Pinned files.                                        */
+#if     ((FTPs_CFG_PIN_EN != DEF_ENABLED ) && \
+         (FTPs_CFG_PIN_EN != DEF_DISABLED))
+#error  "FTPs_CFG_PIN_EN                      illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_ENABLED ]             "
+#error  "                                     [     ||  DEF_DISABLED]             "
+
+#elif   (FTPs_CFG_PIN_EN == DEF_ENABLED)
+#if     (FTPs_CFG_PIN_NBR_ENTRIES < 1)
+#error  "FTPs_CFG_PIN_NBR_ENTRIES             illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1]                     "
+#endif
+#endif
+
+                                                                /* Sequential-access prefetcher.                        */
+#if     ((FTPs_CFG_PREFETCH_EN != DEF_ENABLED ) && \
+         (FTPs_CFG_PREFETCH_EN != DEF_DISABLED))
+#error  "FTPs_CFG_PREFETCH_EN                 illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_ENABLED ]             "
+#error  "                                     [     ||  DEF_DISABLED]             "
+
+#elif   (FTPs_CFG_PREFETCH_EN == DEF_ENABLED)
+#if     (FTPs_CFG_PREFETCH_BUF_SIZE < FTPs_NET_BUF_LEN)
+#error  "FTPs_CFG_PREFETCH_BUF_SIZE           illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= FTPs_NET_BUF_LEN]      "
+#endif
+
+#ifndef  FTPs_OS_CFG_PREFETCH_TASK_PRIO
+#error  "FTPs_OS_CFG_PREFETCH_TASK_PRIO             not #define'd in 'ftp-s_cfg.h'"
+#error  "                                     see template file in package        "
+#error  "                                     named 'ftp-s_cfg.h'                 "
+#endif
+
+#ifndef  FTPs_OS_CFG_PREFETCH_TASK_STK_SIZE
+#error  "FTPs_OS_CFG_PREFETCH_TASK_STK_SIZE         not #define'd in 'ftp-s_cfg.h'"
+#error  "                                     see template file in package        "
+#error  "                                     named 'ftp-s_cfg.h'                 "
+#endif
+#endif
+
+                                                                /* File handle cache.                                   */
+#if     ((FTPs_CFG_HANDLE_CACHE_EN != DEF_ENABLED ) && \
+         (FTPs_CFG_HANDLE_CACHE_EN != DEF_DISABLED))
+#error  "FTPs_CFG_HANDLE_CACHE_EN             illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_ENABLED ]             "
+#error  "                                     [     ||  DEF_DISABLED]             "
+
+#elif   (FTPs_CFG_HANDLE_CACHE_EN == DEF_ENABLED)
+#if     (FTPs_CFG_HANDLE_CACHE_NBR_ENTRIES < 1)
+#error  "FTPs_CFG_HANDLE_CACHE_NBR_ENTRIES    illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1]                     "
+#endif
+#endif
+
+                                                                /* Metadata cache.                                      */
+#if     ((FTPs_CFG_META_CACHE_EN != DEF_ENABLED ) && \
+         (FTPs_CFG_META_CACHE_EN != DEF_DISABLED))
+#error  "FTPs_CFG_META_CACHE_EN               illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_ENABLED ]             "
+#error  "                                     [     ||  DEF_DISABLED]             "
+
+#elif   (FTPs_CFG_META_CACHE_EN == DEF_ENABLED)
+#if     (FTPs_CFG_META_CACHE_NBR_ENTRIES < 1)
+#error  "FTPs_CFG_META_CACHE_NBR_ENTRIES      illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1]                     "
+#endif
+
+#if     (FTPs_CFG_META_CACHE_TTL_MS < 1)
+#error  "FTPs_CFG_META_CACHE_TTL_MS           illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1]                     "
+#endif
+#endif
+
+                                                                /* Negative lookup cache.                               */
+#if     ((FTPs_CFG_NEG_CACHE_EN != DEF_ENABLED ) && \
+         (FTPs_CFG_NEG_CACHE_EN != DEF_DISABLED))
+#error  "FTPs_CFG_NEG_CACHE_EN                illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_ENABLED ]             "
+#error  "                                     [     ||  DEF_DISABLED]             "
+
+#elif   (FTPs_CFG_NEG_CACHE_EN == DEF_ENABLED)
+#if     (FTPs_CFG_NEG_CACHE_NBR_ENTRIES < 1)
+#error  "FTPs_CFG_NEG_CACHE_NBR_ENTRIES       illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1]                     "
+#endif
+
+#if     (FTPs_CFG_NEG_CACHE_TTL_MS < 1)
+#error  "FTPs_CFG_NEG_CACHE_TTL_MS            illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1]                     "
+#endif
+#endif
+
+                                                                /* Directory listing cache.                             */
+#if     ((FTPs_CFG_LIST_CACHE_EN != DEF_ENABLED ) && \
+         (FTPs_CFG_LIST_CACHE_EN != DEF_DISABLED))
+#error  "FTPs_CFG_LIST_CACHE_EN               illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_ENABLED ]             "
+#error  "                                     [     ||  DEF_DISABLED]             "
+
+#elif   (FTPs_CFG_LIST_CACHE_EN == DEF_ENABLED)
+#if     (FTPs_CFG_LIST_CACHE_NBR_ENTRIES < 1)
+#error  "FTPs_CFG_LIST_CACHE_NBR_ENTRIES      illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1]                     "
+#endif
+
+#if     (FTPs_CFG_LIST_CACHE_ENTRY_SIZE_MAX < 1)
+#error  "FTPs_CFG_LIST_CACHE_ENTRY_SIZE_MAX   illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1]                     "
+#endif
+
+#if     (FTPs_CFG_LIST_CACHE_TTL_MS < 1)
+#error  "FTPs_CFG_LIST_CACHE_TTL_MS           illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1]                     "
+#endif
+#endif
+
+                                                                /* Listing name patterns.                               */
+#if     ((FTPs_CFG_LIST_GLOB_EN != DEF_ENABLED ) && \
+         (FTPs_CFG_LIST_GLOB_EN != DEF_DISABLED))
+#error  "FTPs_CFG_LIST_GLOB_EN                illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_ENABLED ]             "
+#error  "                                     [     ||  DEF_DISABLED]             "
+#endif
+
+                                                                /* Recursive listings.                                  */
+#if     ((FTPs_CFG_LIST_RECURSIVE_EN != DEF_ENABLED ) && \
+         (FTPs_CFG_LIST_RECURSIVE_EN != DEF_DISABLED))
+#error  "FTPs_CFG_LIST_RECURSIVE_EN           illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_ENABLED ]             "
+#error  "                                     [     ||  DEF_DISABLED]             "
+
+#elif   (FTPs_CFG_LIST_RECURSIVE_EN == DEF_ENABLED)
+#if     (FTPs_CFG_LIST_RECURSIVE_DEPTH_MAX < 1)
+#error  "FTPs_CFG_LIST_RECURSIVE_DEPTH_MAX    illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1]                     "
+#endif
+#endif
+
+                                                                /* Server-side copy.                                    */
+#if     ((FTPs_CFG_SITE_COPY_EN != DEF_ENABLED ) && \
+         (FTPs_CFG_SITE_COPY_EN != DEF_DISABLED))
+#error  "FTPs_CFG_SITE_COPY_EN                illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_ENABLED ]             "
+#error  "                                     [     ||  DEF_DISABLED]             "
+
+#elif   (FTPs_CFG_SITE_COPY_EN == DEF_ENABLED)
+#if     (FTPs_CFG_SITE_COPY_BUF_SIZE < 512)
+#error  "FTPs_CFG_SITE_COPY_BUF_SIZE          illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 512]                   "
+#endif
+#endif
+
+                                                                /* Directory archives.                                  */
+#if     ((FTPs_CFG_TAR_EN != DEF_ENABLED ) && \
+         (FTPs_CFG_TAR_EN != DEF_DISABLED))
+#error  "FTPs_CFG_TAR_EN                      illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_ENABLED ]             "
+#error  "                                     [     ||  DEF_DISABLED]             "
+
+#elif   (FTPs_CFG_TAR_EN == DEF_ENABLED)
+#if     (FTPs_CFG_TAR_DEPTH_MAX < 1)
+#error  "FTPs_CFG_TAR_DEPTH_MAX               illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1]                     "
+#endif
+#endif
+
+#if     ((FTPs_CFG_TAR_EXTRACT_EN != DEF_ENABLED ) && \
+         (FTPs_CFG_TAR_EXTRACT_EN != DEF_DISABLED))
+#error  "FTPs_CFG_TAR_EXTRACT_EN              illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_ENABLED ]             "
+#error  "                                     [     ||  DEF_DISABLED]             "
+
+#elif   ((FTPs_CFG_TAR_EXTRACT_EN == DEF_ENABLED) && \
+         (FTPs_CFG_TAR_EN         != DEF_ENABLED))
+#error  "FTPs_CFG_TAR_EXTRACT_EN              illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_DISABLED           ]  "
+#error  "                                     [     if  FTPs_CFG_TAR_EN disabled]  "
+#endif
+
+                                                                /* Delta transfers.                                     */
+#if     ((FTPs_CFG_DELTA_EN != DEF_ENABLED ) && \
+         (FTPs_CFG_DELTA_EN != DEF_DISABLED))
+#error  "FTPs_CFG_DELTA_EN                    illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_ENABLED ]             "
+#error  "                                     [     ||  DEF_DISABLED]             "
+
+#elif   (FTPs_CFG_DELTA_EN == DEF_ENABLED)
+#if     ((FTPs_CFG_DELTA_BLK_SIZE <   512) || \
+         (FTPs_CFG_DELTA_BLK_SIZE > 65535))
+#error  "FTPs_CFG_DELTA_BLK_SIZE              illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >=   512]                 "
+#error  "                                     [     &&  <= 65535]                 "
+#endif
+#endif
+
+                                                                /* Deduplication.                                       */
+#if     ((FTPs_CFG_DEDUP_EN != DEF_ENABLED ) && \
+         (FTPs_CFG_DEDUP_EN != DEF_DISABLED))
+#error  "FTPs_CFG_DEDUP_EN                    illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_ENABLED ]             "
+#error  "                                     [     ||  DEF_DISABLED]             "
+
+#elif   (FTPs_CFG_DEDUP_EN == DEF_ENABLED)
+#if     (FTPs_CFG_SITE_COPY_EN != DEF_ENABLED)
+#error  "FTPs_CFG_DEDUP_EN                    illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_DISABLED                 ]"
+#error  "                                     [     if  FTPs_CFG_SITE_COPY_EN disabled]"
+#endif
+
+#ifndef  FTPs_CFG_DEDUP_IDX_PATH
+#error  "FTPs_CFG_DEDUP_IDX_PATH              not #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  outside of users' base paths]"
+#endif
+
+#if     (FTPs_CFG_DEDUP_NBR_MAX < 1)
+#error  "FTPs_CFG_DEDUP_NBR_MAX               illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1]                     "
+#endif
+#endif
+
+                                                                /* Segmented uploads.                                   */
+#if     ((FTPs_CFG_SEGS_EN != DEF_ENABLED ) && \
+         (FTPs_CFG_SEGS_EN != DEF_DISABLED))
+#error  "FTPs_CFG_SEGS_EN                     illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_ENABLED ]             "
+#error  "                                     [     ||  DEF_DISABLED]             "
+
+#elif   (FTPs_CFG_SEGS_EN == DEF_ENABLED)
+#if     (FTPs_CFG_SEGS_NBR_MAX < 1)
+#error  "FTPs_CFG_SEGS_NBR_MAX                illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1]                     "
+#endif
+
+#if     ((FTPs_CFG_SEGS_RANGE_MAX <   1) || \
+         (FTPs_CFG_SEGS_RANGE_MAX > 255))
+#error  "FTPs_CFG_SEGS_RANGE_MAX              illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >=   1]                   "
+#error  "                                     [     &&  <= 255]                   "
+#endif
+
+#if     (FTPs_CFG_SEGS_IDLE_TIMEOUT_MS < 1)
+#error  "FTPs_CFG_SEGS_IDLE_TIMEOUT_MS        illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1]                     "
+#endif
+#endif
+
+                                                                /* Tail-follow RETR.                                    */
+#if     ((FTPs_CFG_TAIL_EN != DEF_ENABLED ) && \
+         (FTPs_CFG_TAIL_EN != DEF_DISABLED))
+#error  "FTPs_CFG_TAIL_EN                     illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_ENABLED ]             "
+#error  "                                     [     ||  DEF_DISABLED]             "
+
+#elif   (FTPs_CFG_TAIL_EN == DEF_ENABLED)
+#if     (FTPs_CFG_TAIL_IDLE_TIMEOUT_MS < 1)
+#error  "FTPs_CFG_TAIL_IDLE_TIMEOUT_MS        illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1]                     "
+#endif
+#endif
+
+                                                                /* Resume journal.                                      */
+#if     ((FTPs_CFG_RESUME_EN != DEF_ENABLED ) && \
+         (FTPs_CFG_RESUME_EN != DEF_DISABLED))
+#error  "FTPs_CFG_RESUME_EN                   illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_ENABLED ]             "
+#error  "                                     [     ||  DEF_DISABLED]             "
+
+#elif   (FTPs_CFG_RESUME_EN == DEF_ENABLED)
+#ifndef  FTPs_CFG_RESUME_JRNL_PATH
+#error  "FTPs_CFG_RESUME_JRNL_PATH            not #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  outside of users' base paths]"
+#endif
+
+#if     (FTPs_CFG_RESUME_NBR_MAX < 1)
+#error  "FTPs_CFG_RESUME_NBR_MAX              illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1]                     "
+#endif
+
+#if     (FTPs_CFG_RESUME_SYNC_LEN < 1)
+#error  "FTPs_CFG_RESUME_SYNC_LEN             illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1]                     "
+#endif
+#endif
+
+                                                                /* Rate limiting.                                       */
+#if     ((FTPs_CFG_RATE_EN != DEF_ENABLED ) && \
+         (FTPs_CFG_RATE_EN != DEF_DISABLED))
+#error  "FTPs_CFG_RATE_EN                     illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  DEF_ENABLED ]             "
+#error  "                                     [     ||  DEF_DISABLED]             "
+
+#elif   (FTPs_CFG_RATE_EN == DEF_ENABLED)
+#if     ((FTPs_CFG_RATE_BURST_MS < 1) || \
+         (FTPs_CFG_RATE_BURST_MS > 1000))
+#error  "FTPs_CFG_RATE_BURST_MS               illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1   ]                  "
+#error  "                                     [     &&  <= 1000]                  "
+#endif
+
+#if     (FTPs_CFG_RATE_GLOBAL_LIMIT > 1000000000)
+#error  "FTPs_CFG_RATE_GLOBAL_LIMIT           illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  <= 1000000000]            "
+#endif
+
+#if     (FTPs_CFG_RATE_SESSION_LIMIT > 1000000000)
+#error  "FTPs_CFG_RATE_SESSION_LIMIT          illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  <= 1000000000]            "
+#endif
+
+#if     (FTPs_CFG_RATE_TMR_MS < 1)
+#error  "FTPs_CFG_RATE_TMR_MS                 illegally #define'd in 'ftp-s_cfg.h'"
+#error  "                                     [MUST be  >= 1]                     "
+#endif
+#endif
+
 
 #if     (FTPs_OS_CFG_SERVER_TASK_PRIO <= NET_OS_CFG_IF_TX_DEALLOC_TASK_PRIO)
 #error  "FTPs_OS_CFG_SERVER_TASK_PRIO         illegally #define'd in 'net_cfg.h'             "